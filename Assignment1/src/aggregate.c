@@ -0,0 +1,603 @@
+/*
+ * Reservation Aggregation Implementation
+ *
+ * Group-by queries over the reservations joined to their flights. The flights are turned
+ * into a read-only join table once (ID hash, airport names as sorted codes, departure day
+ * numbers), then every thread aggregates a slice of the reservations into its own
+ * open-addressing hash table, so the hot loop shares nothing. The per-thread tables are
+ * merged and the groups sorted at the end.
+ *
+ * Sources used:
+ * 1. "Introduction to Algorithms" (CLRS) - Open addressing with linear probing
+ * 2. "Morsel-Driven Parallelism" by Leis et al. - Thread-local pre-aggregation and merge
+ * 3. POSIX Threads Programming (Lawrence Livermore National Laboratory) - pthread_create/join
+ */
+#define _CRT_SECURE_NO_DEPRECATE
+#define _POSIX_C_SOURCE 200809L  // For sysconf
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "aggregate.h"
+#include "csv_writer.h"
+#include "timing.h"
+
+#define SECONDS_PER_DAY (24 * 60 * 60)
+
+// Days the calendar extends before the first and after the last departure
+#define AGGREGATE_CALENDAR_MARGIN (5 * 366)
+
+// Initial size of a per-thread group table (grows at half full)
+#define AGGREGATE_INITIAL_GROUPS 1024
+
+// Fewest reservations worth giving to one more thread
+#define AGGREGATE_ROWS_PER_THREAD 65536
+
+// Space reserved for one output row: every key at its longest plus the numbers
+#define AGGREGATE_MAX_ROW_LENGTH (AGGREGATE_MAX_KEYS * 64 + 128)
+
+// ID of a free slot in the join table
+#define AGGREGATE_EMPTY_ID (-2147483647 - 1)
+
+// Key part that a row fills in from its reservation (the booking day)
+#define AGGREGATE_PER_ROW (-1)
+
+// Column names, indexed by AggregateKey and AggregateValue
+static const char* key_names[AGGREGATE_KEY_COUNT] = {
+    "origin", "destination", "departure_day", "booking_day", "flight_id"
+};
+static const char* value_names[AGGREGATE_VALUE_COUNT] = {"lead_days", "capacity"};
+
+// A flight as the join sees it: the key parts it decides, and what the values need.
+// 32 bytes, so a lookup touches one cache line
+typedef struct {
+    int key[AGGREGATE_MAX_KEYS];
+    time_t departureTime;
+    int id;
+    int capacity;
+} JoinedFlight;
+
+// Read-only join table shared by every thread
+typedef struct {
+    const AggregateQuery* query;
+    JoinedFlight* flights;  // Open-addressing table by flight ID; the size is a power of two
+    int slot_mask;
+    time_t* day_starts;
+    int day_count;
+    int booking_part;     // Position of the booking day in the key, or -1
+} JoinTable;
+
+// One thread's groups: an open-addressing table where count 0 marks a free slot
+typedef struct {
+    AggregateGroup* groups;
+    int capacity;  // Power of two
+    int count;
+} GroupTable;
+
+// One thread's slice of the reservations
+typedef struct {
+    const JoinTable* join;
+    const ReservationRecord* reservations;
+    int first;
+    int last;
+    GroupTable table;
+    long long rows;
+    long long skipped;
+    int ok;
+} AggregateWorker;
+
+//--- PARSING ---//
+
+// Parse a comma-separated key list into a query
+int aggregate_parse_keys(const char* text, AggregateQuery* query) {
+    char copy[MAX_LINE_LENGTH];
+    snprintf(copy, sizeof(copy), "%s", text);
+    query->key_count = 0;
+    
+    char* save = NULL;
+    for (char* token = strtok_r(copy, ",", &save); token != NULL; token = strtok_r(NULL, ",", &save)) {
+        int found = -1;
+        for (int k = 0; k < AGGREGATE_KEY_COUNT; k++) {
+            if (strcmp(token, key_names[k]) == 0) found = k;
+        }
+        if (found < 0) {
+            fprintf(stderr, "Unknown group-by key '%s' (expected origin, destination, departure_day, "
+                    "booking_day or flight_id)\n", token);
+            return 0;
+        }
+        if (query->key_count == AGGREGATE_MAX_KEYS) {
+            fprintf(stderr, "At most %d group-by keys are allowed\n", AGGREGATE_MAX_KEYS);
+            return 0;
+        }
+        query->keys[query->key_count++] = (AggregateKey)found;
+    }
+    if (query->key_count == 0) {
+        fprintf(stderr, "No group-by keys given\n");
+        return 0;
+    }
+    return 1;
+}
+
+// Parse a value column name
+int aggregate_parse_value(const char* text, AggregateValue* value) {
+    for (int v = 0; v < AGGREGATE_VALUE_COUNT; v++) {
+        if (strcmp(text, value_names[v]) == 0) {
+            *value = (AggregateValue)v;
+            return 1;
+        }
+    }
+    fprintf(stderr, "Unknown aggregate value '%s' (expected lead_days or capacity)\n", text);
+    return 0;
+}
+
+//--- JOIN TABLE ---//
+
+// Mix a 32-bit key into a well-spread hash
+static unsigned int hash_int(unsigned int key) {
+    key ^= key >> 16;
+    key *= 0x7feb352du;
+    key ^= key >> 15;
+    key *= 0x846ca68bu;
+    key ^= key >> 16;
+    return key;
+}
+
+// Compare two airport name pointers alphabetically
+static int compare_names(const void* a, const void* b) {
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+// Day number of a time in the calendar, or -1 outside it. Days are 23 to 25 hours long,
+// so the division is off by at most one day
+static int day_number(const JoinTable* join, time_t value) {
+    if (value < join->day_starts[0] || value >= join->day_starts[join->day_count]) {
+        return -1;
+    }
+    int day = (int)((value - join->day_starts[0]) / SECONDS_PER_DAY);
+    if (day >= join->day_count) day = join->day_count - 1;
+    while (day > 0 && value < join->day_starts[day]) day--;
+    while (day + 1 < join->day_count && value >= join->day_starts[day + 1]) day++;
+    return day;
+}
+
+// Build the calendar of local midnights covering every departure plus the margin.
+// Returns 1 on success
+static int build_calendar(JoinTable* join, const Flight* flights, int flight_count) {
+    time_t first = flights[0].departureTime;
+    time_t last = flights[0].departureTime;
+    for (int i = 1; i < flight_count; i++) {
+        if (flights[i].departureTime < first) first = flights[i].departureTime;
+        if (flights[i].departureTime > last) last = flights[i].departureTime;
+    }
+    int days = (int)((last - first) / SECONDS_PER_DAY) + 2 * AGGREGATE_CALENDAR_MARGIN + 2;
+    
+    // One extra entry holds the end of the last day
+    join->day_starts = (time_t*)malloc((days + 1) * sizeof(time_t));
+    if (join->day_starts == NULL) {
+        return 0;
+    }
+    struct tm start;
+    localtime_r(&first, &start);
+    start.tm_mday -= AGGREGATE_CALENDAR_MARGIN;
+    start.tm_hour = 0;
+    start.tm_min = 0;
+    start.tm_sec = 0;
+    for (int d = 0; d <= days; d++) {
+        // mktime normalises tm_mday overflow, so each entry is the next local midnight
+        struct tm day = start;
+        day.tm_mday += d;
+        day.tm_isdst = -1;
+        join->day_starts[d] = mktime(&day);
+    }
+    join->day_count = days;
+    return 1;
+}
+
+// Free the join table (the calendar belongs to the result)
+static void free_join(JoinTable* join) {
+    free(join->flights);
+}
+
+// Build the join table and the result's airport names and calendar. Returns 1 on success
+static int build_join(JoinTable* join, AggregateResult* result, const Flight* flights, int flight_count) {
+    const AggregateQuery* query = join->query;
+    int capacity = 16;
+    while (capacity < flight_count * 2) capacity <<= 1;
+    join->flights = (JoinedFlight*)malloc(capacity * sizeof(JoinedFlight));
+    const char** names = (const char**)malloc(2 * flight_count * sizeof(const char*));
+    if (join->flights == NULL || names == NULL ||
+        !build_calendar(join, flights, flight_count)) {
+        free(names);
+        return 0;
+    }
+    join->slot_mask = capacity - 1;
+    for (int slot = 0; slot < capacity; slot++) {
+        join->flights[slot].id = AGGREGATE_EMPTY_ID;
+    }
+    result->day_starts = join->day_starts;
+    result->day_count = join->day_count;
+    
+    // Airport codes follow alphabetical order, so sorting groups by code sorts them by name
+    for (int i = 0; i < flight_count; i++) {
+        names[2 * i] = flights[i].origin;
+        names[2 * i + 1] = flights[i].destination;
+    }
+    qsort(names, 2 * flight_count, sizeof(const char*), compare_names);
+    result->strings = (char**)malloc(2 * flight_count * sizeof(char*));
+    if (result->strings == NULL) {
+        free(names);
+        return 0;
+    }
+    for (int i = 0; i < 2 * flight_count; i++) {
+        if (result->string_count == 0 || strcmp(names[i], result->strings[result->string_count - 1]) != 0) {
+            result->strings[result->string_count] = strdup(names[i]);
+            if (result->strings[result->string_count] == NULL) {
+                free(names);
+                return 0;
+            }
+            result->string_count++;
+        }
+    }
+    free(names);
+    
+    join->booking_part = -1;
+    for (int i = 0; i < flight_count; i++) {
+        // A repeated flight ID keeps its first flight, as the search structures do
+        unsigned int slot = hash_int((unsigned int)flights[i].id) & join->slot_mask;
+        while (join->flights[slot].id != AGGREGATE_EMPTY_ID && join->flights[slot].id != flights[i].id) {
+            slot = (slot + 1) & join->slot_mask;
+        }
+        JoinedFlight* joined = &join->flights[slot];
+        if (joined->id == flights[i].id) {
+            continue;
+        }
+        memset(joined->key, 0, sizeof(joined->key));
+        joined->id = flights[i].id;
+        joined->departureTime = flights[i].departureTime;
+        joined->capacity = flights[i].capacity;
+        for (int k = 0; k < query->key_count; k++) {
+            const char* name = NULL;
+            switch (query->keys[k]) {
+                case AGGREGATE_ORIGIN:
+                    name = flights[i].origin;
+                    break;
+                case AGGREGATE_DESTINATION:
+                    name = flights[i].destination;
+                    break;
+                case AGGREGATE_DEPARTURE_DAY:
+                    joined->key[k] = day_number(join, flights[i].departureTime);
+                    break;
+                case AGGREGATE_BOOKING_DAY:
+                    joined->key[k] = AGGREGATE_PER_ROW;
+                    join->booking_part = k;
+                    break;
+                default:
+                    joined->key[k] = flights[i].id;
+                    break;
+            }
+            if (name != NULL) {
+                char** found = (char**)bsearch(&name, result->strings, result->string_count,
+                                               sizeof(char*), compare_names);
+                joined->key[k] = (int)(found - result->strings);
+            }
+        }
+    }
+    return 1;
+}
+
+// Find a flight in the join table, or NULL
+static const JoinedFlight* join_find(const JoinTable* join, int flightId) {
+    unsigned int slot = hash_int((unsigned int)flightId) & join->slot_mask;
+    while (join->flights[slot].id != AGGREGATE_EMPTY_ID) {
+        if (join->flights[slot].id == flightId) {
+            return &join->flights[slot];
+        }
+        slot = (slot + 1) & join->slot_mask;
+    }
+    return NULL;
+}
+
+//--- GROUP TABLES ---//
+
+// Hash a whole group key: one multiply per part, then a full mix
+static unsigned int hash_key(const int* key) {
+    unsigned int hash = 0;
+    for (int k = 0; k < AGGREGATE_MAX_KEYS; k++) {
+        hash = (hash ^ (unsigned int)key[k]) * 0x9e3779b1u;
+    }
+    return hash_int(hash);
+}
+
+// Start an empty group table. Returns 1 on success
+static int group_table_init(GroupTable* table, int capacity) {
+    table->groups = (AggregateGroup*)calloc(capacity, sizeof(AggregateGroup));
+    table->capacity = capacity;
+    table->count = 0;
+    return table->groups != NULL;
+}
+
+// Find the group with `key`, adding it if it is new. Returns NULL if the table could not grow
+static AggregateGroup* group_table_find(GroupTable* table, const int* key) {
+    unsigned int mask = (unsigned int)table->capacity - 1;
+    unsigned int slot = hash_key(key) & mask;
+    while (table->groups[slot].count > 0) {
+        if (memcmp(table->groups[slot].key, key, sizeof(table->groups[slot].key)) == 0) {
+            return &table->groups[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    
+    if (2 * (table->count + 1) > table->capacity) {
+        // Rehash into twice the slots, then look again
+        GroupTable larger;
+        if (!group_table_init(&larger, table->capacity * 2)) {
+            return NULL;
+        }
+        unsigned int larger_mask = (unsigned int)larger.capacity - 1;
+        for (int i = 0; i < table->capacity; i++) {
+            if (table->groups[i].count == 0) continue;
+            unsigned int to = hash_key(table->groups[i].key) & larger_mask;
+            while (larger.groups[to].count > 0) to = (to + 1) & larger_mask;
+            larger.groups[to] = table->groups[i];
+        }
+        larger.count = table->count;
+        free(table->groups);
+        *table = larger;
+        return group_table_find(table, key);
+    }
+    
+    AggregateGroup* group = &table->groups[slot];
+    memcpy(group->key, key, sizeof(group->key));
+    table->count++;
+    return group;
+}
+
+// Add one value to a group (count 0 means the group was just created)
+static void group_add(AggregateGroup* group, long long count, long long sum, int min, int max) {
+    if (group->count == 0 || min < group->min) group->min = min;
+    if (group->count == 0 || max > group->max) group->max = max;
+    group->count += count;
+    group->sum += sum;
+}
+
+//--- AGGREGATION ---//
+
+// Aggregate one slice of the reservations into the worker's own table
+static void* aggregate_slice(void* arg) {
+    AggregateWorker* worker = (AggregateWorker*)arg;
+    const JoinTable* join = worker->join;
+    int lead_days = join->query->value == AGGREGATE_LEAD_DAYS;
+    worker->ok = group_table_init(&worker->table, AGGREGATE_INITIAL_GROUPS);
+    
+    for (int i = worker->first; i < worker->last && worker->ok; i++) {
+        const ReservationRecord* record = &worker->reservations[i];
+        const JoinedFlight* flight = join_find(join, record->flightId);
+        if (flight == NULL) {
+            worker->skipped++;
+            continue;
+        }
+        int key[AGGREGATE_MAX_KEYS];
+        memcpy(key, flight->key, sizeof(key));
+        if (join->booking_part >= 0) {
+            key[join->booking_part] = day_number(join, record->bookingDate);
+            if (key[join->booking_part] < 0) {
+                worker->skipped++;
+                continue;
+            }
+        }
+        
+        int value = lead_days ? (int)((flight->departureTime - record->bookingDate) / SECONDS_PER_DAY)
+                              : flight->capacity;
+        AggregateGroup* group = group_table_find(&worker->table, key);
+        if (group == NULL) {
+            worker->ok = 0;
+            break;
+        }
+        group_add(group, 1, value, value, value);
+        worker->rows++;
+    }
+    return NULL;
+}
+
+// Order groups by their key parts
+static int compare_groups(const void* a, const void* b) {
+    const AggregateGroup* left = (const AggregateGroup*)a;
+    const AggregateGroup* right = (const AggregateGroup*)b;
+    for (int k = 0; k < AGGREGATE_MAX_KEYS; k++) {
+        if (left->key[k] != right->key[k]) return left->key[k] < right->key[k] ? -1 : 1;
+    }
+    return 0;
+}
+
+// Number of threads for a query over `rows` reservations
+static int aggregate_thread_count(const AggregateQuery* query, int rows) {
+    int threads = query->threads;
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus < 1 ? 1 : (int)cpus;
+    }
+    if (threads > AGGREGATE_MAX_THREADS) threads = AGGREGATE_MAX_THREADS;
+    int useful = rows / AGGREGATE_ROWS_PER_THREAD + 1;
+    return threads < useful ? threads : useful;
+}
+
+// Group the reservations, joined to their flights by flightId
+AggregateResult* aggregate_reservations(const AggregateQuery* query,
+                                        const Flight* flights, int flight_count,
+                                        const ReservationRecord* reservations, int reservation_count) {
+    if (query->key_count < 1 || query->key_count > AGGREGATE_MAX_KEYS || flight_count < 1) {
+        fprintf(stderr, "Aggregation needs 1 to %d keys and at least one flight\n", AGGREGATE_MAX_KEYS);
+        return NULL;
+    }
+    AggregateResult* result = (AggregateResult*)calloc(1, sizeof(AggregateResult));
+    if (result == NULL) {
+        fprintf(stderr, "Memory allocation failed for aggregation result\n");
+        return NULL;
+    }
+    result->query = *query;
+    uint64_t start = timing_now_ns();
+    
+    JoinTable join;
+    memset(&join, 0, sizeof(join));
+    join.query = &result->query;
+    int threads = aggregate_thread_count(query, reservation_count);
+    AggregateWorker* workers = (AggregateWorker*)calloc(threads, sizeof(AggregateWorker));
+    pthread_t* handles = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    int* started = (int*)calloc(threads, sizeof(int));
+    if (workers == NULL || handles == NULL || started == NULL ||
+        !build_join(&join, result, flights, flight_count)) {
+        fprintf(stderr, "Memory allocation failed for aggregation join table\n");
+        free(workers);
+        free(handles);
+        free(started);
+        free_join(&join);
+        aggregate_free(result);
+        return NULL;
+    }
+    
+    // Contiguous slices, so each thread streams through its own part of the array
+    for (int t = 0; t < threads; t++) {
+        workers[t].join = &join;
+        workers[t].reservations = reservations;
+        workers[t].first = (int)((long long)reservation_count * t / threads);
+        workers[t].last = (int)((long long)reservation_count * (t + 1) / threads);
+        
+        // Fall back to aggregating on this thread if a worker can't be started
+        started[t] = t > 0 && pthread_create(&handles[t], NULL, aggregate_slice, &workers[t]) == 0;
+        if (t > 0 && !started[t]) {
+            aggregate_slice(&workers[t]);
+        }
+    }
+    aggregate_slice(&workers[0]);
+    
+    // Merge every thread's groups into the first thread's table
+    int ok = 1;
+    for (int t = 0; t < threads; t++) {
+        if (started[t]) {
+            pthread_join(handles[t], NULL);
+        }
+        ok &= workers[t].ok;
+        result->rows += workers[t].rows;
+        result->skipped += workers[t].skipped;
+        if (t == 0 || !ok) continue;
+        for (int i = 0; i < workers[t].table.capacity && ok; i++) {
+            const AggregateGroup* from = &workers[t].table.groups[i];
+            if (from->count == 0) continue;
+            AggregateGroup* into = group_table_find(&workers[0].table, from->key);
+            if (into == NULL) {
+                ok = 0;
+            } else {
+                group_add(into, from->count, from->sum, from->min, from->max);
+            }
+        }
+    }
+    
+    // Compact the merged table into a sorted array
+    if (ok) {
+        GroupTable* merged = &workers[0].table;
+        result->groups = (AggregateGroup*)malloc((merged->count + 1) * sizeof(AggregateGroup));
+        ok = result->groups != NULL;
+        for (int i = 0; i < merged->capacity && ok; i++) {
+            if (merged->groups[i].count > 0) {
+                result->groups[result->group_count++] = merged->groups[i];
+            }
+        }
+        if (ok) {
+            qsort(result->groups, result->group_count, sizeof(AggregateGroup), compare_groups);
+        }
+    }
+    result->threads = threads;
+    result->seconds = (timing_now_ns() - start) / 1e9;
+    
+    for (int t = 0; t < threads; t++) {
+        free(workers[t].table.groups);
+    }
+    free(workers);
+    free(handles);
+    free(started);
+    free_join(&join);
+    if (!ok) {
+        fprintf(stderr, "Memory allocation failed for aggregation groups\n");
+        aggregate_free(result);
+        return NULL;
+    }
+    return result;
+}
+
+//--- OUTPUT ---//
+
+// Write the result as CSV
+long long aggregate_write_csv(FILE* file, const AggregateResult* result) {
+    OutputBuffer buffer;
+    if (!output_buffer_init(&buffer, file, OUTPUT_BUFFER_SIZE)) {
+        fprintf(stderr, "Memory allocation failed for aggregation output\n");
+        return -1;
+    }
+    const AggregateQuery* query = &result->query;
+    const char* value = value_names[query->value];
+    DateCache cache;
+    date_cache_init(&cache);
+    long long total = 0;
+    
+    int ok = output_buffer_reserve(&buffer, AGGREGATE_MAX_ROW_LENGTH);
+    char* out = buffer.data + buffer.length;
+    char* p = out;
+    for (int k = 0; k < query->key_count; k++) {
+        p += csv_format_string(p, key_names[query->keys[k]]);
+        *p++ = ',';
+    }
+    p += snprintf(p, 128, "count,sum_%s,min_%s,max_%s,avg_%s\n", value, value, value, value);
+    buffer.length += (size_t)(p - out);
+    total += p - out;
+    
+    for (int g = 0; g < result->group_count; g++) {
+        const AggregateGroup* group = &result->groups[g];
+        ok = output_buffer_reserve(&buffer, AGGREGATE_MAX_ROW_LENGTH);
+        if (!ok) break;
+        out = buffer.data + buffer.length;
+        p = out;
+        for (int k = 0; k < query->key_count; k++) {
+            switch (query->keys[k]) {
+                case AGGREGATE_ORIGIN:
+                case AGGREGATE_DESTINATION:
+                    p += csv_format_string(p, result->strings[group->key[k]]);
+                    break;
+                case AGGREGATE_DEPARTURE_DAY:
+                case AGGREGATE_BOOKING_DAY:
+                    p += csv_format_date(p, &cache, result->day_starts[group->key[k]]);
+                    break;
+                default:
+                    p += csv_format_int(p, group->key[k]);
+                    break;
+            }
+            *p++ = ',';
+        }
+        p += snprintf(p, 128, "%lld,%lld,%d,%d,%.2f\n", group->count, group->sum,
+                      group->min, group->max, (double)group->sum / group->count);
+        buffer.length += (size_t)(p - out);
+        total += p - out;
+    }
+    ok = ok && output_buffer_flush(&buffer);
+    output_buffer_free(&buffer);
+    if (!ok) {
+        fprintf(stderr, "Error writing the aggregation result\n");
+        return -1;
+    }
+    return total;
+}
+
+// Free a result
+void aggregate_free(AggregateResult* result) {
+    if (result == NULL) {
+        return;
+    }
+    for (int i = 0; i < result->string_count; i++) {
+        free(result->strings[i]);
+    }
+    free(result->strings);
+    free(result->day_starts);
+    free(result->groups);
+    free(result);
+}
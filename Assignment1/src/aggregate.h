@@ -0,0 +1,83 @@
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+
+#include <stdio.h>
+#include <time.h>
+#include "airline_types.h"
+
+// Most grouping keys in one query
+#define AGGREGATE_MAX_KEYS 4
+
+// Most aggregation threads
+#define AGGREGATE_MAX_THREADS 64
+
+// Columns a query can group by
+typedef enum {
+    AGGREGATE_ORIGIN = 0,
+    AGGREGATE_DESTINATION,
+    AGGREGATE_DEPARTURE_DAY,
+    AGGREGATE_BOOKING_DAY,
+    AGGREGATE_FLIGHT,
+    AGGREGATE_KEY_COUNT
+} AggregateKey;
+
+// Numeric column summed, and its minimum, maximum and average taken, per group
+typedef enum {
+    AGGREGATE_LEAD_DAYS = 0,  // Whole days from booking to departure
+    AGGREGATE_CAPACITY,       // Capacity of the booked flight
+    AGGREGATE_VALUE_COUNT
+} AggregateValue;
+
+// A group-by query: reservations joined to their flights, grouped by `keys` in order
+typedef struct {
+    AggregateKey keys[AGGREGATE_MAX_KEYS];
+    int key_count;
+    AggregateValue value;
+    int threads;  // 0 = one per CPU
+} AggregateQuery;
+
+// One output group. Key parts are flight IDs, day numbers or string codes (see AggregateResult)
+typedef struct {
+    int key[AGGREGATE_MAX_KEYS];
+    long long count;
+    long long sum;
+    int min;
+    int max;
+} AggregateGroup;
+
+// Result of a query, groups sorted by their keys (strings alphabetically, days by date)
+typedef struct {
+    AggregateQuery query;
+    AggregateGroup* groups;
+    int group_count;
+    char** strings;      // Airport names, indexed by the codes in origin and destination keys
+    int string_count;
+    time_t* day_starts;  // Local midnight of each day number in day keys
+    int day_count;
+    long long rows;      // Reservations aggregated
+    long long skipped;   // Reservations left out (see aggregate_reservations)
+    int threads;         // Threads actually used
+    double seconds;      // Time taken by the join and aggregation
+} AggregateResult;
+
+// Parse a comma-separated key list ("origin,departure_day") into a query. Returns 1 on success
+int aggregate_parse_keys(const char* text, AggregateQuery* query);
+
+// Parse a value column name ("lead_days" or "capacity"). Returns 1 on success
+int aggregate_parse_value(const char* text, AggregateValue* value);
+
+// Group the reservations, joined to their flights by flightId. Each thread pre-aggregates a
+// slice into its own hash table, then the tables are merged. Reservations on unknown flights
+// (or booked more than five years from any departure) are skipped. Returns NULL on failure
+AggregateResult* aggregate_reservations(const AggregateQuery* query,
+                                        const Flight* flights, int flight_count,
+                                        const ReservationRecord* reservations, int reservation_count);
+
+// Write the result as CSV: the key columns, then count, sum, min, max and avg of the value.
+// Returns bytes written, or -1 on failure
+long long aggregate_write_csv(FILE* file, const AggregateResult* result);
+
+// Free a result
+void aggregate_free(AggregateResult* result);
+
+#endif
@@ -0,0 +1,1487 @@
+/*
+ * Airline Reservation System Benchmarks
+ *
+ * Benchmarks every public operation of prototype 1 and prototype 2 at the
+ * Small/Medium/Large/Huge dataset sizes used by the menu, reporting latency
+ * percentiles per operation and writing CSV/JSON for regression tracking.
+ *
+ * Usage: airline_bench [--sizes small,medium,large,huge] [--engines 1,2] [--reps N] [--ops N]
+ *                      [--warmup N] [--clock tsc|monotonic] [--budget seconds] [--op-budget seconds]
+ *                      [--skewed] [--seed N] [--perf] [--csv file] [--json file]
+ *                      [--snapshot-readers N] [--snapshot-seconds S] [--partition-archive dir]
+ *                      [--batch-lookups N] [--bloom fp-rate] [--distinct] [--group-by rows]
+ *                      [--flight-loads] [--unrolled passengers] [--name-scan passengers]
+ *
+ * Sources used:
+ * 1. "Systems Performance" by Brendan Gregg - Benchmarking methodology
+ * 2. "Benchmarking Cloud Serving Systems with YCSB" by Cooper et al. - Random key selection
+ */
+#define _CRT_SECURE_NO_DEPRECATE
+#define _GNU_SOURCE  // For strcasestr function
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "airline_types.h"
+#include "prototype1/flight_management.h"
+#include "prototype1/passenger_management.h"
+#include "prototype1/reservation_management.h"
+#include "prototype1/flight_search.h"
+#include "prototype1/passenger_search.h"
+#include "prototype1/passenger_unrolled.h"
+#include "name_heap.h"
+#include "simd_scan.h"
+#include "prototype2/flight_management_avl.h"
+#include "prototype2/passenger_management_hash.h"
+#include "prototype2/reservation_management_bst.h"
+#include "prototype2/flight_search_avl.h"
+#include "prototype2/passenger_search_hash.h"
+#include "prototype2/flight_persistent_avl.h"
+#include "prototype2/flight_partitions.h"
+#include "prototype2/passenger_sketches.h"
+#include "prototype2/flight_load_index.h"
+#include "data_generator.h"
+#include "benchmark.h"
+#include "timing.h"
+#include "mem_stats.h"
+#include "aggregate.h"
+
+// Number of pre-drawn random keys (power of two so the index can be masked)
+#define BENCH_KEY_COUNT 65536
+
+// Dataset sizes, matching menu option 2 (flights; passengers are 5x and reservations 10x)
+typedef struct {
+    const char* name;
+    int flights;
+} BenchSize;
+
+static const BenchSize bench_sizes[] = {
+    {"small", 100},
+    {"medium", 1000},
+    {"large", 10000},
+    {"huge", 100000}
+};
+#define BENCH_SIZE_COUNT ((int)(sizeof(bench_sizes) / sizeof(bench_sizes[0])))
+
+// What the records column of an operation counts
+typedef enum {
+    COUNT_FLIGHTS,
+    COUNT_PASSENGERS,
+    COUNT_RESERVATIONS
+} RecordKind;
+
+// Everything the operations need: the dataset, both prototypes' structures and key streams
+typedef struct {
+    Flight* flights;
+    int flight_count;
+    Passenger* passengers;
+    int passenger_count;
+    ReservationRecord* reservations;
+    int reservation_count;
+    
+    // Records actually inserted (a build can stop early when it runs out of budget)
+    int built_flights;
+    int built_passengers;
+    int built_reservations;
+    
+    BST_Node* p1_flights;
+    LL_Node* p1_passengers;
+    ReservationArray* p1_reservations;
+    
+    AVL_Node* p2_flights;
+    PassengerHashTable* p2_passengers;
+    ReservationBST* p2_reservations;
+    
+    int* random_keys;                       // Random non-negative ints
+    Passenger* extra_passengers;            // New passengers for insert/remove pairs
+    ReservationRecord* extra_reservations;  // New bookings for book/cancel pairs
+    int extra_count;
+} BenchContext;
+
+// Random index below n for the i-th call
+static int key_index(BenchContext* ctx, int i, int n) {
+    return n > 0 ? ctx->random_keys[i & (BENCH_KEY_COUNT - 1)] % n : 0;
+}
+
+static Flight* random_flight(BenchContext* ctx, int i) {
+    return &ctx->flights[key_index(ctx, i, ctx->built_flights)];
+}
+
+static Passenger* random_passenger(BenchContext* ctx, int i) {
+    return &ctx->passengers[key_index(ctx, i, ctx->built_passengers)];
+}
+
+static ReservationRecord* random_reservation(BenchContext* ctx, int i) {
+    return &ctx->reservations[key_index(ctx, i, ctx->built_reservations)];
+}
+
+// ---- Prototype 1 operations ----
+
+static long p1_insert(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    ctx->p1_flights = insert(ctx->p1_flights, ctx->flights[i]);
+    ctx->built_flights = i + 1;
+    return 0;
+}
+
+static long p1_insert_passenger(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    ctx->p1_passengers = insert_passenger(ctx->p1_passengers, ctx->passengers[i]);
+    ctx->built_passengers = i + 1;
+    return 0;
+}
+
+static long p1_add_reservation(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    add_reservation(ctx->p1_reservations, ctx->reservations[i]);
+    ctx->built_reservations = i + 1;
+    return 0;
+}
+
+static long p1_find_flight(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    return find_flight(ctx->p1_flights, random_flight(ctx, i)->id) != NULL;
+}
+
+static long p1_find_flight_by_number(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    return find_flight_by_number(ctx->p1_flights, random_flight(ctx, i)->flightNumber) != NULL;
+}
+
+static long p1_find_passenger(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    return find_passenger(ctx->p1_passengers, random_passenger(ctx, i)->id) != NULL;
+}
+
+static long p1_find_passenger_by_name(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    return find_passenger_by_name(ctx->p1_passengers, random_passenger(ctx, i)->name) != NULL;
+}
+
+static long p1_count_passengers_by_flight(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    return count_passengers_by_flight_array(ctx->p1_reservations, random_flight(ctx, i)->id);
+}
+
+static long p1_count_flights_by_passenger(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    return count_flights_by_passenger_array(ctx->p1_reservations, random_passenger(ctx, i)->id);
+}
+
+static long p1_has_reservation(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    ReservationRecord* record = random_reservation(ctx, i);
+    return has_reservation_array(ctx->p1_reservations, record->flightId, record->passengerId);
+}
+
+static long p1_validate_flight_capacity(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    return validate_flight_capacity_array(ctx->p1_reservations, ctx->p1_flights, random_flight(ctx, i)->id);
+}
+
+static long p1_add_reservation_with_validation(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    return add_reservation_with_validation(ctx->p1_reservations, ctx->p1_flights,
+                                           ctx->extra_reservations[i % ctx->extra_count]);
+}
+
+static long p1_cancel_reservation(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    ReservationRecord* record = &ctx->extra_reservations[i % ctx->extra_count];
+    return cancel_reservation(ctx->p1_reservations, record->flightId, record->passengerId);
+}
+
+static long p1_insert_extra_passenger(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    ctx->p1_passengers = insert_passenger(ctx->p1_passengers, ctx->extra_passengers[i % ctx->extra_count]);
+    return 0;
+}
+
+static long p1_remove_passenger(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    ctx->p1_passengers = remove_passenger(ctx->p1_passengers, ctx->extra_passengers[i % ctx->extra_count].id);
+    return 0;
+}
+
+static long p1_print_passenger_flights(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    print_passenger_flights(ctx->p1_reservations, ctx->p1_flights, random_passenger(ctx, i)->id);
+    return 0;
+}
+
+static long p1_print_flight_passengers(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    print_flight_passengers(ctx->p1_reservations, ctx->p1_passengers, random_flight(ctx, i)->id);
+    return 0;
+}
+
+static long p1_print_flights(void* c, int i) {
+    (void)i;
+    print_flights(((BenchContext*)c)->p1_flights);
+    return 0;
+}
+
+static long p1_print_passengers(void* c, int i) {
+    (void)i;
+    print_passengers(((BenchContext*)c)->p1_passengers);
+    return 0;
+}
+
+// ---- Prototype 2 operations ----
+
+static long p2_avl_insert(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    ctx->p2_flights = avl_insert(ctx->p2_flights, ctx->flights[i]);
+    ctx->built_flights = i + 1;
+    return 0;
+}
+
+static long p2_hash_insert_passenger(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    hash_insert_passenger(ctx->p2_passengers, ctx->passengers[i]);
+    ctx->built_passengers = i + 1;
+    return 0;
+}
+
+static long p2_add_reservation_bst(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    add_reservation_bst(ctx->p2_reservations, ctx->reservations[i]);
+    ctx->built_reservations = i + 1;
+    return 0;
+}
+
+static long p2_avl_find_flight(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    return avl_find_flight(ctx->p2_flights, random_flight(ctx, i)->id) != NULL;
+}
+
+static long p2_avl_find_flight_by_number(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    return avl_find_flight_by_number(ctx->p2_flights, random_flight(ctx, i)->flightNumber) != NULL;
+}
+
+static long p2_hash_find_passenger(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    return hash_find_passenger(ctx->p2_passengers, random_passenger(ctx, i)->id) != NULL;
+}
+
+static long p2_hash_find_passenger_by_name(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    return hash_find_passenger_by_name(ctx->p2_passengers, random_passenger(ctx, i)->name) != NULL;
+}
+
+static long p2_count_passengers_by_flight(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    return count_passengers_by_flight(ctx->p2_reservations, random_flight(ctx, i)->id);
+}
+
+static long p2_count_flights_by_passenger(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    return count_flights_by_passenger(ctx->p2_reservations, random_passenger(ctx, i)->id);
+}
+
+static long p2_has_reservation(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    ReservationRecord* record = random_reservation(ctx, i);
+    return has_reservation_bst(ctx->p2_reservations, record->flightId, record->passengerId);
+}
+
+// A passenger ID past every generated and extra passenger
+static long p2_hash_find_absent_passenger(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    int id = 2000 + ctx->passenger_count + ctx->extra_count + key_index(ctx, i, ctx->passenger_count);
+    return hash_find_passenger(ctx->p2_passengers, id) != NULL;
+}
+
+// A random flight and passenger, which almost never hold a booking together (the
+// duplicate-booking check of a new booking)
+static long p2_has_reservation_new_pair(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    return has_reservation_bst(ctx->p2_reservations, random_flight(ctx, i)->id, random_passenger(ctx, i + 1)->id);
+}
+
+static long p2_validate_flight_capacity(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    return validate_flight_capacity_bst(ctx->p2_reservations, ctx->p2_flights, random_flight(ctx, i)->id);
+}
+
+static long p2_add_reservation_with_validation(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    return add_reservation_bst_with_validation(ctx->p2_reservations, ctx->p2_flights,
+                                               ctx->extra_reservations[i % ctx->extra_count]);
+}
+
+static long p2_cancel_reservation(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    ReservationRecord* record = &ctx->extra_reservations[i % ctx->extra_count];
+    return cancel_reservation_bst(ctx->p2_reservations, record->flightId, record->passengerId);
+}
+
+static long p2_insert_extra_passenger(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    hash_insert_passenger(ctx->p2_passengers, ctx->extra_passengers[i % ctx->extra_count]);
+    return 0;
+}
+
+static long p2_print_passenger_flights(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    print_passenger_flights_bst(ctx->p2_reservations, ctx->p2_flights, random_passenger(ctx, i)->id);
+    return 0;
+}
+
+static long p2_print_flight_passengers(void* c, int i) {
+    BenchContext* ctx = (BenchContext*)c;
+    print_flight_passengers_bst(ctx->p2_reservations, ctx->p2_passengers, random_flight(ctx, i)->id);
+    return 0;
+}
+
+static long p2_print_flights(void* c, int i) {
+    (void)i;
+    avl_print_flights(((BenchContext*)c)->p2_flights);
+    return 0;
+}
+
+static long p2_print_passengers(void* c, int i) {
+    (void)i;
+    print_hash_passengers(((BenchContext*)c)->p2_passengers);
+    return 0;
+}
+
+// ---- Operation tables ----
+
+typedef struct {
+    BenchOperation op;
+    RecordKind kind;
+} BenchEntry;
+
+// Inserts timed while building the structures: one per record
+static const BenchEntry p1_build[] = {
+    {{"insert", p1_insert, 0, 0}, COUNT_FLIGHTS},
+    {{"insert_passenger", p1_insert_passenger, 0, 0}, COUNT_PASSENGERS},
+    {{"add_reservation", p1_add_reservation, 0, 0}, COUNT_RESERVATIONS}
+};
+
+// Operations against the built structures. Each insert/book is followed by the
+// remove/cancel that undoes it, so later operations see the original sizes
+static const BenchEntry p1_ops[] = {
+    {{"find_flight", p1_find_flight, 0, 0}, COUNT_FLIGHTS},
+    {{"find_flight_by_number", p1_find_flight_by_number, 0, 0}, COUNT_FLIGHTS},
+    {{"find_passenger", p1_find_passenger, 0, 0}, COUNT_PASSENGERS},
+    {{"find_passenger_by_name", p1_find_passenger_by_name, 0, 0}, COUNT_PASSENGERS},
+    {{"count_passengers_by_flight_array", p1_count_passengers_by_flight, 0, 0}, COUNT_RESERVATIONS},
+    {{"count_flights_by_passenger_array", p1_count_flights_by_passenger, 0, 0}, COUNT_RESERVATIONS},
+    {{"has_reservation_array", p1_has_reservation, 0, 0}, COUNT_RESERVATIONS},
+    {{"validate_flight_capacity_array", p1_validate_flight_capacity, 0, 1}, COUNT_RESERVATIONS},
+    {{"add_reservation_with_validation", p1_add_reservation_with_validation, 0, 1}, COUNT_RESERVATIONS},
+    {{"cancel_reservation", p1_cancel_reservation, 0, 0}, COUNT_RESERVATIONS},
+    {{"insert_passenger (new id)", p1_insert_extra_passenger, 0, 0}, COUNT_PASSENGERS},
+    {{"remove_passenger", p1_remove_passenger, 0, 0}, COUNT_PASSENGERS},
+    {{"print_passenger_flights", p1_print_passenger_flights, 0, 1}, COUNT_RESERVATIONS},
+    {{"print_flight_passengers", p1_print_flight_passengers, 0, 1}, COUNT_RESERVATIONS},
+    {{"print_flights", p1_print_flights, 1, 1}, COUNT_FLIGHTS},
+    {{"print_passengers", p1_print_passengers, 1, 1}, COUNT_PASSENGERS}
+};
+
+static const BenchEntry p2_build[] = {
+    {{"avl_insert", p2_avl_insert, 0, 0}, COUNT_FLIGHTS},
+    {{"hash_insert_passenger", p2_hash_insert_passenger, 0, 0}, COUNT_PASSENGERS},
+    {{"add_reservation_bst", p2_add_reservation_bst, 0, 0}, COUNT_RESERVATIONS}
+};
+
+static const BenchEntry p2_ops[] = {
+    {{"avl_find_flight", p2_avl_find_flight, 0, 0}, COUNT_FLIGHTS},
+    {{"avl_find_flight_by_number", p2_avl_find_flight_by_number, 0, 0}, COUNT_FLIGHTS},
+    {{"hash_find_passenger", p2_hash_find_passenger, 0, 0}, COUNT_PASSENGERS},
+    {{"hash_find_passenger_by_name", p2_hash_find_passenger_by_name, 0, 0}, COUNT_PASSENGERS},
+    {{"count_passengers_by_flight", p2_count_passengers_by_flight, 0, 0}, COUNT_RESERVATIONS},
+    {{"count_flights_by_passenger", p2_count_flights_by_passenger, 0, 0}, COUNT_RESERVATIONS},
+    {{"has_reservation_bst", p2_has_reservation, 0, 0}, COUNT_RESERVATIONS},
+    {{"hash_find_passenger (absent id)", p2_hash_find_absent_passenger, 0, 0}, COUNT_PASSENGERS},
+    {{"has_reservation_bst (new pair)", p2_has_reservation_new_pair, 0, 0}, COUNT_RESERVATIONS},
+    {{"validate_flight_capacity_bst", p2_validate_flight_capacity, 0, 1}, COUNT_RESERVATIONS},
+    {{"add_reservation_bst_with_validation", p2_add_reservation_with_validation, 0, 1}, COUNT_RESERVATIONS},
+    {{"cancel_reservation_bst", p2_cancel_reservation, 0, 0}, COUNT_RESERVATIONS},
+    {{"hash_insert_passenger (new id)", p2_insert_extra_passenger, 0, 0}, COUNT_PASSENGERS},
+    {{"print_passenger_flights_bst", p2_print_passenger_flights, 0, 1}, COUNT_RESERVATIONS},
+    {{"print_flight_passengers_bst", p2_print_flight_passengers, 0, 1}, COUNT_RESERVATIONS},
+    {{"avl_print_flights", p2_print_flights, 1, 1}, COUNT_FLIGHTS},
+    {{"print_hash_passengers", p2_print_passengers, 1, 1}, COUNT_PASSENGERS}
+};
+
+#define TABLE_LENGTH(table) ((int)(sizeof(table) / sizeof(table[0])))
+
+// Growable list of results
+typedef struct {
+    BenchResult* items;
+    int count;
+    int capacity;
+} ResultList;
+
+// Append an initialised result slot. Returns NULL on failure
+static BenchResult* next_result(ResultList* list) {
+    if (list->count >= list->capacity) {
+        int new_capacity = list->capacity > 0 ? list->capacity * 2 : 64;
+        BenchResult* items = (BenchResult*)realloc(list->items, new_capacity * sizeof(BenchResult));
+        if (items == NULL) {
+            fprintf(stderr, "Memory allocation failed for benchmark results\n");
+            return NULL;
+        }
+        list->items = items;
+        list->capacity = new_capacity;
+    }
+    return &list->items[list->count];
+}
+
+static int records_for(const BenchContext* ctx, RecordKind kind) {
+    switch (kind) {
+        case COUNT_FLIGHTS: return ctx->built_flights;
+        case COUNT_PASSENGERS: return ctx->built_passengers;
+        default: return ctx->built_reservations;
+    }
+}
+
+// Run one engine's build and operation tables against a dataset
+static void bench_engine(const char* engine, const char* size, BenchContext* ctx,
+                         const BenchEntry* build, int build_count, const BenchEntry* ops, int op_count,
+                         const BenchOptions* options, double build_budget, ResultList* results) {
+    int totals[3] = {ctx->flight_count, ctx->passenger_count, ctx->reservation_count};
+    int header = 1;
+    
+    for (int b = 0; b < build_count; b++) {
+        BenchResult* result = next_result(results);
+        if (result == NULL || !bench_result_init(result, engine, build[b].op.name, size, 0, options->clock)) {
+            return;
+        }
+        int done = bench_run_build(result, &build[b].op, ctx, totals[build[b].kind], build_budget, options);
+        if (done < totals[build[b].kind]) {
+            fprintf(stderr, "%s %s: %s stopped after %d of %d records (build budget %.0fs)\n",
+                    engine, size, build[b].op.name, done, totals[build[b].kind], build_budget);
+        }
+        bench_print_result(result, header);
+        header = 0;
+        results->count++;
+    }
+    
+    for (int o = 0; o < op_count; o++) {
+        BenchResult* result = next_result(results);
+        if (result == NULL || !bench_result_init(result, engine, ops[o].op.name, size,
+                                                 records_for(ctx, ops[o].kind), options->clock)) {
+            return;
+        }
+        bench_run(result, &ops[o].op, ctx, 0, options);
+        bench_print_result(result, 0);
+        results->count++;
+    }
+    fflush(stdout);
+}
+
+// ---- Persistent AVL snapshot reads ----
+
+// One snapshot reader: batches of random lookups, with a full in-order scan every 64 batches
+typedef struct {
+    PersistentFlightTree* tree;
+    BenchContext* ctx;
+    int reader;
+    int* stop;
+    long long finds;
+    long long scans;
+} SnapshotReader;
+
+// Writer inserting flights with new IDs until stopped
+typedef struct {
+    PersistentFlightTree* tree;
+    BenchContext* ctx;
+    int* stop;
+    long long inserts;
+} SnapshotWriter;
+
+static void* snapshot_reader_thread(void* arg) {
+    SnapshotReader* r = (SnapshotReader*)arg;
+    int i = r->reader * 7919;
+    for (int batch = 0; !__atomic_load_n(r->stop, __ATOMIC_RELAXED); batch++) {
+        AVL_Node* snapshot = pavl_read_begin(r->tree, r->reader);
+        for (int k = 0; k < 64; k++) {
+            avl_find_flight(snapshot, random_flight(r->ctx, i++)->id);
+        }
+        r->finds += 64;
+        if (batch % 64 == 63) {
+            pavl_count_flights(snapshot);
+            r->scans++;
+        }
+        pavl_read_end(r->tree, r->reader);
+    }
+    return NULL;
+}
+
+static void* snapshot_writer_thread(void* arg) {
+    SnapshotWriter* w = (SnapshotWriter*)arg;
+    while (!__atomic_load_n(w->stop, __ATOMIC_RELAXED)) {
+        Flight flight = w->ctx->flights[w->inserts % w->ctx->flight_count];
+        flight.id = 1000 + w->ctx->flight_count + (int)w->inserts;
+        pavl_insert(w->tree, flight);
+        w->inserts++;
+    }
+    return NULL;
+}
+
+// Run `readers` reader threads (and optionally the writer) for `seconds`; print the rates
+static void snapshot_phase(PersistentFlightTree* tree, BenchContext* ctx, int readers, double seconds,
+                           int with_writer, const char* label) {
+    SnapshotReader reader_args[PAVL_MAX_READERS];
+    pthread_t reader_threads[PAVL_MAX_READERS];
+    SnapshotWriter writer_args = {tree, ctx, NULL, 0};
+    pthread_t writer_thread;
+    int stop = 0;
+    int started = 0;
+    int writer_started = 0;
+    
+    uint64_t start = timing_now_ns();
+    for (int t = 0; t < readers; t++) {
+        reader_args[t].tree = tree;
+        reader_args[t].ctx = ctx;
+        reader_args[t].reader = t;
+        reader_args[t].stop = &stop;
+        reader_args[t].finds = 0;
+        reader_args[t].scans = 0;
+        if (pthread_create(&reader_threads[t], NULL, snapshot_reader_thread, &reader_args[t]) != 0) {
+            fprintf(stderr, "Could not start snapshot reader %d\n", t);
+            break;
+        }
+        started++;
+    }
+    if (with_writer) {
+        writer_args.stop = &stop;
+        writer_started = pthread_create(&writer_thread, NULL, snapshot_writer_thread, &writer_args) == 0;
+    }
+    
+    timing_wait_until_ns(start + (uint64_t)(seconds * 1e9));
+    __atomic_store_n(&stop, 1, __ATOMIC_RELAXED);
+    long long finds = 0;
+    long long scans = 0;
+    for (int t = 0; t < started; t++) {
+        pthread_join(reader_threads[t], NULL);
+        finds += reader_args[t].finds;
+        scans += reader_args[t].scans;
+    }
+    if (writer_started) {
+        pthread_join(writer_thread, NULL);
+    }
+    double elapsed = (timing_now_ns() - start) / 1e9;
+    
+    printf("  %-14s %12.0f finds/s %8.1f scans/s", label, finds / elapsed, scans / elapsed);
+    if (with_writer) {
+        printf(" %10.0f inserts/s (%lld nodes reclaimed, %d pending)", writer_args.inserts / elapsed,
+               tree->reclaimed, tree->retired_count);
+    }
+    printf("\n");
+}
+
+// Reader throughput on the persistent AVL tree with the writer idle, then inserting nonstop
+static void bench_snapshot_reads(BenchContext* ctx, int readers, double seconds) {
+    PersistentFlightTree* tree = pavl_create();
+    if (tree == NULL) {
+        return;
+    }
+    for (int i = 0; i < ctx->flight_count; i++) {
+        pavl_insert(tree, ctx->flights[i]);
+    }
+    ctx->built_flights = ctx->flight_count;
+    
+    printf("\nPersistent AVL snapshot reads (%d readers, %.1f s per phase)\n", readers, seconds);
+    snapshot_phase(tree, ctx, readers, seconds, 0, "readers only");
+    snapshot_phase(tree, ctx, readers, seconds, 1, "with writer");
+    fflush(stdout);
+    pavl_free(tree);
+}
+
+// Number of one-day window queries timed in the partition benchmark
+#define PARTITION_QUERIES 200
+
+// Count the flights of a single tree departing in [from, to), which needs the whole tree
+static int count_departures(AVL_Node* node, time_t from, time_t to) {
+    if (node == NULL) return 0;
+    int here = node->data.departureTime >= from && node->data.departureTime < to;
+    return here + count_departures(node->left, from, to) + count_departures(node->right, from, to);
+}
+
+// Live bytes of the prototype 2 flight and reservation trees
+static long long tree_bytes() {
+    return mem_stats_get(MEM_FLIGHT_AVL).live_bytes + mem_stats_get(MEM_RESERVATION_BST).live_bytes;
+}
+
+// One-day window queries on one AVL tree against the day partitions, then archiving the oldest
+// three quarters of the days and querying an archived day cold (reloaded) and warm
+static void bench_partitions(BenchContext* ctx, const char* archive_dir) {
+    PartitionedFlightStore* store = partition_store_create(archive_dir);
+    if (store == NULL) {
+        return;
+    }
+    AVL_Node* tree = NULL;
+    time_t first = ctx->flights[0].departureTime;
+    time_t last = first;
+    for (int i = 0; i < ctx->flight_count; i++) {
+        tree = avl_insert(tree, ctx->flights[i]);
+        if (ctx->flights[i].departureTime < first) first = ctx->flights[i].departureTime;
+        if (ctx->flights[i].departureTime > last) last = ctx->flights[i].departureTime;
+    }
+    
+    uint64_t start = timing_now_ns();
+    for (int i = 0; i < ctx->flight_count; i++) {
+        partition_store_add_flight(store, ctx->flights[i]);
+    }
+    for (int i = 0; i < ctx->reservation_count; i++) {
+        partition_store_add_reservation(store, ctx->reservations[i]);
+    }
+    double build_ms = (timing_now_ns() - start) / 1e6;
+    ctx->built_flights = ctx->flight_count;
+    
+    // The same windows for both, starting anywhere in the departure span
+    Flight* found = NULL;
+    int found_capacity = 0;
+    long long tree_total = 0;
+    long long partition_total = 0;
+    start = timing_now_ns();
+    for (int q = 0; q < PARTITION_QUERIES; q++) {
+        time_t from = first + (time_t)(key_index(ctx, q, (int)((last - first) / 60 + 1))) * 60;
+        tree_total += count_departures(tree, from, from + 86400);
+    }
+    double tree_us = (timing_now_ns() - start) / 1e3 / PARTITION_QUERIES;
+    start = timing_now_ns();
+    for (int q = 0; q < PARTITION_QUERIES; q++) {
+        time_t from = first + (time_t)(key_index(ctx, q, (int)((last - first) / 60 + 1))) * 60;
+        partition_total += partition_list_departures(store, from, from + 86400, &found, &found_capacity);
+    }
+    double partition_us = (timing_now_ns() - start) / 1e3 / PARTITION_QUERIES;
+    
+    printf("\nDay partitions (%d days, built in %.1f ms)\n", store->count, build_ms);
+    printf("  one-day window   single tree %10.1f us   partitioned %10.1f us   (%s results)\n",
+           tree_us, partition_us, tree_total == partition_total ? "same" : "DIFFERENT");
+    
+    // Archive the oldest three quarters, then query the first day twice
+    long long bytes_before = tree_bytes();
+    start = timing_now_ns();
+    int archived = partition_archive_before(store, first + (last - first) / 4 * 3);
+    double archive_ms = (timing_now_ns() - start) / 1e6;
+    printf("  archived %d days to %s in %.1f ms, freeing %.1f MB (%d of %d days resident)\n",
+           archived, archive_dir, archive_ms, (bytes_before - tree_bytes()) / 1048576.0,
+           store->resident_count, store->count);
+    if (archived > 0) {
+        double query_us[2];
+        for (int pass = 0; pass < 2; pass++) {
+            start = timing_now_ns();
+            partition_list_departures(store, first, first + 86400, &found, &found_capacity);
+            query_us[pass] = (timing_now_ns() - start) / 1e3;
+        }
+        printf("  archived day     cold (reload) %8.1f us   warm %10.1f us\n", query_us[0], query_us[1]);
+    }
+    fflush(stdout);
+    
+    free(found);
+    free_avl_tree(tree);
+    partition_store_free(store);
+}
+
+// Passes over the key stream timed in the batch lookup benchmark
+#define BATCH_ROUNDS 4
+
+// Print one single-key against batched comparison
+static void print_batch_line(const char* name, double single_ns, double batch_ns, int same) {
+    printf("  %-28s single %8.1f M/s   batched %8.1f M/s   %5.2fx   (%s results)\n", name,
+           BENCH_KEY_COUNT * BATCH_ROUNDS / single_ns * 1e3, BENCH_KEY_COUNT * BATCH_ROUNDS / batch_ns * 1e3,
+           single_ns / batch_ns, same ? "same" : "DIFFERENT");
+}
+
+// Random flight and passenger lookups and per-flight reservation counts, one key at a time
+// against the prefetching batch entry points with `batch` keys per call
+static void bench_batch_lookups(BenchContext* ctx, int batch) {
+    AVL_Node* flights = NULL;
+    for (int i = 0; i < ctx->flight_count; i++) {
+        flights = avl_insert(flights, ctx->flights[i]);
+    }
+    bench_quiet_stdout(1);
+    PassengerHashTable* passengers = init_hash_table(ctx->passenger_count);
+    bench_quiet_stdout(0);
+    ReservationBST* reservations = init_reservation_bst();
+    for (int i = 0; i < ctx->passenger_count; i++) {
+        hash_insert_passenger(passengers, ctx->passengers[i]);
+    }
+    for (int i = 0; i < ctx->reservation_count; i++) {
+        add_reservation_bst(reservations, ctx->reservations[i]);
+    }
+    ctx->built_flights = ctx->flight_count;
+    ctx->built_passengers = ctx->passenger_count;
+    
+    int* flight_ids = (int*)malloc(BENCH_KEY_COUNT * sizeof(int));
+    int* passenger_ids = (int*)malloc(BENCH_KEY_COUNT * sizeof(int));
+    Flight** flight_results = (Flight**)malloc(batch * sizeof(Flight*));
+    Passenger** passenger_results = (Passenger**)malloc(batch * sizeof(Passenger*));
+    int* counts = (int*)malloc(batch * sizeof(int));
+    if (flight_ids == NULL || passenger_ids == NULL || flight_results == NULL ||
+        passenger_results == NULL || counts == NULL) {
+        fprintf(stderr, "Memory allocation failed for the batch lookup benchmark\n");
+    } else {
+        for (int i = 0; i < BENCH_KEY_COUNT; i++) {
+            flight_ids[i] = random_flight(ctx, i)->id;
+            passenger_ids[i] = random_passenger(ctx, i)->id;
+        }
+        printf("\nBatched lookups (%d keys per call, %d-key groups)\n", batch, AVL_BATCH_GROUP);
+        
+        // Checksums of the IDs found keep both loops honest and show they agree
+        long long single_sum = 0;
+        long long batch_sum = 0;
+        uint64_t start = timing_now_ns();
+        for (int r = 0; r < BATCH_ROUNDS; r++) {
+            for (int i = 0; i < BENCH_KEY_COUNT; i++) {
+                Flight* flight = avl_find_flight(flights, flight_ids[i]);
+                single_sum += flight != NULL ? flight->id : -1;
+            }
+        }
+        double single_ns = (double)(timing_now_ns() - start);
+        start = timing_now_ns();
+        for (int r = 0; r < BATCH_ROUNDS; r++) {
+            for (int i = 0; i < BENCH_KEY_COUNT; i += batch) {
+                int n = BENCH_KEY_COUNT - i < batch ? BENCH_KEY_COUNT - i : batch;
+                avl_find_flight_batch(flights, flight_ids + i, n, flight_results);
+                for (int j = 0; j < n; j++) {
+                    batch_sum += flight_results[j] != NULL ? flight_results[j]->id : -1;
+                }
+            }
+        }
+        print_batch_line("avl_find_flight", single_ns, (double)(timing_now_ns() - start), single_sum == batch_sum);
+        
+        single_sum = 0;
+        batch_sum = 0;
+        start = timing_now_ns();
+        for (int r = 0; r < BATCH_ROUNDS; r++) {
+            for (int i = 0; i < BENCH_KEY_COUNT; i++) {
+                Passenger* passenger = hash_find_passenger(passengers, passenger_ids[i]);
+                single_sum += passenger != NULL ? passenger->id : -1;
+            }
+        }
+        single_ns = (double)(timing_now_ns() - start);
+        start = timing_now_ns();
+        for (int r = 0; r < BATCH_ROUNDS; r++) {
+            for (int i = 0; i < BENCH_KEY_COUNT; i += batch) {
+                int n = BENCH_KEY_COUNT - i < batch ? BENCH_KEY_COUNT - i : batch;
+                hash_find_passenger_batch(passengers, passenger_ids + i, n, passenger_results);
+                for (int j = 0; j < n; j++) {
+                    batch_sum += passenger_results[j] != NULL ? passenger_results[j]->id : -1;
+                }
+            }
+        }
+        print_batch_line("hash_find_passenger", single_ns, (double)(timing_now_ns() - start), single_sum == batch_sum);
+        
+        // No single-key function counts seats, so the baseline is the batch call with one key
+        single_sum = 0;
+        batch_sum = 0;
+        start = timing_now_ns();
+        for (int r = 0; r < BATCH_ROUNDS; r++) {
+            for (int i = 0; i < BENCH_KEY_COUNT; i++) {
+                int single[1];
+                count_reservations_by_flight_batch_bst(reservations, flight_ids + i, 1, single);
+                single_sum += single[0];
+            }
+        }
+        single_ns = (double)(timing_now_ns() - start);
+        start = timing_now_ns();
+        for (int r = 0; r < BATCH_ROUNDS; r++) {
+            for (int i = 0; i < BENCH_KEY_COUNT; i += batch) {
+                int n = BENCH_KEY_COUNT - i < batch ? BENCH_KEY_COUNT - i : batch;
+                count_reservations_by_flight_batch_bst(reservations, flight_ids + i, n, counts);
+                for (int j = 0; j < n; j++) {
+                    batch_sum += counts[j];
+                }
+            }
+        }
+        print_batch_line("reservations by flight", single_ns, (double)(timing_now_ns() - start), single_sum == batch_sum);
+        fflush(stdout);
+    }
+    
+    free(flight_ids);
+    free(passenger_ids);
+    free(flight_results);
+    free(passenger_results);
+    free(counts);
+    free_avl_tree(flights);
+    free_hash_table(passengers);
+    free_reservation_bst(reservations);
+}
+
+// Distinct-passenger queries of each kind timed in the sketch benchmark
+#define DISTINCT_QUERIES 100
+
+// Exact distinct passengers on the flights from `origin` (NULL for any) departing in [from, to),
+// marking passengers in a tracking array as print_flight_passengers_bst does
+static int exact_distinct(BenchContext* ctx, AVL_Node* flights, char* seen, const char* origin,
+                          time_t from, time_t to) {
+    memset(seen, 0, ctx->passenger_count + 2000);
+    int count = 0;
+    for (int i = 0; i < ctx->reservation_count; i++) {
+        Flight* flight = avl_find_flight(flights, ctx->reservations[i].flightId);
+        int id = ctx->reservations[i].passengerId;
+        if (flight == NULL || flight->departureTime < from || flight->departureTime >= to ||
+            (origin != NULL && strcmp(flight->origin, origin) != 0) || id < 0 || id >= ctx->passenger_count + 2000) {
+            continue;
+        }
+        count += !seen[id];
+        seen[id] = 1;
+    }
+    return count;
+}
+
+// Week-long distinct-passenger queries per origin and over every origin, from the per-flight
+// sketches against an exact pass over the reservations
+static void bench_distinct(BenchContext* ctx) {
+    uint64_t start = timing_now_ns();
+    PassengerSketchIndex* index = sketch_index_build(ctx->flights, ctx->flight_count,
+                                                     ctx->reservations, ctx->reservation_count);
+    double build_ms = (timing_now_ns() - start) / 1e6;
+    AVL_Node* flights = NULL;
+    for (int i = 0; i < ctx->flight_count; i++) {
+        flights = avl_insert(flights, ctx->flights[i]);
+    }
+    char* seen = (char*)malloc(ctx->passenger_count + 2000);
+    if (index == NULL || seen == NULL) {
+        fprintf(stderr, "Could not set up the distinct-passenger benchmark\n");
+        sketch_index_free(index);
+        free(seen);
+        free_avl_tree(flights);
+        return;
+    }
+    ctx->built_flights = ctx->flight_count;
+    printf("\nDistinct passengers (sketches built in %.1f ms, %.1f MB)\n", build_ms,
+           mem_stats_get(MEM_PASSENGER_SKETCHES).live_bytes / 1048576.0);
+    
+    for (int kind = 0; kind < 2; kind++) {
+        double sketch_ns = 0.0;
+        double exact_ns = 0.0;
+        double error_sum = 0.0;
+        double error_max = 0.0;
+        int queries = 0;
+        for (int q = 0; q < DISTINCT_QUERIES; q++) {
+            Flight* around = random_flight(ctx, q);
+            const char* origin = kind == 0 ? around->origin : NULL;
+            time_t from = around->departureTime - 3 * 86400;
+            time_t to = from + 7 * 86400;
+            
+            start = timing_now_ns();
+            double estimate = sketch_distinct_passengers(index, origin, NULL, from, to);
+            sketch_ns += timing_now_ns() - start;
+            start = timing_now_ns();
+            int exact = exact_distinct(ctx, flights, seen, origin, from, to);
+            exact_ns += timing_now_ns() - start;
+            
+            if (exact > 0) {
+                double error = (estimate > exact ? estimate - exact : exact - estimate) * 100.0 / exact;
+                error_sum += error;
+                if (error > error_max) error_max = error;
+                queries++;
+            }
+        }
+        printf("  %-22s sketches %10.1f us   exact %12.1f us   error mean %.2f%% max %.2f%%\n",
+               kind == 0 ? "one origin, one week" : "all origins, one week", sketch_ns / 1e3 / DISTINCT_QUERIES,
+               exact_ns / 1e3 / DISTINCT_QUERIES, queries > 0 ? error_sum / queries : 0.0, error_max);
+    }
+    fflush(stdout);
+    
+    free(seen);
+    free_avl_tree(flights);
+    sketch_index_free(index);
+}
+
+// Group `rows` reservations (the dataset's, repeated as needed) by origin and departure day on
+// 1, 2, 4 and 8 threads and on every CPU
+static void bench_group_by(BenchContext* ctx, int rows) {
+    ReservationRecord* records = (ReservationRecord*)malloc((size_t)rows * sizeof(ReservationRecord));
+    if (records == NULL || ctx->reservation_count == 0) {
+        fprintf(stderr, "Could not set up the group-by benchmark\n");
+        free(records);
+        return;
+    }
+    for (int i = 0; i < rows; i++) {
+        records[i] = ctx->reservations[i % ctx->reservation_count];
+    }
+    
+    AggregateQuery query;
+    memset(&query, 0, sizeof(query));
+    aggregate_parse_keys("origin,departure_day", &query);
+    query.value = AGGREGATE_LEAD_DAYS;
+    printf("\nGroup-by origin,departure_day over %d reservations\n", rows);
+    const int thread_counts[] = {1, 2, 4, 8, 0};
+    int previous = 0;
+    for (int t = 0; t < (int)(sizeof(thread_counts) / sizeof(thread_counts[0])); t++) {
+        query.threads = thread_counts[t];
+        AggregateResult* result = aggregate_reservations(&query, ctx->flights, ctx->flight_count, records, rows);
+        if (result == NULL) {
+            break;
+        }
+        if (result->threads != previous) {
+            printf("  %2d threads %9.1f ms %8.1f M rows/s  %d groups\n", result->threads, result->seconds * 1e3,
+                   rows / result->seconds / 1e6, result->group_count);
+            fflush(stdout);
+        }
+        previous = result->threads;
+        aggregate_free(result);
+    }
+    free(records);
+}
+
+// Flights listed per fullest/emptiest query in the load benchmark
+#define LOAD_TOP_K 20
+
+// Fullest/emptiest queries timed per measurement
+#define LOAD_QUERIES 1000
+
+// Order flights by load factor, fullest first, for the count-and-sort baseline
+static int compare_loads_desc(const void* a, const void* b) {
+    double left = load_factor((const FlightLoad*)a);
+    double right = load_factor((const FlightLoad*)b);
+    return (left < right) - (left > right);
+}
+
+// Top-20 fullest and emptiest flights from the load index against counting every flight's
+// reservations and sorting, plus what the index adds to a booking and cancellation
+static void bench_flight_loads(BenchContext* ctx) {
+    AVL_Node* flights = NULL;
+    for (int i = 0; i < ctx->flight_count; i++) {
+        flights = avl_insert(flights, ctx->flights[i]);
+    }
+    ReservationBST* reservations = init_reservation_bst();
+    for (int i = 0; reservations != NULL && i < ctx->reservation_count; i++) {
+        add_reservation_bst(reservations, ctx->reservations[i]);
+    }
+    ctx->built_flights = ctx->flight_count;
+    uint64_t start = timing_now_ns();
+    int ok = reservations != NULL && reservation_bst_enable_load_index(reservations, flights);
+    double build_ms = (timing_now_ns() - start) / 1e6;
+    int* ids = (int*)malloc(ctx->flight_count * sizeof(int));
+    int* counts = (int*)malloc(ctx->flight_count * sizeof(int));
+    FlightLoad* all = (FlightLoad*)malloc(ctx->flight_count * sizeof(FlightLoad));
+    FlightLoad top[LOAD_TOP_K];
+    if (!ok || ids == NULL || counts == NULL || all == NULL) {
+        fprintf(stderr, "Could not set up the flight load benchmark\n");
+        free(ids);
+        free(counts);
+        free(all);
+        free_reservation_bst(reservations);
+        free_avl_tree(flights);
+        return;
+    }
+    printf("\nFullest/emptiest %d flights (load index built in %.1f ms)\n", LOAD_TOP_K, build_ms);
+    
+    // One week around a random flight, as a departure-window query
+    long long checksum = 0;
+    start = timing_now_ns();
+    for (int q = 0; q < LOAD_QUERIES; q++) {
+        checksum += load_index_fullest(reservations->load_index, LOAD_TOP_K, 0, 0, top);
+        checksum += load_index_emptiest(reservations->load_index, LOAD_TOP_K, 0, 0, top);
+    }
+    double all_ns = (double)(timing_now_ns() - start) / LOAD_QUERIES;
+    start = timing_now_ns();
+    for (int q = 0; q < LOAD_QUERIES; q++) {
+        time_t from = random_flight(ctx, q)->departureTime - 3 * 86400;
+        checksum += load_index_fullest(reservations->load_index, LOAD_TOP_K, from, from + 7 * 86400, top);
+    }
+    double window_ns = (double)(timing_now_ns() - start) / LOAD_QUERIES;
+    
+    // The baseline counts every flight (with the batched counter, the fastest one) and sorts
+    start = timing_now_ns();
+    for (int i = 0; i < ctx->flight_count; i++) {
+        ids[i] = ctx->flights[i].id;
+    }
+    count_reservations_by_flight_batch_bst(reservations, ids, ctx->flight_count, counts);
+    for (int i = 0; i < ctx->flight_count; i++) {
+        all[i] = (FlightLoad){ctx->flights[i].id, counts[i], ctx->flights[i].capacity, ctx->flights[i].departureTime};
+    }
+    qsort(all, ctx->flight_count, sizeof(FlightLoad), compare_loads_desc);
+    double scan_ns = (double)(timing_now_ns() - start);
+    printf("  both lists, all flights   %10.2f us\n", all_ns / 1e3);
+    printf("  fullest, one-week window  %10.2f us\n", window_ns / 1e3);
+    printf("  count and sort every flight %8.2f us\n", scan_ns / 1e3);
+    
+    // Booking and cancelling the extra reservations, with the index and then without it
+    for (int pass = 0; pass < 2 && ctx->extra_count > 0; pass++) {
+        start = timing_now_ns();
+        for (int i = 0; i < ctx->extra_count; i++) {
+            add_reservation_bst(reservations, ctx->extra_reservations[i]);
+            cancel_reservation_bst(reservations, ctx->extra_reservations[i].flightId,
+                                   ctx->extra_reservations[i].passengerId);
+        }
+        printf("  book + cancel %-13s %8.0f ns\n", pass == 0 ? "with index" : "without index",
+               (double)(timing_now_ns() - start) / ctx->extra_count);
+        load_index_free(reservations->load_index);
+        reservations->load_index = NULL;
+    }
+    fflush(stdout);
+    if (checksum < 0) printf("%lld\n", checksum);
+    
+    free(ids);
+    free(counts);
+    free(all);
+    free_reservation_bst(reservations);
+    free_avl_tree(flights);
+}
+
+// Full scans timed per structure in the unrolled list benchmark (the fastest is reported)
+#define UNROLLED_SCAN_PASSES 3
+
+// Inserts and removals timed per structure in the unrolled list benchmark
+#define UNROLLED_CHURN_OPS 2000
+
+// Full scans of `count` passengers in prototype 1's skip list (walking `next`) against the
+// unrolled list: summing IDs in order and a name search that matches nobody, then the cost
+// of inserting and removing passengers in each
+static void bench_unrolled(int count) {
+    Passenger* passengers = generate_passengers(count);
+    if (passengers == NULL) {
+        fprintf(stderr, "Could not set up the unrolled list benchmark\n");
+        return;
+    }
+    uint64_t start = timing_now_ns();
+    LL_Node* head = NULL;
+    for (int i = 0; i < count; i++) {
+        head = insert_passenger(head, passengers[i]);
+    }
+    double list_build_ms = (timing_now_ns() - start) / 1e6;
+    start = timing_now_ns();
+    UnrolledPassengerList* unrolled = unrolled_build(passengers, count);
+    double unrolled_build_ms = (timing_now_ns() - start) / 1e6;
+    if (unrolled == NULL) {
+        free_list(head);
+        free(passengers);
+        return;
+    }
+    printf("\nOrdered scans of %d passengers (skip list built in %.0f ms, unrolled list in %.0f ms, %d blocks)\n",
+           count, list_build_ms, unrolled_build_ms, unrolled->block_count);
+    
+    long long checksum = 0;
+    double best[2][2] = {{1e30, 1e30}, {1e30, 1e30}};
+    for (int pass = 0; pass < UNROLLED_SCAN_PASSES; pass++) {
+        start = timing_now_ns();
+        for (LL_Node* node = head; node != NULL; node = node->next) {
+            checksum += node->data.id;
+        }
+        double ns = (double)(timing_now_ns() - start);
+        if (ns < best[0][0]) best[0][0] = ns;
+        
+        start = timing_now_ns();
+        for (PassengerBlock* block = unrolled->head; block != NULL; block = block->next) {
+            for (int i = 0; i < block->count; i++) {
+                checksum += block->ids[i];
+            }
+        }
+        ns = (double)(timing_now_ns() - start);
+        if (ns < best[1][0]) best[1][0] = ns;
+        
+        start = timing_now_ns();
+        checksum += find_passenger_by_name(head, "no such passenger") != NULL;
+        ns = (double)(timing_now_ns() - start);
+        if (ns < best[0][1]) best[0][1] = ns;
+        
+        start = timing_now_ns();
+        checksum += unrolled_find_by_name(unrolled, "no such passenger") != NULL;
+        ns = (double)(timing_now_ns() - start);
+        if (ns < best[1][1]) best[1][1] = ns;
+    }
+    printf("  %-26s %14s %14s %8s\n", "scan", "skip list", "unrolled", "speedup");
+    printf("  %-26s %11.1f ms %11.1f ms %7.1fx\n", "IDs in order", best[0][0] / 1e6, best[1][0] / 1e6,
+           best[0][0] / best[1][0]);
+    printf("  %-26s %11.1f ms %11.1f ms %7.1fx\n", "find_passenger_by_name", best[0][1] / 1e6, best[1][1] / 1e6,
+           best[0][1] / best[1][1]);
+    
+    // Remove passengers spread over the whole list, then put them back
+    int churn = count < UNROLLED_CHURN_OPS ? count : UNROLLED_CHURN_OPS;
+    for (int structure = 0; structure < 2; structure++) {
+        start = timing_now_ns();
+        for (int i = 0; i < churn; i++) {
+            int id = passengers[(int)((long long)i * count / churn)].id;
+            if (structure == 0) {
+                head = remove_passenger(head, id);
+            } else {
+                unrolled_remove(unrolled, id);
+            }
+        }
+        double remove_ns = (double)(timing_now_ns() - start) / churn;
+        start = timing_now_ns();
+        for (int i = 0; i < churn; i++) {
+            Passenger passenger = passengers[(int)((long long)i * count / churn)];
+            if (structure == 0) {
+                head = insert_passenger(head, passenger);
+            } else {
+                unrolled_insert(unrolled, passenger);
+            }
+        }
+        double insert_ns = (double)(timing_now_ns() - start) / churn;
+        printf("  %-26s remove %10.0f ns  insert %10.0f ns\n", structure == 0 ? "skip list" : "unrolled list",
+               remove_ns, insert_ns);
+    }
+    fflush(stdout);
+    if (checksum < 0) printf("%lld\n", checksum);
+    
+    unrolled_free(unrolled);
+    free_list(head);
+    free(passengers);
+}
+
+// Passes per search in the name scan benchmark (the fastest is reported)
+#define NAME_SCAN_PASSES 5
+
+// Find every passenger whose name contains each pattern among `count` passengers: strcasestr
+// on every record, as the prototypes' name searches do, against the name heap scanned on one
+// thread and on every CPU
+static void bench_name_scan(int count) {
+    Passenger* passengers = generate_passengers(count);
+    uint64_t start = timing_now_ns();
+    PassengerNameHeap* heap = passengers != NULL ? name_heap_build(passengers, count) : NULL;
+    double build_ms = (timing_now_ns() - start) / 1e6;
+    if (heap == NULL) {
+        fprintf(stderr, "Could not set up the name scan benchmark\n");
+        free(passengers);
+        return;
+    }
+    printf("\nSubstring scans of %d passenger names (%.1f MB heap built in %.0f ms, %s)\n",
+           count, heap->length / 1e6, build_ms, simd_scan_isa());
+    printf("  %-8s %9s %14s %14s %14s %8s\n", "pattern", "matches", "strcasestr", "heap 1 thread",
+           "heap all CPUs", "speedup");
+    
+    const char* patterns[] = {"an", "so", "hern", "xq"};
+    int* ids = NULL;
+    int capacity = 0;
+    for (int p = 0; p < 4; p++) {
+        double best[3] = {1e30, 1e30, 1e30};
+        int matches[3] = {0, 0, 0};
+        for (int pass = 0; pass < NAME_SCAN_PASSES; pass++) {
+            start = timing_now_ns();
+            int found = 0;
+            for (int i = 0; i < count; i++) {
+                found += strcasestr(passengers[i].name, patterns[p]) != NULL;
+            }
+            double ns = (double)(timing_now_ns() - start);
+            if (ns < best[0]) best[0] = ns;
+            matches[0] = found;
+            
+            for (int run = 1; run < 3; run++) {
+                start = timing_now_ns();
+                matches[run] = name_heap_find(heap, patterns[p], run == 1 ? 1 : 0, &ids, &capacity);
+                ns = (double)(timing_now_ns() - start);
+                if (ns < best[run]) best[run] = ns;
+            }
+        }
+        printf("  %-8s %9d %11.1f ms %11.1f ms %11.1f ms %7.1fx%s\n", patterns[p], matches[1], best[0] / 1e6,
+               best[1] / 1e6, best[2] / 1e6, best[0] / best[2],
+               matches[0] == matches[1] && matches[1] == matches[2] ? "" : "  (match counts differ)");
+    }
+    fflush(stdout);
+    
+    free(ids);
+    name_heap_free(heap);
+    free(passengers);
+}
+
+// Generate the dataset for one size. Returns 1 on success
+static int create_dataset(BenchContext* ctx, int flight_count, int skewed, unsigned int seed, int extra_count) {
+    memset(ctx, 0, sizeof(*ctx));
+    GeneratorConfig config = skewed ? skewed_generator_config() : uniform_generator_config();
+    config.seed = seed;
+    srand(seed);
+    
+    ctx->flight_count = flight_count;
+    ctx->passenger_count = flight_count * 5;
+    ctx->reservation_count = flight_count * 10;
+    ctx->flights = generate_flights(ctx->flight_count, config.reference_time);
+    ctx->passengers = skewed ? generate_passengers_clustered(ctx->passenger_count, &config)
+                             : generate_passengers(ctx->passenger_count);
+    
+    // The skewed generator's reservation routine is used for both distributions (with Zipf
+    // and Pareto exponents of 0 it is uniform) since generate_reservations is quadratic
+    if (ctx->flights != NULL) {
+        ctx->reservations = generate_reservations_skewed(ctx->reservation_count, ctx->flights, ctx->flight_count,
+                                                         ctx->passenger_count, &config, &ctx->reservation_count);
+    }
+    
+    ctx->random_keys = (int*)malloc(BENCH_KEY_COUNT * sizeof(int));
+    ctx->extra_count = extra_count > 0 ? extra_count : 1;
+    ctx->extra_passengers = (Passenger*)malloc(ctx->extra_count * sizeof(Passenger));
+    ctx->extra_reservations = (ReservationRecord*)malloc(ctx->extra_count * sizeof(ReservationRecord));
+    if (ctx->flights == NULL || ctx->passengers == NULL || ctx->reservations == NULL ||
+        ctx->random_keys == NULL || ctx->extra_passengers == NULL || ctx->extra_reservations == NULL) {
+        fprintf(stderr, "Could not generate the benchmark dataset\n");
+        return 0;
+    }
+    
+    for (int i = 0; i < BENCH_KEY_COUNT; i++) {
+        ctx->random_keys[i] = (int)(generator_random_unit() * 2147483647.0);
+    }
+    
+    // New passengers get IDs past the generated ones; new bookings go to random flights
+    for (int i = 0; i < ctx->extra_count; i++) {
+        ctx->extra_passengers[i] = ctx->passengers[i % ctx->passenger_count];
+        ctx->extra_passengers[i].id = 2000 + ctx->passenger_count + i;
+        
+        ctx->extra_reservations[i] = ctx->reservations[i % ctx->reservation_count];
+        ctx->extra_reservations[i].flightId = 1000 + rand() % ctx->flight_count;
+        ctx->extra_reservations[i].passengerId = 2000 + rand() % ctx->passenger_count;
+    }
+    return 1;
+}
+
+static void free_dataset(BenchContext* ctx) {
+    free(ctx->flights);
+    free(ctx->passengers);
+    free(ctx->reservations);
+    free(ctx->random_keys);
+    free(ctx->extra_passengers);
+    free(ctx->extra_reservations);
+}
+
+// Parse a comma-separated list of size names into flags. Returns 1 on success
+static int parse_sizes(const char* text, int selected[BENCH_SIZE_COUNT]) {
+    memset(selected, 0, BENCH_SIZE_COUNT * sizeof(int));
+    if (strcmp(text, "all") == 0) {
+        for (int s = 0; s < BENCH_SIZE_COUNT; s++) selected[s] = 1;
+        return 1;
+    }
+    
+    char buffer[MAX_LINE_LENGTH];
+    strncpy(buffer, text, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+    for (char* token = strtok(buffer, ","); token != NULL; token = strtok(NULL, ",")) {
+        int found = 0;
+        for (int s = 0; s < BENCH_SIZE_COUNT; s++) {
+            if (strcmp(token, bench_sizes[s].name) == 0) {
+                selected[s] = 1;
+                found = 1;
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "Unknown size '%s' (expected small, medium, large, huge or all)\n", token);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options = default_bench_options();
+    int selected[BENCH_SIZE_COUNT] = {1, 1, 1, 1};
+    int run_engine[3] = {0, 1, 1};
+    int skewed = 0;
+    unsigned int seed = 205;
+    double build_budget = 60.0;
+    const char* csv_path = NULL;
+    const char* json_path = NULL;
+    int snapshot_readers = 0;
+    double snapshot_seconds = 1.0;
+    const char* partition_archive = NULL;
+    int batch_lookups = 0;
+    double bloom_fp_rate = 0.0;
+    int distinct = 0;
+    int group_by_rows = 0;
+    int flight_loads = 0;
+    int unrolled_passengers = 0;
+    int name_scan_passengers = 0;
+    PerfCounters perf_counters;
+    
+    for (int i = 1; i < argc; i++) {
+        int has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--sizes") == 0 && has_value) {
+            if (!parse_sizes(argv[++i], selected)) return 1;
+        } else if (strcmp(argv[i], "--engines") == 0 && has_value) {
+            const char* list = argv[++i];
+            run_engine[1] = strchr(list, '1') != NULL;
+            run_engine[2] = strchr(list, '2') != NULL;
+        } else if (strcmp(argv[i], "--reps") == 0 && has_value) {
+            options.repetitions = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ops") == 0 && has_value) {
+            options.ops_per_rep = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--warmup") == 0 && has_value) {
+            options.warmup_ops = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--clock") == 0 && has_value) {
+            options.clock = strcmp(argv[++i], "tsc") == 0 ? BENCH_CLOCK_TSC : BENCH_CLOCK_MONOTONIC;
+        } else if (strcmp(argv[i], "--budget") == 0 && has_value) {
+            build_budget = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--op-budget") == 0 && has_value) {
+            options.op_budget_seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--outlier-mads") == 0 && has_value) {
+            options.outlier_mads = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--skewed") == 0) {
+            skewed = 1;
+        } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+            seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            // Hardware counters; with none available the results just have empty counter columns
+            perf_counters_open(&perf_counters);
+            options.perf = &perf_counters;
+        } else if (strcmp(argv[i], "--csv") == 0 && has_value) {
+            csv_path = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0 && has_value) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--snapshot-readers") == 0 && has_value) {
+            snapshot_readers = atoi(argv[++i]);
+            if (snapshot_readers < 1 || snapshot_readers > PAVL_MAX_READERS) {
+                fprintf(stderr, "--snapshot-readers must be between 1 and %d\n", PAVL_MAX_READERS);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--snapshot-seconds") == 0 && has_value) {
+            snapshot_seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--partition-archive") == 0 && has_value) {
+            partition_archive = argv[++i];
+        } else if (strcmp(argv[i], "--group-by") == 0 && has_value) {
+            group_by_rows = atoi(argv[++i]);
+            if (group_by_rows < 1) {
+                fprintf(stderr, "--group-by must be at least 1 row\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--flight-loads") == 0) {
+            flight_loads = 1;
+        } else if (strcmp(argv[i], "--unrolled") == 0 && has_value) {
+            unrolled_passengers = atoi(argv[++i]);
+            if (unrolled_passengers < 1) {
+                fprintf(stderr, "--unrolled must be at least 1 passenger\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--name-scan") == 0 && has_value) {
+            name_scan_passengers = atoi(argv[++i]);
+            if (name_scan_passengers < 1) {
+                fprintf(stderr, "--name-scan must be at least 1 passenger\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--distinct") == 0) {
+            distinct = 1;
+        } else if (strcmp(argv[i], "--bloom") == 0 && has_value) {
+            bloom_fp_rate = atof(argv[++i]);
+            if (bloom_fp_rate <= 0.0 || bloom_fp_rate >= 1.0) {
+                fprintf(stderr, "--bloom must be a false-positive rate between 0 and 1\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--batch-lookups") == 0 && has_value) {
+            batch_lookups = atoi(argv[++i]);
+            if (batch_lookups < 1) {
+                fprintf(stderr, "--batch-lookups must be at least 1\n");
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    
+    printf("Benchmark: %d repetitions x %d operations, %d warmup, clock %s, timer overhead %.0f ns\n",
+           options.repetitions, options.ops_per_rep, options.warmup_ops,
+           options.clock == BENCH_CLOCK_TSC && timing_has_tsc() ? "rdtsc" : "CLOCK_MONOTONIC",
+           bench_timer_overhead_ns(options.clock));
+    
+    ResultList results = {NULL, 0, 0};
+    int extra_count = options.warmup_ops + options.repetitions * options.ops_per_rep;
+    
+    for (int s = 0; s < BENCH_SIZE_COUNT; s++) {
+        if (!selected[s]) continue;
+        
+        BenchContext ctx;
+        if (!create_dataset(&ctx, bench_sizes[s].flights, skewed, seed, extra_count)) {
+            free_dataset(&ctx);
+            return 1;
+        }
+        printf("\n===== %s: %d flights, %d passengers, %d reservations (%s) =====\n", bench_sizes[s].name,
+               ctx.flight_count, ctx.passenger_count, ctx.reservation_count, skewed ? "skewed" : "uniform");
+        
+        if (run_engine[1]) {
+            ctx.p1_reservations = init_reservations(ctx.reservation_count);
+            bench_engine("prototype1", bench_sizes[s].name, &ctx, p1_build, TABLE_LENGTH(p1_build),
+                         p1_ops, TABLE_LENGTH(p1_ops), &options, build_budget, &results);
+            free_tree(ctx.p1_flights);
+            free_list(ctx.p1_passengers);
+            free_reservations(ctx.p1_reservations);
+            ctx.p1_flights = NULL;
+            ctx.p1_passengers = NULL;
+        }
+        
+        if (run_engine[2]) {
+            bench_quiet_stdout(1);  // init_hash_table announces its size
+            ctx.p2_passengers = init_hash_table(ctx.passenger_count);
+            bench_quiet_stdout(0);
+            ctx.p2_reservations = init_reservation_bst();
+            
+            // Filters go on before the build, so its inserts pay for keeping them up to date
+            if (bloom_fp_rate > 0.0) {
+                hash_enable_filter(ctx.p2_passengers, bloom_fp_rate);
+                reservation_bst_enable_filter(ctx.p2_reservations, ctx.reservation_count, bloom_fp_rate);
+            }
+            bench_engine(bloom_fp_rate > 0.0 ? "proto2+bloom" : "prototype2", bench_sizes[s].name,
+                         &ctx, p2_build, TABLE_LENGTH(p2_build),
+                         p2_ops, TABLE_LENGTH(p2_ops), &options, build_budget, &results);
+            free_avl_tree(ctx.p2_flights);
+            free_hash_table(ctx.p2_passengers);
+            free_reservation_bst(ctx.p2_reservations);
+        }
+        
+        if (snapshot_readers > 0) {
+            bench_snapshot_reads(&ctx, snapshot_readers, snapshot_seconds);
+        }
+        
+        if (partition_archive != NULL) {
+            bench_partitions(&ctx, partition_archive);
+        }
+        
+        if (batch_lookups > 0) {
+            bench_batch_lookups(&ctx, batch_lookups);
+        }
+        
+        if (distinct) {
+            bench_distinct(&ctx);
+        }
+        
+        if (group_by_rows > 0) {
+            bench_group_by(&ctx, group_by_rows);
+        }
+        
+        if (flight_loads) {
+            bench_flight_loads(&ctx);
+        }
+        
+        free_dataset(&ctx);
+    }
+    
+    // Independent of the dataset sizes, so run once
+    if (unrolled_passengers > 0) {
+        bench_unrolled(unrolled_passengers);
+    }
+    if (name_scan_passengers > 0) {
+        bench_name_scan(name_scan_passengers);
+    }
+    
+    if (csv_path != NULL) {
+        FILE* file = fopen(csv_path, "w");
+        if (file == NULL) {
+            fprintf(stderr, "Could not open %s for writing\n", csv_path);
+        } else {
+            bench_write_csv_header(file);
+            for (int i = 0; i < results.count; i++) {
+                bench_write_csv_row(file, &results.items[i]);
+            }
+            fclose(file);
+            printf("\nResults written to %s\n", csv_path);
+        }
+    }
+    
+    if (json_path != NULL) {
+        FILE* file = fopen(json_path, "w");
+        if (file == NULL) {
+            fprintf(stderr, "Could not open %s for writing\n", json_path);
+        } else {
+            bench_write_json(file, results.items, results.count);
+            fclose(file);
+            printf("Results written to %s\n", json_path);
+        }
+    }
+    
+    for (int i = 0; i < results.count; i++) {
+        bench_result_free(&results.items[i]);
+    }
+    free(results.items);
+    if (options.perf != NULL) {
+        perf_counters_close(options.perf);
+    }
+    return 0;
+}
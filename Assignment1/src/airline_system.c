@@ -3,7 +3,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <time.h>
+#include <signal.h>
 #include "airline_types.h"
 #include "prototype1/flight_management.h"
 #include "prototype1/passenger_management.h"
@@ -15,8 +17,24 @@
 #include "prototype2/reservation_management_bst.h"
 #include "prototype2/flight_search_avl.h"
 #include "prototype2/passenger_search_hash.h"
+#include "prototype2/passenger_sketches.h"
+#include "prototype2/flight_load_index.h"
+#include "prototype2/reservation_mvcc.h"
+#include "name_heap.h"
 #include "file_loader.h"
 #include "data_generator.h"
+#include "snapshot.h"
+#include "engine.h"
+#include "trace.h"
+#include "timing.h"
+#include "perf_counters.h"
+#include "mem_stats.h"
+#include "structure_health.h"
+#include "batch.h"
+#include "aggregate.h"
+#include "server.h"
+#include "loadgen.h"
+#include "benchmark.h"
 #include "test_framework.h"
 
 // Global variables to store data structures for both prototypes
@@ -29,6 +47,9 @@ ReservationArray* p1_reservations_array = NULL;
 AVL_Node* p2_flights_root = NULL;
 PassengerHashTable* p2_passengers_table = NULL;
 ReservationBST* p2_reservations_bst = NULL;
+PassengerSketchIndex* passenger_sketches = NULL;  // Distinct passengers per flight (menu option 17)
+PassengerNameHeap* passenger_names = NULL;        // Case-folded names for fragment searches (menu option 19)
+MvccReservationStore* reservation_versions = NULL; // Versioned copy of the reservation BST (menu option 20)
 
 // Global variables to store loaded data
 Flight* flights = NULL;
@@ -38,6 +59,14 @@ int flight_count = 0;
 int passenger_count = 0;
 int reservation_count = 0;
 
+// Records menu operations when started with --record-trace
+TraceRecorder* session_recorder = NULL;
+
+// Hardware counters reported for each search when started with --profile
+PerfCounters profile_counters;
+int profile_enabled = 0;
+uint64_t profile_start_ns = 0;
+
 // Helper function prototypes
 void display_menu(int active_prototype);
 int check_data_loaded(int data_loaded);
@@ -91,6 +120,7 @@ void run_prototype1(Flight* flights, int flight_count, Passenger* passengers, in
     for (int i = 0; i < reservation_count; i++) {
         add_reservation(reservations_array, reservations[i]);
     }
+    sort_reservations(reservations_array);
     
     end = clock();
     execution_time = ((double)(end - start)) / CLOCKS_PER_SEC;
@@ -223,6 +253,9 @@ void build_data_structures() {
     if (p2_flights_root) free_avl_tree(p2_flights_root);
     if (p2_passengers_table) free_hash_table(p2_passengers_table);
     if (p2_reservations_bst) free_reservation_bst(p2_reservations_bst);
+    sketch_index_free(passenger_sketches);
+    name_heap_free(passenger_names);
+    mvcc_free(reservation_versions);
     
     // Reset data structures
     p1_flights_root = NULL;
@@ -231,6 +264,9 @@ void build_data_structures() {
     p2_flights_root = NULL;
     p2_passengers_table = NULL;
     p2_reservations_bst = NULL;
+    passenger_sketches = NULL;
+    passenger_names = NULL;
+    reservation_versions = NULL;
     
     clock_t start, end;
     
@@ -252,6 +288,7 @@ void build_data_structures() {
     for (int i = 0; i < reservation_count; i++) {
         add_reservation(p1_reservations_array, reservations[i]);
     }
+    sort_reservations(p1_reservations_array);
     
     end = clock();
     double proto1_time = ((double)(end - start)) / CLOCKS_PER_SEC;
@@ -294,14 +331,42 @@ void build_data_structures() {
                 add_reservation_bst(p2_reservations_bst, reservations[j]);
             }
         }
+        
+        // Flights in load-factor order, kept current by every later booking and cancellation
+        reservation_bst_enable_load_index(p2_reservations_bst, p2_flights_root);
     }
     
     end = clock();
     double proto2_time = ((double)(end - start)) / CLOCKS_PER_SEC;
     
+    // Distinct passenger sketches for the dashboard queries
+    start = clock();
+    passenger_sketches = sketch_index_build(flights, flight_count, reservations, reservation_count);
+    end = clock();
+    double sketch_time = ((double)(end - start)) / CLOCKS_PER_SEC;
+    
+    // One contiguous heap of the passenger names for fragment searches
+    start = clock();
+    passenger_names = name_heap_build(passengers, passenger_count);
+    end = clock();
+    double name_heap_time = ((double)(end - start)) / CLOCKS_PER_SEC;
+    
+    // Versioned copy of the reservation BST for snapshot reports
+    start = clock();
+    reservation_versions = mvcc_create();
+    if (reservation_versions != NULL && mvcc_import_bst(reservation_versions, p2_reservations_bst) == 0) {
+        mvcc_free(reservation_versions);
+        reservation_versions = NULL;
+    }
+    end = clock();
+    double versions_time = ((double)(end - start)) / CLOCKS_PER_SEC;
+    
     printf("\nData structures built successfully.\n");
     printf("Prototype 1 build time: %f seconds\n", proto1_time);
     printf("Prototype 2 build time: %f seconds\n", proto2_time);
+    printf("Passenger sketch build time: %f seconds\n", sketch_time);
+    printf("Passenger name heap build time: %f seconds\n", name_heap_time);
+    printf("Versioned reservation store build time: %f seconds\n", versions_time);
 }
 
 // Function to display a summary of the loaded data
@@ -366,9 +431,18 @@ void display_menu(int active_prototype) {
     printf("\nPerformance Testing:\n");
     printf(" 11. Run performance comparison between prototypes\n");
     printf(" 12. Switch active prototype (current: Prototype %d)\n", active_prototype);
+    printf(" 14. Show memory usage by structure\n");
+    printf(" 15. Show structure health statistics\n");
+    printf("\nChanges:\n");
+    printf(" 16. Cancel a flight or a day's departures\n");
+    printf("\nAnalytics:\n");
+    printf(" 17. Estimate distinct passengers by origin, route or dates\n");
+    printf(" 18. Show the fullest and emptiest flights\n");
+    printf(" 19. Find every passenger whose name contains a fragment\n");
+    printf(" 20. Fleet capacity report from a reservation snapshot\n");
     printf("\n 13. Exit program\n");
     printf("==============================================\n");
-    printf("Enter your choice (1-13): ");
+    printf("Enter your choice (1-20): ");
 }
 
 // Function to search for a flight by ID
@@ -412,6 +486,509 @@ void display_passenger_details(Passenger* passenger) {
     }
 }
 
+// Flights shown per page by menu option 3
+#define FLIGHT_PAGE_SIZE 20
+
+// List flights one page at a time (menu option 3). Prototype 2 reaches any page in O(log n)
+// through the subtree sizes of its AVL tree; prototype 1 walks every flight before the page
+void list_flights_paged(int prototype) {
+    int total = prototype == 1 ? count_flights_in_range(p1_flights_root, INT_MIN, INT_MAX)
+                               : avl_size(p2_flights_root);
+    if (total == 0) {
+        printf("No flights loaded.\n");
+        return;
+    }
+    
+    int pages = (total + FLIGHT_PAGE_SIZE - 1) / FLIGHT_PAGE_SIZE;
+    int page_number = 1;
+    Flight page[FLIGHT_PAGE_SIZE];
+    char input[MAX_LINE_LENGTH];
+    while (page_number >= 1 && page_number <= pages) {
+        int start = (page_number - 1) * FLIGHT_PAGE_SIZE;
+        int count = prototype == 1 ? list_flights_from_rank(p1_flights_root, start, page, FLIGHT_PAGE_SIZE)
+                                   : avl_list_flights_from_rank(p2_flights_root, start, page, FLIGHT_PAGE_SIZE);
+        for (int i = 0; i < count; i++) {
+            printf("Flight ID: %d, Number: %s, From: %s, To: %s\n",
+                   page[i].id, page[i].flightNumber, page[i].origin, page[i].destination);
+        }
+        printf("Page %d of %d (flights %d-%d of %d)\n", page_number, pages, start + 1, start + count, total);
+        if (pages == 1) break;
+        
+        printf("Page number, Enter for the next page, or 0 to stop: ");
+        if (fgets(input, sizeof(input), stdin) == NULL) break;
+        page_number = (input[0] == '\n' || input[0] == '\0') ? page_number + 1 : atoi(input);
+    }
+}
+
+// Most affected reservations printed after a cancellation
+#define CANCEL_REPORT_LIMIT 20
+
+// Drop cancelled flights and their reservations from the loaded data, so later rebuilds and
+// reports match the structures
+void remove_cancelled_from_dataset() {
+    int kept = 0;
+    for (int i = 0; i < flight_count; i++) {
+        if (avl_find_flight(p2_flights_root, flights[i].id) != NULL) {
+            flights[kept++] = flights[i];
+        }
+    }
+    flight_count = kept;
+    
+    kept = 0;
+    for (int i = 0; i < reservation_count; i++) {
+        if (avl_find_flight(p2_flights_root, reservations[i].flightId) != NULL) {
+            reservations[kept++] = reservations[i];
+        }
+    }
+    reservation_count = kept;
+    
+    // A cancelled flight's passengers cannot be taken out of a merged sketch, but its own sketch can go
+    for (int i = passenger_sketches != NULL ? passenger_sketches->count - 1 : -1; i >= 0; i--) {
+        int flight_id = passenger_sketches->flights[i].flightId;
+        if (avl_find_flight(p2_flights_root, flight_id) == NULL) {
+            sketch_index_remove_flight(passenger_sketches, flight_id);
+        }
+    }
+}
+
+// Cancel one flight, or every departure on a date, in both prototypes (menu option 16),
+// then list the passengers who need rebooking
+void cancel_flights_menu(int prototype) {
+    char input[MAX_LINE_LENGTH];
+    printf("Enter a flight ID, or a date (YYYY-MM-DD) to cancel every departure that day: ");
+    if (fgets(input, sizeof(input), stdin) == NULL) return;
+    
+    // A date covers local midnight to the next midnight
+    int year, month, day;
+    int by_date = sscanf(input, "%d-%d-%d", &year, &month, &day) == 3;
+    time_t from = 0;
+    time_t to = 0;
+    if (by_date) {
+        struct tm start = {0};
+        start.tm_year = year - 1900;
+        start.tm_mon = month - 1;
+        start.tm_mday = day;
+        start.tm_isdst = -1;
+        struct tm end = start;
+        end.tm_mday++;
+        from = mktime(&start);
+        to = mktime(&end);
+    }
+    int flight_id = atoi(input);
+    if (!by_date && avl_find_flight(p2_flights_root, flight_id) == NULL) {
+        printf("\nFlight with ID %d not found.\n", flight_id);
+        return;
+    }
+    
+    ReservationRecord* p1_records = NULL;
+    ReservationRecord* p2_records = NULL;
+    int p1_capacity = 0;
+    int p2_capacity = 0;
+    int p1_flights = 1;
+    int p2_flights = 1;
+    
+    // Both prototypes hold the same data, so both are changed; each one is timed
+    uint64_t start_ns = timing_now_ns();
+    int p1_count = by_date ? cancel_departures(p1_reservations_array, &p1_flights_root, from, to, &p1_flights,
+                                               &p1_records, &p1_capacity)
+                           : cancel_flight(p1_reservations_array, &p1_flights_root, flight_id,
+                                           &p1_records, &p1_capacity);
+    uint64_t p1_ns = timing_now_ns() - start_ns;
+    
+    start_ns = timing_now_ns();
+    int p2_count = by_date ? cancel_departures_bst(p2_reservations_bst, &p2_flights_root, from, to, &p2_flights,
+                                                   &p2_records, &p2_capacity)
+                           : cancel_flight_bst(p2_reservations_bst, &p2_flights_root, flight_id,
+                                               &p2_records, &p2_capacity);
+    uint64_t p2_ns = timing_now_ns() - start_ns;
+    
+    // The versioned store is a copy, so its reservations are ended one by one; snapshots
+    // opened before this still see them
+    for (int i = 0; reservation_versions != NULL && i < p2_count; i++) {
+        mvcc_cancel(reservation_versions, p2_records[i].flightId, p2_records[i].passengerId);
+    }
+    
+    remove_cancelled_from_dataset();
+    
+    int count = prototype == 1 ? p1_count : p2_count;
+    ReservationRecord* records = prototype == 1 ? p1_records : p2_records;
+    printf("\nCancelled %d flight(s) and %d reservation(s).\n", prototype == 1 ? p1_flights : p2_flights,
+           count > 0 ? count : 0);
+    for (int i = 0; i < count && i < CANCEL_REPORT_LIMIT; i++) {
+        Passenger* passenger = prototype == 1 ? find_passenger(p1_passengers_head, records[i].passengerId)
+                                              : hash_find_passenger(p2_passengers_table, records[i].passengerId);
+        printf("Rebook Passenger ID: %d, Name: %s, was on Flight ID: %d, Seat: %s\n", records[i].passengerId,
+               passenger != NULL ? passenger->name : "(unknown)", records[i].flightId, records[i].seatNumber);
+    }
+    if (count > CANCEL_REPORT_LIMIT) {
+        printf("... and %d more\n", count - CANCEL_REPORT_LIMIT);
+    }
+    printf("Prototype 1 (BST / array scan): %.2f us\n", p1_ns / 1000.0);
+    printf("Prototype 2 (AVL / reservation BST range): %.2f us\n", p2_ns / 1000.0);
+    
+    free(p1_records);
+    free(p2_records);
+}
+
+// Read one line of menu input without its newline. Returns 0 at end of input
+int read_menu_line(const char* prompt, char* buffer, size_t size) {
+    printf("%s", prompt);
+    if (fgets(buffer, (int)size, stdin) == NULL) return 0;
+    buffer[strcspn(buffer, "\n")] = 0;
+    return 1;
+}
+
+// Replace a generator parameter with the number typed, if any, within [minimum, maximum]
+void prompt_generator_value(const char* label, double* value, double minimum, double maximum) {
+    char prompt[MAX_LINE_LENGTH];
+    char input[MAX_LINE_LENGTH];
+    snprintf(prompt, sizeof(prompt), "%s (blank for %g): ", label, *value);
+    if (!read_menu_line(prompt, input, sizeof(input)) || input[0] == '\0') return;
+    
+    char* end;
+    double parsed = strtod(input, &end);
+    if (end == input || parsed < minimum || parsed > maximum) {
+        printf("Invalid value, keeping %g\n", *value);
+        return;
+    }
+    *value = parsed;
+}
+
+// Let the user set the generator's seed and reference time and, for the skewed generator, its
+// distribution parameters (menu option 2)
+void prompt_generator_config(GeneratorConfig* config) {
+    char prompt[MAX_LINE_LENGTH];
+    char input[MAX_LINE_LENGTH];
+    snprintf(prompt, sizeof(prompt), "Random seed (blank for %u): ", config->seed);
+    if (!read_menu_line(prompt, input, sizeof(input))) return;
+    if (input[0] != '\0') {
+        char* end;
+        unsigned long seed = strtoul(input, &end, 10);
+        if (end == input || seed > UINT_MAX) {
+            printf("Invalid seed, keeping %u\n", config->seed);
+        } else {
+            config->seed = (unsigned int)seed;
+        }
+    }
+    
+    // Departures and booking dates are offsets from the reference time, so reproducing a
+    // dataset takes the manifest's reference_time as well as its seed
+    snprintf(prompt, sizeof(prompt), "Reference time in seconds since 1970 (blank for now, %lld): ",
+             (long long)config->reference_time);
+    if (!read_menu_line(prompt, input, sizeof(input))) return;
+    if (input[0] != '\0') {
+        char* end;
+        long long reference_time = strtoll(input, &end, 10);
+        if (end == input || reference_time < 0) {
+            printf("Invalid reference time, keeping %lld\n", (long long)config->reference_time);
+        } else {
+            config->reference_time = (time_t)reference_time;
+        }
+    }
+    if (!config->skewed) return;
+    
+    double window_days = config->booking_window_days;
+    double cluster_count = config->name_cluster_count;
+    prompt_generator_value("Flight popularity Zipf exponent (0 = uniform)", &config->flight_zipf_exponent, 0, 10);
+    prompt_generator_value("Bookings per passenger Pareto alpha (0 = uniform)", &config->passenger_pareto_alpha, 0, 10);
+    prompt_generator_value("Mean days booked before departure (0 = uniform)", &config->booking_lead_mean_days, 0, 3650);
+    prompt_generator_value("Longest days booked before departure", &window_days, 1, 3650);
+    prompt_generator_value("Fraction of passengers with clustered names", &config->name_cluster_fraction, 0, 1);
+    prompt_generator_value("Number of clustered names", &cluster_count, 0, 10000);
+    config->booking_window_days = (int)window_days;
+    config->name_cluster_count = (int)cluster_count;
+}
+
+// Estimate distinct passengers over an origin, route and/or range of dates from the per-flight
+// sketches, and check it against an exact count over the reservations (menu option 17)
+void distinct_passengers_menu() {
+    char origin[MAX_LINE_LENGTH];
+    char destination[MAX_LINE_LENGTH];
+    char date[MAX_LINE_LENGTH];
+    char days_text[MAX_LINE_LENGTH];
+    if (!read_menu_line("Origin (blank for any): ", origin, sizeof(origin)) ||
+        !read_menu_line("Destination (blank for any): ", destination, sizeof(destination)) ||
+        !read_menu_line("First departure date YYYY-MM-DD (blank for all dates): ", date, sizeof(date))) {
+        return;
+    }
+    
+    // A date starts at local midnight and the window covers whole days
+    time_t from = 0;
+    time_t to = (time_t)INT64_MAX;
+    int year, month, day;
+    if (sscanf(date, "%d-%d-%d", &year, &month, &day) == 3) {
+        if (!read_menu_line("Number of days (blank for 1): ", days_text, sizeof(days_text))) return;
+        int days = atoi(days_text) > 0 ? atoi(days_text) : 1;
+        struct tm start = {0};
+        start.tm_year = year - 1900;
+        start.tm_mon = month - 1;
+        start.tm_mday = day;
+        start.tm_isdst = -1;
+        struct tm end = start;
+        end.tm_mday += days;
+        from = mktime(&start);
+        to = mktime(&end);
+    }
+    if (passenger_sketches == NULL) {
+        printf("\nPassenger sketches are not available.\n");
+        return;
+    }
+    
+    uint64_t start_ns = timing_now_ns();
+    double estimate = sketch_distinct_passengers(passenger_sketches, origin, destination, from, to);
+    uint64_t sketch_ns = timing_now_ns() - start_ns;
+    
+    // The exact count marks every passenger seen in a tracking array
+    start_ns = timing_now_ns();
+    int max_passenger_id = 0;
+    for (int i = 0; i < reservation_count; i++) {
+        if (reservations[i].passengerId > max_passenger_id) max_passenger_id = reservations[i].passengerId;
+    }
+    char* seen = (char*)calloc(max_passenger_id + 1, 1);
+    int exact = 0;
+    for (int i = 0; seen != NULL && i < reservation_count; i++) {
+        Flight* flight = avl_find_flight(p2_flights_root, reservations[i].flightId);
+        if (flight == NULL || flight->departureTime < from || flight->departureTime >= to ||
+            (origin[0] != '\0' && strcmp(flight->origin, origin) != 0) ||
+            (destination[0] != '\0' && strcmp(flight->destination, destination) != 0) ||
+            reservations[i].passengerId < 0 || seen[reservations[i].passengerId]) {
+            continue;
+        }
+        seen[reservations[i].passengerId] = 1;
+        exact++;
+    }
+    free(seen);
+    uint64_t exact_ns = timing_now_ns() - start_ns;
+    
+    printf("\nEstimated distinct passengers: %.0f (%.2f us from the sketches)\n", estimate, sketch_ns / 1000.0);
+    printf("Exact distinct passengers:     %d (%.2f us over %d reservations)\n", exact, exact_ns / 1000.0,
+           reservation_count);
+    if (exact > 0) {
+        printf("Error: %.2f%%\n", (estimate - exact) * 100.0 / exact);
+    }
+}
+
+// Order flights by load factor, fullest first, for the full-scan comparison in menu option 18
+int compare_flight_loads(const void* a, const void* b) {
+    double left = load_factor((const FlightLoad*)a);
+    double right = load_factor((const FlightLoad*)b);
+    return (left < right) - (left > right);
+}
+
+// Print one line of a fullest/emptiest flight list
+void print_flight_load(const FlightLoad* load) {
+    char date[20];
+    strftime(date, sizeof(date), "%Y-%m-%d %H:%M", localtime(&load->departureTime));
+    printf("  Flight ID: %6d  Departs: %s  Booked: %4d / %-4d  Load: %6.1f%%\n", load->flightId, date,
+           load->booked, load->capacity, load_factor(load) * 100.0);
+}
+
+// List the fullest and emptiest flights, optionally over a range of departure dates, from the
+// load index, and time a full count-and-sort of every flight for comparison (menu option 18)
+void flight_load_menu() {
+    char count_text[MAX_LINE_LENGTH];
+    char date[MAX_LINE_LENGTH];
+    char days_text[MAX_LINE_LENGTH];
+    if (!read_menu_line("How many flights (blank for 20): ", count_text, sizeof(count_text)) ||
+        !read_menu_line("First departure date YYYY-MM-DD (blank for all dates): ", date, sizeof(date))) {
+        return;
+    }
+    int k = atoi(count_text) > 0 ? atoi(count_text) : 20;
+    
+    // A date starts at local midnight and the window covers whole days
+    time_t from = 0;
+    time_t to = 0;
+    int year, month, day;
+    if (sscanf(date, "%d-%d-%d", &year, &month, &day) == 3) {
+        if (!read_menu_line("Number of days (blank for 1): ", days_text, sizeof(days_text))) return;
+        int days = atoi(days_text) > 0 ? atoi(days_text) : 1;
+        struct tm start = {0};
+        start.tm_year = year - 1900;
+        start.tm_mon = month - 1;
+        start.tm_mday = day;
+        start.tm_isdst = -1;
+        struct tm end = start;
+        end.tm_mday += days;
+        from = mktime(&start);
+        to = mktime(&end);
+    }
+    FlightLoadIndex* index = p2_reservations_bst != NULL ? p2_reservations_bst->load_index : NULL;
+    FlightLoad* fullest = (FlightLoad*)malloc(k * sizeof(FlightLoad));
+    FlightLoad* emptiest = (FlightLoad*)malloc(k * sizeof(FlightLoad));
+    if (index == NULL || fullest == NULL || emptiest == NULL) {
+        printf("\nThe flight load index is not available.\n");
+        free(fullest);
+        free(emptiest);
+        return;
+    }
+    
+    uint64_t start_ns = timing_now_ns();
+    int full_count = load_index_fullest(index, k, from, to, fullest);
+    int empty_count = load_index_emptiest(index, k, from, to, emptiest);
+    uint64_t index_ns = timing_now_ns() - start_ns;
+    
+    printf("\nFullest flights:\n");
+    for (int i = 0; i < full_count; i++) {
+        print_flight_load(&fullest[i]);
+    }
+    printf("\nEmptiest flights:\n");
+    for (int i = 0; i < empty_count; i++) {
+        print_flight_load(&emptiest[i]);
+    }
+    
+    // The full scan counts the reservations of every flight in the window, then sorts them all.
+    // Like the index it counts seats booked, not distinct passengers
+    start_ns = timing_now_ns();
+    int scanned = 0;
+    ReservationRecord* records = NULL;
+    int records_capacity = 0;
+    FlightLoad* all = (FlightLoad*)malloc((flight_count + 1) * sizeof(FlightLoad));
+    for (int i = 0; all != NULL && i < flight_count; i++) {
+        if ((from != 0 || to != 0) && (flights[i].departureTime < from || flights[i].departureTime >= to)) continue;
+        int booked = find_reservations_by_flight_bst(p2_reservations_bst, flights[i].id, &records, &records_capacity);
+        all[scanned].flightId = flights[i].id;
+        all[scanned].booked = booked > 0 ? booked : 0;
+        all[scanned].capacity = flights[i].capacity;
+        all[scanned].departureTime = flights[i].departureTime;
+        scanned++;
+    }
+    if (all != NULL) qsort(all, scanned, sizeof(FlightLoad), compare_flight_loads);
+    uint64_t scan_ns = timing_now_ns() - start_ns;
+    free(records);
+    free(all);
+    
+    printf("\nLoad index: %.2f us for both lists\n", index_ns / 1000.0);
+    printf("Counting and sorting %d flights: %.2f us\n", scanned, scan_ns / 1000.0);
+    free(fullest);
+    free(emptiest);
+}
+
+// Most matches name_fragment_menu lists
+#define NAME_FRAGMENT_LISTED 20
+
+// List every passenger whose name contains a fragment, found by scanning the name heap, with
+// the active prototype's record for each (menu option 19)
+void name_fragment_menu(int prototype) {
+    char fragment[MAX_LINE_LENGTH];
+    if (!read_menu_line("Name fragment: ", fragment, sizeof(fragment))) {
+        return;
+    }
+    if (passenger_names == NULL) {
+        printf("\nThe passenger name heap is not available.\n");
+        return;
+    }
+    
+    int* ids = NULL;
+    int capacity = 0;
+    uint64_t start_ns = timing_now_ns();
+    int count = name_heap_find(passenger_names, fragment, 0, &ids, &capacity);
+    uint64_t scan_ns = timing_now_ns() - start_ns;
+    
+    printf("\n");
+    for (int i = 0; i < count && i < NAME_FRAGMENT_LISTED; i++) {
+        Passenger* passenger = prototype == 1 ? find_passenger(p1_passengers_head, ids[i])
+                                              : hash_find_passenger(p2_passengers_table, ids[i]);
+        if (passenger != NULL) {
+            printf("Passenger ID: %d, Name: %s, Passport: %s\n", passenger->id, passenger->name,
+                   passenger->passportNumber);
+        }
+    }
+    if (count > NAME_FRAGMENT_LISTED) {
+        printf("... and %d more\n", count - NAME_FRAGMENT_LISTED);
+    }
+    printf("\n%d passengers match \"%s\" (%.2f us to scan %zu bytes of names)\n", count < 0 ? 0 : count,
+           fragment, scan_ns / 1000.0, passenger_names->length);
+    free(ids);
+}
+
+// Reader slot the menu's snapshot reports use
+#define MENU_SNAPSHOT_READER 0
+
+// Per-flight reservation counts gathered by a snapshot scan
+typedef struct {
+    int* counts;
+    int min_id;
+    int max_id;
+} CapacityTally;
+
+// Count one reservation seen by the snapshot scan
+void tally_reservation(const ReservationRecord* record, void* context) {
+    CapacityTally* tally = (CapacityTally*)context;
+    if (record->flightId >= tally->min_id && record->flightId <= tally->max_id) {
+        tally->counts[record->flightId - tally->min_id]++;
+    }
+}
+
+// Report seats booked against capacity for every flight, reading the reservations from one
+// snapshot of the versioned store so bookings and cancellations committed during the scan
+// are not half counted (menu option 20)
+void capacity_report_menu() {
+    if (reservation_versions == NULL || flight_count == 0) {
+        printf("\nThe versioned reservation store is not available.\n");
+        return;
+    }
+    
+    CapacityTally tally = {NULL, flights[0].id, flights[0].id};
+    for (int i = 1; i < flight_count; i++) {
+        if (flights[i].id < tally.min_id) tally.min_id = flights[i].id;
+        if (flights[i].id > tally.max_id) tally.max_id = flights[i].id;
+    }
+    tally.counts = (int*)calloc((size_t)(tally.max_id - tally.min_id) + 1, sizeof(int));
+    if (tally.counts == NULL) {
+        fprintf(stderr, "Memory allocation failed for the capacity report\n");
+        return;
+    }
+    
+    uint64_t start_ns = timing_now_ns();
+    unsigned long snapshot = mvcc_snapshot_begin(reservation_versions, MENU_SNAPSHOT_READER);
+    int scanned = mvcc_scan(reservation_versions, snapshot, tally_reservation, &tally);
+    mvcc_snapshot_end(reservation_versions, MENU_SNAPSHOT_READER);
+    uint64_t scan_ns = timing_now_ns() - start_ns;
+    
+    long long booked = 0;
+    long long seats = 0;
+    int full = 0;
+    int over = 0;
+    int empty = 0;
+    for (int i = 0; i < flight_count; i++) {
+        int count = tally.counts[flights[i].id - tally.min_id];
+        booked += count;
+        seats += flights[i].capacity;
+        if (count > flights[i].capacity) {
+            over++;
+        } else if (count == flights[i].capacity) {
+            full++;
+        } else if (count == 0) {
+            empty++;
+        }
+    }
+    free(tally.counts);
+    
+    printf("\nFleet capacity at snapshot %lu:\n", snapshot);
+    printf("Flights: %d (%d full, %d over capacity, %d empty)\n", flight_count, full, over, empty);
+    printf("Seats booked: %lld of %lld (%.1f%%)\n", booked, seats, seats > 0 ? booked * 100.0 / seats : 0.0);
+    printf("Read %d reservations from the snapshot in %.2f us\n", scanned < 0 ? 0 : scanned, scan_ns / 1000.0);
+}
+
+// Start measuring a menu operation (only with --profile)
+void profile_begin() {
+    if (!profile_enabled) return;
+    fflush(stdout);
+    profile_start_ns = timing_now_ns();
+    perf_counters_begin(&profile_counters);
+}
+
+// Report time and hardware counters for a menu operation (only with --profile)
+void profile_end(const char* operation) {
+    if (!profile_enabled) return;
+    PerfSample sample;
+    perf_counters_end(&profile_counters, &sample);
+    uint64_t elapsed = timing_now_ns() - profile_start_ns;
+    
+    printf("\n[profile] %s: %.2f us\n", operation, elapsed / 1000.0);
+    perf_print_sample("[profile] ", &sample, 1.0);
+}
+
 // Helper function to free all data structures and loaded data
 void cleanup_resources() {
     if (flights) free(flights);
@@ -423,16 +1000,574 @@ void cleanup_resources() {
     if (p2_flights_root) free_avl_tree(p2_flights_root);
     if (p2_passengers_table) free_hash_table(p2_passengers_table);
     if (p2_reservations_bst) free_reservation_bst(p2_reservations_bst);
+    sketch_index_free(passenger_sketches);
+    name_heap_free(passenger_names);
+    mvcc_free(reservation_versions);
+}
+
+// Load the dataset used by the command-line tools, from a snapshot if given, otherwise from CSV files
+int load_tool_dataset(const char* data_dir, const char* snapshot_path) {
+    if (snapshot_path != NULL) {
+        return load_data_from_snapshot(snapshot_path, &flights, &flight_count, &passengers, &passenger_count,
+                                       &reservations, &reservation_count);
+    }
+    
+    char path[MAX_LINE_LENGTH + 32];
+    snprintf(path, sizeof(path), "%s/flights.csv", data_dir);
+    flights = load_flights(path, &flight_count);
+    snprintf(path, sizeof(path), "%s/passengers.csv", data_dir);
+    passengers = load_passengers(path, &passenger_count);
+    snprintf(path, sizeof(path), "%s/reservations.csv", data_dir);
+    reservations = load_reservations(path, &reservation_count);
+    
+    return flights != NULL && passengers != NULL && reservations != NULL;
+}
+
+// Parse "a,b,c,d,e,f" into the trace operation mix. Returns 1 on success
+int parse_trace_mix(const char* text, double mix[TRACE_OP_COUNT]) {
+    double values[TRACE_OP_COUNT];
+    int consumed = 0;
+    for (int i = 0; i < TRACE_OP_COUNT; i++) {
+        int length;
+        if (sscanf(text + consumed, i == 0 ? "%lf%n" : ",%lf%n", &values[i], &length) != 1) {
+            return 0;
+        }
+        consumed += length;
+    }
+    memcpy(mix, values, sizeof(values));
+    return 1;
+}
+
+// Replay a trace on a fresh engine at 1, 2, 4, ... threads and print throughput and speedup.
+// Returns the exit code
+int run_thread_sweep(int prototype, const Trace* trace, int max_threads) {
+    double base = 0.0;
+    for (int threads = 1; ; threads = threads * 2 < max_threads ? threads * 2 : max_threads) {
+        bench_quiet_stdout(1);
+        QueryEngine* engine = create_engine(prototype, flights, flight_count, passengers, passenger_count,
+                                            reservations, reservation_count);
+        bench_quiet_stdout(0);
+        ReplayStats stats;
+        if (engine == NULL || !replay_trace_parallel(engine, trace, threads, &stats)) {
+            fprintf(stderr, "Replay failed with %d threads\n", threads);
+            destroy_engine(engine);
+            return 1;
+        }
+        
+        int hits = 0;
+        for (int t = 0; t < TRACE_OP_COUNT; t++) hits += stats.hits[t];
+        if (threads == 1) {
+            base = stats.throughput;
+            printf("\n%s - closed-loop thread sweep (%d operations)\n", engine->name, trace->count);
+            printf("%8s %14s %9s %9s\n", "Threads", "ops/sec", "Speedup", "Hits");
+        }
+        printf("%8d %14.0f %8.2fx %9d\n", threads, stats.throughput, base > 0 ? stats.throughput / base : 0.0, hits);
+        destroy_engine(engine);
+        if (threads == max_threads) break;
+    }
+    return 0;
+}
+
+// Handle --gen-trace and --replay. Returns -1 if neither was requested, otherwise the exit code
+int run_trace_tools(int argc, char* argv[]) {
+    const char* gen_path = NULL;
+    const char* replay_path = NULL;
+    const char* data_dir = "data";
+    const char* snapshot_path = NULL;
+    TraceConfig config = default_trace_config();
+    ReplayMode mode = REPLAY_CLOSED_LOOP;
+    double speed = 1.0;
+    int prototype = 0;  // 0 = replay against both prototypes
+    int threads = 1;
+    int sweep = 0;  // Replay at 1, 2, 4, ... up to `threads` threads
+    
+    for (int i = 1; i < argc; i++) {
+        int has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--gen-trace") == 0 && has_value) {
+            gen_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && has_value) {
+            replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--data-dir") == 0 && has_value) {
+            data_dir = argv[++i];
+        } else if (strcmp(argv[i], "--snapshot") == 0 && has_value) {
+            snapshot_path = argv[++i];
+        } else if (strcmp(argv[i], "--ops") == 0 && has_value) {
+            config.op_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--mix") == 0 && has_value) {
+            if (!parse_trace_mix(argv[++i], config.mix)) {
+                fprintf(stderr, "--mix expects %d comma-separated weights "
+                        "(flight id, flight number, passenger, bookings, book, cancel)\n", TRACE_OP_COUNT);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--skew") == 0 && has_value) {
+            config.key_skew = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--rate") == 0 && has_value) {
+            config.rate = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+            config.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--engine") == 0 && has_value) {
+            prototype = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bloom") == 0 && has_value) {
+            engine_set_bloom_fp_rate(atof(argv[++i]));
+        } else if (strcmp(argv[i], "--speed") == 0 && has_value) {
+            speed = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--open-loop") == 0) {
+            mode = REPLAY_OPEN_LOOP;
+        } else if (strcmp(argv[i], "--threads") == 0 && has_value) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sweep") == 0) {
+            sweep = 1;
+        }
+    }
+    
+    if (gen_path == NULL && replay_path == NULL) {
+        return -1;
+    }
+    if (threads > 1 && (prototype < 3 || mode == REPLAY_OPEN_LOOP)) {
+        fprintf(stderr, "--threads needs --engine 3 or 4 (the thread-safe engines) and a closed-loop replay\n");
+        return 1;
+    }
+    
+    if (!load_tool_dataset(data_dir, snapshot_path)) {
+        fprintf(stderr, "Could not load the dataset (use --data-dir <dir> or --snapshot <file>)\n");
+        cleanup_resources();
+        return 1;
+    }
+    
+    Trace* trace = NULL;
+    if (gen_path != NULL) {
+        trace = generate_trace(&config, flights, flight_count, passengers, passenger_count,
+                               reservations, reservation_count);
+        if (trace == NULL || !save_trace(trace, gen_path)) {
+            fprintf(stderr, "Could not generate trace %s\n", gen_path);
+            free_trace(trace);
+            cleanup_resources();
+            return 1;
+        }
+        printf("Generated %d operations (skew %.2f, %.0f ops/sec) to %s\n",
+               trace->count, config.key_skew, config.rate, gen_path);
+    }
+    
+    int status = 0;
+    if (replay_path != NULL) {
+        if (trace == NULL || strcmp(replay_path, gen_path) != 0) {
+            free_trace(trace);
+            trace = load_trace(replay_path);
+        }
+        if (trace == NULL) {
+            cleanup_resources();
+            return 1;
+        }
+        
+        if (threads > 1 && sweep) {
+            status = run_thread_sweep(prototype, trace, threads);
+            free_trace(trace);
+            cleanup_resources();
+            return status;
+        }
+        
+        // Engines 3 and 4 are only replayed when asked for explicitly
+        for (int p = 1; p <= 4; p++) {
+            if (prototype == 0 ? p >= 3 : prototype != p) continue;
+            
+            // Each replay gets fresh structures, since bookings and cancellations modify them
+            QueryEngine* engine = create_engine(p, flights, flight_count, passengers, passenger_count,
+                                                reservations, reservation_count);
+            ReplayStats stats;
+            int replayed = engine != NULL && (threads > 1 ? replay_trace_parallel(engine, trace, threads, &stats)
+                                                          : replay_trace(engine, trace, mode, speed, &stats));
+            if (!replayed) {
+                fprintf(stderr, "Replay failed for prototype %d\n", p);
+                status = 1;
+            } else {
+                print_replay_stats(engine, &stats, mode);
+                if (threads > 1) printf("Threads: %d\n", threads);
+            }
+            destroy_engine(engine);
+        }
+    }
+    
+    free_trace(trace);
+    cleanup_resources();
+    return status;
+}
+
+// Print live/peak bytes of every structure, with bytes per stored record (menu option 14)
+void print_memory_report() {
+    long long records[MEM_TAG_COUNT];
+    records[MEM_FLIGHT_BST] = flight_count;
+    records[MEM_PASSENGER_LIST] = passenger_count;
+    records[MEM_RESERVATION_ARRAY] = reservation_count;
+    records[MEM_FLIGHT_AVL] = flight_count;
+    records[MEM_PASSENGER_HASH] = passenger_count;
+    records[MEM_PASSENGER_HASH_CHAINS] = passenger_count;
+    records[MEM_RESERVATION_BST] = reservation_count;
+    records[MEM_RESERVATION_MVCC] = reservation_count;
+    records[MEM_BLOOM_FILTER] = 0;  // The menu keeps no Bloom filters
+    records[MEM_PASSENGER_SKETCHES] = flight_count;
+    records[MEM_FLIGHT_LOAD_INDEX] = flight_count;
+    records[MEM_PASSENGER_LIST_TOWERS] = passenger_count;
+    records[MEM_PASSENGER_UNROLLED] = 0;  // The menu keeps no unrolled list
+    records[MEM_NAME_HEAP] = passenger_count;
+    
+    printf("\n===== Memory Usage by Structure =====\n");
+    mem_stats_print(stdout, records);
+}
+
+// Walk every structure and print its shape, optionally exporting Prometheus metrics (menu option 15)
+int print_structure_health_report(const char* prometheus_path) {
+    StructureHealth health;
+    if (!collect_structure_health(&health, p1_flights_root, p1_passengers_head, p1_reservations_array,
+                                  p2_flights_root, p2_passengers_table, p2_reservations_bst)) {
+        return 0;
+    }
+    
+    printf("\n===== Structure Health =====\n");
+    print_structure_health(stdout, &health);
+    
+    if (prometheus_path != NULL) {
+        if (!write_structure_health_prometheus(prometheus_path, &health)) return 0;
+        printf("Prometheus metrics written to %s\n", prometheus_path);
+    }
+    return 1;
+}
+
+// Handle --memory-stats and --health. Returns -1 if neither was requested, otherwise the exit code.
+// Both build their own copy of the structures from the dataset or snapshot, so they never touch
+// a running session
+int run_stats_tools(int argc, char* argv[]) {
+    const char* data_dir = "data";
+    const char* snapshot_path = NULL;
+    const char* prometheus_path = NULL;
+    int memory_stats = 0;
+    int health = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        int has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--memory-stats") == 0) {
+            memory_stats = 1;
+        } else if (strcmp(argv[i], "--health") == 0) {
+            health = 1;
+        } else if (strcmp(argv[i], "--prom-out") == 0 && has_value) {
+            prometheus_path = argv[++i];
+        } else if (strcmp(argv[i], "--data-dir") == 0 && has_value) {
+            data_dir = argv[++i];
+        } else if (strcmp(argv[i], "--snapshot") == 0 && has_value) {
+            snapshot_path = argv[++i];
+        }
+    }
+    
+    if (!memory_stats && !health) {
+        return -1;
+    }
+    
+    if (!load_tool_dataset(data_dir, snapshot_path)) {
+        fprintf(stderr, "Could not load the dataset (use --data-dir <dir> or --snapshot <file>)\n");
+        cleanup_resources();
+        return 1;
+    }
+    
+    build_data_structures();
+    int status = 0;
+    if (memory_stats) {
+        print_memory_report();
+    }
+    if (health && !print_structure_health_report(prometheus_path)) {
+        status = 1;
+    }
+    cleanup_resources();
+    return status;
+}
+
+// Handle --batch. Returns -1 if it was not requested, otherwise the exit code
+int run_batch_tool(int argc, char* argv[]) {
+    const char* batch_path = NULL;
+    const char* output_path = NULL;
+    const char* data_dir = "data";
+    const char* snapshot_path = NULL;
+    int prototype = 2;
+    
+    for (int i = 1; i < argc; i++) {
+        int has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--batch") == 0 && has_value) {
+            batch_path = argv[++i];
+        } else if (strcmp(argv[i], "--out") == 0 && has_value) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "--data-dir") == 0 && has_value) {
+            data_dir = argv[++i];
+        } else if (strcmp(argv[i], "--snapshot") == 0 && has_value) {
+            snapshot_path = argv[++i];
+        } else if (strcmp(argv[i], "--engine") == 0 && has_value) {
+            prototype = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bloom") == 0 && has_value) {
+            engine_set_bloom_fp_rate(atof(argv[++i]));
+        }
+    }
+    
+    if (batch_path == NULL) {
+        return -1;
+    }
+    
+    // "-" reads queries from stdin; results go to stdout unless --out is given
+    FILE* input = strcmp(batch_path, "-") == 0 ? stdin : fopen(batch_path, "r");
+    if (input == NULL) {
+        fprintf(stderr, "Could not open batch file %s\n", batch_path);
+        return 1;
+    }
+    FILE* output = output_path != NULL ? fopen(output_path, "w") : stdout;
+    if (output == NULL) {
+        fprintf(stderr, "Could not open %s for writing\n", output_path);
+        if (input != stdin) fclose(input);
+        return 1;
+    }
+    
+    int status = 1;
+    if (!load_tool_dataset(data_dir, snapshot_path)) {
+        fprintf(stderr, "Could not load the dataset (use --data-dir <dir> or --snapshot <file>)\n");
+    } else {
+        // Building the structures prints progress messages, which must not mix with results on stdout
+        bench_quiet_stdout(output == stdout);
+        QueryEngine* engine = create_engine(prototype, flights, flight_count, passengers, passenger_count,
+                                            reservations, reservation_count);
+        bench_quiet_stdout(0);
+        BatchStats stats;
+        if (engine != NULL && run_batch(engine, input, output, &stats)) {
+            // Statistics go to stderr so stdout carries only results
+            print_batch_stats(stderr, engine, &stats);
+            status = 0;
+        }
+        destroy_engine(engine);
+    }
+    
+    if (input != stdin) fclose(input);
+    if (output != stdout) fclose(output);
+    cleanup_resources();
+    return status;
+}
+
+// Handle --group-by. Returns -1 if it was not requested, otherwise the exit code
+int run_aggregate_tool(int argc, char* argv[]) {
+    const char* keys = NULL;
+    const char* value = "lead_days";
+    const char* output_path = NULL;
+    const char* data_dir = "data";
+    const char* snapshot_path = NULL;
+    AggregateQuery query;
+    memset(&query, 0, sizeof(query));
+    
+    for (int i = 1; i < argc; i++) {
+        int has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--group-by") == 0 && has_value) {
+            keys = argv[++i];
+        } else if (strcmp(argv[i], "--value") == 0 && has_value) {
+            value = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && has_value) {
+            query.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--out") == 0 && has_value) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "--data-dir") == 0 && has_value) {
+            data_dir = argv[++i];
+        } else if (strcmp(argv[i], "--snapshot") == 0 && has_value) {
+            snapshot_path = argv[++i];
+        }
+    }
+    
+    if (keys == NULL) {
+        return -1;
+    }
+    if (!aggregate_parse_keys(keys, &query) || !aggregate_parse_value(value, &query.value)) {
+        return 1;
+    }
+    FILE* output = output_path != NULL ? fopen(output_path, "w") : stdout;
+    if (output == NULL) {
+        fprintf(stderr, "Could not open %s for writing\n", output_path);
+        return 1;
+    }
+    
+    int status = 1;
+    if (!load_tool_dataset(data_dir, snapshot_path)) {
+        fprintf(stderr, "Could not load the dataset (use --data-dir <dir> or --snapshot <file>)\n");
+    } else {
+        // The aggregation reads the loaded arrays directly, no structures are built
+        AggregateResult* result = aggregate_reservations(&query, flights, flight_count,
+                                                         reservations, reservation_count);
+        if (result != NULL && aggregate_write_csv(output, result) >= 0) {
+            // Statistics go to stderr so stdout carries only results
+            fprintf(stderr, "Aggregated %lld reservations (%lld skipped) into %d groups in %.3f s "
+                    "on %d threads (%.1f M rows/s)\n", result->rows, result->skipped, result->group_count,
+                    result->seconds, result->threads,
+                    result->seconds > 0.0 ? (result->rows + result->skipped) / result->seconds / 1e6 : 0.0);
+            status = 0;
+        }
+        aggregate_free(result);
+    }
+    
+    if (output != stdout) fclose(output);
+    cleanup_resources();
+    return status;
+}
+
+// Server started by --serve, stopped from the signal handler
+QueryServer* active_server = NULL;
+
+// SIGINT/SIGTERM handler for --serve
+void stop_server_on_signal(int signal_number) {
+    (void)signal_number;
+    if (active_server != NULL) server_stop(active_server);
+}
+
+// Handle --serve and --loadgen. Returns -1 if neither was requested, otherwise the exit code
+int run_server_tools(int argc, char* argv[]) {
+    const char* serve_address = NULL;
+    const char* load_address = NULL;
+    const char* data_dir = "data";
+    const char* snapshot_path = NULL;
+    TraceConfig config = default_trace_config();
+    int prototype = 2;
+    int connections = 4;
+    int pipeline = 16;
+    
+    for (int i = 1; i < argc; i++) {
+        int has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--serve") == 0 && has_value) {
+            serve_address = argv[++i];
+        } else if (strcmp(argv[i], "--loadgen") == 0 && has_value) {
+            load_address = argv[++i];
+        } else if (strcmp(argv[i], "--data-dir") == 0 && has_value) {
+            data_dir = argv[++i];
+        } else if (strcmp(argv[i], "--snapshot") == 0 && has_value) {
+            snapshot_path = argv[++i];
+        } else if (strcmp(argv[i], "--engine") == 0 && has_value) {
+            prototype = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bloom") == 0 && has_value) {
+            engine_set_bloom_fp_rate(atof(argv[++i]));
+        } else if (strcmp(argv[i], "--clients") == 0 && has_value) {
+            connections = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pipeline") == 0 && has_value) {
+            pipeline = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ops") == 0 && has_value) {
+            config.op_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--mix") == 0 && has_value) {
+            if (!parse_trace_mix(argv[++i], config.mix)) {
+                fprintf(stderr, "--mix expects %d comma-separated weights "
+                        "(flight id, flight number, passenger, bookings, book, cancel)\n", TRACE_OP_COUNT);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--skew") == 0 && has_value) {
+            config.key_skew = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+            config.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        }
+    }
+    
+    if (serve_address == NULL && load_address == NULL) {
+        return -1;
+    }
+    
+    // The load generator needs the dataset too, to pick keys that exist on the server
+    if (!load_tool_dataset(data_dir, snapshot_path)) {
+        fprintf(stderr, "Could not load the dataset (use --data-dir <dir> or --snapshot <file>)\n");
+        cleanup_resources();
+        return 1;
+    }
+    
+    int status = 1;
+    if (serve_address != NULL) {
+        bench_quiet_stdout(1);
+        QueryEngine* engine = create_engine(prototype, flights, flight_count, passengers, passenger_count,
+                                            reservations, reservation_count);
+        bench_quiet_stdout(0);
+        active_server = engine != NULL ? server_open(serve_address) : NULL;
+        if (active_server != NULL) {
+            signal(SIGINT, stop_server_on_signal);
+            signal(SIGTERM, stop_server_on_signal);
+            printf("Serving %s on %s (Ctrl+C to stop)\n", engine->name, serve_address);
+            fflush(stdout);
+            
+            if (server_run(active_server, engine)) status = 0;
+            ServerStats stats = server_stats(active_server);
+            printf("Served %lld requests on %lld connections (%lld errors, %lld bytes in, %lld bytes out)\n",
+                   stats.requests, stats.connections, stats.errors, stats.bytes_in, stats.bytes_out);
+            server_close(active_server);
+            active_server = NULL;
+        }
+        destroy_engine(engine);
+    } else {
+        Trace* trace = generate_trace(&config, flights, flight_count, passengers, passenger_count,
+                                      reservations, reservation_count);
+        LoadStats stats;
+        if (trace != NULL) {
+            if (run_load_generator(load_address, trace, connections, pipeline, &stats)) status = 0;
+            print_load_stats(stdout, &stats, connections, pipeline);
+            histogram_free(stats.latency);
+        }
+        free_trace(trace);
+    }
+    
+    cleanup_resources();
+    return status;
+}
+
+// Replay a generated closed-loop trace against both prototypes (part of menu option 11)
+void run_trace_comparison() {
+    TraceConfig config = default_trace_config();
+    if (config.op_count > reservation_count * 2) {
+        config.op_count = reservation_count * 2 > 1000 ? reservation_count * 2 : 1000;
+    }
+    
+    Trace* trace = generate_trace(&config, flights, flight_count, passengers, passenger_count,
+                                  reservations, reservation_count);
+    if (trace == NULL) return;
+    
+    printf("\n===== Trace Replay: %d mixed operations (Zipf skew %.2f) =====\n", trace->count, config.key_skew);
+    for (int p = 1; p <= 2; p++) {
+        QueryEngine* engine = create_engine(p, flights, flight_count, passengers, passenger_count,
+                                            reservations, reservation_count);
+        ReplayStats stats;
+        if (engine != NULL && replay_trace(engine, trace, REPLAY_CLOSED_LOOP, 1.0, &stats)) {
+            print_replay_stats(engine, &stats, REPLAY_CLOSED_LOOP);
+        }
+        destroy_engine(engine);
+    }
+    free_trace(trace);
 }
 
 // Main function
 int main(int argc, char* argv[]) {
+    // Command-line trace tools run without the interactive menu
+    int tool_status = run_trace_tools(argc, argv);
+    if (tool_status >= 0) {
+        return tool_status;
+    }
+    tool_status = run_stats_tools(argc, argv);
+    if (tool_status >= 0) {
+        return tool_status;
+    }
+    tool_status = run_batch_tool(argc, argv);
+    if (tool_status >= 0) {
+        return tool_status;
+    }
+    tool_status = run_aggregate_tool(argc, argv);
+    if (tool_status >= 0) {
+        return tool_status;
+    }
+    tool_status = run_server_tools(argc, argv);
+    if (tool_status >= 0) {
+        return tool_status;
+    }
+    
     // Parse command line arguments
     int skip_tests = 0;
     
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--skip-tests") == 0) {
             skip_tests = 1;
+        } else if (strcmp(argv[i], "--record-trace") == 0 && i + 1 < argc) {
+            session_recorder = trace_recorder_open(argv[++i]);
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            // Falls back to wall time alone when no counters can be opened
+            perf_counters_open(&profile_counters);
+            profile_enabled = 1;
         }
     }
     
@@ -538,22 +1673,73 @@ int main(int argc, char* argv[]) {
                     default: printf("Invalid choice, using default (small)\n"); dataset_size = 100;
                 }
                 
+                printf("\nSelect distribution:\n");
+                printf("1. Uniform (random flights, passengers and booking dates)\n");
+                printf("2. Skewed (Zipf flight popularity, frequent flyers, booking curve, name clusters)\n");
+                printf("Enter choice (1-2): ");
+                
+                int distribution_choice;
+                scanf("%d", &distribution_choice);
+                int c_flush;
+                while ((c_flush = getchar()) != '\n' && c_flush != EOF) {}
+                
+                GeneratorConfig generator_config = distribution_choice == 2 ?
+                    skewed_generator_config() : uniform_generator_config();
+                prompt_generator_config(&generator_config);
+                
                 // Free any existing data
                 if (flights) free(flights);
                 if (passengers) free(passengers);
                 if (reservations) free(reservations);
                 
                 // Generate the data
-                printf("\nGenerating %d flights, %d passengers, and approximately %d reservations...\n", 
-                    dataset_size, dataset_size * 5, dataset_size * 10);
+                printf("\nGenerating %d flights, %d passengers, and approximately %d reservations (%s)...\n", 
+                    dataset_size, dataset_size * 5, dataset_size * 10,
+                    generator_config.skewed ? "skewed" : "uniform");
                 
-                flights = generate_flights(dataset_size);
-                passengers = generate_passengers(dataset_size * 5);
-                reservations = generate_reservations(dataset_size * 10, dataset_size, dataset_size * 5);
+                // The tests and trace tools reseed rand() too, so seed it here for the manifest to hold
+                srand(generator_config.seed);
+                reservation_count = dataset_size * 10;
+                if (generator_config.skewed) {
+                    flights = generate_flights(dataset_size, generator_config.reference_time);
+                    passengers = generate_passengers_clustered(dataset_size * 5, &generator_config);
+                    reservations = generate_reservations_skewed(dataset_size * 10, flights, dataset_size,
+                                                                dataset_size * 5, &generator_config,
+                                                                &reservation_count);
+                } else {
+                    flights = generate_flights(dataset_size, generator_config.reference_time);
+                    passengers = generate_passengers(dataset_size * 5);
+                    reservations = generate_reservations(dataset_size * 10, dataset_size, dataset_size * 5,
+                                                         generator_config.reference_time);
+                }
                 
                 flight_count = dataset_size;
                 passenger_count = dataset_size * 5;
-                reservation_count = dataset_size * 10;
+                
+                // Optionally save the dataset with a manifest of its parameters
+                printf("Enter an existing directory to save the dataset and manifest (blank to skip): ");
+                char output_dir[MAX_LINE_LENGTH];
+                if (fgets(output_dir, sizeof(output_dir), stdin) != NULL) {
+                    output_dir[strcspn(output_dir, "\n")] = 0;
+                    if (output_dir[0] != '\0') {
+                        save_data_to_csv(flights, flight_count, passengers, passenger_count,
+                                         reservations, reservation_count, output_dir);
+                        save_generator_manifest(&generator_config, flight_count, passenger_count,
+                                                reservation_count, output_dir);
+                        
+                        // The snapshot carries the passenger sketches too, so they need not be rebuilt
+                        char snapshot_path[MAX_LINE_LENGTH + 16];
+                        snprintf(snapshot_path, sizeof(snapshot_path), "%s/dataset.snap", output_dir);
+                        PassengerSketchIndex* sketches = sketch_index_build(flights, flight_count,
+                                                                            reservations, reservation_count);
+                        if (sketches != NULL &&
+                            sketch_index_save_snapshot(sketches, flights, flight_count, passengers, passenger_count,
+                                                       reservations, reservation_count, snapshot_path)) {
+                            printf("Binary snapshot saved to %s\n", snapshot_path);
+                        }
+                        sketch_index_free(sketches);
+                    }
+                }
                 
                 // Build data structures for both prototypes
                 printf("\nBuilding data structures...\n");
@@ -569,11 +1755,7 @@ int main(int argc, char* argv[]) {
                 
                 printf("\n======== Using Prototype %d ========\n", active_prototype);
                 printf("\nAll Flights (ordered by ID):\n");
-                if (active_prototype == 1) {
-                    print_flights(p1_flights_root);
-                } else {
-                    avl_print_flights(p2_flights_root);
-                }
+                list_flights_paged(active_prototype);
                 break;
                 
             case 4: // List all passengers (ordered)
@@ -595,11 +1777,14 @@ int main(int argc, char* argv[]) {
                 printf("Enter flight ID: ");
                 scanf("%d", &id);
                 
+                profile_begin();
                 if (active_prototype == 1) {
                     flight = search_flight_by_id(p1_flights_root, id, 1);
                 } else {
                     flight = search_flight_by_id(p2_flights_root, id, 2);
                 }
+                profile_end(active_prototype == 1 ? "find_flight" : "avl_find_flight");
+                trace_record(session_recorder, TRACE_FLIGHT_BY_ID, id, 0, NULL);
                 
                 display_flight_details(flight);
                 break;
@@ -612,11 +1797,14 @@ int main(int argc, char* argv[]) {
                 fgets(search_term, MAX_LINE_LENGTH, stdin);
                 search_term[strcspn(search_term, "\n")] = 0; // Remove newline
                 
+                profile_begin();
                 if (active_prototype == 1) {
                     flight = find_flight_by_number(p1_flights_root, search_term);
                 } else {
                     flight = avl_find_flight_by_number(p2_flights_root, search_term);
                 }
+                profile_end(active_prototype == 1 ? "find_flight_by_number" : "avl_find_flight_by_number");
+                trace_record(session_recorder, TRACE_FLIGHT_BY_NUMBER, 0, 0, search_term);
                 
                 display_flight_details(flight);
                 break;
@@ -628,11 +1816,14 @@ int main(int argc, char* argv[]) {
                 printf("Enter passenger ID: ");
                 scanf("%d", &id);
                 
+                profile_begin();
                 if (active_prototype == 1) {
                     passenger = search_passenger_by_id(p1_passengers_head, id, 1);
                 } else {
                     passenger = search_passenger_by_id(p2_passengers_table, id, 2);
                 }
+                profile_end(active_prototype == 1 ? "find_passenger" : "hash_find_passenger");
+                trace_record(session_recorder, TRACE_PASSENGER_BY_ID, 0, id, NULL);
                 
                 display_passenger_details(passenger);
                 break;
@@ -645,11 +1836,13 @@ int main(int argc, char* argv[]) {
                 fgets(search_term, MAX_LINE_LENGTH, stdin);
                 search_term[strcspn(search_term, "\n")] = 0; // Remove newline
                 
+                profile_begin();
                 if (active_prototype == 1) {
                     passenger = find_passenger_by_name(p1_passengers_head, search_term);
                 } else {
                     passenger = hash_find_passenger_by_name(p2_passengers_table, search_term);
                 }
+                profile_end(active_prototype == 1 ? "find_passenger_by_name" : "hash_find_passenger_by_name");
                 
                 display_passenger_details(passenger);
                 break;
@@ -662,11 +1855,14 @@ int main(int argc, char* argv[]) {
                 scanf("%d", &id);
                 
                 printf("\nFlights booked by Passenger ID %d:\n", id);
+                profile_begin();
                 if (active_prototype == 1) {
                     print_passenger_flights(p1_reservations_array, p1_flights_root, id);
                 } else {
                     print_passenger_flights_bst(p2_reservations_bst, p2_flights_root, id);
                 }
+                profile_end(active_prototype == 1 ? "print_passenger_flights" : "print_passenger_flights_bst");
+                trace_record(session_recorder, TRACE_LIST_BOOKINGS, 0, id, NULL);
                 break;
                 
             case 10: // Find passengers who booked a specific flight
@@ -677,11 +1873,13 @@ int main(int argc, char* argv[]) {
                 scanf("%d", &id);
                 
                 printf("\nPassengers who booked Flight ID %d:\n", id);
+                profile_begin();
                 if (active_prototype == 1) {
                     print_flight_passengers(p1_reservations_array, p1_passengers_head, id);
                 } else {
                     print_flight_passengers_bst(p2_reservations_bst, p2_passengers_table, id);
                 }
+                profile_end(active_prototype == 1 ? "print_flight_passengers" : "print_flight_passengers_bst");
                 break;
                 
             case 11: // Run performance comparison tests
@@ -694,6 +1892,8 @@ int main(int argc, char* argv[]) {
                 
                 printf("\n===== Performance Test: Prototype 2 =====\n");
                 run_prototype2(flights, flight_count, passengers, passenger_count, reservations, reservation_count);
+                
+                run_trace_comparison();
                 break;
                 
             case 12: // Switch active prototype
@@ -703,6 +1903,43 @@ int main(int argc, char* argv[]) {
                 printf("Prototype 2: AVL Tree for flights, Hash Table for passengers, BST for reservations\n");
                 break;
                 
+            case 14: // Show memory usage by structure
+                if (!check_data_loaded(data_loaded)) break;
+                print_memory_report();
+                break;
+                
+            case 15: // Show structure health statistics
+                if (!check_data_loaded(data_loaded)) break;
+                print_structure_health_report(NULL);
+                break;
+                
+            case 16: // Cancel a flight or a day's departures
+                if (!check_data_loaded(data_loaded)) break;
+                
+                printf("\n======== Using Prototype %d ========\n", active_prototype);
+                cancel_flights_menu(active_prototype);
+                break;
+                
+            case 17: // Estimate distinct passengers
+                if (!check_data_loaded(data_loaded)) break;
+                distinct_passengers_menu();
+                break;
+                
+            case 18: // Fullest and emptiest flights
+                if (!check_data_loaded(data_loaded)) break;
+                flight_load_menu();
+                break;
+                
+            case 19: // Passengers whose name contains a fragment
+                if (!check_data_loaded(data_loaded)) break;
+                name_fragment_menu(active_prototype);
+                break;
+                
+            case 20: // Capacity report over a consistent snapshot
+                if (!check_data_loaded(data_loaded)) break;
+                capacity_report_menu();
+                break;
+                
             case 13: // Exit program
                 exit_program = 1;
                 printf("\nExiting program. Cleaning up resources...\n");
@@ -720,6 +1957,8 @@ int main(int argc, char* argv[]) {
     }
     
     // Cleanup
+    trace_recorder_close(session_recorder);
+    if (profile_enabled) perf_counters_close(&profile_counters);
     cleanup_resources();
     
     printf("\n======================================\n");
@@ -42,7 +42,7 @@ typedef struct {
     int flightId;
     int passengerId;
     time_t bookingDate;
-    char seatNumber[10];
+    char seatNumber[MAX_SEAT_NUMBER_LENGTH];
 } ReservationRecord;
 
 //--- PROTOTYPE 1 DATA STRUCTURES ---//
@@ -54,16 +54,30 @@ typedef struct BST_Node {
     struct BST_Node* right;
 } BST_Node;
 
-// Linked List implementation for passengers
+// Skip list node for passengers. `next` is level 0, so following it visits every passenger in
+// ID order; tower holds the forward pointers for levels 1 to level - 1. The head node (lowest
+// ID) always has every level and holds the list's tower pool
 typedef struct LL_Node {
     Passenger data;
     struct LL_Node* next;
+    struct LL_Node** tower;
+    int level;
+    struct SkipTowerPool* pool;
 } LL_Node;
 
-// Array implementation for reservation records
+// Array implementation for reservation records, one column per field. Rows [0, sorted) are
+// ordered by flight ID, then passenger ID, then booking order; the rows after them are recent
+// bookings in booking order, merged in once enough accumulate. passenger_order lists the
+// sorted rows by passenger ID while passenger_order_valid is set
 typedef struct {
-    ReservationRecord* records;
+    int* flightIds;
+    int* passengerIds;
+    time_t* bookingDates;
+    char (*seatNumbers)[MAX_SEAT_NUMBER_LENGTH];
+    int* passenger_order;
+    int passenger_order_valid;
     int count;
+    int sorted;
     int capacity;
 } ReservationArray;
 
@@ -75,6 +89,7 @@ typedef struct AVL_Node {
     struct AVL_Node* left;
     struct AVL_Node* right;
     int height; // Height for balancing
+    int size;   // Flights in this subtree, for rank and select
 } AVL_Node;
 
 // Hash table entry for passengers
@@ -89,6 +104,7 @@ typedef struct {
     HashEntry* table;
     int size;
     int count;
+    struct BloomFilter* filter;  // Optional filter of the IDs present (NULL when off)
 } PassengerHashTable;
 
 // Reservation BST for efficient lookup
@@ -114,6 +130,9 @@ typedef struct {
         int max_passenger_id;                // Maximum passenger ID for array indexing
     } passenger_index;
     int index_enabled;                       // Flag to indicate if indexes are enabled
+    struct BloomFilter* pair_filter;         // Optional filter of the (flight, passenger) pairs present
+    struct FlightLoadIndex* load_index;      // Optional load-factor order of the flights, kept current
+                                             // by every booking and cancellation
 } ReservationBST;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,253 @@
+/*
+ * Batch Query Implementation
+ *
+ * Runs a stream of queries against a query engine without the interactive menu.
+ * Results are formatted straight into a reusable output buffer (with the cached
+ * date formatting of the CSV writer) instead of one printf and one
+ * localtime/strftime call per result line.
+ *
+ * Sources used:
+ * 1. The C Programming Language (K&R) - Buffered input and string handling
+ * 2. "The Practice of Programming" by Kernighan and Pike - Simple text protocols
+ */
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "batch.h"
+#include "csv_writer.h"
+#include "timing.h"
+
+// Space reserved for one output line: the query number, a separator and one CSV row
+#define BATCH_MAX_OUTPUT_LINE (CSV_MAX_ROW_LENGTH + 32)
+
+// State shared by every query of one run
+typedef struct {
+    QueryEngine* engine;
+    OutputBuffer buffer;
+    DateCache dates;
+    ReservationRecord* records;  // Reused result array for the list queries
+    int record_capacity;
+    Flight* flights;             // Reused page for LIST_FLIGHTS
+    BatchStats* stats;
+} BatchContext;
+
+// Start an output line: "<line>,". Returns the write position
+static char* begin_line(BatchContext* context, long long line) {
+    output_buffer_reserve(&context->buffer, BATCH_MAX_OUTPUT_LINE);
+    char* out = context->buffer.data + context->buffer.length;
+    out += csv_format_int(out, (int)line);
+    *out++ = ',';
+    return out;
+}
+
+// Finish an output line that ends at `end`
+static void end_line(BatchContext* context, char* end) {
+    size_t length = (size_t)(end - (context->buffer.data + context->buffer.length));
+    context->buffer.length += length;
+    context->stats->output_bytes += (long long)length;
+    context->stats->rows++;
+}
+
+// Write "<line>,<status>[,<count>]"
+static void write_status(BatchContext* context, long long line, const char* status, int count) {
+    char* out = begin_line(context, line);
+    out += csv_format_string(out, status);
+    if (count >= 0) {
+        *out++ = ',';
+        out += csv_format_int(out, count);
+    }
+    *out++ = '\n';
+    end_line(context, out);
+}
+
+// Write "<line>,ERROR,<message>"
+static void write_error(BatchContext* context, long long line, const char* message) {
+    char* out = begin_line(context, line);
+    out += csv_format_string(out, "ERROR,");
+    out += csv_format_string(out, message);
+    *out++ = '\n';
+    end_line(context, out);
+    context->stats->errors++;
+}
+
+// Write a flight row, or NOT_FOUND
+static void write_flight(BatchContext* context, long long line, const Flight* flight) {
+    if (flight == NULL) {
+        write_status(context, line, "NOT_FOUND", -1);
+        context->stats->not_found++;
+        return;
+    }
+    char* out = begin_line(context, line);
+    out += csv_format_flight_row(out, flight, &context->dates);
+    end_line(context, out);
+}
+
+// Write a passenger row, or NOT_FOUND
+static void write_passenger(BatchContext* context, long long line, const Passenger* passenger) {
+    if (passenger == NULL) {
+        write_status(context, line, "NOT_FOUND", -1);
+        context->stats->not_found++;
+        return;
+    }
+    char* out = begin_line(context, line);
+    out += csv_format_passenger_row(out, passenger);
+    end_line(context, out);
+}
+
+// Write one reservation row per record, then the total
+static void write_reservations(BatchContext* context, long long line, int count) {
+    if (count < 0) {
+        write_error(context, line, "out of memory");
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        char* out = begin_line(context, line);
+        out += csv_format_reservation_row(out, &context->records[i], &context->dates);
+        end_line(context, out);
+    }
+    write_status(context, line, "TOTAL", count);
+}
+
+// Parse and run one query line (already stripped of its newline)
+static void run_query(BatchContext* context, long long line, char* text) {
+    QueryEngine* engine = context->engine;
+    char command[32];
+    int consumed = 0;
+    if (sscanf(text, "%31s%n", command, &consumed) != 1) {
+        return;  // Blank line
+    }
+    if (command[0] == '#') {
+        return;
+    }
+    
+    const char* args = text + consumed;
+    int first, second;
+    char key[MAX_LINE_LENGTH];
+    context->stats->queries++;
+    
+    if (strcmp(command, "FLIGHT_ID") == 0 && sscanf(args, "%d", &first) == 1) {
+        write_flight(context, line, engine->find_flight(engine->state, first));
+    } else if (strcmp(command, "FLIGHT_NUMBER") == 0 && sscanf(args, "%19s", key) == 1) {
+        write_flight(context, line, engine->find_flight_by_number(engine->state, key));
+    } else if (strcmp(command, "PASSENGER") == 0 && sscanf(args, "%d", &first) == 1) {
+        write_passenger(context, line, engine->find_passenger(engine->state, first));
+    } else if (strcmp(command, "PASSENGER_NAME") == 0 && sscanf(args, " %255[^\n]", key) == 1) {
+        write_passenger(context, line, engine->find_passenger_by_name(engine->state, key));
+    } else if (strcmp(command, "PASSENGER_FLIGHTS") == 0 && sscanf(args, "%d", &first) == 1) {
+        int count = engine->passenger_reservations(engine->state, first, &context->records, &context->record_capacity);
+        write_reservations(context, line, count);
+    } else if (strcmp(command, "FLIGHT_PASSENGERS") == 0 && sscanf(args, "%d", &first) == 1) {
+        int count = engine->flight_reservations(engine->state, first, &context->records, &context->record_capacity);
+        write_reservations(context, line, count);
+    } else if (strcmp(command, "BOOK") == 0 && sscanf(args, "%d %d %9s", &first, &second, key) == 3) {
+        ReservationRecord record;
+        record.flightId = first;
+        record.passengerId = second;
+        record.bookingDate = time(NULL);
+        strncpy(record.seatNumber, key, sizeof(record.seatNumber) - 1);
+        record.seatNumber[sizeof(record.seatNumber) - 1] = '\0';
+        
+        int booked = engine->book(engine->state, record);
+        write_status(context, line, booked ? "OK" : "REJECTED", -1);
+        if (!booked) context->stats->not_found++;
+    } else if (strcmp(command, "CANCEL") == 0 && sscanf(args, "%d %d", &first, &second) == 2) {
+        int cancelled = engine->cancel(engine->state, first, second);
+        write_status(context, line, cancelled ? "OK" : "NOT_FOUND", -1);
+        if (!cancelled) context->stats->not_found++;
+    } else if (strcmp(command, "LIST_FLIGHTS") == 0 && sscanf(args, "%d %d", &first, &second) == 2) {
+        if (second < 0 || second > BATCH_MAX_FLIGHT_PAGE) second = BATCH_MAX_FLIGHT_PAGE;
+        int count = engine->list_flights(engine->state, first, context->flights, second);
+        for (int i = 0; i < count; i++) {
+            write_flight(context, line, &context->flights[i]);
+        }
+        write_status(context, line, "TOTAL", count);
+    } else if (strcmp(command, "COUNT_FLIGHTS") == 0 && sscanf(args, "%d %d", &first, &second) == 2) {
+        write_status(context, line, "TOTAL", engine->count_flights(engine->state, first, second));
+    } else {
+        write_error(context, line, "unknown query or missing arguments");
+    }
+}
+
+// Run every query read from `input` against the engine
+int run_batch(QueryEngine* engine, FILE* input, FILE* output, BatchStats* stats) {
+    memset(stats, 0, sizeof(BatchStats));
+    
+    BatchContext context;
+    context.engine = engine;
+    context.stats = stats;
+    context.records = NULL;
+    context.record_capacity = 0;
+    context.flights = (Flight*)malloc(BATCH_MAX_FLIGHT_PAGE * sizeof(Flight));
+    if (context.flights == NULL) {
+        fprintf(stderr, "Memory allocation failed for batch flight page\n");
+        return 0;
+    }
+    date_cache_init(&context.dates);
+    if (!output_buffer_init(&context.buffer, output, OUTPUT_BUFFER_SIZE)) {
+        free(context.flights);
+        return 0;
+    }
+    
+    // Read the input in large chunks and split lines in place, instead of one fgets per line
+    char* input_buffer = (char*)malloc(BATCH_INPUT_BUFFER_SIZE + 1);
+    if (input_buffer == NULL) {
+        fprintf(stderr, "Memory allocation failed for batch input buffer\n");
+        output_buffer_free(&context.buffer);
+        free(context.flights);
+        return 0;
+    }
+    
+    uint64_t start = timing_now_ns();
+    size_t filled = 0;
+    long long line = 0;
+    int at_end = 0;
+    while (!at_end) {
+        size_t read = fread(input_buffer + filled, 1, BATCH_INPUT_BUFFER_SIZE - filled, input);
+        filled += read;
+        at_end = read == 0;
+        
+        // A final line without a newline still counts
+        if (at_end && filled > 0) {
+            input_buffer[filled++] = '\n';
+        }
+        
+        char* next = input_buffer;
+        char* limit = input_buffer + filled;
+        char* newline;
+        while ((newline = (char*)memchr(next, '\n', (size_t)(limit - next))) != NULL) {
+            *newline = '\0';
+            if (newline > next && newline[-1] == '\r') newline[-1] = '\0';
+            run_query(&context, ++line, next);
+            next = newline + 1;
+        }
+        
+        // Keep the partial last line for the next chunk
+        filled = (size_t)(limit - next);
+        memmove(input_buffer, next, filled);
+        if (filled == BATCH_INPUT_BUFFER_SIZE) {
+            stats->queries++;
+            write_error(&context, ++line, "line too long");
+            filled = 0;
+        }
+    }
+    output_buffer_free(&context.buffer);
+    fflush(output);
+    
+    stats->elapsed_seconds = (timing_now_ns() - start) / 1e9;
+    stats->throughput = stats->elapsed_seconds > 0 ? stats->queries / stats->elapsed_seconds : 0.0;
+    
+    free(context.records);
+    free(context.flights);
+    free(input_buffer);
+    return !ferror(output);
+}
+
+// Print the totals and aggregate throughput
+void print_batch_stats(FILE* file, const QueryEngine* engine, const BatchStats* stats) {
+    fprintf(file, "Batch on %s: %lld queries in %.3f s (%.0f queries/sec)\n",
+            engine->name, stats->queries, stats->elapsed_seconds, stats->throughput);
+    fprintf(file, "  %lld output lines (%.1f MB), %lld not found/rejected, %lld errors\n",
+            stats->rows, stats->output_bytes / (1024.0 * 1024.0), stats->not_found, stats->errors);
+}
@@ -0,0 +1,52 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+#include "engine.h"
+
+// Batch query protocol (text, one query per line, blank lines and '#' comments are skipped):
+//   FLIGHT_ID <flightId>                   menu option 5
+//   FLIGHT_NUMBER <flightNumber>           menu option 6
+//   PASSENGER <passengerId>                menu option 7
+//   PASSENGER_NAME <name>                  menu option 8 (the rest of the line is the name)
+//   PASSENGER_FLIGHTS <passengerId>        menu option 9
+//   FLIGHT_PASSENGERS <flightId>           menu option 10
+//   BOOK <flightId> <passengerId> <seat>
+//   CANCEL <flightId> <passengerId>
+//   LIST_FLIGHTS <afterId> <limit>         menu option 3, one page of flights with IDs above
+//                                          afterId (use the last ID as the next afterId)
+//   COUNT_FLIGHTS <lowId> <highId>         flights with IDs in [lowId, highId]
+//
+// Every output line starts with the query's line number, followed by either a CSV row
+// in the same layout as the data files, or a status:
+//   <line>,<flight or passenger row>       lookup hit
+//   <line>,<reservation row>               one line per booking (or flight) for the list queries...
+//   <line>,TOTAL,<count>                   ...followed by their total
+//   <line>,NOT_FOUND | OK | REJECTED
+//   <line>,ERROR,<message>
+
+// Most flights returned by one LIST_FLIGHTS query
+#define BATCH_MAX_FLIGHT_PAGE 1000
+
+// Read buffer for the input stream (bytes)
+#define BATCH_INPUT_BUFFER_SIZE (1024 * 1024)
+
+// Totals for one batch run
+typedef struct {
+    long long queries;
+    long long rows;       // Output lines, including status lines
+    long long not_found;  // Lookups without a match, cancels without a booking, rejected bookings
+    long long errors;     // Lines that could not be parsed
+    long long output_bytes;
+    double elapsed_seconds;
+    double throughput;    // Queries per second
+} BatchStats;
+
+// Run every query read from `input` against the engine, writing results to `output`
+// through a reusable buffer. Returns 1 on success, 0 on failure
+int run_batch(QueryEngine* engine, FILE* input, FILE* output, BatchStats* stats);
+
+// Print the totals and aggregate throughput
+void print_batch_stats(FILE* file, const QueryEngine* engine, const BatchStats* stats);
+
+#endif
@@ -0,0 +1,368 @@
+/*
+ * Benchmark Harness Implementation
+ * 
+ * Times individual operations with the monotonic clock or the CPU timestamp
+ * counter, records them in HDR-style histograms and reports percentiles, so
+ * results show the latency distribution rather than one clock() total per phase.
+ * 
+ * Sources used:
+ * 1. "Systems Performance" by Brendan Gregg - Warmup, repetitions and outliers
+ * 2. HdrHistogram by Gil Tene - Latency histograms
+ * 3. The Linux man-pages project - dup(2), dup2(2)
+ */
+#define _POSIX_C_SOURCE 200809L  // For dup, fileno
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "benchmark.h"
+#include "timing.h"
+
+// Results of operations are added here so the compiler can't optimise the calls away
+static volatile long bench_sink = 0;
+
+// Saved stdout while quiet
+static int saved_stdout = -1;
+
+// Default harness settings
+BenchOptions default_bench_options() {
+    BenchOptions options;
+    options.warmup_ops = 200;
+    options.repetitions = 10;
+    options.ops_per_rep = 2000;
+    options.scan_ops_per_rep = 5;
+    options.outlier_mads = 3.0;
+    options.op_budget_seconds = 2.0;
+    options.clock = timing_has_tsc() ? BENCH_CLOCK_TSC : BENCH_CLOCK_MONOTONIC;
+    options.perf = NULL;
+    return options;
+}
+
+// Start a result row
+int bench_result_init(BenchResult* result, const char* engine, const char* operation,
+                      const char* size, int records, BenchClock clock) {
+    memset(result, 0, sizeof(*result));
+    strncpy(result->engine, engine, sizeof(result->engine) - 1);
+    strncpy(result->operation, operation, sizeof(result->operation) - 1);
+    strncpy(result->size, size, sizeof(result->size) - 1);
+    result->records = records;
+    result->timer_overhead_ns = bench_timer_overhead_ns(clock);
+    result->histogram = histogram_create();
+    return result->histogram != NULL;
+}
+
+// Free the histogram held by a result
+void bench_result_free(BenchResult* result) {
+    histogram_free(result->histogram);
+    result->histogram = NULL;
+}
+
+// Read the benchmark clock
+uint64_t bench_stamp(BenchClock clock) {
+    return clock == BENCH_CLOCK_TSC ? timing_ticks() : timing_now_ns();
+}
+
+// Nanoseconds between two bench_stamp readings
+uint64_t bench_elapsed_ns(BenchClock clock, uint64_t start, uint64_t end) {
+    if (clock == BENCH_CLOCK_TSC) {
+        return (uint64_t)((end - start) * timing_ns_per_tick() + 0.5);
+    }
+    return end - start;
+}
+
+// Median cost of taking two timestamps back to back
+double bench_timer_overhead_ns(BenchClock clock) {
+    enum { SAMPLES = 1001 };
+    uint64_t samples[SAMPLES];
+    for (int i = 0; i < SAMPLES; i++) {
+        uint64_t start = bench_stamp(clock);
+        uint64_t end = bench_stamp(clock);
+        samples[i] = bench_elapsed_ns(clock, start, end);
+    }
+    timing_sort_ns(samples, SAMPLES);
+    return (double)samples[SAMPLES / 2];
+}
+
+// Send stdout to /dev/null or restore it
+void bench_quiet_stdout(int quiet) {
+    fflush(stdout);
+    if (quiet && saved_stdout < 0) {
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd < 0) {
+            return;
+        }
+        saved_stdout = dup(fileno(stdout));
+        dup2(null_fd, fileno(stdout));
+        close(null_fd);
+    } else if (!quiet && saved_stdout >= 0) {
+        dup2(saved_stdout, fileno(stdout));
+        close(saved_stdout);
+        saved_stdout = -1;
+    }
+}
+
+// Comparison function for qsort
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Median of an array (sorts a copy)
+static double median_of(const double* values, int count) {
+    double* sorted = (double*)malloc(count * sizeof(double));
+    if (sorted == NULL) {
+        return values[0];
+    }
+    memcpy(sorted, values, count * sizeof(double));
+    qsort(sorted, count, sizeof(double), compare_doubles);
+    double median = count % 2 ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) / 2.0;
+    free(sorted);
+    return median;
+}
+
+// Warm up, run the repetitions, drop outlier repetitions and fill in the result
+int bench_run(BenchResult* result, const BenchOperation* op, void* context, int first_index,
+              const BenchOptions* options) {
+    int index = first_index;
+    int reps = options->repetitions > 0 ? options->repetitions : 1;
+    int ops = op->scan ? options->scan_ops_per_rep : options->ops_per_rep;
+    if (ops < 1) ops = 1;
+    
+    LatencyHistogram** rep_histograms = (LatencyHistogram**)calloc(reps, sizeof(LatencyHistogram*));
+    double* rep_medians = (double*)malloc(reps * sizeof(double));
+    double* rep_throughput = (double*)malloc(reps * sizeof(double));
+    PerfSample* rep_perf = (PerfSample*)calloc(reps, sizeof(PerfSample));
+    if (rep_histograms == NULL || rep_medians == NULL || rep_throughput == NULL || rep_perf == NULL) {
+        fprintf(stderr, "Memory allocation failed for benchmark repetitions\n");
+        free(rep_histograms);
+        free(rep_medians);
+        free(rep_throughput);
+        free(rep_perf);
+        return index;
+    }
+    
+    if (op->quiet) bench_quiet_stdout(1);
+    
+    // Warmup: fill caches and branch predictors, and let the CPU leave any idle state
+    int warmup = op->scan ? (options->warmup_ops > 0 ? 1 : 0) : options->warmup_ops;
+    uint64_t warmup_start = timing_now_ns();
+    for (int i = 0; i < warmup; i++) {
+        bench_sink += op->run(context, index++);
+    }
+    
+    // Scale down the repetitions of slow operations (e.g. linear scans at the larger sizes)
+    if (warmup > 0 && options->op_budget_seconds > 0.0) {
+        double seconds_per_op = (timing_now_ns() - warmup_start) / 1e9 / warmup;
+        double affordable = options->op_budget_seconds / (seconds_per_op * reps);
+        if (affordable < ops) {
+            ops = affordable > 10.0 ? (int)affordable : 10;
+        }
+    }
+    
+    for (int r = 0; r < reps; r++) {
+        rep_histograms[r] = histogram_create();
+        if (rep_histograms[r] == NULL) {
+            reps = r;
+            break;
+        }
+        
+        // Counters are read around the whole repetition, since a read is a system call
+        // costing far more than most operations
+        if (options->perf != NULL) perf_counters_begin(options->perf);
+        uint64_t rep_start = timing_now_ns();
+        for (int i = 0; i < ops; i++) {
+            uint64_t start = bench_stamp(options->clock);
+            bench_sink += op->run(context, index++);
+            uint64_t end = bench_stamp(options->clock);
+            histogram_record(rep_histograms[r], bench_elapsed_ns(options->clock, start, end));
+        }
+        uint64_t rep_ns = timing_now_ns() - rep_start;
+        if (options->perf != NULL) perf_counters_end(options->perf, &rep_perf[r]);
+        
+        rep_medians[r] = (double)histogram_percentile(rep_histograms[r], 50.0);
+        rep_throughput[r] = rep_ns > 0 ? ops * 1e9 / rep_ns : 0.0;
+    }
+    
+    if (op->quiet) bench_quiet_stdout(0);
+    
+    // Outlier repetitions (e.g. one hit by a page-cache flush or a context switch) are
+    // dropped using the median absolute deviation, which the outliers themselves can't skew
+    double center = reps > 0 ? median_of(rep_medians, reps) : 0.0;
+    double limit = -1.0;
+    if (options->outlier_mads > 0.0 && reps >= 3) {
+        double* deviations = (double*)malloc(reps * sizeof(double));
+        if (deviations != NULL) {
+            for (int r = 0; r < reps; r++) {
+                deviations[r] = fabs(rep_medians[r] - center);
+            }
+            double mad = median_of(deviations, reps);
+            free(deviations);
+            
+            // Don't let a near-zero MAD turn ordinary jitter into outliers
+            double floor_mad = center * 0.02 > result->timer_overhead_ns ? center * 0.02 : result->timer_overhead_ns;
+            limit = options->outlier_mads * (mad > floor_mad ? mad : floor_mad);
+        }
+    }
+    
+    double throughput_sum = 0.0;
+    result->repetitions = reps;
+    result->kept_repetitions = 0;
+    result->perf_measured = options->perf != NULL;
+    perf_sample_reset(&result->perf);
+    for (int r = 0; r < reps; r++) {
+        if (limit < 0.0 || fabs(rep_medians[r] - center) <= limit) {
+            histogram_merge(result->histogram, rep_histograms[r]);
+            throughput_sum += rep_throughput[r];
+            perf_sample_add(&result->perf, &rep_perf[r]);
+            result->perf_operations += ops;
+            result->kept_repetitions++;
+        }
+        histogram_free(rep_histograms[r]);
+    }
+    result->ops_per_second = result->kept_repetitions > 0 ? throughput_sum / result->kept_repetitions : 0.0;
+    
+    free(rep_histograms);
+    free(rep_medians);
+    free(rep_throughput);
+    free(rep_perf);
+    return index;
+}
+
+// Time each call once, stopping early when the budget is used up
+int bench_run_build(BenchResult* result, const BenchOperation* op, void* context, int count,
+                    double budget_seconds, const BenchOptions* options) {
+    BenchClock clock = options->clock;
+    if (options->perf != NULL) perf_counters_begin(options->perf);
+    uint64_t build_start = timing_now_ns();
+    uint64_t budget_ns = (uint64_t)(budget_seconds * 1e9);
+    int done = 0;
+    
+    if (op->quiet) bench_quiet_stdout(1);
+    while (done < count) {
+        uint64_t start = bench_stamp(clock);
+        bench_sink += op->run(context, done);
+        uint64_t end = bench_stamp(clock);
+        histogram_record(result->histogram, bench_elapsed_ns(clock, start, end));
+        done++;
+        
+        // Checking the budget every 256 calls keeps the clock reads out of the samples' way
+        if (budget_ns > 0 && (done & 255) == 0 && timing_now_ns() - build_start > budget_ns) {
+            break;
+        }
+    }
+    uint64_t elapsed = timing_now_ns() - build_start;
+    if (options->perf != NULL) perf_counters_end(options->perf, &result->perf);
+    if (op->quiet) bench_quiet_stdout(0);
+    
+    result->perf_measured = options->perf != NULL;
+    result->perf_operations = done;
+    result->repetitions = 1;
+    result->kept_repetitions = 1;
+    result->records = done;
+    result->ops_per_second = elapsed > 0 ? done * 1e9 / elapsed : 0.0;
+    return done;
+}
+
+// Print one result as a table row
+void bench_print_result(const BenchResult* result, int header) {
+    if (header) {
+        printf("%-12s %-34s %-7s %9s %5s %10s %10s %10s %10s %12s %12s\n", "Engine", "Operation", "Size",
+               "Records", "Reps", "p50 (ns)", "p99 (ns)", "p999 (ns)", "max (ns)", "mean (ns)", "ops/sec");
+    }
+    const LatencyHistogram* h = result->histogram;
+    printf("%-12s %-34s %-7s %9d %2d/%-2d %10llu %10llu %10llu %10llu %12.1f %12.0f\n",
+           result->engine, result->operation, result->size, result->records,
+           result->kept_repetitions, result->repetitions,
+           (unsigned long long)histogram_percentile(h, 50.0),
+           (unsigned long long)histogram_percentile(h, 99.0),
+           (unsigned long long)histogram_percentile(h, 99.9),
+           (unsigned long long)(h->total_count > 0 ? h->max : 0),
+           histogram_mean(h), result->ops_per_second);
+    if (result->perf_measured) {
+        perf_print_sample("             ", &result->perf, result->perf_operations);
+    }
+}
+
+// CSV header
+void bench_write_csv_header(FILE* file) {
+    fprintf(file, "engine,operation,size,records,samples,repetitions,kept_repetitions,"
+                  "min_ns,mean_ns,p50_ns,p90_ns,p99_ns,p999_ns,max_ns,ops_per_sec,timer_overhead_ns");
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        fprintf(file, ",%s_per_op", perf_event_name(e));
+    }
+    fprintf(file, "\n");
+}
+
+// One CSV row
+void bench_write_csv_row(FILE* file, const BenchResult* result) {
+    const LatencyHistogram* h = result->histogram;
+    fprintf(file, "%s,%s,%s,%d,%llu,%d,%d,%llu,%.1f,%llu,%llu,%llu,%llu,%llu,%.1f,%.1f",
+            result->engine, result->operation, result->size, result->records,
+            (unsigned long long)h->total_count, result->repetitions, result->kept_repetitions,
+            (unsigned long long)(h->total_count > 0 ? h->min : 0), histogram_mean(h),
+            (unsigned long long)histogram_percentile(h, 50.0),
+            (unsigned long long)histogram_percentile(h, 90.0),
+            (unsigned long long)histogram_percentile(h, 99.0),
+            (unsigned long long)histogram_percentile(h, 99.9),
+            (unsigned long long)h->max, result->ops_per_second, result->timer_overhead_ns);
+    
+    // Counter columns stay empty when counters were off or unavailable
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        if (result->perf_measured && result->perf.valid[e] && result->perf_operations > 0) {
+            fprintf(file, ",%.3f", result->perf.values[e] / result->perf_operations);
+        } else {
+            fprintf(file, ",");
+        }
+    }
+    fprintf(file, "\n");
+}
+
+// JSON output including the non-empty histogram buckets
+void bench_write_json(FILE* file, const BenchResult* results, int count) {
+    fprintf(file, "[\n");
+    for (int i = 0; i < count; i++) {
+        const BenchResult* result = &results[i];
+        const LatencyHistogram* h = result->histogram;
+        fprintf(file, "  {\"engine\": \"%s\", \"operation\": \"%s\", \"size\": \"%s\", \"records\": %d,\n",
+                result->engine, result->operation, result->size, result->records);
+        fprintf(file, "   \"samples\": %llu, \"repetitions\": %d, \"kept_repetitions\": %d, "
+                      "\"timer_overhead_ns\": %.1f, \"ops_per_sec\": %.1f,\n",
+                (unsigned long long)h->total_count, result->repetitions, result->kept_repetitions,
+                result->timer_overhead_ns, result->ops_per_second);
+        fprintf(file, "   \"min_ns\": %llu, \"mean_ns\": %.1f, \"p50_ns\": %llu, \"p90_ns\": %llu, "
+                      "\"p99_ns\": %llu, \"p999_ns\": %llu, \"max_ns\": %llu,\n",
+                (unsigned long long)(h->total_count > 0 ? h->min : 0), histogram_mean(h),
+                (unsigned long long)histogram_percentile(h, 50.0),
+                (unsigned long long)histogram_percentile(h, 90.0),
+                (unsigned long long)histogram_percentile(h, 99.0),
+                (unsigned long long)histogram_percentile(h, 99.9),
+                (unsigned long long)h->max);
+        
+        // Hardware counters per operation (null when off or unavailable)
+        fprintf(file, "   \"perf_per_op\": {");
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            fprintf(file, "%s\"%s\": ", e > 0 ? ", " : "", perf_event_name(e));
+            if (result->perf_measured && result->perf.valid[e] && result->perf_operations > 0) {
+                fprintf(file, "%.3f", result->perf.values[e] / result->perf_operations);
+            } else {
+                fprintf(file, "null");
+            }
+        }
+        fprintf(file, "},\n");
+        
+        // Histogram as [bucket upper bound (ns), count] pairs
+        fprintf(file, "   \"histogram\": [");
+        int first = 1;
+        for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+            if (h->counts[b] == 0) continue;
+            fprintf(file, "%s[%llu, %llu]", first ? "" : ", ",
+                    (unsigned long long)histogram_bucket_upper_bound(b), (unsigned long long)h->counts[b]);
+            first = 0;
+        }
+        fprintf(file, "]}%s\n", i + 1 < count ? "," : "");
+    }
+    fprintf(file, "]\n");
+}
@@ -0,0 +1,96 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "histogram.h"
+#include "perf_counters.h"
+
+// Clock used to time each operation
+typedef enum {
+    BENCH_CLOCK_MONOTONIC = 0,  // clock_gettime(CLOCK_MONOTONIC)
+    BENCH_CLOCK_TSC             // rdtsc (falls back to the monotonic clock off x86)
+} BenchClock;
+
+// Harness settings
+typedef struct {
+    int warmup_ops;        // Operations run before measuring, not recorded
+    int repetitions;       // Measured repetitions of each operation
+    int ops_per_rep;       // Operations per repetition
+    int scan_ops_per_rep;  // Operations per repetition for whole-structure scans
+    double outlier_mads;   // Drop repetitions whose median is further than this many median
+                           // absolute deviations from the median of all repetitions (0 = keep all)
+    double op_budget_seconds;  // Fewer operations per repetition for operations slower than this allows
+    BenchClock clock;
+    PerfCounters* perf;    // Hardware counters read around each repetition (NULL = off)
+} BenchOptions;
+
+// A benchmarked operation. run(context, i) performs the i-th call; i keeps counting across
+// warmup and repetitions so operations that consume keys (inserts, cancels) never repeat one
+typedef struct {
+    const char* name;
+    long (*run)(void* context, int i);
+    int scan;   // Walks a whole structure: uses scan_ops_per_rep
+    int quiet;  // Prints as a side effect: stdout is sent to /dev/null while measuring
+} BenchOperation;
+
+// Results for one operation at one dataset size
+typedef struct {
+    char engine[32];
+    char operation[48];
+    char size[16];
+    int records;                  // Records in the structure the operation ran against
+    int repetitions;
+    int kept_repetitions;         // Repetitions left after outlier removal
+    LatencyHistogram* histogram;  // Latencies (ns) of the kept repetitions
+    double ops_per_second;        // Mean throughput of the kept repetitions
+    double timer_overhead_ns;     // Cost of one timestamp pair, included in every sample
+    int perf_measured;            // 1 if hardware counters were read
+    PerfSample perf;              // Counter totals over the kept repetitions
+    double perf_operations;       // Operations those totals cover
+} BenchResult;
+
+// Default harness settings
+BenchOptions default_bench_options();
+
+// Start a result row. Returns 1 on success
+int bench_result_init(BenchResult* result, const char* engine, const char* operation,
+                      const char* size, int records, BenchClock clock);
+
+// Free the histogram held by a result
+void bench_result_free(BenchResult* result);
+
+// Read the benchmark clock (ticks for BENCH_CLOCK_TSC, nanoseconds otherwise)
+uint64_t bench_stamp(BenchClock clock);
+
+// Nanoseconds between two bench_stamp readings
+uint64_t bench_elapsed_ns(BenchClock clock, uint64_t start, uint64_t end);
+
+// Median cost of taking two timestamps back to back
+double bench_timer_overhead_ns(BenchClock clock);
+
+// Send stdout to /dev/null (quiet = 1) or restore it (quiet = 0)
+void bench_quiet_stdout(int quiet);
+
+// Warm up, run the repetitions, drop outlier repetitions and fill in the result.
+// `first_index` is the first i passed to op->run. Returns the next unused index
+int bench_run(BenchResult* result, const BenchOperation* op, void* context, int first_index,
+              const BenchOptions* options);
+
+// Time count calls of op->run(context, 0..count-1) once each, e.g. inserting every record
+// while building a structure. Stops early once budget_seconds is used up (0 = no limit).
+// Returns the number of calls made
+int bench_run_build(BenchResult* result, const BenchOperation* op, void* context, int count,
+                    double budget_seconds, const BenchOptions* options);
+
+// Print one result as a table row (with a header row when header is 1)
+void bench_print_result(const BenchResult* result, int header);
+
+// CSV output for regression tracking
+void bench_write_csv_header(FILE* file);
+void bench_write_csv_row(FILE* file, const BenchResult* result);
+
+// JSON output: an array of result objects including the non-empty histogram buckets
+void bench_write_json(FILE* file, const BenchResult* results, int count);
+
+#endif
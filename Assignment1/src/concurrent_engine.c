@@ -0,0 +1,273 @@
+/*
+ * Concurrent Query Engine (Prototype 2)
+ *
+ * Prototype 2's AVL tree, hash table and reservation BST wrapped for use from
+ * many threads. The reservation BST is guarded by a "big reader" lock: one
+ * reader-writer lock per reader slot, each on its own cache line. A reader
+ * only takes the lock of its own slot, so read-heavy workloads don't all
+ * bounce one lock word between cores; a writer takes every slot.
+ *
+ * Writers are also serialised per flight shard, which is what keeps bookings
+ * under capacity: the capacity check and the insert happen while holding the
+ * flight's shard mutex, so two bookings for the same flight can never both
+ * see the last free seat. The check itself runs under the shared lock.
+ *
+ * Sources used:
+ * 1. "The Art of Multiprocessor Programming" by Herlihy and Shavit - Reader-writer locks
+ * 2. Linux kernel brlock (big-reader lock) design notes - Per-CPU reader locks
+ * 3. POSIX Threads Programming (Lawrence Livermore National Laboratory) - pthread rwlocks and mutexes
+ */
+
+#define _GNU_SOURCE  // For pthread_rwlockattr_setkind_np
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "concurrent_engine.h"
+#include "prototype2/flight_management_avl.h"
+#include "prototype2/passenger_management_hash.h"
+#include "prototype2/reservation_management_bst.h"
+#include "prototype2/flight_search_avl.h"
+#include "prototype2/passenger_search_hash.h"
+
+// One reader slot, padded to a cache line
+typedef struct {
+    pthread_rwlock_t lock;
+} __attribute__((aligned(64))) ReaderSlot;
+
+// One booking shard, padded to a cache line
+typedef struct {
+    pthread_mutex_t lock;
+} __attribute__((aligned(64))) FlightShard;
+
+typedef struct {
+    ReaderSlot readers[CONCURRENT_READER_SLOTS];
+    FlightShard shards[CONCURRENT_FLIGHT_SHARDS];
+    AVL_Node* flights_root;
+    PassengerHashTable* passengers_table;
+    ReservationBST* reservations;
+    int locks_ready;
+} ConcurrentState;
+
+// Slot of the calling thread (assigned round-robin the first time a thread reads)
+static __thread int reader_slot = -1;
+static int next_reader_slot = 0;
+
+static int current_reader_slot() {
+    if (reader_slot < 0) {
+        reader_slot = __atomic_fetch_add(&next_reader_slot, 1, __ATOMIC_RELAXED) % CONCURRENT_READER_SLOTS;
+    }
+    return reader_slot;
+}
+
+//--- LOCKING ---//
+
+static void read_lock(ConcurrentState* state) {
+    pthread_rwlock_rdlock(&state->readers[current_reader_slot()].lock);
+}
+
+static void read_unlock(ConcurrentState* state) {
+    pthread_rwlock_unlock(&state->readers[current_reader_slot()].lock);
+}
+
+// Slots are always taken in the same order, so two writers can't deadlock
+static void write_lock(ConcurrentState* state) {
+    for (int i = 0; i < CONCURRENT_READER_SLOTS; i++) {
+        pthread_rwlock_wrlock(&state->readers[i].lock);
+    }
+}
+
+static void write_unlock(ConcurrentState* state) {
+    for (int i = CONCURRENT_READER_SLOTS - 1; i >= 0; i--) {
+        pthread_rwlock_unlock(&state->readers[i].lock);
+    }
+}
+
+static pthread_mutex_t* flight_shard(ConcurrentState* state, int flightId) {
+    return &state->shards[(unsigned int)flightId % CONCURRENT_FLIGHT_SHARDS].lock;
+}
+
+// Create every lock. Writers are preferred where supported, so a steady stream of
+// readers can't hold off bookings indefinitely
+static int init_locks(ConcurrentState* state) {
+    pthread_rwlockattr_t attributes;
+    if (pthread_rwlockattr_init(&attributes) != 0) {
+        return 0;
+    }
+#ifdef __GLIBC__
+    pthread_rwlockattr_setkind_np(&attributes, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    int ok = 1;
+    for (int i = 0; i < CONCURRENT_READER_SLOTS; i++) {
+        ok &= pthread_rwlock_init(&state->readers[i].lock, &attributes) == 0;
+    }
+    for (int i = 0; i < CONCURRENT_FLIGHT_SHARDS; i++) {
+        ok &= pthread_mutex_init(&state->shards[i].lock, NULL) == 0;
+    }
+    pthread_rwlockattr_destroy(&attributes);
+    return ok;
+}
+
+//--- OPERATIONS ---//
+
+// Flights and passengers are never modified after the build, so lookups need no lock
+static Flight* c_find_flight(void* state, int flightId) {
+    return avl_find_flight(((ConcurrentState*)state)->flights_root, flightId);
+}
+
+static Flight* c_find_flight_by_number(void* state, const char* flightNumber) {
+    return avl_find_flight_by_number(((ConcurrentState*)state)->flights_root, flightNumber);
+}
+
+static int c_list_flights(void* state, int afterId, Flight* page, int limit) {
+    return avl_list_flights_after(((ConcurrentState*)state)->flights_root, afterId, page, limit);
+}
+
+static int c_count_flights(void* state, int lowId, int highId) {
+    return avl_count_range(((ConcurrentState*)state)->flights_root, lowId, highId);
+}
+
+static Passenger* c_find_passenger(void* state, int passengerId) {
+    return hash_find_passenger(((ConcurrentState*)state)->passengers_table, passengerId);
+}
+
+static Passenger* c_find_passenger_by_name(void* state, const char* name) {
+    return hash_find_passenger_by_name(((ConcurrentState*)state)->passengers_table, name);
+}
+
+static int c_count_passenger_bookings(void* state, int passengerId) {
+    ConcurrentState* c = (ConcurrentState*)state;
+    read_lock(c);
+    int count = count_flights_by_passenger(c->reservations, passengerId);
+    read_unlock(c);
+    return count;
+}
+
+static int c_passenger_reservations(void* state, int passengerId, ReservationRecord** records, int* capacity) {
+    ConcurrentState* c = (ConcurrentState*)state;
+    read_lock(c);
+    int count = find_reservations_by_passenger_bst(c->reservations, passengerId, records, capacity);
+    read_unlock(c);
+    return count;
+}
+
+static int c_flight_reservations(void* state, int flightId, ReservationRecord** records, int* capacity) {
+    ConcurrentState* c = (ConcurrentState*)state;
+    read_lock(c);
+    int count = find_reservations_by_flight_bst(c->reservations, flightId, records, capacity);
+    read_unlock(c);
+    return count;
+}
+
+// Same rules as p2_book. Only bookings and cancellations change a flight's passenger count,
+// and they hold the flight's shard mutex, so the count can't change between check and insert
+static int c_book(void* state, ReservationRecord record) {
+    ConcurrentState* c = (ConcurrentState*)state;
+    Flight* flight = avl_find_flight(c->flights_root, record.flightId);
+    if (flight == NULL) {
+        return 0;
+    }
+    
+    pthread_mutex_t* shard = flight_shard(c, record.flightId);
+    pthread_mutex_lock(shard);
+    read_lock(c);
+    int full = !has_reservation_bst(c->reservations, record.flightId, record.passengerId) &&
+               count_passengers_by_flight(c->reservations, record.flightId) >= flight->capacity;
+    read_unlock(c);
+    
+    if (!full) {
+        write_lock(c);
+        add_reservation_bst(c->reservations, record);
+        write_unlock(c);
+    }
+    pthread_mutex_unlock(shard);
+    return !full;
+}
+
+static int c_cancel(void* state, int flightId, int passengerId) {
+    ConcurrentState* c = (ConcurrentState*)state;
+    pthread_mutex_t* shard = flight_shard(c, flightId);
+    pthread_mutex_lock(shard);
+    write_lock(c);
+    int cancelled = cancel_reservation_bst(c->reservations, flightId, passengerId);
+    write_unlock(c);
+    pthread_mutex_unlock(shard);
+    return cancelled;
+}
+
+static void c_destroy(void* state) {
+    ConcurrentState* c = (ConcurrentState*)state;
+    if (c->locks_ready) {
+        for (int i = 0; i < CONCURRENT_READER_SLOTS; i++) {
+            pthread_rwlock_destroy(&c->readers[i].lock);
+        }
+        for (int i = 0; i < CONCURRENT_FLIGHT_SHARDS; i++) {
+            pthread_mutex_destroy(&c->shards[i].lock);
+        }
+    }
+    free_avl_tree(c->flights_root);
+    free_hash_table(c->passengers_table);
+    free_reservation_bst(c->reservations);
+    free(c);
+}
+
+// Build the concurrent engine from the given data
+QueryEngine* create_concurrent_engine(const Flight* flights, int flight_count,
+                                      const Passenger* passengers, int passenger_count,
+                                      const ReservationRecord* reservations, int reservation_count) {
+    QueryEngine* engine = (QueryEngine*)malloc(sizeof(QueryEngine));
+    // Cache-line aligned so every reader slot and shard sits on its own line
+    ConcurrentState* state = NULL;
+    if (posix_memalign((void**)&state, 64, sizeof(ConcurrentState)) != 0) {
+        state = NULL;
+    }
+    if (engine == NULL || state == NULL) {
+        fprintf(stderr, "Memory allocation failed for concurrent engine\n");
+        free(engine);
+        free(state);
+        return NULL;
+    }
+    memset(state, 0, sizeof(ConcurrentState));
+    
+    state->locks_ready = init_locks(state);
+    for (int i = 0; i < flight_count; i++) {
+        state->flights_root = avl_insert(state->flights_root, flights[i]);
+    }
+    state->passengers_table = init_hash_table(passenger_count > 0 ? passenger_count * 2 : 16);
+    state->reservations = init_reservation_bst();
+    if (!state->locks_ready || state->passengers_table == NULL || state->reservations == NULL) {
+        fprintf(stderr, "Could not set up the concurrent engine\n");
+        c_destroy(state);
+        free(engine);
+        return NULL;
+    }
+    for (int i = 0; i < passenger_count; i++) {
+        hash_insert_passenger(state->passengers_table, passengers[i]);
+    }
+    for (int i = 0; i < reservation_count; i++) {
+        add_reservation_bst(state->reservations, reservations[i]);
+    }
+    
+    // Passengers never change after this, so readers can share the filter without a lock
+    if (engine_bloom_fp_rate() > 0.0) {
+        hash_enable_filter(state->passengers_table, engine_bloom_fp_rate());
+        reservation_bst_enable_filter(state->reservations, reservation_count, engine_bloom_fp_rate());
+    }
+    
+    engine->name = "Prototype 2 Concurrent (AVL Tree / Hash Table / BST, reader-writer locks)";
+    engine->state = state;
+    engine->find_flight = c_find_flight;
+    engine->find_flight_by_number = c_find_flight_by_number;
+    engine->find_passenger = c_find_passenger;
+    engine->find_passenger_by_name = c_find_passenger_by_name;
+    engine->count_passenger_bookings = c_count_passenger_bookings;
+    engine->passenger_reservations = c_passenger_reservations;
+    engine->flight_reservations = c_flight_reservations;
+    engine->list_flights = c_list_flights;
+    engine->count_flights = c_count_flights;
+    engine->book = c_book;
+    engine->cancel = c_cancel;
+    engine->destroy = c_destroy;
+    return engine;
+}
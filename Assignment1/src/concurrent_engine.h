@@ -0,0 +1,21 @@
+#ifndef CONCURRENT_ENGINE_H
+#define CONCURRENT_ENGINE_H
+
+#include "engine.h"
+
+// Reader slots of the engine's reader-writer lock. Each reader thread always uses the same
+// slot, so readers on different slots never touch the same cache line
+#define CONCURRENT_READER_SLOTS 16
+
+// Booking shards: bookings and cancellations on flights in the same shard are serialised
+#define CONCURRENT_FLIGHT_SHARDS 64
+
+// Build prototype 2 structures behind locks so any number of threads may call every engine
+// operation at once. Flight and passenger lookups take no lock (those structures are never
+// modified after the build); reservation reads share the reservation BST; bookings check
+// capacity under a per-flight-shard mutex and lock out readers only for the insert itself
+QueryEngine* create_concurrent_engine(const Flight* flights, int flight_count,
+                                      const Passenger* passengers, int passenger_count,
+                                      const ReservationRecord* reservations, int reservation_count);
+
+#endif
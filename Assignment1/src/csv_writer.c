@@ -0,0 +1,424 @@
+/*
+ * Buffered CSV Writer Implementation
+ * 
+ * Fast serialisation path for the generated datasets. Rows are formatted by hand into
+ * large reusable buffers instead of going through fprintf/strftime for every row, and
+ * blocks of rows can be formatted on several threads and written out in order.
+ * 
+ * Sources used:
+ * 1. The C Programming Language (K&R) - Buffered I/O and integer to string conversion
+ * 2. "Three Optimization Tips for C++" by Andrei Alexandrescu - Two-digit lookup table for integer formatting
+ * 3. POSIX Threads Programming (Lawrence Livermore National Laboratory) - pthread_create/join
+ */
+#define _CRT_SECURE_NO_DEPRECATE
+#define _POSIX_C_SOURCE 200809L  // For localtime_r and sysconf
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "csv_writer.h"
+
+#define SECONDS_PER_DAY (24 * 60 * 60)
+
+// "00" "01" ... "99" - lets us emit two digits per division
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Initialise a buffer with the given capacity (file may be NULL for an in-memory buffer)
+int output_buffer_init(OutputBuffer* buffer, FILE* file, size_t capacity) {
+    buffer->data = (char*)malloc(capacity);
+    if (buffer->data == NULL) {
+        fprintf(stderr, "Memory allocation failed for output buffer (%zu bytes)\n", capacity);
+        buffer->capacity = 0;
+        buffer->length = 0;
+        return 0;
+    }
+    buffer->capacity = capacity;
+    buffer->length = 0;
+    buffer->file = file;
+    return 1;
+}
+
+// Write any buffered bytes to the file. Returns 0 if the write was short
+int output_buffer_flush(OutputBuffer* buffer) {
+    int ok = 1;
+    if (buffer->file != NULL && buffer->length > 0) {
+        ok = fwrite(buffer->data, 1, buffer->length, buffer->file) == buffer->length;
+        buffer->length = 0;
+    }
+    return ok;
+}
+
+// Make sure at least `needed` more bytes fit (flushing or growing as required)
+int output_buffer_reserve(OutputBuffer* buffer, size_t needed) {
+    if (buffer->length + needed <= buffer->capacity) {
+        return 1;
+    }
+    
+    // File-backed buffers just drain to the file
+    if (buffer->file != NULL) {
+        if (!output_buffer_flush(buffer)) {
+            return 0;
+        }
+        if (needed <= buffer->capacity) {
+            return 1;
+        }
+    }
+    
+    // In-memory buffers (or oversized requests) grow by doubling
+    size_t new_capacity = buffer->capacity > 0 ? buffer->capacity : 4096;
+    while (new_capacity < buffer->length + needed) {
+        new_capacity *= 2;
+    }
+    char* new_data = (char*)realloc(buffer->data, new_capacity);
+    if (new_data == NULL) {
+        fprintf(stderr, "Memory allocation failed while growing output buffer to %zu bytes\n", new_capacity);
+        return 0;
+    }
+    buffer->data = new_data;
+    buffer->capacity = new_capacity;
+    return 1;
+}
+
+// Flush and release the buffer memory (does not close the file)
+void output_buffer_free(OutputBuffer* buffer) {
+    output_buffer_flush(buffer);
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->capacity = 0;
+    buffer->length = 0;
+}
+
+// Reset a date cache so the next lookup recomputes the day
+void date_cache_init(DateCache* cache) {
+    cache->day_start = 1;
+    cache->day_end = 0;  // Empty range: nothing is cached yet
+    cache->date[0] = '\0';
+}
+
+// Write exactly two digits
+static void put_two_digits(char* out, int value) {
+    out[0] = digit_pairs[value * 2];
+    out[1] = digit_pairs[value * 2 + 1];
+}
+
+// Format a signed integer, two digits at a time
+size_t csv_format_int(char* out, int value) {
+    char temp[12];
+    char* end = temp + sizeof(temp);
+    char* p = end;
+    unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+    
+    while (magnitude >= 100) {
+        unsigned int pair = magnitude % 100;
+        magnitude /= 100;
+        p -= 2;
+        put_two_digits(p, (int)pair);
+    }
+    if (magnitude >= 10) {
+        p -= 2;
+        put_two_digits(p, (int)magnitude);
+    } else {
+        *--p = (char)('0' + magnitude);
+    }
+    if (value < 0) {
+        *--p = '-';
+    }
+    
+    size_t length = (size_t)(end - p);
+    memcpy(out, p, length);
+    return length;
+}
+
+// Copy a NUL-terminated string without the terminator
+size_t csv_format_string(char* out, const char* value) {
+    size_t length = strlen(value);
+    memcpy(out, value, length);
+    return length;
+}
+
+// Recompute the cached local day containing `value`
+static void date_cache_load(DateCache* cache, time_t value) {
+    struct tm tm_info;
+    localtime_r(&value, &tm_info);
+    
+    put_two_digits(cache->date, (tm_info.tm_year + 1900) / 100);
+    put_two_digits(cache->date + 2, (tm_info.tm_year + 1900) % 100);
+    cache->date[4] = '-';
+    put_two_digits(cache->date + 5, tm_info.tm_mon + 1);
+    cache->date[7] = '-';
+    put_two_digits(cache->date + 8, tm_info.tm_mday);
+    cache->date[10] = '\0';
+    
+    // Local midnight today and tomorrow (mktime normalises tm_mday overflow)
+    tm_info.tm_hour = 0;
+    tm_info.tm_min = 0;
+    tm_info.tm_sec = 0;
+    tm_info.tm_isdst = -1;
+    cache->day_start = mktime(&tm_info);
+    tm_info.tm_mday += 1;
+    tm_info.tm_isdst = -1;
+    cache->day_end = mktime(&tm_info);
+}
+
+// Format YYYY-MM-DD, reusing the cached day when possible
+size_t csv_format_date(char* out, DateCache* cache, time_t value) {
+    if (value < cache->day_start || value >= cache->day_end) {
+        date_cache_load(cache, value);
+    }
+    memcpy(out, cache->date, 10);
+    return 10;
+}
+
+// Format YYYY-MM-DD HH:MM:SS, reusing the cached day when possible
+size_t csv_format_datetime(char* out, DateCache* cache, time_t value) {
+    csv_format_date(out, cache, value);
+    out[10] = ' ';
+    
+    int hour, minute, second;
+    if (cache->day_end - cache->day_start == SECONDS_PER_DAY) {
+        // Ordinary day: the time of day is just the offset from midnight
+        int offset = (int)(value - cache->day_start);
+        hour = offset / 3600;
+        minute = (offset / 60) % 60;
+        second = offset % 60;
+    } else {
+        // Daylight saving changes on this day, so ask the C library
+        struct tm tm_info;
+        localtime_r(&value, &tm_info);
+        hour = tm_info.tm_hour;
+        minute = tm_info.tm_min;
+        second = tm_info.tm_sec;
+    }
+    
+    put_two_digits(out + 11, hour);
+    out[13] = ':';
+    put_two_digits(out + 14, minute);
+    out[16] = ':';
+    put_two_digits(out + 17, second);
+    return 19;
+}
+
+// Format one flight row: id,flightNumber,origin,destination,departureTime,capacity
+size_t csv_format_flight_row(char* out, const Flight* flight, DateCache* cache) {
+    char* p = out;
+    p += csv_format_int(p, flight->id);
+    *p++ = ',';
+    p += csv_format_string(p, flight->flightNumber);
+    *p++ = ',';
+    p += csv_format_string(p, flight->origin);
+    *p++ = ',';
+    p += csv_format_string(p, flight->destination);
+    *p++ = ',';
+    p += csv_format_datetime(p, cache, flight->departureTime);
+    *p++ = ',';
+    p += csv_format_int(p, flight->capacity);
+    *p++ = '\n';
+    return (size_t)(p - out);
+}
+
+// Format one passenger row: id,name,passportNumber
+size_t csv_format_passenger_row(char* out, const Passenger* passenger) {
+    char* p = out;
+    p += csv_format_int(p, passenger->id);
+    *p++ = ',';
+    p += csv_format_string(p, passenger->name);
+    *p++ = ',';
+    p += csv_format_string(p, passenger->passportNumber);
+    *p++ = '\n';
+    return (size_t)(p - out);
+}
+
+// Format one reservation row: flightId,passengerId,bookingDate,seatNumber
+size_t csv_format_reservation_row(char* out, const ReservationRecord* record, DateCache* cache) {
+    char* p = out;
+    p += csv_format_int(p, record->flightId);
+    *p++ = ',';
+    p += csv_format_int(p, record->passengerId);
+    *p++ = ',';
+    p += csv_format_datetime(p, cache, record->bookingDate);
+    *p++ = ',';
+    p += csv_format_string(p, record->seatNumber);
+    *p++ = '\n';
+    return (size_t)(p - out);
+}
+
+//--- TABLE WRITERS ---//
+
+// Row formatter with a common signature so one writer handles all three tables
+typedef size_t (*RowFormatter)(char* out, const void* row, DateCache* cache);
+
+static size_t format_flight_any(char* out, const void* row, DateCache* cache) {
+    return csv_format_flight_row(out, (const Flight*)row, cache);
+}
+
+static size_t format_passenger_any(char* out, const void* row, DateCache* cache) {
+    (void)cache;
+    return csv_format_passenger_row(out, (const Passenger*)row);
+}
+
+static size_t format_reservation_any(char* out, const void* row, DateCache* cache) {
+    return csv_format_reservation_row(out, (const ReservationRecord*)row, cache);
+}
+
+// One block of rows handed to a formatting thread
+typedef struct {
+    const char* rows;
+    size_t row_size;
+    int first;
+    int last;
+    RowFormatter formatter;
+    OutputBuffer buffer;  // Reused across rounds
+    DateCache cache;      // Per thread, so no sharing between formatters
+    int ok;
+} FormatBlock;
+
+// Format rows [first, last) of a block into its in-memory buffer
+static void* format_block(void* arg) {
+    FormatBlock* block = (FormatBlock*)arg;
+    block->buffer.length = 0;
+    block->ok = output_buffer_reserve(&block->buffer, (size_t)(block->last - block->first) * CSV_MAX_ROW_LENGTH);
+    if (!block->ok) {
+        return NULL;
+    }
+    
+    char* p = block->buffer.data;
+    for (int i = block->first; i < block->last; i++) {
+        p += block->formatter(p, block->rows + (size_t)i * block->row_size, &block->cache);
+    }
+    block->buffer.length = (size_t)(p - block->buffer.data);
+    return NULL;
+}
+
+// Write a header line and all rows, formatting blocks on `threads` threads and
+// writing them to the file in their original order
+static long long write_table(FILE* file, const char* header, const void* rows, size_t row_size,
+                             int count, RowFormatter formatter, int threads) {
+    long long total = 0;
+    size_t header_length = strlen(header);
+    if (fwrite(header, 1, header_length, file) != header_length) {
+        return -1;
+    }
+    total += (long long)header_length;
+    
+    if (threads < 1) threads = 1;
+    
+    // Single-threaded path: format straight into one big file-backed buffer
+    if (threads == 1) {
+        OutputBuffer buffer;
+        DateCache cache;
+        if (!output_buffer_init(&buffer, file, OUTPUT_BUFFER_SIZE)) {
+            return -1;
+        }
+        date_cache_init(&cache);
+        const char* row = (const char*)rows;
+        int ok = 1;
+        for (int i = 0; i < count; i++) {
+            ok = output_buffer_reserve(&buffer, CSV_MAX_ROW_LENGTH);
+            if (!ok) break;
+            size_t length = formatter(buffer.data + buffer.length, row, &cache);
+            buffer.length += length;
+            total += (long long)length;
+            row += row_size;
+        }
+        ok = ok && output_buffer_flush(&buffer);
+        output_buffer_free(&buffer);
+        return ok ? total : -1;
+    }
+    
+    // Parallel path: each round formats up to `threads` blocks concurrently
+    FormatBlock* blocks = (FormatBlock*)calloc(threads, sizeof(FormatBlock));
+    pthread_t* workers = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    int* started = (int*)calloc(threads, sizeof(int));
+    if (blocks == NULL || workers == NULL || started == NULL) {
+        fprintf(stderr, "Memory allocation failed for CSV formatting threads\n");
+        free(blocks);
+        free(workers);
+        free(started);
+        return -1;
+    }
+    for (int t = 0; t < threads; t++) {
+        blocks[t].rows = (const char*)rows;
+        blocks[t].row_size = row_size;
+        blocks[t].formatter = formatter;
+        output_buffer_init(&blocks[t].buffer, NULL, (size_t)CSV_BLOCK_ROWS * CSV_MAX_ROW_LENGTH);
+        date_cache_init(&blocks[t].cache);
+    }
+    
+    int next_row = 0;
+    int failed = 0;
+    while (next_row < count && !failed) {
+        int active = 0;
+        for (int t = 0; t < threads && next_row < count; t++) {
+            blocks[t].first = next_row;
+            blocks[t].last = next_row + CSV_BLOCK_ROWS < count ? next_row + CSV_BLOCK_ROWS : count;
+            next_row = blocks[t].last;
+            
+            // Fall back to formatting on this thread if a worker can't be started
+            started[t] = pthread_create(&workers[t], NULL, format_block, &blocks[t]) == 0;
+            if (!started[t]) {
+                format_block(&blocks[t]);
+            }
+            active++;
+        }
+        
+        // Merge in order: wait for each block and write it before the next
+        for (int t = 0; t < active; t++) {
+            if (started[t]) {
+                pthread_join(workers[t], NULL);
+            }
+            if (failed || !blocks[t].ok ||
+                fwrite(blocks[t].buffer.data, 1, blocks[t].buffer.length, file) != blocks[t].buffer.length) {
+                failed = 1;
+                continue;
+            }
+            total += (long long)blocks[t].buffer.length;
+        }
+    }
+    
+    for (int t = 0; t < threads; t++) {
+        free(blocks[t].buffer.data);
+    }
+    free(blocks);
+    free(workers);
+    free(started);
+    return failed ? -1 : total;
+}
+
+// Write all flights as CSV
+long long write_flights_csv(FILE* file, const Flight* flights, int count, int threads) {
+    return write_table(file, "id,flightNumber,origin,destination,departureTime,capacity\n",
+                       flights, sizeof(Flight), count, format_flight_any, threads);
+}
+
+// Write all passengers as CSV
+long long write_passengers_csv(FILE* file, const Passenger* passengers, int count, int threads) {
+    return write_table(file, "id,name,passportNumber\n",
+                       passengers, sizeof(Passenger), count, format_passenger_any, threads);
+}
+
+// Write all reservations as CSV
+long long write_reservations_csv(FILE* file, const ReservationRecord* reservations, int count, int threads) {
+    return write_table(file, "flightId,passengerId,bookingDate,seatNumber\n",
+                       reservations, sizeof(ReservationRecord), count, format_reservation_any, threads);
+}
+
+// Number of formatting threads used by save_data_to_csv
+int csv_writer_default_threads() {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) return 1;
+    if (cpus > 8) return 8;  // Formatting outruns the disk well before this
+    return (int)cpus;
+}
@@ -0,0 +1,73 @@
+#ifndef CSV_WRITER_H
+#define CSV_WRITER_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <time.h>
+#include "airline_types.h"
+
+// Default size of a reusable output buffer (bytes)
+#define OUTPUT_BUFFER_SIZE (4 * 1024 * 1024)
+
+// Upper bound on the length of one formatted CSV row (bytes)
+#define CSV_MAX_ROW_LENGTH 256
+
+// Rows formatted per block when formatting in parallel
+#define CSV_BLOCK_ROWS 65536
+
+// Growable output buffer. When file is NULL the buffer just grows in memory,
+// otherwise it is flushed to the file whenever it fills up
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+    FILE* file;
+} OutputBuffer;
+
+// Cache of the formatted calendar day, so rows on the same day skip localtime/strftime
+typedef struct {
+    time_t day_start;  // Local midnight of the cached day
+    time_t day_end;    // Local midnight of the next day
+    char date[11];     // "YYYY-MM-DD"
+} DateCache;
+
+// Initialise a buffer with the given capacity (file may be NULL for an in-memory buffer)
+// Returns 1 on success, 0 on failure
+int output_buffer_init(OutputBuffer* buffer, FILE* file, size_t capacity);
+
+// Make sure at least `needed` more bytes fit (flushing or growing as required)
+// Returns 1 on success, 0 on failure
+int output_buffer_reserve(OutputBuffer* buffer, size_t needed);
+
+// Write any buffered bytes to the file
+// Returns 1 on success, 0 if the write was short
+int output_buffer_flush(OutputBuffer* buffer);
+
+// Flush and release the buffer memory (does not close the file)
+void output_buffer_free(OutputBuffer* buffer);
+
+// Reset a date cache so the next lookup recomputes the day
+void date_cache_init(DateCache* cache);
+
+// Formatting primitives - the caller must reserve enough space first.
+// Each returns the number of bytes written at `out`
+size_t csv_format_int(char* out, int value);
+size_t csv_format_string(char* out, const char* value);
+size_t csv_format_date(char* out, DateCache* cache, time_t value);      // YYYY-MM-DD
+size_t csv_format_datetime(char* out, DateCache* cache, time_t value);  // YYYY-MM-DD HH:MM:SS
+
+// Format one CSV row (including the trailing newline). Returns bytes written
+size_t csv_format_flight_row(char* out, const Flight* flight, DateCache* cache);
+size_t csv_format_passenger_row(char* out, const Passenger* passenger);
+size_t csv_format_reservation_row(char* out, const ReservationRecord* record, DateCache* cache);
+
+// Write whole tables as CSV (with header) using reusable buffers and `threads` formatting
+// threads (1 = format on the calling thread). Returns bytes written, or -1 on failure
+long long write_flights_csv(FILE* file, const Flight* flights, int count, int threads);
+long long write_passengers_csv(FILE* file, const Passenger* passengers, int count, int threads);
+long long write_reservations_csv(FILE* file, const ReservationRecord* reservations, int count, int threads);
+
+// Number of formatting threads used by save_data_to_csv
+int csv_writer_default_threads();
+
+#endif
@@ -12,8 +12,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <math.h>
 #include "airline_types.h"
 #include "data_generator.h"
+#include "csv_writer.h"
 
 // Constants for random generation
 #define NUM_AIRLINES 12
@@ -84,7 +86,7 @@ void generate_person_name(char* name, int max_length) {
 }
 
 // Generate flights data with given count
-Flight* generate_flights(int count) {
+Flight* generate_flights(int count, time_t reference_time) {
     // Allocate memory for flights
     Flight* flights = (Flight*)malloc(count * sizeof(Flight));
     if (flights == NULL) {
@@ -111,9 +113,8 @@ Flight* generate_flights(int count) {
         strncpy(flights[i].destination, cities[dest_idx], sizeof(flights[i].destination)-1);
         flights[i].destination[sizeof(flights[i].destination)-1] = '\0';
         
-        // Random departure time (within next year)
-        time_t now = time(NULL);
-        flights[i].departureTime = now + (rand() % (365 * 24 * 60 * 60));
+        // Random departure time (within the year after the reference time)
+        flights[i].departureTime = reference_time + (rand() % (365 * 24 * 60 * 60));
         
         // Random capacity between MIN_CAPACITY and MAX_CAPACITY
         flights[i].capacity = MIN_CAPACITY + (rand() % (MAX_CAPACITY - MIN_CAPACITY + 1));
@@ -149,7 +150,7 @@ Passenger* generate_passengers(int count) {
 }
 
 // Generate reservation records with given count and ID ranges
-ReservationRecord* generate_reservations(int count, int max_flight_id, int max_passenger_id) {
+ReservationRecord* generate_reservations(int count, int max_flight_id, int max_passenger_id, time_t reference_time) {
     // Allocate memory for reservation records
     ReservationRecord* reservations = (ReservationRecord*)malloc(count * sizeof(ReservationRecord));
     if (reservations == NULL) {
@@ -212,9 +213,8 @@ ReservationRecord* generate_reservations(int count, int max_flight_id, int max_p
             reservations[reservation_index].flightId = flight_id;
             reservations[reservation_index].passengerId = passenger_id;
             
-            // Random booking date (within past year)
-            time_t now = time(NULL);
-            reservations[reservation_index].bookingDate = now - (rand() % (365 * 24 * 60 * 60));
+            // Random booking date (within the year before the reference time)
+            reservations[reservation_index].bookingDate = reference_time - (rand() % (365 * 24 * 60 * 60));
             
             // Generate a random seat number
             generate_seat_number(reservations[reservation_index].seatNumber, 
@@ -314,9 +314,8 @@ ReservationRecord* generate_reservations(int count, int max_flight_id, int max_p
             reservations[reservation_index].flightId = flight_id;
             reservations[reservation_index].passengerId = passenger_id;
             
-            // Random booking date (within past year)
-            time_t now = time(NULL);
-            reservations[reservation_index].bookingDate = now - (rand() % (365 * 24 * 60 * 60));
+            // Random booking date (within the year before the reference time)
+            reservations[reservation_index].bookingDate = reference_time - (rand() % (365 * 24 * 60 * 60));
             
             // Generate a random seat number
             generate_seat_number(reservations[reservation_index].seatNumber, 
@@ -348,9 +347,8 @@ ReservationRecord* generate_reservations(int count, int max_flight_id, int max_p
             }
         } while (!flight_bookings[flight_index].assigned_passengers[passenger_id - 2000]);
         
-        // Random booking date (within past year)
-        time_t now = time(NULL);
-        reservations[reservation_index].bookingDate = now - (rand() % (365 * 24 * 60 * 60));
+        // Random booking date (within the year before the reference time)
+        reservations[reservation_index].bookingDate = reference_time - (rand() % (365 * 24 * 60 * 60));
         
         // Generate a random seat number
         generate_seat_number(reservations[reservation_index].seatNumber, 
@@ -371,92 +369,320 @@ ReservationRecord* generate_reservations(int count, int max_flight_id, int max_p
     return reservations;
 }
 
-// Format time_t to a date string (YYYY-MM-DD format)
-void format_date(time_t time_value, char* buffer, int buffer_size) {
-    struct tm* tm_info = localtime(&time_value);
-    strftime(buffer, buffer_size, "%Y-%m-%d", tm_info);
+//--- SKEWED WORKLOAD GENERATION ---//
+
+#define SECONDS_PER_DAY (24 * 60 * 60)
+
+// Uniform random number in (0, 1), combining two rand() calls so the resolution
+// is good enough for large CDF tables even where RAND_MAX is only 32767
+double generator_random_unit() {
+    double range = (double)RAND_MAX + 1.0;
+    return ((double)rand() * range + (double)rand() + 0.5) / (range * range);
 }
 
-// Save generated data to CSV files
-void save_data_to_csv(Flight* flights, int flight_count, 
-                     Passenger* passengers, int passenger_count, 
-                     ReservationRecord* reservations, int reservation_count,
-                     const char* output_dir) {
-    char filepath[256];
-    FILE* file;
-    
-    // Save flights
-    snprintf(filepath, sizeof(filepath), "%s/flights.csv", output_dir);
-    file = fopen(filepath, "w");
-    if (file) {
-        // Write header
-        fprintf(file, "id,flightNumber,origin,destination,departureTime,capacity\n");
-        
-        // Write data
-        for (int i = 0; i < flight_count; i++) {
-            char departure_str[20];
-            struct tm* tm_info = localtime(&flights[i].departureTime);
-            strftime(departure_str, sizeof(departure_str), "%Y-%m-%d %H:%M:%S", tm_info);
-            
-            fprintf(file, "%d,%s,%s,%s,%s,%d\n", 
-                   flights[i].id, 
-                   flights[i].flightNumber,
-                   flights[i].origin,
-                   flights[i].destination,
-                   departure_str,
-                   flights[i].capacity);
+// Find the first CDF entry >= u (binary search)
+int generator_sample_cdf(const double* cdf, int n, double u) {
+    int low = 0;
+    int high = n - 1;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (cdf[mid] < u) {
+            low = mid + 1;
+        } else {
+            high = mid;
         }
-        
-        fclose(file);
-        printf("Generated %d flights and saved to %s\n", flight_count, filepath);
-    } else {
-        fprintf(stderr, "Could not open file %s for writing\n", filepath);
+    }
+    return low;
+}
+
+// Normalise an array of weights into a cumulative distribution in place
+static void weights_to_cdf(double* weights, int n) {
+    double total = 0.0;
+    for (int i = 0; i < n; i++) {
+        total += weights[i];
+        weights[i] = total;
+    }
+    for (int i = 0; i < n; i++) {
+        weights[i] /= total;
+    }
+    weights[n - 1] = 1.0;
+}
+
+// Build a Zipf CDF over n ranks with the given exponent (0 = uniform). Caller frees
+double* generator_zipf_cdf(int n, double exponent) {
+    double* cdf = (double*)malloc(n * sizeof(double));
+    if (cdf == NULL) {
+        fprintf(stderr, "Memory allocation failed for Zipf table (%d entries)\n", n);
+        return NULL;
+    }
+    for (int i = 0; i < n; i++) {
+        cdf[i] = 1.0 / pow(i + 1, exponent);
+    }
+    weights_to_cdf(cdf, n);
+    return cdf;
+}
+
+// Default settings for the uniform generator, with the current time as the reference time
+GeneratorConfig uniform_generator_config() {
+    GeneratorConfig config;
+    config.skewed = 0;
+    config.seed = 1;
+    config.reference_time = time(NULL);
+    config.flight_zipf_exponent = 0.0;
+    config.passenger_pareto_alpha = 0.0;
+    config.booking_lead_mean_days = 0.0;
+    config.booking_window_days = DATE_RANGE_DAYS;
+    config.name_cluster_fraction = 0.0;
+    config.name_cluster_count = 0;
+    return config;
+}
+
+// Default settings for the skewed generator, with the current time as the reference time
+GeneratorConfig skewed_generator_config() {
+    GeneratorConfig config;
+    config.skewed = 1;
+    config.seed = 205;
+    config.reference_time = time(NULL);
+    config.flight_zipf_exponent = 1.0;    // Classic Zipf: the top flight gets ~1/H(n) of bookings
+    config.passenger_pareto_alpha = 1.5;  // Finite mean, infinite variance: a few frequent flyers
+    config.booking_lead_mean_days = 21.0; // Most bookings land in the three weeks before departure
+    config.booking_window_days = 330;
+    config.name_cluster_fraction = 0.05;
+    config.name_cluster_count = 8;
+    return config;
+}
+
+// Generate passengers where a fraction of them share a small set of repeated names
+Passenger* generate_passengers_clustered(int count, const GeneratorConfig* config) {
+    Passenger* passengers = generate_passengers(count);
+    if (passengers == NULL || config == NULL || config->name_cluster_count <= 0 ||
+        config->name_cluster_fraction <= 0.0) {
+        return passengers;
     }
     
-    // Save passengers
-    snprintf(filepath, sizeof(filepath), "%s/passengers.csv", output_dir);
-    file = fopen(filepath, "w");
-    if (file) {
-        // Write header
-        fprintf(file, "id,name,passportNumber\n");
-        
-        // Write data
-        for (int i = 0; i < passenger_count; i++) {
-            fprintf(file, "%d,%s,%s\n", 
-                   passengers[i].id, 
-                   passengers[i].name,
-                   passengers[i].passportNumber);
+    // Pick the clustered names up front so every cluster member gets an identical name
+    int cluster_count = config->name_cluster_count;
+    char (*cluster_names)[MAX_PASSENGER_NAME_LENGTH] = malloc(cluster_count * sizeof(*cluster_names));
+    if (cluster_names == NULL) {
+        fprintf(stderr, "Memory allocation failed for name clusters\n");
+        return passengers;
+    }
+    for (int i = 0; i < cluster_count; i++) {
+        generate_person_name(cluster_names[i], MAX_PASSENGER_NAME_LENGTH);
+    }
+    
+    // Cluster sizes follow a Zipf(1) shape, so the first name is the most common
+    double* cluster_cdf = (double*)malloc(cluster_count * sizeof(double));
+    if (cluster_cdf == NULL) {
+        fprintf(stderr, "Memory allocation failed for name clusters\n");
+        free(cluster_names);
+        return passengers;
+    }
+    for (int i = 0; i < cluster_count; i++) {
+        cluster_cdf[i] = 1.0 / (i + 1);
+    }
+    weights_to_cdf(cluster_cdf, cluster_count);
+    
+    for (int i = 0; i < count; i++) {
+        if (generator_random_unit() < config->name_cluster_fraction) {
+            int cluster = generator_sample_cdf(cluster_cdf, cluster_count, generator_random_unit());
+            strncpy(passengers[i].name, cluster_names[cluster], sizeof(passengers[i].name) - 1);
+            passengers[i].name[sizeof(passengers[i].name) - 1] = '\0';
         }
-        
-        fclose(file);
-        printf("Generated %d passengers and saved to %s\n", passenger_count, filepath);
-    } else {
-        fprintf(stderr, "Could not open file %s for writing\n", filepath);
     }
     
-    // Save reservations
-    snprintf(filepath, sizeof(filepath), "%s/reservations.csv", output_dir);
-    file = fopen(filepath, "w");
-    if (file) {
-        // Write header
-        fprintf(file, "flightId,passengerId,bookingDate,seatNumber\n");
+    free(cluster_cdf);
+    free(cluster_names);
+    return passengers;
+}
+
+// Generate reservations with Zipf flight popularity, heavy-tailed bookings per passenger
+// and booking dates clustered before departure
+ReservationRecord* generate_reservations_skewed(int count, Flight* flights, int flight_count,
+                                                int passenger_count, const GeneratorConfig* config,
+                                                int* generated_count) {
+    *generated_count = 0;
+    if (flights == NULL || flight_count <= 0 || passenger_count <= 0 || count <= 0 || config == NULL) {
+        return NULL;
+    }
+    
+    ReservationRecord* reservations = (ReservationRecord*)malloc(count * sizeof(ReservationRecord));
+    double* flight_cdf = (double*)malloc(flight_count * sizeof(double));
+    int* flight_by_rank = (int*)malloc(flight_count * sizeof(int));
+    int* booked = (int*)calloc(flight_count, sizeof(int));
+    double* passenger_cdf = (double*)malloc(passenger_count * sizeof(double));
+    
+    if (reservations == NULL || flight_cdf == NULL || flight_by_rank == NULL ||
+        booked == NULL || passenger_cdf == NULL) {
+        fprintf(stderr, "Memory allocation failed for skewed reservation generation\n");
+        free(reservations);
+        free(flight_cdf);
+        free(flight_by_rank);
+        free(booked);
+        free(passenger_cdf);
+        return NULL;
+    }
+    
+    // Zipf popularity by rank; ranks are shuffled onto flights so hot flights are
+    // spread across the ID space rather than being the lowest IDs
+    for (int i = 0; i < flight_count; i++) {
+        flight_cdf[i] = 1.0 / pow(i + 1, config->flight_zipf_exponent);
+        flight_by_rank[i] = i;
+    }
+    weights_to_cdf(flight_cdf, flight_count);
+    for (int i = flight_count - 1; i > 0; i--) {
+        int j = (int)(generator_random_unit() * (i + 1));
+        int tmp = flight_by_rank[i];
+        flight_by_rank[i] = flight_by_rank[j];
+        flight_by_rank[j] = tmp;
+    }
+    
+    // Pareto-distributed booking propensity per passenger (frequent flyers)
+    for (int i = 0; i < passenger_count; i++) {
+        if (config->passenger_pareto_alpha > 0.0) {
+            passenger_cdf[i] = pow(generator_random_unit(), -1.0 / config->passenger_pareto_alpha);
+        } else {
+            passenger_cdf[i] = 1.0;
+        }
+    }
+    weights_to_cdf(passenger_cdf, passenger_count);
+    
+    int generated = 0;
+    int full_flights = 0;
+    while (generated < count && full_flights < flight_count) {
+        // Sample a flight; if it is already full, fall through to the next flight with seats
+        int rank = generator_sample_cdf(flight_cdf, flight_count, generator_random_unit());
+        int flight_index = flight_by_rank[rank];
+        int probes = 0;
+        while (booked[flight_index] >= flights[flight_index].capacity && probes < flight_count) {
+            rank = (rank + 1) % flight_count;
+            flight_index = flight_by_rank[rank];
+            probes++;
+        }
         
-        // Write data
-        for (int i = 0; i < reservation_count; i++) {
-            char booking_date_str[20]; // YYYY-MM-DD HH:MM:SS + null terminator
-            
-            format_date(reservations[i].bookingDate, booking_date_str, sizeof(booking_date_str));
-            
-            fprintf(file, "%d,%d,%s,%s\n", 
-                   reservations[i].flightId, 
-                   reservations[i].passengerId,
-                   booking_date_str,
-                   reservations[i].seatNumber);
+        Flight* flight = &flights[flight_index];
+        ReservationRecord* record = &reservations[generated];
+        record->flightId = flight->id;
+        record->passengerId = 2000 + generator_sample_cdf(passenger_cdf, passenger_count, generator_random_unit());
+        
+        // Booking curve: exponential lead time before departure, capped by the booking window
+        double lead_days = config->booking_window_days * generator_random_unit();
+        if (config->booking_lead_mean_days > 0.0) {
+            lead_days = -config->booking_lead_mean_days * log(generator_random_unit());
+            if (lead_days > config->booking_window_days) {
+                lead_days = config->booking_window_days * generator_random_unit();
+            }
         }
+        record->bookingDate = flight->departureTime - (time_t)(lead_days * SECONDS_PER_DAY);
+        
+        generate_seat_number(record->seatNumber, sizeof(record->seatNumber));
         
-        fclose(file);
-        printf("Generated %d reservation records and saved to %s\n", reservation_count, filepath);
-    } else {
+        booked[flight_index]++;
+        if (booked[flight_index] == flight->capacity) {
+            full_flights++;
+        }
+        generated++;
+    }
+    
+    if (generated < count) {
+        fprintf(stderr, "All flights are full: generated %d of %d requested reservations\n",
+                generated, count);
+    }
+    
+    free(flight_cdf);
+    free(flight_by_rank);
+    free(booked);
+    free(passenger_cdf);
+    
+    *generated_count = generated;
+    return reservations;
+}
+
+// Write the generator parameters to <output_dir>/manifest.txt so a dataset can be reproduced
+int save_generator_manifest(const GeneratorConfig* config, int flight_count, int passenger_count,
+                            int reservation_count, const char* output_dir) {
+    char filepath[256];
+    snprintf(filepath, sizeof(filepath), "%s/manifest.txt", output_dir);
+    
+    FILE* file = fopen(filepath, "w");
+    if (file == NULL) {
         fprintf(stderr, "Could not open file %s for writing\n", filepath);
+        return 0;
     }
+    
+    time_t now = time(NULL);
+    char created[32];
+    strftime(created, sizeof(created), "%Y-%m-%d %H:%M:%S", localtime(&now));
+    
+    fprintf(file, "# Airline reservation dataset manifest\n");
+    fprintf(file, "created=%s\n", created);
+    fprintf(file, "distribution=%s\n", config->skewed ? "skewed" : "uniform");
+    fprintf(file, "seed=%u\n", config->seed);
+    fprintf(file, "reference_time=%lld\n", (long long)config->reference_time);
+    fprintf(file, "flights=%d\n", flight_count);
+    fprintf(file, "passengers=%d\n", passenger_count);
+    fprintf(file, "reservations=%d\n", reservation_count);
+    fprintf(file, "flight_zipf_exponent=%.4f\n", config->flight_zipf_exponent);
+    fprintf(file, "passenger_pareto_alpha=%.4f\n", config->passenger_pareto_alpha);
+    fprintf(file, "booking_lead_mean_days=%.4f\n", config->booking_lead_mean_days);
+    fprintf(file, "booking_window_days=%d\n", config->booking_window_days);
+    fprintf(file, "name_cluster_fraction=%.4f\n", config->name_cluster_fraction);
+    fprintf(file, "name_cluster_count=%d\n", config->name_cluster_count);
+    
+    fclose(file);
+    printf("Dataset manifest saved to %s\n", filepath);
+    return 1;
+}
+
+// Save one table through the buffered CSV writer and report throughput
+static void save_table_csv(const char* output_dir, const char* filename, const char* label, int count,
+                           long long (*writer)(FILE*, const void*, int, int), const void* rows) {
+    char filepath[256];
+    snprintf(filepath, sizeof(filepath), "%s/%s", output_dir, filename);
+    FILE* file = fopen(filepath, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Could not open file %s for writing\n", filepath);
+        return;
+    }
+    
+    struct timespec start, end;
+    timespec_get(&start, TIME_UTC);
+    long long bytes = writer(file, rows, count, csv_writer_default_threads());
+    if (fclose(file) != 0) {
+        bytes = -1;
+    }
+    timespec_get(&end, TIME_UTC);
+    
+    if (bytes < 0) {
+        fprintf(stderr, "Error writing %s\n", filepath);
+        return;
+    }
+    
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("Generated %d %s and saved to %s (%.1f MB/s)\n", count, label, filepath,
+           seconds > 0 ? bytes / seconds / (1024.0 * 1024.0) : 0.0);
+}
+
+// Adapters so the typed writers fit save_table_csv
+static long long write_flights_any(FILE* file, const void* rows, int count, int threads) {
+    return write_flights_csv(file, (const Flight*)rows, count, threads);
+}
+
+static long long write_passengers_any(FILE* file, const void* rows, int count, int threads) {
+    return write_passengers_csv(file, (const Passenger*)rows, count, threads);
+}
+
+static long long write_reservations_any(FILE* file, const void* rows, int count, int threads) {
+    return write_reservations_csv(file, (const ReservationRecord*)rows, count, threads);
+}
+
+// Save generated data to CSV files
+void save_data_to_csv(Flight* flights, int flight_count, 
+                     Passenger* passengers, int passenger_count, 
+                     ReservationRecord* reservations, int reservation_count,
+                     const char* output_dir) {
+    save_table_csv(output_dir, "flights.csv", "flights", flight_count, write_flights_any, flights);
+    save_table_csv(output_dir, "passengers.csv", "passengers", passenger_count, write_passengers_any, passengers);
+    save_table_csv(output_dir, "reservations.csv", "reservation records", reservation_count,
+                   write_reservations_any, reservations);
 }
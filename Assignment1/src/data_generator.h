@@ -3,14 +3,27 @@
 
 #include "airline_types.h"
 
-// Generate flights data with given count
-Flight* generate_flights(int count);
+// Distribution settings for skewed (production-like) workload generation
+typedef struct {
+    int skewed;                      // 0 = uniform generator, 1 = skewed distributions below
+    unsigned int seed;               // Seed passed to srand() so datasets can be reproduced
+    time_t reference_time;           // Departures and booking dates are offsets from this time
+    double flight_zipf_exponent;     // Zipf exponent for flight popularity (0 = uniform)
+    double passenger_pareto_alpha;   // Pareto tail index for bookings per passenger (0 = uniform)
+    double booking_lead_mean_days;   // Mean days between booking and departure (exponential curve)
+    int booking_window_days;         // Bookings are made at most this many days before departure
+    double name_cluster_fraction;    // Fraction of passengers that share a clustered name
+    int name_cluster_count;          // Number of distinct clustered names
+} GeneratorConfig;
+
+// Generate flights data with given count, departing in the year after reference_time
+Flight* generate_flights(int count, time_t reference_time);
 
 // Generate passengers data with given count
 Passenger* generate_passengers(int count);
 
-// Generate reservation records with given count
-ReservationRecord* generate_reservations(int count, int max_flight_id, int max_passenger_id);
+// Generate reservation records with given count, booked in the year before reference_time
+ReservationRecord* generate_reservations(int count, int max_flight_id, int max_passenger_id, time_t reference_time);
 
 // Generate a random flight number
 void generate_flight_number(char* flight_number, int max_length);
@@ -21,6 +34,36 @@ void generate_seat_number(char* seat_number, int max_length);
 // Generate a random person name
 void generate_person_name(char* name, int max_length);
 
+// Uniform random number in (0, 1) built from rand()
+double generator_random_unit();
+
+// Index of the first CDF entry >= u (binary search)
+int generator_sample_cdf(const double* cdf, int n, double u);
+
+// Build a Zipf CDF over n ranks with the given exponent (0 = uniform). Caller frees
+double* generator_zipf_cdf(int n, double exponent);
+
+// Default settings for the uniform generator, with the current time as the reference time
+GeneratorConfig uniform_generator_config();
+
+// Default settings for the skewed generator, with the current time as the reference time
+GeneratorConfig skewed_generator_config();
+
+// Generate passengers where a fraction of them share a small set of repeated names
+Passenger* generate_passengers_clustered(int count, const GeneratorConfig* config);
+
+// Generate reservations with Zipf flight popularity, heavy-tailed bookings per passenger
+// and booking dates clustered before departure. Passenger IDs are 2000..2000+passenger_count-1.
+// Stops early once every flight is full; *generated_count is the number actually generated
+ReservationRecord* generate_reservations_skewed(int count, Flight* flights, int flight_count,
+                                                int passenger_count, const GeneratorConfig* config,
+                                                int* generated_count);
+
+// Write the generator parameters to <output_dir>/manifest.txt so a dataset can be reproduced
+// Returns 1 on success, 0 on failure
+int save_generator_manifest(const GeneratorConfig* config, int flight_count, int passenger_count,
+                            int reservation_count, const char* output_dir);
+
 // Save generated data to CSV files
 void save_data_to_csv(Flight* flights, int flight_count, 
                       Passenger* passengers, int passenger_count, 
@@ -0,0 +1,316 @@
+/*
+ * Query Engine Implementation
+ * 
+ * Adapts prototype 1 and prototype 2 to the common QueryEngine interface.
+ * Each engine owns its own copy of the data structures, so replaying bookings
+ * and cancellations never disturbs the structures used by the interactive menu.
+ * 
+ * Sources used:
+ * 1. "C Interfaces and Implementations" by David R. Hanson - Function-pointer interfaces in C
+ * 2. The C Programming Language (K&R) - Structures and pointers to functions
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "engine.h"
+#include "concurrent_engine.h"
+#include "sharded_engine.h"
+#include "prototype1/flight_management.h"
+#include "prototype1/passenger_management.h"
+#include "prototype1/reservation_management.h"
+#include "prototype1/flight_search.h"
+#include "prototype1/passenger_search.h"
+#include "prototype2/flight_management_avl.h"
+#include "prototype2/passenger_management_hash.h"
+#include "prototype2/reservation_management_bst.h"
+#include "prototype2/flight_search_avl.h"
+#include "prototype2/passenger_search_hash.h"
+
+// False-positive rate of the Bloom filters of new prototype 2 engines (0 for none)
+static double bloom_fp_rate = 0.0;
+
+// Set the false-positive rate of new engines' Bloom filters
+void engine_set_bloom_fp_rate(double fp_rate) {
+    bloom_fp_rate = fp_rate;
+}
+
+// Get the false-positive rate of new engines' Bloom filters
+double engine_bloom_fp_rate() {
+    return bloom_fp_rate;
+}
+
+//--- PROTOTYPE 1 ---//
+
+typedef struct {
+    BST_Node* flights_root;
+    LL_Node* passengers_head;
+    ReservationArray* reservations;
+} Prototype1State;
+
+static Flight* p1_find_flight(void* state, int flightId) {
+    return find_flight(((Prototype1State*)state)->flights_root, flightId);
+}
+
+static Flight* p1_find_flight_by_number(void* state, const char* flightNumber) {
+    return find_flight_by_number(((Prototype1State*)state)->flights_root, flightNumber);
+}
+
+static Passenger* p1_find_passenger(void* state, int passengerId) {
+    return find_passenger(((Prototype1State*)state)->passengers_head, passengerId);
+}
+
+static Passenger* p1_find_passenger_by_name(void* state, const char* name) {
+    return find_passenger_by_name(((Prototype1State*)state)->passengers_head, name);
+}
+
+static int p1_count_passenger_bookings(void* state, int passengerId) {
+    return count_flights_by_passenger_array(((Prototype1State*)state)->reservations, passengerId);
+}
+
+static int p1_passenger_reservations(void* state, int passengerId, ReservationRecord** records, int* capacity) {
+    return find_reservations_by_passenger_array(((Prototype1State*)state)->reservations, passengerId, records, capacity);
+}
+
+static int p1_flight_reservations(void* state, int flightId, ReservationRecord** records, int* capacity) {
+    return find_reservations_by_flight_array(((Prototype1State*)state)->reservations, flightId, records, capacity);
+}
+
+// One page of flights with IDs above afterId, in ID order
+static int p1_list_flights(void* state, int afterId, Flight* page, int limit) {
+    return list_flights_after(((Prototype1State*)state)->flights_root, afterId, page, limit);
+}
+
+// Number of flights with IDs in [lowId, highId]
+static int p1_count_flights(void* state, int lowId, int highId) {
+    return count_flights_in_range(((Prototype1State*)state)->flights_root, lowId, highId);
+}
+
+// Same rules as add_reservation_with_validation, without printing on rejection
+static int p1_book(void* state, ReservationRecord record) {
+    Prototype1State* p1 = (Prototype1State*)state;
+    Flight* flight = find_flight(p1->flights_root, record.flightId);
+    if (flight == NULL) {
+        return 0;
+    }
+    if (!has_reservation_array(p1->reservations, record.flightId, record.passengerId) &&
+        count_passengers_by_flight_array(p1->reservations, record.flightId) >= flight->capacity) {
+        return 0;
+    }
+    add_reservation(p1->reservations, record);
+    return 1;
+}
+
+static int p1_cancel(void* state, int flightId, int passengerId) {
+    return cancel_reservation(((Prototype1State*)state)->reservations, flightId, passengerId);
+}
+
+static void p1_destroy(void* state) {
+    Prototype1State* p1 = (Prototype1State*)state;
+    free_tree(p1->flights_root);
+    free_list(p1->passengers_head);
+    free_reservations(p1->reservations);
+    free(p1);
+}
+
+// Build prototype 1 structures from the given data
+QueryEngine* create_prototype1_engine(const Flight* flights, int flight_count,
+                                      const Passenger* passengers, int passenger_count,
+                                      const ReservationRecord* reservations, int reservation_count) {
+    QueryEngine* engine = (QueryEngine*)malloc(sizeof(QueryEngine));
+    Prototype1State* state = (Prototype1State*)calloc(1, sizeof(Prototype1State));
+    if (engine == NULL || state == NULL) {
+        fprintf(stderr, "Memory allocation failed for prototype 1 engine\n");
+        free(engine);
+        free(state);
+        return NULL;
+    }
+    
+    for (int i = 0; i < flight_count; i++) {
+        state->flights_root = insert(state->flights_root, flights[i]);
+    }
+    for (int i = 0; i < passenger_count; i++) {
+        state->passengers_head = insert_passenger(state->passengers_head, passengers[i]);
+    }
+    state->reservations = init_reservations(reservation_count > 0 ? reservation_count : 16);
+    if (state->reservations == NULL) {
+        p1_destroy(state);
+        free(engine);
+        return NULL;
+    }
+    for (int i = 0; i < reservation_count; i++) {
+        add_reservation(state->reservations, reservations[i]);
+    }
+    sort_reservations(state->reservations);
+    
+    engine->name = "Prototype 1 (BST / Linked List / Array)";
+    engine->state = state;
+    engine->find_flight = p1_find_flight;
+    engine->find_flight_by_number = p1_find_flight_by_number;
+    engine->find_passenger = p1_find_passenger;
+    engine->find_passenger_by_name = p1_find_passenger_by_name;
+    engine->count_passenger_bookings = p1_count_passenger_bookings;
+    engine->passenger_reservations = p1_passenger_reservations;
+    engine->flight_reservations = p1_flight_reservations;
+    engine->list_flights = p1_list_flights;
+    engine->count_flights = p1_count_flights;
+    engine->book = p1_book;
+    engine->cancel = p1_cancel;
+    engine->destroy = p1_destroy;
+    return engine;
+}
+
+//--- PROTOTYPE 2 ---//
+
+typedef struct {
+    AVL_Node* flights_root;
+    PassengerHashTable* passengers_table;
+    ReservationBST* reservations;
+} Prototype2State;
+
+static Flight* p2_find_flight(void* state, int flightId) {
+    return avl_find_flight(((Prototype2State*)state)->flights_root, flightId);
+}
+
+static Flight* p2_find_flight_by_number(void* state, const char* flightNumber) {
+    return avl_find_flight_by_number(((Prototype2State*)state)->flights_root, flightNumber);
+}
+
+static Passenger* p2_find_passenger(void* state, int passengerId) {
+    return hash_find_passenger(((Prototype2State*)state)->passengers_table, passengerId);
+}
+
+static Passenger* p2_find_passenger_by_name(void* state, const char* name) {
+    return hash_find_passenger_by_name(((Prototype2State*)state)->passengers_table, name);
+}
+
+static int p2_count_passenger_bookings(void* state, int passengerId) {
+    return count_flights_by_passenger(((Prototype2State*)state)->reservations, passengerId);
+}
+
+static int p2_passenger_reservations(void* state, int passengerId, ReservationRecord** records, int* capacity) {
+    return find_reservations_by_passenger_bst(((Prototype2State*)state)->reservations, passengerId, records, capacity);
+}
+
+static int p2_flight_reservations(void* state, int flightId, ReservationRecord** records, int* capacity) {
+    return find_reservations_by_flight_bst(((Prototype2State*)state)->reservations, flightId, records, capacity);
+}
+
+// One page of flights with IDs above afterId, in ID order
+static int p2_list_flights(void* state, int afterId, Flight* page, int limit) {
+    return avl_list_flights_after(((Prototype2State*)state)->flights_root, afterId, page, limit);
+}
+
+// Number of flights with IDs in [lowId, highId]
+static int p2_count_flights(void* state, int lowId, int highId) {
+    return avl_count_range(((Prototype2State*)state)->flights_root, lowId, highId);
+}
+
+// Same rules as add_reservation_bst_with_validation, without printing on rejection
+static int p2_book(void* state, ReservationRecord record) {
+    Prototype2State* p2 = (Prototype2State*)state;
+    Flight* flight = avl_find_flight(p2->flights_root, record.flightId);
+    if (flight == NULL) {
+        return 0;
+    }
+    if (!has_reservation_bst(p2->reservations, record.flightId, record.passengerId) &&
+        count_passengers_by_flight(p2->reservations, record.flightId) >= flight->capacity) {
+        return 0;
+    }
+    add_reservation_bst(p2->reservations, record);
+    return 1;
+}
+
+static int p2_cancel(void* state, int flightId, int passengerId) {
+    return cancel_reservation_bst(((Prototype2State*)state)->reservations, flightId, passengerId);
+}
+
+static void p2_destroy(void* state) {
+    Prototype2State* p2 = (Prototype2State*)state;
+    free_avl_tree(p2->flights_root);
+    free_hash_table(p2->passengers_table);
+    free_reservation_bst(p2->reservations);
+    free(p2);
+}
+
+// Build prototype 2 structures from the given data
+QueryEngine* create_prototype2_engine(const Flight* flights, int flight_count,
+                                      const Passenger* passengers, int passenger_count,
+                                      const ReservationRecord* reservations, int reservation_count) {
+    QueryEngine* engine = (QueryEngine*)malloc(sizeof(QueryEngine));
+    Prototype2State* state = (Prototype2State*)calloc(1, sizeof(Prototype2State));
+    if (engine == NULL || state == NULL) {
+        fprintf(stderr, "Memory allocation failed for prototype 2 engine\n");
+        free(engine);
+        free(state);
+        return NULL;
+    }
+    
+    for (int i = 0; i < flight_count; i++) {
+        state->flights_root = avl_insert(state->flights_root, flights[i]);
+    }
+    state->passengers_table = init_hash_table(passenger_count > 0 ? passenger_count * 2 : 16);
+    state->reservations = init_reservation_bst();
+    if (state->passengers_table == NULL || state->reservations == NULL) {
+        p2_destroy(state);
+        free(engine);
+        return NULL;
+    }
+    for (int i = 0; i < passenger_count; i++) {
+        hash_insert_passenger(state->passengers_table, passengers[i]);
+    }
+    for (int i = 0; i < reservation_count; i++) {
+        add_reservation_bst(state->reservations, reservations[i]);
+    }
+    if (bloom_fp_rate > 0.0) {
+        hash_enable_filter(state->passengers_table, bloom_fp_rate);
+        reservation_bst_enable_filter(state->reservations, reservation_count, bloom_fp_rate);
+    }
+    
+    engine->name = "Prototype 2 (AVL Tree / Hash Table / BST)";
+    engine->state = state;
+    engine->find_flight = p2_find_flight;
+    engine->find_flight_by_number = p2_find_flight_by_number;
+    engine->find_passenger = p2_find_passenger;
+    engine->find_passenger_by_name = p2_find_passenger_by_name;
+    engine->count_passenger_bookings = p2_count_passenger_bookings;
+    engine->passenger_reservations = p2_passenger_reservations;
+    engine->flight_reservations = p2_flight_reservations;
+    engine->list_flights = p2_list_flights;
+    engine->count_flights = p2_count_flights;
+    engine->book = p2_book;
+    engine->cancel = p2_cancel;
+    engine->destroy = p2_destroy;
+    return engine;
+}
+
+// Create an engine by prototype number
+QueryEngine* create_engine(int prototype,
+                           const Flight* flights, int flight_count,
+                           const Passenger* passengers, int passenger_count,
+                           const ReservationRecord* reservations, int reservation_count) {
+    switch (prototype) {
+        case 1:
+            return create_prototype1_engine(flights, flight_count, passengers, passenger_count,
+                                            reservations, reservation_count);
+        case 2:
+            return create_prototype2_engine(flights, flight_count, passengers, passenger_count,
+                                            reservations, reservation_count);
+        case 3:
+            return create_concurrent_engine(flights, flight_count, passengers, passenger_count,
+                                            reservations, reservation_count);
+        case 4:
+            return create_sharded_engine(flights, flight_count, passengers, passenger_count,
+                                         reservations, reservation_count);
+        default:
+            fprintf(stderr, "Unknown engine: %d\n", prototype);
+            return NULL;
+    }
+}
+
+// Free an engine and its data structures
+void destroy_engine(QueryEngine* engine) {
+    if (engine != NULL) {
+        engine->destroy(engine->state);
+        free(engine);
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "airline_types.h"
+
+// A query engine wraps one set of data structures behind a common set of operations,
+// so tools like the trace replayer can drive prototype 1, prototype 2 or any newer engine
+typedef struct QueryEngine {
+    const char* name;
+    void* state;
+    
+    Flight* (*find_flight)(void* state, int flightId);
+    Flight* (*find_flight_by_number)(void* state, const char* flightNumber);
+    Passenger* (*find_passenger)(void* state, int passengerId);
+    Passenger* (*find_passenger_by_name)(void* state, const char* name);
+    int (*count_passenger_bookings)(void* state, int passengerId);
+    // Copy the reservations of a passenger / on a flight into *records (grown as needed).
+    // Return the number found, or -1 on failure
+    int (*passenger_reservations)(void* state, int passengerId, ReservationRecord** records, int* capacity);
+    int (*flight_reservations)(void* state, int flightId, ReservationRecord** records, int* capacity);
+    // Copy up to `limit` flights with IDs above afterId into page, in ID order (pass the last ID
+    // of one page to get the next). Returns the number copied
+    int (*list_flights)(void* state, int afterId, Flight* page, int limit);
+    // Count the flights with IDs in [lowId, highId]
+    int (*count_flights)(void* state, int lowId, int highId);
+    // Book with capacity validation: returns 1 if booked, 0 if rejected
+    int (*book)(void* state, ReservationRecord record);
+    // Cancel one booking of a passenger on a flight: returns 1 if cancelled
+    int (*cancel)(void* state, int flightId, int passengerId);
+    void (*destroy)(void* state);
+} QueryEngine;
+
+// Build prototype 1 structures (BST, linked list, array) from the given data
+QueryEngine* create_prototype1_engine(const Flight* flights, int flight_count,
+                                      const Passenger* passengers, int passenger_count,
+                                      const ReservationRecord* reservations, int reservation_count);
+
+// Build prototype 2 structures (AVL tree, hash table, reservation BST) from the given data
+QueryEngine* create_prototype2_engine(const Flight* flights, int flight_count,
+                                      const Passenger* passengers, int passenger_count,
+                                      const ReservationRecord* reservations, int reservation_count);
+
+// Create an engine by prototype number: 1, 2, 3 for the thread-safe prototype 2 in
+// concurrent_engine.h, or 4 for the sharded booking engine in sharded_engine.h.
+// Returns NULL for unknown engines
+QueryEngine* create_engine(int prototype,
+                           const Flight* flights, int flight_count,
+                           const Passenger* passengers, int passenger_count,
+                           const ReservationRecord* reservations, int reservation_count);
+
+// Free an engine and its data structures
+void destroy_engine(QueryEngine* engine);
+
+// Put Bloom filters with this false-positive rate in front of the passenger lookups and
+// duplicate-booking checks of prototype 2 engines (2, 3 and 4) created from now on,
+// or turn them off with 0 (the default)
+void engine_set_bloom_fp_rate(double fp_rate);
+
+// The rate set above
+double engine_bloom_fp_rate();
+
+#endif
@@ -0,0 +1,131 @@
+/*
+ * Latency Histogram Implementation
+ * 
+ * A fixed-size log-linear histogram in the style of HdrHistogram: recording is
+ * O(1) with no allocation, histograms from separate runs can be merged, and
+ * percentiles keep a bounded relative error instead of storing every sample.
+ * 
+ * Sources used:
+ * 1. HdrHistogram by Gil Tene - Log-linear bucket layout
+ * 2. "How NOT to Measure Latency" by Gil Tene - Reporting high percentiles
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "histogram.h"
+
+#define HALF_SUB_BUCKETS (HISTOGRAM_SUB_BUCKETS / 2)
+
+// Position of the highest set bit (value must be non-zero)
+static int highest_bit(uint64_t value) {
+    return 63 - __builtin_clzll(value);
+}
+
+// Bucket index for a value
+static int bucket_index(uint64_t value) {
+    if (value < HISTOGRAM_SUB_BUCKETS) {
+        return (int)value;
+    }
+    
+    // Shift so the value keeps HISTOGRAM_SUB_BUCKET_BITS significant bits
+    int shift = highest_bit(value) - (HISTOGRAM_SUB_BUCKET_BITS - 1);
+    int sub_bucket = (int)(value >> shift) - HALF_SUB_BUCKETS;
+    return HISTOGRAM_SUB_BUCKETS + (shift - 1) * HALF_SUB_BUCKETS + sub_bucket;
+}
+
+// Highest value that maps to a bucket
+uint64_t histogram_bucket_upper_bound(int index) {
+    if (index < HISTOGRAM_SUB_BUCKETS) {
+        return (uint64_t)index;
+    }
+    
+    int shift = (index - HISTOGRAM_SUB_BUCKETS) / HALF_SUB_BUCKETS + 1;
+    uint64_t sub_bucket = (uint64_t)((index - HISTOGRAM_SUB_BUCKETS) % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS);
+    return ((sub_bucket + 1) << shift) - 1;
+}
+
+// Allocate an empty histogram
+LatencyHistogram* histogram_create() {
+    LatencyHistogram* histogram = (LatencyHistogram*)malloc(sizeof(LatencyHistogram));
+    if (histogram == NULL) {
+        fprintf(stderr, "Memory allocation failed for latency histogram\n");
+        return NULL;
+    }
+    histogram_reset(histogram);
+    return histogram;
+}
+
+// Clear all recorded values
+void histogram_reset(LatencyHistogram* histogram) {
+    memset(histogram->counts, 0, sizeof(histogram->counts));
+    histogram->total_count = 0;
+    histogram->min = UINT64_MAX;
+    histogram->max = 0;
+    histogram->sum = 0.0;
+}
+
+// Record one value
+void histogram_record(LatencyHistogram* histogram, uint64_t value) {
+    if (value > HISTOGRAM_MAX_VALUE) {
+        value = HISTOGRAM_MAX_VALUE;
+    }
+    histogram->counts[bucket_index(value)]++;
+    histogram->total_count++;
+    histogram->sum += (double)value;
+    if (value < histogram->min) histogram->min = value;
+    if (value > histogram->max) histogram->max = value;
+}
+
+// Add all values of `source` into `target`
+void histogram_merge(LatencyHistogram* target, const LatencyHistogram* source) {
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        target->counts[i] += source->counts[i];
+    }
+    target->total_count += source->total_count;
+    target->sum += source->sum;
+    if (source->min < target->min) target->min = source->min;
+    if (source->max > target->max) target->max = source->max;
+}
+
+// Value at a percentile (0-100)
+uint64_t histogram_percentile(const LatencyHistogram* histogram, double percentile) {
+    if (histogram->total_count == 0) {
+        return 0;
+    }
+    
+    // Nearest rank, as in timing_percentile_ns
+    uint64_t rank = (uint64_t)(percentile / 100.0 * histogram->total_count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > histogram->total_count) rank = histogram->total_count;
+    
+    uint64_t seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->counts[i];
+        if (seen >= rank) {
+            uint64_t value = histogram_bucket_upper_bound(i);
+            return value < histogram->max ? value : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+// Mean of all recorded values
+double histogram_mean(const LatencyHistogram* histogram) {
+    return histogram->total_count > 0 ? histogram->sum / histogram->total_count : 0.0;
+}
+
+// Print non-empty buckets
+void histogram_print(FILE* file, const LatencyHistogram* histogram) {
+    uint64_t seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if (histogram->counts[i] == 0) continue;
+        seen += histogram->counts[i];
+        fprintf(file, "%llu %llu %.6f\n", (unsigned long long)histogram_bucket_upper_bound(i),
+                (unsigned long long)histogram->counts[i], (double)seen / histogram->total_count);
+    }
+}
+
+// Free a histogram
+void histogram_free(LatencyHistogram* histogram) {
+    free(histogram);
+}
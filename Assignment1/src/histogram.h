@@ -0,0 +1,52 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// HDR-style log-linear latency histogram. Values below HISTOGRAM_SUB_BUCKETS are
+// recorded exactly; larger values land in one of HISTOGRAM_SUB_BUCKETS / 2 linear
+// sub-buckets per power of two, so every value keeps ~1% relative precision
+// (7 significant bits) from nanoseconds up to HISTOGRAM_MAX_VALUE
+#define HISTOGRAM_SUB_BUCKET_BITS 7
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_MAX_SHIFT 34
+#define HISTOGRAM_BUCKETS (HISTOGRAM_SUB_BUCKETS + HISTOGRAM_MAX_SHIFT * (HISTOGRAM_SUB_BUCKETS / 2))
+#define HISTOGRAM_MAX_VALUE (((uint64_t)HISTOGRAM_SUB_BUCKETS << HISTOGRAM_MAX_SHIFT) - 1)
+
+typedef struct {
+    uint64_t counts[HISTOGRAM_BUCKETS];
+    uint64_t total_count;
+    uint64_t min;
+    uint64_t max;
+    double sum;
+} LatencyHistogram;
+
+// Allocate an empty histogram. Returns NULL on failure
+LatencyHistogram* histogram_create();
+
+// Clear all recorded values
+void histogram_reset(LatencyHistogram* histogram);
+
+// Record one value (values above HISTOGRAM_MAX_VALUE are clamped)
+void histogram_record(LatencyHistogram* histogram, uint64_t value);
+
+// Add all values of `source` into `target`
+void histogram_merge(LatencyHistogram* target, const LatencyHistogram* source);
+
+// Value at a percentile (0-100), reported as the highest value equivalent to the bucket it falls in
+uint64_t histogram_percentile(const LatencyHistogram* histogram, double percentile);
+
+// Mean of all recorded values
+double histogram_mean(const LatencyHistogram* histogram);
+
+// Highest value that maps to bucket `index` (0 <= index < HISTOGRAM_BUCKETS)
+uint64_t histogram_bucket_upper_bound(int index);
+
+// Print non-empty buckets as "<bucket upper bound> <count> <cumulative fraction>" lines
+void histogram_print(FILE* file, const LatencyHistogram* histogram);
+
+// Free a histogram
+void histogram_free(LatencyHistogram* histogram);
+
+#endif
@@ -0,0 +1,298 @@
+/*
+ * Query Server Load Generator
+ *
+ * Drives a running query server with the operations of a trace over several
+ * pipelined connections from one thread, and measures each request from the
+ * moment it is queued until its response is decoded.
+ *
+ * Sources used:
+ * 1. "Unix Network Programming" by W. Richard Stevens - Non-blocking clients
+ * 2. Gil Tene, "How NOT to Measure Latency" - Latency percentiles under load
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "loadgen.h"
+#include "protocol.h"
+#include "server.h"
+#include "timing.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+
+// Milliseconds without any response before the run is abandoned
+#define LOADGEN_TIMEOUT_MS 10000
+
+// One client connection and its in-flight requests (a ring of `pipeline` slots)
+typedef struct {
+    int fd;
+    char* output;
+    size_t output_length;
+    size_t output_sent;
+    char* input;
+    size_t input_length;
+    size_t input_capacity;
+    uint64_t* started;  // Queue time of each in-flight request
+    int* ops;           // Protocol op of each in-flight request
+    uint32_t* ids;
+    int head;
+    int outstanding;
+    unsigned int events;
+} ClientConnection;
+
+// Protocol request for a trace operation
+static void request_for_op(const TraceOp* op, uint32_t id, ProtocolRequest* request) {
+    memset(request, 0, sizeof(ProtocolRequest));
+    request->id = id;
+    request->flightId = op->flightId;
+    request->passengerId = op->passengerId;
+    strncpy(request->key, op->key, sizeof(request->key) - 1);
+    
+    switch (op->type) {
+        case TRACE_FLIGHT_BY_ID:     request->op = PROTOCOL_FLIGHT_BY_ID; break;
+        case TRACE_FLIGHT_BY_NUMBER: request->op = PROTOCOL_FLIGHT_BY_NUMBER; break;
+        case TRACE_PASSENGER_BY_ID:  request->op = PROTOCOL_PASSENGER_BY_ID; break;
+        case TRACE_LIST_BOOKINGS:    request->op = PROTOCOL_PASSENGER_BOOKINGS; break;
+        case TRACE_BOOK:             request->op = PROTOCOL_BOOK; break;
+        default:                     request->op = PROTOCOL_CANCEL; break;
+    }
+}
+
+// Queue requests until the pipeline is full or the trace is used up
+static void fill_requests(ClientConnection* client, const Trace* trace, int* next, int pipeline) {
+    // Drop bytes already sent so the buffer always has room for a full pipeline
+    if (client->output_sent > 0) {
+        client->output_length -= client->output_sent;
+        memmove(client->output, client->output + client->output_sent, client->output_length);
+        client->output_sent = 0;
+    }
+    
+    while (client->outstanding < pipeline && *next < trace->count) {
+        ProtocolRequest request;
+        request_for_op(&trace->ops[*next], (uint32_t)*next, &request);
+        
+        int slot = (client->head + client->outstanding) % pipeline;
+        client->ids[slot] = request.id;
+        client->ops[slot] = request.op;
+        client->started[slot] = timing_now_ns();
+        client->output_length += protocol_encode_request(client->output + client->output_length, &request);
+        client->outstanding++;
+        (*next)++;
+    }
+}
+
+// Send queued requests. Returns 0 on a write error
+static int send_requests(ClientConnection* client) {
+    while (client->output_sent < client->output_length) {
+        ssize_t sent = send(client->fd, client->output + client->output_sent,
+                            client->output_length - client->output_sent, MSG_NOSIGNAL);
+        if (sent > 0) {
+            client->output_sent += (size_t)sent;
+        } else if (sent < 0 && errno == EINTR) {
+            continue;
+        } else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Read and decode every available response. Returns 0 if the server closed the connection
+// or sent something unexpected
+static int receive_responses(ClientConnection* client, int pipeline, LoadStats* stats) {
+    for (;;) {
+        if (client->input_capacity - client->input_length < 64 * 1024) {
+            size_t new_capacity = client->input_capacity > 0 ? client->input_capacity * 2 : 128 * 1024;
+            char* grown = (char*)realloc(client->input, new_capacity);
+            if (grown == NULL) {
+                fprintf(stderr, "Memory allocation failed for load generator input\n");
+                return 0;
+            }
+            client->input = grown;
+            client->input_capacity = new_capacity;
+        }
+        
+        ssize_t received = recv(client->fd, client->input + client->input_length,
+                                client->input_capacity - client->input_length, 0);
+        if (received > 0) {
+            client->input_length += (size_t)received;
+            continue;
+        }
+        if (received < 0 && errno == EINTR) continue;
+        if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            fprintf(stderr, "Server closed the connection\n");
+            return 0;
+        }
+        break;
+    }
+    
+    // Responses come back in request order, so each one completes the oldest request
+    size_t offset = 0;
+    long frame;
+    while ((frame = protocol_frame_length(client->input + offset, client->input_length - offset)) > 0) {
+        ProtocolResponse response;
+        if (client->outstanding == 0 ||
+            !protocol_decode_response(client->input + offset + PROTOCOL_HEADER_SIZE,
+                                      (size_t)frame - PROTOCOL_HEADER_SIZE, client->ops[client->head], &response) ||
+            response.id != client->ids[client->head]) {
+            fprintf(stderr, "Unexpected response from server\n");
+            return 0;
+        }
+        
+        histogram_record(stats->latency, timing_now_ns() - client->started[client->head]);
+        if (response.status == PROTOCOL_ERROR) {
+            stats->errors++;
+        } else if (response.status != PROTOCOL_OK) {
+            stats->not_found++;
+        }
+        stats->completed++;
+        
+        client->head = (client->head + 1) % pipeline;
+        client->outstanding--;
+        offset += (size_t)frame;
+    }
+    if (frame < 0) {
+        fprintf(stderr, "Oversized response from server\n");
+        return 0;
+    }
+    
+    client->input_length -= offset;
+    memmove(client->input, client->input + offset, client->input_length);
+    return 1;
+}
+
+// Watch for writability only while requests are waiting to be sent
+static int update_client_events(int epoll_fd, ClientConnection* client) {
+    unsigned int events = EPOLLIN;
+    if (client->output_sent < client->output_length) events |= EPOLLOUT;
+    if (events == client->events) return 1;
+    
+    struct epoll_event event;
+    event.events = events;
+    event.data.ptr = client;
+    int operation = client->events == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+    client->events = events;
+    return epoll_ctl(epoll_fd, operation, client->fd, &event) == 0;
+}
+
+// Free the buffers of every client and close their sockets
+static void free_clients(ClientConnection* clients, int connections) {
+    for (int c = 0; c < connections; c++) {
+        if (clients[c].fd >= 0) close(clients[c].fd);
+        free(clients[c].output);
+        free(clients[c].input);
+        free(clients[c].started);
+        free(clients[c].ops);
+        free(clients[c].ids);
+    }
+    free(clients);
+}
+
+// Send every operation of a trace to a query server
+int run_load_generator(const char* address, const Trace* trace, int connections, int pipeline, LoadStats* stats) {
+    memset(stats, 0, sizeof(LoadStats));
+    if (connections < 1) connections = 1;
+    if (pipeline < 1) pipeline = 1;
+    
+    stats->latency = histogram_create();
+    ClientConnection* clients = (ClientConnection*)calloc(connections, sizeof(ClientConnection));
+    int epoll_fd = epoll_create1(0);
+    if (stats->latency == NULL || clients == NULL || epoll_fd < 0) {
+        fprintf(stderr, "Could not set up the load generator\n");
+        free(clients);
+        if (epoll_fd >= 0) close(epoll_fd);
+        return 0;
+    }
+    
+    int ok = 1;
+    for (int c = 0; c < connections; c++) {
+        ClientConnection* client = &clients[c];
+        client->fd = -1;
+        client->output = (char*)malloc((size_t)pipeline * PROTOCOL_MAX_REQUEST);
+        client->started = (uint64_t*)malloc(pipeline * sizeof(uint64_t));
+        client->ops = (int*)malloc(pipeline * sizeof(int));
+        client->ids = (uint32_t*)malloc(pipeline * sizeof(uint32_t));
+        if (client->output == NULL || client->started == NULL || client->ops == NULL || client->ids == NULL) {
+            fprintf(stderr, "Memory allocation failed for load generator connection\n");
+            ok = 0;
+            break;
+        }
+        client->fd = server_connect(address);
+        if (client->fd < 0) {
+            ok = 0;
+            break;
+        }
+    }
+    
+    uint64_t start = timing_now_ns();
+    int next = 0;
+    for (int c = 0; ok && c < connections; c++) {
+        fill_requests(&clients[c], trace, &next, pipeline);
+        ok = send_requests(&clients[c]) && update_client_events(epoll_fd, &clients[c]);
+    }
+    
+    struct epoll_event events[64];
+    while (ok && stats->completed < trace->count) {
+        int ready = epoll_wait(epoll_fd, events, 64, LOADGEN_TIMEOUT_MS);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready <= 0) {
+            fprintf(stderr, "Load generator timed out waiting for the server\n");
+            ok = 0;
+            break;
+        }
+        
+        for (int i = 0; ok && i < ready; i++) {
+            ClientConnection* client = (ClientConnection*)events[i].data.ptr;
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                ok = receive_responses(client, pipeline, stats);
+            }
+            if (ok) {
+                fill_requests(client, trace, &next, pipeline);
+                ok = send_requests(client) && update_client_events(epoll_fd, client);
+            }
+        }
+    }
+    
+    stats->elapsed_seconds = (timing_now_ns() - start) / 1e9;
+    stats->throughput = stats->elapsed_seconds > 0 ? stats->completed / stats->elapsed_seconds : 0.0;
+    
+    free_clients(clients, connections);
+    close(epoll_fd);
+    return ok;
+}
+
+#else
+
+// epoll is Linux-only
+int run_load_generator(const char* address, const Trace* trace, int connections, int pipeline, LoadStats* stats) {
+    (void)trace;
+    (void)connections;
+    (void)pipeline;
+    memset(stats, 0, sizeof(LoadStats));
+    fprintf(stderr, "Load generator is only supported on Linux (cannot connect to %s)\n", address);
+    return 0;
+}
+
+#endif
+
+// Print throughput and latency percentiles
+void print_load_stats(FILE* file, const LoadStats* stats, int connections, int pipeline) {
+    fprintf(file, "Load: %lld requests over %d connection(s), pipeline depth %d\n",
+            stats->completed, connections, pipeline);
+    fprintf(file, "  %.3f s, %.0f requests/sec, %lld not found/rejected, %lld errors\n",
+            stats->elapsed_seconds, stats->throughput, stats->not_found, stats->errors);
+    if (stats->latency != NULL && stats->latency->total_count > 0) {
+        fprintf(file, "  latency (us): p50 %.1f  p99 %.1f  p999 %.1f  max %.1f  mean %.1f\n",
+                histogram_percentile(stats->latency, 50.0) / 1000.0,
+                histogram_percentile(stats->latency, 99.0) / 1000.0,
+                histogram_percentile(stats->latency, 99.9) / 1000.0,
+                stats->latency->max / 1000.0,
+                histogram_mean(stats->latency) / 1000.0);
+    }
+}
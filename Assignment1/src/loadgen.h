@@ -0,0 +1,26 @@
+#ifndef LOADGEN_H
+#define LOADGEN_H
+
+#include <stdio.h>
+#include "trace.h"
+#include "histogram.h"
+
+// Results of one load generator run
+typedef struct {
+    long long completed;
+    long long not_found;   // NOT_FOUND and REJECTED responses
+    long long errors;      // ERROR responses
+    double elapsed_seconds;
+    double throughput;     // Completed requests per second
+    LatencyHistogram* latency;  // Request latency in nanoseconds (free with histogram_free)
+} LoadStats;
+
+// Send every operation of a trace to a query server over `connections` connections, keeping
+// up to `pipeline` requests in flight on each. Operations are issued as fast as responses
+// allow (closed loop). Returns 1 if every request was answered
+int run_load_generator(const char* address, const Trace* trace, int connections, int pipeline, LoadStats* stats);
+
+// Print throughput and latency percentiles
+void print_load_stats(FILE* file, const LoadStats* stats, int connections, int pipeline);
+
+#endif
@@ -0,0 +1,128 @@
+/*
+ * Memory Accounting Implementation
+ * 
+ * Allocation wrappers tagged by subsystem, so the system can report how many
+ * bytes each data structure actually holds instead of estimating it.
+ * 
+ * Sources used:
+ * 1. The C Programming Language (K&R) - Storage allocators
+ * 2. GCC manual - __atomic builtins
+ */
+
+#include <stdlib.h>
+#include "mem_stats.h"
+
+static const char* mem_tag_names[MEM_TAG_COUNT] = {
+    "flight_bst",
+    "passenger_list",
+    "reservation_array",
+    "flight_avl",
+    "passenger_hash",
+    "passenger_hash_chains",
+    "reservation_bst",
+    "reservation_mvcc",
+    "bloom_filter",
+    "passenger_sketches",
+    "flight_load_index",
+    "passenger_list_towers",
+    "passenger_unrolled",
+    "name_heap"
+};
+
+static MemStats mem_stats[MEM_TAG_COUNT];
+
+// Add a change in live bytes to a subsystem and raise its peak if needed
+static void account(MemTag tag, long long delta) {
+    MemStats* stats = &mem_stats[tag];
+    long long live = __atomic_add_fetch(&stats->live_bytes, delta, __ATOMIC_RELAXED);
+    long long peak = __atomic_load_n(&stats->peak_bytes, __ATOMIC_RELAXED);
+    while (live > peak &&
+           !__atomic_compare_exchange_n(&stats->peak_bytes, &peak, live, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        // peak was reloaded by the failed exchange
+    }
+}
+
+// Allocate memory accounted to a subsystem
+void* mem_alloc(MemTag tag, size_t size) {
+    void* ptr = malloc(size);
+    if (ptr != NULL) {
+        __atomic_add_fetch(&mem_stats[tag].allocations, 1, __ATOMIC_RELAXED);
+        account(tag, (long long)size);
+    }
+    return ptr;
+}
+
+// Allocate zeroed memory accounted to a subsystem
+void* mem_calloc(MemTag tag, size_t count, size_t size) {
+    void* ptr = calloc(count, size);
+    if (ptr != NULL) {
+        __atomic_add_fetch(&mem_stats[tag].allocations, 1, __ATOMIC_RELAXED);
+        account(tag, (long long)(count * size));
+    }
+    return ptr;
+}
+
+// Resize memory accounted to a subsystem (ptr may be NULL, as with realloc)
+void* mem_realloc(MemTag tag, void* ptr, size_t old_size, size_t new_size) {
+    void* new_ptr = realloc(ptr, new_size);
+    if (new_ptr != NULL) {
+        if (ptr == NULL) {
+            __atomic_add_fetch(&mem_stats[tag].allocations, 1, __ATOMIC_RELAXED);
+            old_size = 0;
+        }
+        account(tag, (long long)new_size - (long long)old_size);
+    }
+    return new_ptr;
+}
+
+// Free memory accounted to a subsystem
+void mem_free(MemTag tag, void* ptr, size_t size) {
+    if (ptr == NULL) {
+        return;
+    }
+    free(ptr);
+    __atomic_add_fetch(&mem_stats[tag].frees, 1, __ATOMIC_RELAXED);
+    account(tag, -(long long)size);
+}
+
+// Current counters for one subsystem
+MemStats mem_stats_get(MemTag tag) {
+    MemStats stats;
+    stats.live_bytes = __atomic_load_n(&mem_stats[tag].live_bytes, __ATOMIC_RELAXED);
+    stats.peak_bytes = __atomic_load_n(&mem_stats[tag].peak_bytes, __ATOMIC_RELAXED);
+    stats.allocations = __atomic_load_n(&mem_stats[tag].allocations, __ATOMIC_RELAXED);
+    stats.frees = __atomic_load_n(&mem_stats[tag].frees, __ATOMIC_RELAXED);
+    return stats;
+}
+
+// Name of a subsystem
+const char* mem_tag_name(MemTag tag) {
+    if (tag < 0 || tag >= MEM_TAG_COUNT) {
+        return "unknown";
+    }
+    return mem_tag_names[tag];
+}
+
+// Print the counters for every subsystem
+void mem_stats_print(FILE* file, const long long records[MEM_TAG_COUNT]) {
+    fprintf(file, "%-22s %14s %14s %12s %12s %10s %14s\n", "Structure", "Live bytes", "Peak bytes",
+            "Allocs", "Frees", "Records", "Bytes/record");
+    
+    long long total_live = 0, total_peak = 0;
+    for (int t = 0; t < MEM_TAG_COUNT; t++) {
+        MemStats stats = mem_stats_get((MemTag)t);
+        total_live += stats.live_bytes;
+        total_peak += stats.peak_bytes;
+        
+        fprintf(file, "%-22s %14lld %14lld %12lld %12lld", mem_tag_names[t], stats.live_bytes,
+                stats.peak_bytes, stats.allocations, stats.frees);
+        if (records != NULL && records[t] > 0) {
+            fprintf(file, " %10lld %14.1f\n", records[t], (double)stats.live_bytes / records[t]);
+        } else {
+            fprintf(file, " %10s %14s\n", "-", "-");
+        }
+    }
+    
+    // Peaks are per subsystem, so the total peak is an upper bound on the combined peak
+    fprintf(file, "%-22s %14lld %14lld\n", "total", total_live, total_peak);
+}
@@ -0,0 +1,51 @@
+#ifndef MEM_STATS_H
+#define MEM_STATS_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+// Subsystems that memory is accounted to
+typedef enum {
+    MEM_FLIGHT_BST = 0,        // Prototype 1 flight BST nodes
+    MEM_PASSENGER_LIST,        // Prototype 1 passenger linked list nodes
+    MEM_RESERVATION_ARRAY,     // Prototype 1 reservation array (header and records)
+    MEM_FLIGHT_AVL,            // Prototype 2 flight AVL nodes
+    MEM_PASSENGER_HASH,        // Prototype 2 hash table header and bucket array
+    MEM_PASSENGER_HASH_CHAINS, // Prototype 2 chained hash entries
+    MEM_RESERVATION_BST,       // Prototype 2 reservation BST header and nodes
+    MEM_RESERVATION_MVCC,      // Prototype 2 multi-version reservation nodes and versions
+    MEM_BLOOM_FILTER,          // Prototype 2 Bloom filter bit arrays
+    MEM_PASSENGER_SKETCHES,    // Prototype 2 per-flight HyperLogLog sketches
+    MEM_FLIGHT_LOAD_INDEX,     // Prototype 2 load-factor ordered flight nodes and ID hash
+    MEM_PASSENGER_LIST_TOWERS, // Prototype 1 skip list tower pool
+    MEM_PASSENGER_UNROLLED,    // Prototype 1 unrolled passenger list blocks and records
+    MEM_NAME_HEAP,             // Case-folded passenger name heap for substring scans
+    MEM_TAG_COUNT
+} MemTag;
+
+// Counters for one subsystem
+typedef struct {
+    long long live_bytes;
+    long long peak_bytes;
+    long long allocations;  // Successful allocations (a growing realloc counts as one)
+    long long frees;
+} MemStats;
+
+// Tagged allocation wrappers. Frees take the size of the block (as with C23 free_sized),
+// so the accounting needs no per-block header. All counters are updated atomically
+void* mem_alloc(MemTag tag, size_t size);
+void* mem_calloc(MemTag tag, size_t count, size_t size);
+void* mem_realloc(MemTag tag, void* ptr, size_t old_size, size_t new_size);
+void mem_free(MemTag tag, void* ptr, size_t size);
+
+// Current counters for one subsystem
+MemStats mem_stats_get(MemTag tag);
+
+// Name of a subsystem, e.g. "flight_avl"
+const char* mem_tag_name(MemTag tag);
+
+// Print live/peak bytes, allocation counts and bytes per record for every subsystem.
+// records[tag] is the number of records the subsystem holds (0 to omit bytes per record)
+void mem_stats_print(FILE* file, const long long records[MEM_TAG_COUNT]);
+
+#endif
@@ -0,0 +1,303 @@
+/*
+ * Passenger Name Heap
+ *
+ * All names live lower-cased in one contiguous string, so a case-insensitive substring search
+ * is a single vectorised pass over memory (simd_scan_bytes filters 32 positions at a time on
+ * the pattern's first and last bytes) instead of a strcasestr call per record. Each match
+ * is mapped back to its name by a galloping search over the name offsets, and the scan skips
+ * to the next name so every passenger is reported once. Large heaps are split by name across
+ * threads, and each thread's matches are concatenated in heap order.
+ *
+ * Sources used:
+ * 1. "SIMD-friendly algorithms for substring searching" by Wojciech Mula - First/last byte filter
+ * 2. Data Structures and Algorithm Analysis by Mark Allen Weiss - Binary search
+ * 3. POSIX Threads Programming (Lawrence Livermore National Laboratory) - pthread_create/join
+ */
+#define _POSIX_C_SOURCE 200809L  // For sysconf and strnlen
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "name_heap.h"
+#include "simd_scan.h"
+#include "mem_stats.h"
+
+// One thread's share of a scan: names [first, last) and the IDs that matched
+typedef struct {
+    const PassengerNameHeap* heap;
+    const char* pattern;
+    long pattern_length;
+    int first;
+    int last;
+    size_t base;  // Offset of the slice's first name
+    int name;     // First name the scan has not matched yet
+    int* ids;
+    int count;
+    int capacity;
+    int failed;
+} NameScanSlice;
+
+// Create an empty heap with room for `names` names of `bytes` bytes in all
+static PassengerNameHeap* name_heap_create(int names, size_t bytes) {
+    PassengerNameHeap* heap = (PassengerNameHeap*)mem_alloc(MEM_NAME_HEAP, sizeof(PassengerNameHeap));
+    if (heap == NULL) {
+        fprintf(stderr, "Memory allocation failed for passenger name heap\n");
+        return NULL;
+    }
+    memset(heap, 0, sizeof(PassengerNameHeap));
+    heap->capacity = names > 0 ? names : 64;
+    heap->text_capacity = bytes > 0 ? bytes : 1024;
+    heap->text = (char*)mem_alloc(MEM_NAME_HEAP, heap->text_capacity);
+    heap->starts = (size_t*)mem_alloc(MEM_NAME_HEAP, heap->capacity * sizeof(size_t));
+    heap->ids = (int*)mem_alloc(MEM_NAME_HEAP, heap->capacity * sizeof(int));
+    if (heap->text == NULL || heap->starts == NULL || heap->ids == NULL) {
+        fprintf(stderr, "Memory allocation failed for a name heap of %d passengers\n", heap->capacity);
+        name_heap_free(heap);
+        return NULL;
+    }
+    return heap;
+}
+
+// Append a lower-cased copy of a passenger's name. Returns 1 on success
+static int name_heap_append(PassengerNameHeap* heap, const Passenger* passenger) {
+    size_t name_length = strnlen(passenger->name, sizeof(passenger->name) - 1);
+    if (heap->length + name_length + 1 > heap->text_capacity) {
+        size_t new_capacity = heap->text_capacity * 2 + name_length + 1;
+        char* grown = (char*)mem_realloc(MEM_NAME_HEAP, heap->text, heap->text_capacity, new_capacity);
+        if (grown == NULL) {
+            fprintf(stderr, "Memory allocation failed while growing the name heap\n");
+            return 0;
+        }
+        heap->text = grown;
+        heap->text_capacity = new_capacity;
+    }
+    if (heap->count >= heap->capacity) {
+        int new_capacity = heap->capacity * 2;
+        size_t* starts = (size_t*)mem_alloc(MEM_NAME_HEAP, new_capacity * sizeof(size_t));
+        int* ids = (int*)mem_alloc(MEM_NAME_HEAP, new_capacity * sizeof(int));
+        if (starts == NULL || ids == NULL) {
+            fprintf(stderr, "Memory allocation failed while growing the name heap\n");
+            mem_free(MEM_NAME_HEAP, starts, new_capacity * sizeof(size_t));
+            mem_free(MEM_NAME_HEAP, ids, new_capacity * sizeof(int));
+            return 0;
+        }
+        memcpy(starts, heap->starts, heap->count * sizeof(size_t));
+        memcpy(ids, heap->ids, heap->count * sizeof(int));
+        mem_free(MEM_NAME_HEAP, heap->starts, heap->capacity * sizeof(size_t));
+        mem_free(MEM_NAME_HEAP, heap->ids, heap->capacity * sizeof(int));
+        heap->starts = starts;
+        heap->ids = ids;
+        heap->capacity = new_capacity;
+    }
+    
+    heap->starts[heap->count] = heap->length;
+    heap->ids[heap->count] = passenger->id;
+    heap->count++;
+    for (size_t i = 0; i < name_length; i++) {
+        heap->text[heap->length++] = (char)tolower((unsigned char)passenger->name[i]);
+    }
+    heap->text[heap->length++] = '\0';
+    return 1;
+}
+
+// Build a heap from an array of passengers, in array order
+PassengerNameHeap* name_heap_build(const Passenger* passengers, int count) {
+    size_t bytes = 0;
+    for (int i = 0; i < count; i++) {
+        bytes += strnlen(passengers[i].name, sizeof(passengers[i].name) - 1) + 1;
+    }
+    PassengerNameHeap* heap = name_heap_create(count, bytes);
+    for (int i = 0; heap != NULL && i < count; i++) {
+        if (!name_heap_append(heap, &passengers[i])) {
+            name_heap_free(heap);
+            return NULL;
+        }
+    }
+    return heap;
+}
+
+// Build a heap from prototype 1's passenger list, in ID order
+PassengerNameHeap* name_heap_from_list(LL_Node* head) {
+    PassengerNameHeap* heap = name_heap_create(0, 0);
+    for (LL_Node* node = head; heap != NULL && node != NULL; node = node->next) {
+        if (!name_heap_append(heap, &node->data)) {
+            name_heap_free(heap);
+            return NULL;
+        }
+    }
+    return heap;
+}
+
+// Build a heap from prototype 2's hash table, visiting buckets and chains like
+// hash_find_passenger_by_name
+PassengerNameHeap* name_heap_from_table(PassengerHashTable* table) {
+    PassengerNameHeap* heap = name_heap_create(table != NULL ? table->count : 0, 0);
+    for (int i = 0; heap != NULL && table != NULL && i < table->size; i++) {
+        if (table->table[i].occupied != 1) continue;
+        for (HashEntry* entry = &table->table[i]; entry != NULL; entry = entry->next) {
+            if (!name_heap_append(heap, &entry->data)) {
+                name_heap_free(heap);
+                return NULL;
+            }
+        }
+    }
+    return heap;
+}
+
+// Record a match in a slice's own result array
+static void slice_add(NameScanSlice* slice, int id) {
+    if (slice->count >= slice->capacity) {
+        int new_capacity = slice->capacity > 0 ? slice->capacity * 2 : 64;
+        int* grown = (int*)realloc(slice->ids, new_capacity * sizeof(int));
+        if (grown == NULL) {
+            slice->failed = 1;
+            return;
+        }
+        slice->ids = grown;
+        slice->capacity = new_capacity;
+    }
+    slice->ids[slice->count++] = id;
+}
+
+// Record the name holding a match and resume the scan at the next name
+static long record_match(long position, void* context) {
+    NameScanSlice* slice = (NameScanSlice*)context;
+    const PassengerNameHeap* heap = slice->heap;
+    
+    // The match is in the last name starting at or before it, usually close by: gallop
+    // forward from the current name, then binary search within the last step
+    size_t offset = slice->base + (size_t)position;
+    int low = slice->name;
+    int step = 1;
+    int high = low + 1;
+    while (high < slice->last && heap->starts[high] <= offset) {
+        low = high;
+        step *= 2;
+        high = low + step;
+    }
+    if (high > slice->last) {
+        high = slice->last;
+    }
+    while (high - low > 1) {
+        int mid = low + (high - low) / 2;
+        if (heap->starts[mid] <= offset) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    slice_add(slice, heap->ids[low]);
+    slice->name = low + 1;
+    if (slice->failed || slice->name >= slice->last) {
+        return -1;
+    }
+    return (long)(heap->starts[slice->name] - slice->base);
+}
+
+// Scan a slice's names
+static void* scan_slice(void* arg) {
+    NameScanSlice* slice = (NameScanSlice*)arg;
+    const PassengerNameHeap* heap = slice->heap;
+    size_t end = slice->last < heap->count ? heap->starts[slice->last] : heap->length;
+    slice->base = heap->starts[slice->first];
+    slice->name = slice->first;
+    simd_scan_bytes(heap->text + slice->base, (long)(end - slice->base), slice->pattern, slice->pattern_length,
+                    record_match, slice);
+    return NULL;
+}
+
+// Number of threads for a scan of the heap
+static int scan_thread_count(const PassengerNameHeap* heap, int threads) {
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus < 1 ? 1 : (int)cpus;
+    }
+    if (threads > NAME_HEAP_MAX_THREADS) threads = NAME_HEAP_MAX_THREADS;
+    size_t useful = heap->length / NAME_HEAP_BYTES_PER_THREAD + 1;
+    if ((size_t)threads > useful) threads = (int)useful;
+    return threads < heap->count ? threads : heap->count;
+}
+
+// Copy the IDs of every passenger whose name contains `pattern` into *ids
+int name_heap_find(const PassengerNameHeap* heap, const char* pattern, int threads, int** ids, int* capacity) {
+    if (heap == NULL || pattern == NULL || heap->count == 0) {
+        return 0;
+    }
+    
+    // No name is longer than MAX_PASSENGER_NAME_LENGTH - 1 bytes
+    size_t pattern_length = strlen(pattern);
+    if (pattern_length >= MAX_PASSENGER_NAME_LENGTH) {
+        return 0;
+    }
+    char folded[MAX_PASSENGER_NAME_LENGTH];
+    for (size_t i = 0; i <= pattern_length; i++) {
+        folded[i] = (char)tolower((unsigned char)pattern[i]);
+    }
+    
+    threads = scan_thread_count(heap, threads);
+    NameScanSlice slices[NAME_HEAP_MAX_THREADS];
+    for (int t = 0; t < threads; t++) {
+        slices[t] = (NameScanSlice){heap, folded, (long)pattern_length,
+                                    (int)((long long)heap->count * t / threads),
+                                    (int)((long long)heap->count * (t + 1) / threads), 0, 0, NULL, 0, 0, 0};
+    }
+    
+    // The first slice runs on this thread, and on it too if a worker can't be started
+    pthread_t handles[NAME_HEAP_MAX_THREADS];
+    int started[NAME_HEAP_MAX_THREADS];
+    for (int t = 1; t < threads; t++) {
+        started[t] = pthread_create(&handles[t], NULL, scan_slice, &slices[t]) == 0;
+        if (!started[t]) {
+            scan_slice(&slices[t]);
+        }
+    }
+    scan_slice(&slices[0]);
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) {
+            pthread_join(handles[t], NULL);
+        }
+    }
+    
+    int total = 0;
+    int failed = 0;
+    for (int t = 0; t < threads; t++) {
+        total += slices[t].count;
+        failed |= slices[t].failed;
+    }
+    if (!failed && total > *capacity) {
+        int* grown = (int*)realloc(*ids, total * sizeof(int));
+        if (grown == NULL) {
+            failed = 1;
+        } else {
+            *ids = grown;
+            *capacity = total;
+        }
+    }
+    int count = 0;
+    for (int t = 0; t < threads; t++) {
+        if (!failed && slices[t].count > 0) {
+            memcpy(*ids + count, slices[t].ids, slices[t].count * sizeof(int));
+            count += slices[t].count;
+        }
+        free(slices[t].ids);
+    }
+    if (failed) {
+        fprintf(stderr, "Memory allocation failed when collecting name matches\n");
+        return -1;
+    }
+    return count;
+}
+
+// Free the heap
+void name_heap_free(PassengerNameHeap* heap) {
+    if (heap == NULL) {
+        return;
+    }
+    mem_free(MEM_NAME_HEAP, heap->text, heap->text_capacity);
+    mem_free(MEM_NAME_HEAP, heap->starts, heap->capacity * sizeof(size_t));
+    mem_free(MEM_NAME_HEAP, heap->ids, heap->capacity * sizeof(int));
+    mem_free(MEM_NAME_HEAP, heap, sizeof(PassengerNameHeap));
+}
@@ -0,0 +1,44 @@
+#ifndef NAME_HEAP_H
+#define NAME_HEAP_H
+
+#include <stddef.h>
+#include "airline_types.h"
+
+// Most threads one scan uses
+#define NAME_HEAP_MAX_THREADS 16
+
+// Heap bytes per thread below which extra threads cost more than they save
+#define NAME_HEAP_BYTES_PER_THREAD (1 << 20)
+
+// Every passenger name lower-cased into one contiguous string, each name ended by '\0' (which
+// no pattern contains, so a match never spans two names). Substring searches scan the whole
+// heap rather than walking records, for fragments too short or too irregular for an index.
+// The heap is a snapshot: build it again after passengers change
+typedef struct {
+    char* text;
+    size_t length;
+    size_t text_capacity;
+    size_t* starts;  // Offset of each name in text
+    int* ids;        // Passenger ID of each name
+    int count;
+    int capacity;
+} PassengerNameHeap;
+
+// Build a heap from an array of passengers, in array order. Returns NULL on failure
+PassengerNameHeap* name_heap_build(const Passenger* passengers, int count);
+
+// Build a heap from prototype 1's list (ID order) or prototype 2's table (the order
+// hash_find_passenger_by_name visits). Returns NULL on failure
+PassengerNameHeap* name_heap_from_list(LL_Node* head);
+PassengerNameHeap* name_heap_from_table(PassengerHashTable* table);
+
+// Copy the IDs of every passenger whose name contains `pattern` (ignoring ASCII case, like
+// strcasestr) into *ids, growing the caller's array as needed, in heap order. The scan is
+// split by name over `threads` threads (0 = one per CPU). Returns the number found, or -1
+// on failure
+int name_heap_find(const PassengerNameHeap* heap, const char* pattern, int threads, int** ids, int* capacity);
+
+// Free the heap
+void name_heap_free(PassengerNameHeap* heap);
+
+#endif
@@ -0,0 +1,212 @@
+/*
+ * Hardware Performance Counters
+ * 
+ * Wraps perf_event_open so the cost of an operation can be broken down into
+ * cycles, instructions, cache misses, branch misses and TLB misses. Counters
+ * are per-thread and user-space only; when they can't be opened every sample
+ * is simply marked invalid and callers report timings alone.
+ * 
+ * Sources used:
+ * 1. The Linux man-pages project - perf_event_open(2)
+ * 2. "Systems Performance" by Brendan Gregg - CPU performance counters and IPC
+ */
+#define _GNU_SOURCE  // For syscall
+
+#include <stdio.h>
+#include <string.h>
+#include "perf_counters.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+static const char* perf_event_names[PERF_EVENT_COUNT] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "dtlb_misses"
+};
+
+// Short name of an event
+const char* perf_event_name(int event) {
+    if (event < 0 || event >= PERF_EVENT_COUNT) {
+        return "unknown";
+    }
+    return perf_event_names[event];
+}
+
+#ifdef __linux__
+
+// Cache event config: cache id | (operation << 8) | (result << 16)
+#define CACHE_READ_MISS(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+// glibc has no wrapper for perf_event_open
+static int perf_event_open(struct perf_event_attr* attr, pid_t pid, int cpu, int group_fd, unsigned long flags) {
+    return (int)syscall(SYS_perf_event_open, attr, pid, cpu, group_fd, flags);
+}
+
+// Open one counter for the calling thread on any CPU. Returns the fd or -1
+static int open_event(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = 1;  // Allowed at perf_event_paranoid <= 2 and what we care about anyway
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return perf_event_open(&attr, 0, -1, -1, 0);
+}
+
+// Open counters for the calling thread
+int perf_counters_open(PerfCounters* counters) {
+    static const uint32_t types[PERF_EVENT_COUNT] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+        PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE
+    };
+    static const uint64_t configs[PERF_EVENT_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D),
+        CACHE_READ_MISS(PERF_COUNT_HW_CACHE_LL),
+        PERF_COUNT_HW_BRANCH_MISSES,
+        CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB)
+    };
+    
+    memset(counters, 0, sizeof(*counters));
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        counters->fds[e] = open_event(types[e], configs[e]);
+        if (counters->fds[e] >= 0) {
+            counters->available++;
+        }
+    }
+    
+    if (counters->available < PERF_EVENT_COUNT) {
+        fprintf(stderr, "Performance counters: %d of %d events available", counters->available, PERF_EVENT_COUNT);
+        if (counters->available == 0) {
+            fprintf(stderr, " (no PMU access - check /proc/sys/kernel/perf_event_paranoid)");
+        }
+        fprintf(stderr, "\n");
+    }
+    return counters->available;
+}
+
+// Read one counter. Returns 1 on success
+static int read_event(int fd, PerfReading* reading) {
+    uint64_t data[3];
+    if (read(fd, data, sizeof(data)) != (ssize_t)sizeof(data)) {
+        return 0;
+    }
+    reading->value = data[0];
+    reading->time_enabled = data[1];
+    reading->time_running = data[2];
+    return 1;
+}
+
+// Start an interval
+void perf_counters_begin(PerfCounters* counters) {
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        if (counters->fds[e] >= 0 && !read_event(counters->fds[e], &counters->start[e])) {
+            memset(&counters->start[e], 0, sizeof(PerfReading));
+        }
+    }
+}
+
+// End an interval
+void perf_counters_end(PerfCounters* counters, PerfSample* sample) {
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        PerfReading end;
+        sample->values[e] = 0.0;
+        sample->valid[e] = counters->fds[e] >= 0 && read_event(counters->fds[e], &end);
+        if (!sample->valid[e]) {
+            continue;
+        }
+        
+        // Scale up when the counter only ran for part of the interval
+        uint64_t enabled = end.time_enabled - counters->start[e].time_enabled;
+        uint64_t running = end.time_running - counters->start[e].time_running;
+        double value = (double)(end.value - counters->start[e].value);
+        if (running == 0) {
+            sample->valid[e] = enabled == 0;  // Never scheduled onto the PMU during the interval
+        } else if (running < enabled) {
+            value *= (double)enabled / running;
+        }
+        sample->values[e] = value;
+    }
+}
+
+// Close the counters
+void perf_counters_close(PerfCounters* counters) {
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        if (counters->fds[e] >= 0) {
+            close(counters->fds[e]);
+            counters->fds[e] = -1;
+        }
+    }
+    counters->available = 0;
+}
+
+#else
+
+// Without perf_event_open every event is unavailable
+int perf_counters_open(PerfCounters* counters) {
+    memset(counters, 0, sizeof(*counters));
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        counters->fds[e] = -1;
+    }
+    fprintf(stderr, "Performance counters are only supported on Linux\n");
+    return 0;
+}
+
+void perf_counters_begin(PerfCounters* counters) {
+    (void)counters;
+}
+
+void perf_counters_end(PerfCounters* counters, PerfSample* sample) {
+    (void)counters;
+    memset(sample, 0, sizeof(*sample));
+}
+
+void perf_counters_close(PerfCounters* counters) {
+    counters->available = 0;
+}
+
+#endif
+
+// Clear a sample
+void perf_sample_reset(PerfSample* sample) {
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        sample->values[e] = 0.0;
+        sample->valid[e] = 1;
+    }
+}
+
+// Add `source` into `total`
+void perf_sample_add(PerfSample* total, const PerfSample* source) {
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        total->values[e] += source->values[e];
+        total->valid[e] = total->valid[e] && source->valid[e];
+    }
+}
+
+// Print per-operation counts, IPC and miss rates on one line
+void perf_print_sample(const char* prefix, const PerfSample* sample, double operations) {
+    if (operations <= 0.0) operations = 1.0;
+    
+    int any = 0;
+    printf("%s", prefix);
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        if (sample->valid[e]) {
+            printf("%s%s/op %.1f", any ? "  " : "", perf_event_names[e], sample->values[e] / operations);
+            any = 1;
+        }
+    }
+    if (sample->valid[PERF_CYCLES] && sample->valid[PERF_INSTRUCTIONS] && sample->values[PERF_CYCLES] > 0.0) {
+        printf("  IPC %.2f", sample->values[PERF_INSTRUCTIONS] / sample->values[PERF_CYCLES]);
+    }
+    if (!any) {
+        printf("hardware counters unavailable");
+    }
+    printf("\n");
+}
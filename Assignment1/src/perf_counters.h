@@ -0,0 +1,64 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+
+// Hardware events counted around an operation
+typedef enum {
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_EVENT_COUNT
+} PerfEvent;
+
+// Counter values over an interval. valid[e] is 0 when event e could not be counted
+typedef struct {
+    double values[PERF_EVENT_COUNT];
+    int valid[PERF_EVENT_COUNT];
+} PerfSample;
+
+// One raw counter reading: value plus the time it was enabled and actually counting
+// (the kernel multiplexes counters when there are more events than hardware registers)
+typedef struct {
+    uint64_t value;
+    uint64_t time_enabled;
+    uint64_t time_running;
+} PerfReading;
+
+// Counters for the calling thread. Each thread that wants counts opens its own set
+typedef struct {
+    int fds[PERF_EVENT_COUNT];  // -1 when the event is unavailable
+    int available;              // Number of events that opened
+    PerfReading start[PERF_EVENT_COUNT];
+} PerfCounters;
+
+// Open counters for the calling thread (user-space only). Events the kernel or CPU can't
+// provide (no PMU in a VM, perf_event_paranoid, non-Linux builds) are skipped.
+// Returns the number of events available; 0 means every sample will be invalid
+int perf_counters_open(PerfCounters* counters);
+
+// Start an interval
+void perf_counters_begin(PerfCounters* counters);
+
+// End an interval, storing the (multiplexing-scaled) counts since perf_counters_begin
+void perf_counters_end(PerfCounters* counters, PerfSample* sample);
+
+// Close the counters
+void perf_counters_close(PerfCounters* counters);
+
+// Clear a sample (all events valid with zero counts, ready for perf_sample_add)
+void perf_sample_reset(PerfSample* sample);
+
+// Add `source` into `total`; an event stays valid only if it is valid in both
+void perf_sample_add(PerfSample* total, const PerfSample* source);
+
+// Short name of an event, e.g. "cycles" or "llc_misses"
+const char* perf_event_name(int event);
+
+// Print per-operation counts, IPC and miss rates on one line (prefix may be "")
+void perf_print_sample(const char* prefix, const PerfSample* sample, double operations);
+
+#endif
@@ -0,0 +1,354 @@
+/*
+ * Binary Query Protocol Implementation
+ *
+ * Length-prefixed frames with fixed-width little-endian integers and short
+ * length-prefixed strings. Encoding writes straight into caller buffers, and
+ * decoding checks every read against the payload length, so a malformed or
+ * truncated frame is rejected instead of read past its end.
+ *
+ * Sources used:
+ * 1. "Unix Network Programming" by W. Richard Stevens - Framing messages on stream sockets
+ * 2. The C Programming Language (K&R) - Bitwise operators
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "protocol.h"
+
+//--- WRITING ---//
+
+static char* put_u8(char* out, unsigned int value) {
+    *out++ = (char)(value & 0xFF);
+    return out;
+}
+
+static char* put_u32(char* out, uint32_t value) {
+    out[0] = (char)(value & 0xFF);
+    out[1] = (char)((value >> 8) & 0xFF);
+    out[2] = (char)((value >> 16) & 0xFF);
+    out[3] = (char)((value >> 24) & 0xFF);
+    return out + 4;
+}
+
+static char* put_i64(char* out, int64_t value) {
+    out = put_u32(out, (uint32_t)((uint64_t)value & 0xFFFFFFFFu));
+    return put_u32(out, (uint32_t)((uint64_t)value >> 32));
+}
+
+// Strings longer than 255 bytes are truncated
+static char* put_string(char* out, const char* value) {
+    size_t length = strlen(value);
+    if (length > 255) length = 255;
+    out = put_u8(out, (unsigned int)length);
+    memcpy(out, value, length);
+    return out + length;
+}
+
+//--- READING ---//
+
+// Bounds-checked cursor over a payload
+typedef struct {
+    const unsigned char* data;
+    size_t left;
+    int ok;
+} Reader;
+
+static uint32_t get_u8(Reader* reader) {
+    if (reader->left < 1) {
+        reader->ok = 0;
+        return 0;
+    }
+    reader->left--;
+    return *reader->data++;
+}
+
+static uint32_t get_u32(Reader* reader) {
+    if (reader->left < 4) {
+        reader->ok = 0;
+        return 0;
+    }
+    const unsigned char* p = reader->data;
+    uint32_t value = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    reader->data += 4;
+    reader->left -= 4;
+    return value;
+}
+
+static int64_t get_i64(Reader* reader) {
+    uint64_t low = get_u32(reader);
+    uint64_t high = get_u32(reader);
+    return (int64_t)(low | (high << 32));
+}
+
+// Copy a string into a buffer of `size` bytes (truncating if needed)
+static void get_string(Reader* reader, char* out, size_t size) {
+    size_t length = get_u8(reader);
+    if (!reader->ok || reader->left < length) {
+        reader->ok = 0;
+        out[0] = '\0';
+        return;
+    }
+    size_t copied = length < size - 1 ? length : size - 1;
+    memcpy(out, reader->data, copied);
+    out[copied] = '\0';
+    reader->data += length;
+    reader->left -= length;
+}
+
+//--- FRAMES ---//
+
+// Length of the frame at the start of `data`
+long protocol_frame_length(const char* data, size_t available) {
+    if (available < PROTOCOL_HEADER_SIZE) return 0;
+    Reader reader = {(const unsigned char*)data, available, 1};
+    uint32_t payload = get_u32(&reader);
+    if (payload > PROTOCOL_MAX_PAYLOAD) return -1;
+    size_t total = PROTOCOL_HEADER_SIZE + (size_t)payload;
+    return available >= total ? (long)total : 0;
+}
+
+// Encode a request frame into `out`
+size_t protocol_encode_request(char* out, const ProtocolRequest* request) {
+    char* p = out + PROTOCOL_HEADER_SIZE;
+    p = put_u8(p, (unsigned int)request->op);
+    p = put_u32(p, request->id);
+    
+    switch (request->op) {
+        case PROTOCOL_FLIGHT_BY_ID:
+        case PROTOCOL_FLIGHT_BOOKINGS:
+            p = put_u32(p, (uint32_t)request->flightId);
+            break;
+        case PROTOCOL_PASSENGER_BY_ID:
+        case PROTOCOL_PASSENGER_BOOKINGS:
+            p = put_u32(p, (uint32_t)request->passengerId);
+            break;
+        case PROTOCOL_FLIGHT_BY_NUMBER:
+        case PROTOCOL_PASSENGER_BY_NAME:
+            p = put_string(p, request->key);
+            break;
+        case PROTOCOL_BOOK:
+            p = put_u32(p, (uint32_t)request->flightId);
+            p = put_u32(p, (uint32_t)request->passengerId);
+            p = put_string(p, request->key);
+            break;
+        case PROTOCOL_CANCEL:
+            p = put_u32(p, (uint32_t)request->flightId);
+            p = put_u32(p, (uint32_t)request->passengerId);
+            break;
+        case PROTOCOL_LIST_FLIGHTS:
+            p = put_u32(p, (uint32_t)request->flightId);
+            p = put_u32(p, (uint32_t)request->limit);
+            break;
+        case PROTOCOL_COUNT_FLIGHTS:
+            p = put_u32(p, (uint32_t)request->flightId);
+            p = put_u32(p, (uint32_t)request->highId);
+            break;
+    }
+    
+    put_u32(out, (uint32_t)(p - out - PROTOCOL_HEADER_SIZE));
+    return (size_t)(p - out);
+}
+
+// Decode a request payload
+int protocol_decode_request(const char* payload, size_t length, ProtocolRequest* request) {
+    Reader reader = {(const unsigned char*)payload, length, 1};
+    request->op = (int)get_u8(&reader);
+    request->id = get_u32(&reader);
+    request->flightId = 0;
+    request->passengerId = 0;
+    request->key[0] = '\0';
+    request->limit = 0;
+    request->highId = 0;
+    
+    switch (request->op) {
+        case PROTOCOL_FLIGHT_BY_ID:
+        case PROTOCOL_FLIGHT_BOOKINGS:
+            request->flightId = (int)get_u32(&reader);
+            break;
+        case PROTOCOL_PASSENGER_BY_ID:
+        case PROTOCOL_PASSENGER_BOOKINGS:
+            request->passengerId = (int)get_u32(&reader);
+            break;
+        case PROTOCOL_FLIGHT_BY_NUMBER:
+        case PROTOCOL_PASSENGER_BY_NAME:
+            get_string(&reader, request->key, sizeof(request->key));
+            break;
+        case PROTOCOL_BOOK:
+            request->flightId = (int)get_u32(&reader);
+            request->passengerId = (int)get_u32(&reader);
+            get_string(&reader, request->key, MAX_SEAT_NUMBER_LENGTH);
+            break;
+        case PROTOCOL_CANCEL:
+            request->flightId = (int)get_u32(&reader);
+            request->passengerId = (int)get_u32(&reader);
+            break;
+        case PROTOCOL_LIST_FLIGHTS:
+            request->flightId = (int)get_u32(&reader);
+            request->limit = (int)get_u32(&reader);
+            break;
+        case PROTOCOL_COUNT_FLIGHTS:
+            request->flightId = (int)get_u32(&reader);
+            request->highId = (int)get_u32(&reader);
+            break;
+        default:
+            return 0;
+    }
+    return reader.ok && reader.left == 0;
+}
+
+//--- RESPONSES ---//
+
+// Reserve room for a response and write its id and status. Returns the frame start, or NULL
+static char* begin_response(OutputBuffer* out, size_t body_size, uint32_t id, int status) {
+    if (!output_buffer_reserve(out, PROTOCOL_HEADER_SIZE + 5 + body_size)) {
+        return NULL;
+    }
+    char* frame = out->data + out->length;
+    char* p = put_u32(frame + PROTOCOL_HEADER_SIZE, id);
+    put_u8(p, (unsigned int)status);
+    return frame;
+}
+
+// Fill in the length prefix of a frame ending at `end` and commit it to the buffer
+static void end_response(OutputBuffer* out, char* frame, char* end) {
+    put_u32(frame, (uint32_t)(end - frame - PROTOCOL_HEADER_SIZE));
+    out->length += (size_t)(end - frame);
+}
+
+// Response without a body
+int protocol_encode_status(OutputBuffer* out, uint32_t id, int status) {
+    char* frame = begin_response(out, 0, id, status);
+    if (frame == NULL) return 0;
+    end_response(out, frame, frame + PROTOCOL_HEADER_SIZE + 5);
+    return 1;
+}
+
+// Write a flight body
+static char* put_flight(char* p, const Flight* flight) {
+    p = put_u32(p, (uint32_t)flight->id);
+    p = put_string(p, flight->flightNumber);
+    p = put_string(p, flight->origin);
+    p = put_string(p, flight->destination);
+    p = put_i64(p, (int64_t)flight->departureTime);
+    return put_u32(p, (uint32_t)flight->capacity);
+}
+
+// Flight lookup response
+int protocol_encode_flight(OutputBuffer* out, uint32_t id, const Flight* flight) {
+    char* frame = begin_response(out, PROTOCOL_FLIGHT_SIZE, id, PROTOCOL_OK);
+    if (frame == NULL) return 0;
+    char* p = put_flight(frame + PROTOCOL_HEADER_SIZE + 5, flight);
+    end_response(out, frame, p);
+    return 1;
+}
+
+// Passenger lookup response
+int protocol_encode_passenger(OutputBuffer* out, uint32_t id, const Passenger* passenger) {
+    char* frame = begin_response(out, 4 + 2 * 256, id, PROTOCOL_OK);
+    if (frame == NULL) return 0;
+    char* p = frame + PROTOCOL_HEADER_SIZE + 5;
+    p = put_u32(p, (uint32_t)passenger->id);
+    p = put_string(p, passenger->name);
+    p = put_string(p, passenger->passportNumber);
+    end_response(out, frame, p);
+    return 1;
+}
+
+// Bookings response (all reservations of a flight or passenger)
+int protocol_encode_bookings(OutputBuffer* out, uint32_t id, const ReservationRecord* records, int count) {
+    char* frame = begin_response(out, 4 + (size_t)count * PROTOCOL_BOOKING_SIZE, id, PROTOCOL_OK);
+    if (frame == NULL) return 0;
+    char* p = frame + PROTOCOL_HEADER_SIZE + 5;
+    p = put_u32(p, (uint32_t)count);
+    for (int i = 0; i < count; i++) {
+        p = put_u32(p, (uint32_t)records[i].flightId);
+        p = put_u32(p, (uint32_t)records[i].passengerId);
+        p = put_i64(p, (int64_t)records[i].bookingDate);
+        p = put_string(p, records[i].seatNumber);
+    }
+    end_response(out, frame, p);
+    return 1;
+}
+
+// Flight page response
+int protocol_encode_flights(OutputBuffer* out, uint32_t id, const Flight* flights, int count) {
+    char* frame = begin_response(out, 4 + (size_t)count * PROTOCOL_FLIGHT_SIZE, id, PROTOCOL_OK);
+    if (frame == NULL) return 0;
+    char* p = frame + PROTOCOL_HEADER_SIZE + 5;
+    p = put_u32(p, (uint32_t)count);
+    for (int i = 0; i < count; i++) {
+        p = put_flight(p, &flights[i]);
+    }
+    end_response(out, frame, p);
+    return 1;
+}
+
+// Count response
+int protocol_encode_count(OutputBuffer* out, uint32_t id, int count) {
+    char* frame = begin_response(out, 4, id, PROTOCOL_OK);
+    if (frame == NULL) return 0;
+    char* p = put_u32(frame + PROTOCOL_HEADER_SIZE + 5, (uint32_t)count);
+    end_response(out, frame, p);
+    return 1;
+}
+
+// Read a flight body
+static void get_flight(Reader* reader, Flight* flight) {
+    flight->id = (int)get_u32(reader);
+    get_string(reader, flight->flightNumber, sizeof(flight->flightNumber));
+    get_string(reader, flight->origin, sizeof(flight->origin));
+    get_string(reader, flight->destination, sizeof(flight->destination));
+    flight->departureTime = (time_t)get_i64(reader);
+    flight->capacity = (int)get_u32(reader);
+}
+
+// Decode a response payload for an operation
+int protocol_decode_response(const char* payload, size_t length, int op, ProtocolResponse* response) {
+    Reader reader = {(const unsigned char*)payload, length, 1};
+    response->id = get_u32(&reader);
+    response->status = (int)get_u8(&reader);
+    response->count = 0;
+    if (!reader.ok) return 0;
+    if (response->status != PROTOCOL_OK) return reader.left == 0;
+    
+    switch (op) {
+        case PROTOCOL_FLIGHT_BY_ID:
+        case PROTOCOL_FLIGHT_BY_NUMBER:
+            get_flight(&reader, &response->flight);
+            response->count = 1;
+            break;
+        case PROTOCOL_PASSENGER_BY_ID:
+        case PROTOCOL_PASSENGER_BY_NAME: {
+            Passenger* passenger = &response->passenger;
+            passenger->id = (int)get_u32(&reader);
+            get_string(&reader, passenger->name, sizeof(passenger->name));
+            get_string(&reader, passenger->passportNumber, sizeof(passenger->passportNumber));
+            response->count = 1;
+            break;
+        }
+        case PROTOCOL_FLIGHT_BOOKINGS:
+        case PROTOCOL_PASSENGER_BOOKINGS: {
+            response->count = (int)get_u32(&reader);
+            char seat[MAX_SEAT_NUMBER_LENGTH];
+            for (int i = 0; i < response->count && reader.ok; i++) {
+                get_u32(&reader);
+                get_u32(&reader);
+                get_i64(&reader);
+                get_string(&reader, seat, sizeof(seat));
+            }
+            break;
+        }
+        case PROTOCOL_LIST_FLIGHTS:
+            response->count = (int)get_u32(&reader);
+            for (int i = 0; i < response->count && reader.ok; i++) {
+                get_flight(&reader, &response->flight);
+            }
+            break;
+        case PROTOCOL_COUNT_FLIGHTS:
+            response->count = (int)get_u32(&reader);
+            break;
+        default:
+            break;
+    }
+    return reader.ok && reader.left == 0;
+}
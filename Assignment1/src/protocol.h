@@ -0,0 +1,118 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "airline_types.h"
+#include "csv_writer.h"
+
+// Binary query protocol used by --serve and the load generator. All integers are
+// little-endian; strings are a 1-byte length followed by that many bytes.
+//
+// Every message is a frame: <u32 payload length> <payload>
+//   Request payload:  <u8 op> <u32 request id> <arguments>
+//   Response payload: <u32 request id> <u8 status> <body>
+//
+// Request arguments by op:
+//   FLIGHT_BY_ID, PASSENGER_BY_ID         <i32 id>
+//   FLIGHT_BY_NUMBER, PASSENGER_BY_NAME   <str key>
+//   FLIGHT_BOOKINGS, PASSENGER_BOOKINGS   <i32 id>
+//   BOOK                                  <i32 flightId> <i32 passengerId> <str seat>
+//   CANCEL                                <i32 flightId> <i32 passengerId>
+//   LIST_FLIGHTS                          <i32 afterId> <u32 limit>
+//   COUNT_FLIGHTS                         <i32 lowId> <i32 highId>
+//
+// Response bodies (status OK only):
+//   flight:       <i32 id> <str number> <str origin> <str destination> <i64 departure> <i32 capacity>
+//   passenger:    <i32 id> <str name> <str passport>
+//   bookings:     <u32 count> then per record <i32 flightId> <i32 passengerId> <i64 bookingDate> <str seat>
+//   flight page:  <u32 count> then a flight body per flight, in ID order (the next page starts
+//                 after the last ID)
+//   count:        <u32 count>
+//   book, cancel: empty
+//
+// A client may send any number of requests without waiting (pipelining);
+// responses on one connection always come back in request order.
+
+// Size of the frame length prefix
+#define PROTOCOL_HEADER_SIZE 4
+
+// Largest payload accepted in either direction (bytes)
+#define PROTOCOL_MAX_PAYLOAD (16 * 1024 * 1024)
+
+// Upper bound on the encoded size of one record in a bookings response
+#define PROTOCOL_BOOKING_SIZE (4 + 4 + 8 + 1 + MAX_SEAT_NUMBER_LENGTH)
+
+// Upper bound on the encoded size of one flight body
+#define PROTOCOL_FLIGHT_SIZE (4 + 3 * 256 + 8 + 4)
+
+// Most flights in one LIST_FLIGHTS response
+#define PROTOCOL_MAX_FLIGHT_PAGE 1000
+
+// Upper bound on the size of an encoded request frame
+#define PROTOCOL_MAX_REQUEST (PROTOCOL_HEADER_SIZE + 16 + 2 * 256)
+
+// Operations
+typedef enum {
+    PROTOCOL_FLIGHT_BY_ID = 1,
+    PROTOCOL_FLIGHT_BY_NUMBER,
+    PROTOCOL_PASSENGER_BY_ID,
+    PROTOCOL_PASSENGER_BY_NAME,
+    PROTOCOL_FLIGHT_BOOKINGS,
+    PROTOCOL_PASSENGER_BOOKINGS,
+    PROTOCOL_BOOK,
+    PROTOCOL_CANCEL,
+    PROTOCOL_LIST_FLIGHTS,
+    PROTOCOL_COUNT_FLIGHTS
+} ProtocolOp;
+
+// Response statuses
+typedef enum {
+    PROTOCOL_OK = 0,
+    PROTOCOL_NOT_FOUND,
+    PROTOCOL_REJECTED,
+    PROTOCOL_ERROR
+} ProtocolStatus;
+
+// A decoded request
+typedef struct {
+    int op;
+    uint32_t id;
+    int flightId;     // Also the ID of FLIGHT_BY_ID and FLIGHT_BOOKINGS
+    int passengerId;  // Also the ID of PASSENGER_BY_ID and PASSENGER_BOOKINGS
+    char key[MAX_PASSENGER_NAME_LENGTH];  // Flight number, passenger name or seat
+    int limit;        // Page size of LIST_FLIGHTS (flightId is the ID to list after)
+    int highId;       // Upper ID of COUNT_FLIGHTS (flightId is the lower)
+} ProtocolRequest;
+
+// A decoded response (records of a bookings response are counted, not kept)
+typedef struct {
+    uint32_t id;
+    int status;
+    Flight flight;        // Set for OK flight lookups, and the last flight of a flight page
+    Passenger passenger;  // Set for OK passenger lookups
+    int count;            // Number of records in a bookings response or flight page, or the count
+} ProtocolResponse;
+
+// Length of the frame at the start of `data`: the whole frame size if it is complete,
+// 0 if more bytes are needed, or -1 if the declared payload is too large
+long protocol_frame_length(const char* data, size_t available);
+
+// Encode a request frame into `out` (at least PROTOCOL_MAX_REQUEST bytes). Returns its size
+size_t protocol_encode_request(char* out, const ProtocolRequest* request);
+
+// Decode a request payload. Returns 1 if it is well formed
+int protocol_decode_request(const char* payload, size_t length, ProtocolRequest* request);
+
+// Response encoders: each appends one complete frame to `out`. Return 1 on success
+int protocol_encode_status(OutputBuffer* out, uint32_t id, int status);
+int protocol_encode_flight(OutputBuffer* out, uint32_t id, const Flight* flight);
+int protocol_encode_passenger(OutputBuffer* out, uint32_t id, const Passenger* passenger);
+int protocol_encode_bookings(OutputBuffer* out, uint32_t id, const ReservationRecord* records, int count);
+int protocol_encode_flights(OutputBuffer* out, uint32_t id, const Flight* flights, int count);
+int protocol_encode_count(OutputBuffer* out, uint32_t id, int count);
+
+// Decode a response payload for an operation. Returns 1 if it is well formed
+int protocol_decode_response(const char* payload, size_t length, int op, ProtocolResponse* response);
+
+#endif
@@ -9,10 +9,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "flight_management.h"
+#include "../mem_stats.h"
 
 // Create a new BST node
 BST_Node* create_node(Flight flight) {
-    BST_Node* node = (BST_Node*)malloc(sizeof(BST_Node));
+    BST_Node* node = (BST_Node*)mem_alloc(MEM_FLIGHT_BST, sizeof(BST_Node));
     if (node == NULL) {
         fprintf(stderr, "Memory allocation failed for BST node\n");
         exit(1);
@@ -45,6 +46,35 @@ BST_Node* insert(BST_Node* root, Flight flight) {
     return root;
 }
 
+// Delete a flight from the BST
+BST_Node* delete_flight(BST_Node* root, int id, int* deleted) {
+    if (root == NULL) {
+        return NULL;
+    }
+    
+    if (id < root->data.id) {
+        root->left = delete_flight(root->left, id, deleted);
+    } else if (id > root->data.id) {
+        root->right = delete_flight(root->right, id, deleted);
+    } else if (root->left == NULL || root->right == NULL) {
+        // Zero or one child: splice the node out
+        BST_Node* child = root->left != NULL ? root->left : root->right;
+        mem_free(MEM_FLIGHT_BST, root, sizeof(BST_Node));
+        *deleted = 1;
+        return child;
+    } else {
+        // Two children: take over the in-order successor's flight, then delete the successor
+        BST_Node* successor = root->right;
+        while (successor->left != NULL) {
+            successor = successor->left;
+        }
+        root->data = successor->data;
+        root->right = delete_flight(root->right, successor->data.id, deleted);
+    }
+    
+    return root;
+}
+
 // Find a flight in the BST
 Flight* find_flight(BST_Node* root, int id) {
     // Base cases: root is NULL or flight is at root
@@ -76,6 +106,6 @@ void free_tree(BST_Node* root) {
     if (root != NULL) {
         free_tree(root->left);
         free_tree(root->right);
-        free(root);
+        mem_free(MEM_FLIGHT_BST, root, sizeof(BST_Node));
     }
 }
@@ -10,6 +10,10 @@ BST_Node* create_node(Flight flight);
 // Insert a flight into the BST
 BST_Node* insert(BST_Node* root, Flight flight);
 
+// Delete a flight from the BST. Sets *deleted to 1 if the flight was found.
+// Returns the new root; Flight pointers into the tree are invalidated
+BST_Node* delete_flight(BST_Node* root, int id, int* deleted);
+
 // Find a flight in the BST
 Flight* find_flight(BST_Node* root, int id);
 
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include "../airline_types.h"
 #include "flight_management.h"
 
@@ -23,3 +24,57 @@ Flight* find_flight_by_number(BST_Node* root, const char* flight_number) {
     
     return find_flight_by_number(root->right, flight_number);
 }
+
+// In-order walk copying flights with IDs above `after_id`, skipping the first *skip of them
+static void collect_flights(BST_Node* root, int after_id, int* skip, Flight* page, int limit, int* count) {
+    if (root == NULL || *count >= limit) {
+        return;
+    }
+    
+    // Everything on the left is smaller, so it can only match if this node is above after_id
+    if (root->data.id > after_id) {
+        collect_flights(root->left, after_id, skip, page, limit, count);
+        if (*count >= limit) {
+            return;
+        }
+        if (*skip > 0) {
+            (*skip)--;
+        } else {
+            page[(*count)++] = root->data;
+        }
+    }
+    collect_flights(root->right, after_id, skip, page, limit, count);
+}
+
+// Copy up to `limit` flights with IDs above `after_id`, in ID order
+int list_flights_after(BST_Node* root, int after_id, Flight* page, int limit) {
+    int skip = 0;
+    int count = 0;
+    collect_flights(root, after_id, &skip, page, limit, &count);
+    return count;
+}
+
+// Copy up to `limit` flights starting at position `start` in ID order
+int list_flights_from_rank(BST_Node* root, int start, Flight* page, int limit) {
+    int skip = start > 0 ? start : 0;
+    int count = 0;
+    collect_flights(root, INT_MIN, &skip, page, limit, &count);
+    return count;
+}
+
+// Count the flights with IDs in [low, high]
+int count_flights_in_range(BST_Node* root, int low, int high) {
+    if (root == NULL || low > high) {
+        return 0;
+    }
+    
+    // Only visit subtrees that can hold IDs in the range
+    int count = (root->data.id >= low && root->data.id <= high) ? 1 : 0;
+    if (root->data.id > low) {
+        count += count_flights_in_range(root->left, low, high);
+    }
+    if (root->data.id < high) {
+        count += count_flights_in_range(root->right, low, high);
+    }
+    return count;
+}
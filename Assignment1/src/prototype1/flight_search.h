@@ -7,4 +7,13 @@
 // Search for a flight by flight number in BST
 Flight* find_flight_by_number(BST_Node* root, const char* flight_number);
 
+// Copy up to `limit` flights into `page` in ID order, starting after flight `after_id`
+// or at position `start`. The BST keeps no subtree sizes, so reaching position `start`
+// walks every flight before it. Return the number copied
+int list_flights_after(BST_Node* root, int after_id, Flight* page, int limit);
+int list_flights_from_rank(BST_Node* root, int start, Flight* page, int limit);
+
+// Count the flights with IDs in [low, high]
+int count_flights_in_range(BST_Node* root, int low, int high);
+
 #endif
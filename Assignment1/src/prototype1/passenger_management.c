@@ -1,19 +1,164 @@
 /*
- * Passenger Management Linked List Implementation (Prototype 1)
- * 
+ * Passenger Management Skip List Implementation (Prototype 1)
+ *
+ * Passengers are kept in a skip list whose level 0 is the original sorted linked list, so code
+ * that walks `next` still sees every passenger in ID order. Higher levels skip ahead for
+ * O(log n) expected insert, find and remove. The pointers of a node above level 0 (its tower)
+ * are carved out of chunks owned by the list, so towers built together sit together in memory.
+ *
  * Sources used:
  * 1. The C Programming Language (K&R) - Linked list concepts
  * 2. Data Structures and Algorithm Analysis by Mark Allen Weiss - List operations
+ * 3. "Skip Lists: A Probabilistic Alternative to Balanced Trees" by William Pugh - Search, insert and delete
+ * 4. "xorshift RNGs" by George Marsaglia - Level generator
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "passenger_management.h"
+#include "../mem_stats.h"
 
-// Create a new linked list node for a passenger
+// Tower pointers per pool chunk
+#define TOWER_CHUNK_POINTERS 4096
+
+// One block of tower pointers
+typedef struct TowerChunk {
+    struct TowerChunk* next;
+    LL_Node* pointers[TOWER_CHUNK_POINTERS];
+} TowerChunk;
+
+// Towers of one list: chunks handed out in order, with a free list per tower size
+typedef struct SkipTowerPool {
+    TowerChunk* chunks;
+    int used;                                            // Pointers handed out of the newest chunk
+    LL_Node** free_towers[PASSENGER_SKIP_MAX_LEVEL];     // Freed towers by pointer count
+    int top_level;                                       // Highest level any node has used
+    unsigned long long random_state;
+} SkipTowerPool;
+
+// Create an empty tower pool
+static SkipTowerPool* create_tower_pool() {
+    SkipTowerPool* pool = (SkipTowerPool*)mem_alloc(MEM_PASSENGER_LIST_TOWERS, sizeof(SkipTowerPool));
+    if (pool == NULL) {
+        fprintf(stderr, "Memory allocation failed for passenger tower pool\n");
+        exit(1);
+    }
+    
+    memset(pool, 0, sizeof(SkipTowerPool));
+    pool->top_level = 1;
+    pool->random_state = 0x9E3779B97F4A7C15ULL;
+    return pool;
+}
+
+// Take a tower of `size` pointers, reusing a freed one of the same size when possible
+static LL_Node** tower_alloc(SkipTowerPool* pool, int size) {
+    LL_Node** tower = pool->free_towers[size];
+    if (tower != NULL) {
+        pool->free_towers[size] = (LL_Node**)tower[0];
+        return tower;
+    }
+    
+    if (pool->chunks == NULL || pool->used + size > TOWER_CHUNK_POINTERS) {
+        TowerChunk* chunk = (TowerChunk*)mem_alloc(MEM_PASSENGER_LIST_TOWERS, sizeof(TowerChunk));
+        if (chunk == NULL) {
+            fprintf(stderr, "Memory allocation failed for passenger towers\n");
+            exit(1);
+        }
+        chunk->next = pool->chunks;
+        pool->chunks = chunk;
+        pool->used = 0;
+    }
+    tower = pool->chunks->pointers + pool->used;
+    pool->used += size;
+    return tower;
+}
+
+// Return a tower of `size` pointers to the pool
+static void tower_free(SkipTowerPool* pool, LL_Node** tower, int size) {
+    if (tower == NULL) return;
+    
+    tower[0] = (LL_Node*)pool->free_towers[size];
+    pool->free_towers[size] = tower;
+}
+
+// Free the pool and every tower in it
+static void free_tower_pool(SkipTowerPool* pool) {
+    if (pool == NULL) return;
+    
+    TowerChunk* chunk = pool->chunks;
+    while (chunk != NULL) {
+        TowerChunk* next = chunk->next;
+        mem_free(MEM_PASSENGER_LIST_TOWERS, chunk, sizeof(TowerChunk));
+        chunk = next;
+    }
+    mem_free(MEM_PASSENGER_LIST_TOWERS, pool, sizeof(SkipTowerPool));
+}
+
+// Draw a level for a new node: each extra level with probability 1/4
+static int random_level(SkipTowerPool* pool) {
+    unsigned long long x = pool->random_state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    pool->random_state = x;
+    
+    int level = 1;
+    while (level < PASSENGER_SKIP_MAX_LEVEL && (x & 3) == 0) {
+        level++;
+        x >>= 2;
+    }
+    if (level > pool->top_level) {
+        pool->top_level = level;
+    }
+    return level;
+}
+
+// Next node on a level
+static LL_Node* forward(LL_Node* node, int level) {
+    return level == 0 ? node->next : node->tower[level - 1];
+}
+
+// Link a node to `target` on a level
+static void set_forward(LL_Node* node, int level, LL_Node* target) {
+    if (level == 0) {
+        node->next = target;
+    } else {
+        node->tower[level - 1] = target;
+    }
+}
+
+// Give a head node every level and a tower pool, if it does not have them yet
+static void promote_head(LL_Node* head) {
+    if (head->pool != NULL) return;
+    
+    head->pool = create_tower_pool();
+    head->tower = tower_alloc(head->pool, PASSENGER_SKIP_MAX_LEVEL - 1);
+    for (int i = 0; i < PASSENGER_SKIP_MAX_LEVEL - 1; i++) {
+        head->tower[i] = NULL;
+    }
+    head->level = PASSENGER_SKIP_MAX_LEVEL;
+}
+
+// Find the last node before `id` on every level, for an ID above the head's
+static void find_predecessors(LL_Node* head, int id, LL_Node** update) {
+    LL_Node* node = head;
+    for (int i = head->pool->top_level; i < PASSENGER_SKIP_MAX_LEVEL; i++) {
+        update[i] = head;
+    }
+    for (int i = head->pool->top_level - 1; i >= 0; i--) {
+        LL_Node* next = forward(node, i);
+        while (next != NULL && next->data.id < id) {
+            node = next;
+            next = forward(node, i);
+        }
+        update[i] = node;
+    }
+}
+
+// Create a new single-level node for a passenger
 LL_Node* create_passenger_node(Passenger passenger) {
-    LL_Node* new_node = (LL_Node*)malloc(sizeof(LL_Node));
+    LL_Node* new_node = (LL_Node*)mem_alloc(MEM_PASSENGER_LIST, sizeof(LL_Node));
     if (new_node == NULL) {
         fprintf(stderr, "Memory allocation failed for passenger node\n");
         exit(1);
@@ -21,113 +166,176 @@ LL_Node* create_passenger_node(Passenger passenger) {
     
     new_node->data = passenger;
     new_node->next = NULL;
+    new_node->tower = NULL;
+    new_node->level = 1;
+    new_node->pool = NULL;
     
     return new_node;
 }
 
-// Insert a passenger into the linked list
+// Insert a passenger into the skip list
 LL_Node* insert_passenger(LL_Node* head, Passenger passenger) {
-    // Create a new node for the passenger
-    LL_Node* new_node = create_passenger_node(passenger);
-    
-    // If list is empty, make the new node the head
+    // If list is empty, the new node is the head
     if (head == NULL) {
+        LL_Node* new_node = create_passenger_node(passenger);
+        promote_head(new_node);
         return new_node;
     }
+    promote_head(head);
+    SkipTowerPool* pool = head->pool;
     
-    // If passenger ID is smaller than the head, insert at beginning
+    // If passenger with same ID is the head, update the data
+    if (passenger.id == head->data.id) {
+        head->data = passenger;
+        return head;
+    }
+    
+    // A smaller ID becomes the head: it takes over the full tower, and the old head keeps
+    // a random level of its own
     if (passenger.id < head->data.id) {
+        LL_Node* new_node = create_passenger_node(passenger);
+        int level = random_level(pool);
+        LL_Node** full_tower = head->tower;
+        LL_Node** tower = level > 1 ? tower_alloc(pool, level - 1) : NULL;
+        for (int i = 1; i < level; i++) {
+            tower[i - 1] = full_tower[i - 1];
+            full_tower[i - 1] = head;
+        }
         new_node->next = head;
+        new_node->tower = full_tower;
+        new_node->level = PASSENGER_SKIP_MAX_LEVEL;
+        new_node->pool = pool;
+        head->tower = tower;
+        head->level = level;
+        head->pool = NULL;
         return new_node;
     }
     
-    // Find the correct position to insert
-    LL_Node* current = head;
-    while (current->next != NULL && current->next->data.id < passenger.id) {
-        current = current->next;
-    }
+    // Find the correct position on every level
+    LL_Node* update[PASSENGER_SKIP_MAX_LEVEL];
+    find_predecessors(head, passenger.id, update);
     
     // If passenger with same ID exists, update the data
-    if (current->next != NULL && current->next->data.id == passenger.id) {
-        current->next->data = passenger;
-    } else {
-        // Insert the new node after the current node
-        new_node->next = current->next;
-        current->next = new_node;
+    if (update[0]->next != NULL && update[0]->next->data.id == passenger.id) {
+        update[0]->next->data = passenger;
+        return head;
+    }
+    
+    // Link the new node in on each of its levels
+    LL_Node* new_node = create_passenger_node(passenger);
+    int level = random_level(pool);
+    if (level > 1) {
+        new_node->tower = tower_alloc(pool, level - 1);
+    }
+    new_node->level = level;
+    for (int i = 0; i < level; i++) {
+        set_forward(new_node, i, forward(update[i], i));
+        set_forward(update[i], i, new_node);
     }
     
     return head;
 }
 
-// Find a passenger in the linked list
+// Find a passenger in the skip list
 Passenger* find_passenger(LL_Node* head, int id) {
-    LL_Node* current = head;
+    if (head == NULL || id < head->data.id) {
+        return NULL;
+    }
+    if (head->data.id == id) {
+        return &(head->data);
+    }
     
-    // Traverse the list
-    while (current != NULL) {
-        if (current->data.id == id) {
-            return &(current->data);
+    // Drop down a level whenever the next node would overshoot; a head without a pool
+    // only has level 0
+    LL_Node* current = head;
+    int top_level = head->pool != NULL ? head->pool->top_level : 1;
+    for (int i = top_level - 1; i >= 0; i--) {
+        LL_Node* next = forward(current, i);
+        while (next != NULL && next->data.id < id) {
+            current = next;
+            next = forward(current, i);
         }
-        current = current->next;
+    }
+    
+    current = current->next;
+    if (current != NULL && current->data.id == id) {
+        return &(current->data);
     }
     
     // Not found
     return NULL;
 }
 
-// Print all passengers in the linked list
+// Print all passengers in ID order
 void print_passengers(LL_Node* head) {
     LL_Node* current = head;
     
     while (current != NULL) {
-        printf("Passenger ID: %d, Name: %s, Passport: %s\n", 
+        printf("Passenger ID: %d, Name: %s, Passport: %s\n",
                current->data.id, current->data.name, current->data.passportNumber);
         current = current->next;
     }
 }
 
-// Remove a passenger from the linked list
+// Remove a passenger from the skip list
 LL_Node* remove_passenger(LL_Node* head, int id) {
-    // If list is empty
-    if (head == NULL) {
-        return NULL;
+    // If list is empty or the ID is below every passenger
+    if (head == NULL || id < head->data.id) {
+        return head;
     }
+    promote_head(head);
+    SkipTowerPool* pool = head->pool;
     
-    // If the head node itself holds the key to be deleted
+    // If the head node itself holds the key to be deleted, the next node takes over the full
+    // tower: its own pointers below its level and the old head's above
     if (head->data.id == id) {
-        LL_Node* temp = head;
-        head = head->next;
-        free(temp);
-        return head;
+        LL_Node* next = head->next;
+        if (next == NULL) {
+            free_tower_pool(pool);
+            mem_free(MEM_PASSENGER_LIST, head, sizeof(LL_Node));
+            return NULL;
+        }
+        for (int i = 1; i < next->level; i++) {
+            head->tower[i - 1] = next->tower[i - 1];
+        }
+        tower_free(pool, next->tower, next->level - 1);
+        next->tower = head->tower;
+        next->level = PASSENGER_SKIP_MAX_LEVEL;
+        next->pool = pool;
+        mem_free(MEM_PASSENGER_LIST, head, sizeof(LL_Node));
+        return next;
     }
     
     // Search for the key to be deleted
-    LL_Node* current = head;
-    while (current->next != NULL && current->next->data.id != id) {
-        current = current->next;
-    }
+    LL_Node* update[PASSENGER_SKIP_MAX_LEVEL];
+    find_predecessors(head, id, update);
+    LL_Node* target = update[0]->next;
     
     // If the key was not present
-    if (current->next == NULL) {
+    if (target == NULL || target->data.id != id) {
         return head;
     }
     
-    // Remove the node
-    LL_Node* temp = current->next;
-    current->next = temp->next;
-    free(temp);
+    // Unlink the node from each of its levels
+    for (int i = 0; i < target->level; i++) {
+        set_forward(update[i], i, forward(target, i));
+    }
+    tower_free(pool, target->tower, target->level - 1);
+    mem_free(MEM_PASSENGER_LIST, target, sizeof(LL_Node));
     
     return head;
 }
 
-// Free linked list memory
+// Free the skip list and its tower pool
 void free_list(LL_Node* head) {
+    SkipTowerPool* pool = head != NULL ? head->pool : NULL;
     LL_Node* current = head;
     LL_Node* next;
     
     while (current != NULL) {
         next = current->next;
-        free(current);
+        mem_free(MEM_PASSENGER_LIST, current, sizeof(LL_Node));
         current = next;
     }
+    free_tower_pool(pool);
 }
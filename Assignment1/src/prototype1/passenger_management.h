@@ -4,22 +4,26 @@
 // Include airline_types.h first to get all type definitions
 #include "../airline_types.h"
 
-// Create a new linked list node for a passenger
+// Most levels in the passenger skip list (each level holds about a quarter of the one below)
+#define PASSENGER_SKIP_MAX_LEVEL 16
+
+// Create a new single-level node for a passenger. Nodes linked by hand through `next` in ID
+// order still form a valid list for the functions below
 LL_Node* create_passenger_node(Passenger passenger);
 
-// Insert a passenger into the linked list
+// Insert a passenger into the skip list (replacing one with the same ID). Returns the new head
 LL_Node* insert_passenger(LL_Node* head, Passenger passenger);
 
-// Find a passenger in the linked list
+// Find a passenger in the skip list in O(log n) expected time
 Passenger* find_passenger(LL_Node* head, int id);
 
-// Print all passengers in the linked list
+// Print all passengers in ID order
 void print_passengers(LL_Node* head);
 
-// Remove a passenger from the linked list
+// Remove a passenger from the skip list. Returns the new head
 LL_Node* remove_passenger(LL_Node* head, int id);
 
-// Free linked list memory
+// Free the skip list and its tower pool
 void free_list(LL_Node* head);
 
 #endif
@@ -0,0 +1,392 @@
+/*
+ * Unrolled Passenger List Implementation (Prototype 1)
+ *
+ * A linked list of blocks, each holding up to UNROLLED_BLOCK_CAPACITY passenger IDs in order
+ * with pointers to the passenger records. A scan follows one link per block instead of one
+ * per passenger, the IDs of a block share its first two cache lines, and the next block and
+ * its records are prefetched while the current block is compared. Blocks and records are
+ * carved out of 64-byte aligned chunks.
+ *
+ * Sources used:
+ * 1. "Fast Sorting with Unrolled Linked Lists" by Shao, Reppy and Appel - Block splitting and merging
+ * 2. Data Structures and Algorithm Analysis by Mark Allen Weiss - List operations
+ * 3. "What Every Programmer Should Know About Memory" by Ulrich Drepper - Cache lines and prefetching
+ */
+#define _GNU_SOURCE  // For strcasestr function
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "passenger_unrolled.h"
+#include "../mem_stats.h"
+
+// Usable bytes per slab chunk
+#define SLAB_CHUNK_BYTES 65536
+
+// Bytes allocated per chunk: the usable bytes, the chunk link and room to align the slots
+#define SLAB_CHUNK_ALLOCATION (SLAB_CHUNK_BYTES + 128)
+
+// Bytes per record slot (a Passenger rounded up to whole cache lines)
+#define PAYLOAD_SLOT_BYTES ((sizeof(Passenger) + 63) / 64 * 64)
+
+// Set up an empty slab of `slot_size`-byte slots
+static void slab_init(UnrolledSlab* slab, size_t slot_size) {
+    slab->chunks = NULL;
+    slab->free_slots = NULL;
+    slab->cursor = NULL;
+    slab->end = NULL;
+    slab->slot_size = slot_size;
+}
+
+// Take a slot, reusing a freed one when possible. Returns NULL on failure
+static void* slab_alloc(UnrolledSlab* slab) {
+    if (slab->free_slots != NULL) {
+        void* slot = slab->free_slots;
+        slab->free_slots = *(void**)slot;
+        return slot;
+    }
+    
+    if (slab->cursor == NULL || slab->cursor + slab->slot_size > slab->end) {
+        char* chunk = (char*)mem_alloc(MEM_PASSENGER_UNROLLED, SLAB_CHUNK_ALLOCATION);
+        if (chunk == NULL) {
+            return NULL;
+        }
+        *(void**)chunk = slab->chunks;
+        slab->chunks = chunk;
+        slab->cursor = (char*)(((uintptr_t)chunk + sizeof(void*) + 63) & ~(uintptr_t)63);
+        slab->end = slab->cursor + SLAB_CHUNK_BYTES;
+    }
+    void* slot = slab->cursor;
+    slab->cursor += slab->slot_size;
+    return slot;
+}
+
+// Return a slot to the slab
+static void slab_free(UnrolledSlab* slab, void* slot) {
+    *(void**)slot = slab->free_slots;
+    slab->free_slots = slot;
+}
+
+// Free every chunk of a slab
+static void slab_destroy(UnrolledSlab* slab) {
+    void* chunk = slab->chunks;
+    while (chunk != NULL) {
+        void* next = *(void**)chunk;
+        mem_free(MEM_PASSENGER_UNROLLED, chunk, SLAB_CHUNK_ALLOCATION);
+        chunk = next;
+    }
+    slab_init(slab, slab->slot_size);
+}
+
+// Take an empty block. Returns NULL on failure
+static PassengerBlock* new_block(UnrolledPassengerList* list) {
+    PassengerBlock* block = (PassengerBlock*)slab_alloc(&list->blocks);
+    if (block == NULL) {
+        return NULL;
+    }
+    block->next = NULL;
+    block->count = 0;
+    list->block_count++;
+    return block;
+}
+
+// Return a block to the list's slab
+static void release_block(UnrolledPassengerList* list, PassengerBlock* block) {
+    slab_free(&list->blocks, block);
+    list->block_count--;
+}
+
+// Find the block an ID belongs in: the last block whose first ID is not above it (or the
+// head), along with the block before it
+static PassengerBlock* find_block(UnrolledPassengerList* list, int id, PassengerBlock** previous) {
+    PassengerBlock* block = list->head;
+    PassengerBlock* before = NULL;
+    while (block->next != NULL && block->next->ids[0] <= id) {
+        before = block;
+        block = block->next;
+    }
+    if (previous != NULL) {
+        *previous = before;
+    }
+    return block;
+}
+
+// Position of the first ID in a block that is not below `id`
+static int find_position(const PassengerBlock* block, int id) {
+    int position = 0;
+    while (position < block->count && block->ids[position] < id) {
+        position++;
+    }
+    return position;
+}
+
+// Create an empty list
+UnrolledPassengerList* unrolled_create() {
+    UnrolledPassengerList* list = (UnrolledPassengerList*)mem_alloc(MEM_PASSENGER_UNROLLED,
+                                                                    sizeof(UnrolledPassengerList));
+    if (list == NULL) {
+        fprintf(stderr, "Memory allocation failed for unrolled passenger list\n");
+        return NULL;
+    }
+    
+    list->head = NULL;
+    list->count = 0;
+    list->block_count = 0;
+    slab_init(&list->blocks, sizeof(PassengerBlock));
+    slab_init(&list->payloads, PAYLOAD_SLOT_BYTES);
+    return list;
+}
+
+// A passenger's ID and position in the input, for sorting a bulk build
+typedef struct {
+    int id;
+    int index;
+} BuildKey;
+
+// Order build keys by ID, then by input position
+static int compare_build_keys(const void* a, const void* b) {
+    const BuildKey* left = (const BuildKey*)a;
+    const BuildKey* right = (const BuildKey*)b;
+    if (left->id != right->id) return (left->id > right->id) - (left->id < right->id);
+    return (left->index > right->index) - (left->index < right->index);
+}
+
+// Build a list from passengers in any order
+UnrolledPassengerList* unrolled_build(const Passenger* passengers, int count) {
+    UnrolledPassengerList* list = unrolled_create();
+    BuildKey* keys = count > 0 ? (BuildKey*)malloc(count * sizeof(BuildKey)) : NULL;
+    if (list == NULL || (count > 0 && keys == NULL)) {
+        fprintf(stderr, "Memory allocation failed for unrolled passenger list\n");
+        free(keys);
+        unrolled_free(list);
+        return NULL;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        keys[i].id = passengers[i].id;
+        keys[i].index = i;
+    }
+    qsort(keys, count, sizeof(BuildKey), compare_build_keys);
+    
+    // Append the last copy of each ID, starting a new block every UNROLLED_BUILD_FILL passengers
+    PassengerBlock* tail = NULL;
+    for (int i = 0; i < count; i++) {
+        if (i + 1 < count && keys[i + 1].id == keys[i].id) {
+            continue;
+        }
+        if (tail == NULL || tail->count == UNROLLED_BUILD_FILL) {
+            PassengerBlock* block = new_block(list);
+            if (block == NULL) {
+                fprintf(stderr, "Memory allocation failed for unrolled passenger block\n");
+                free(keys);
+                unrolled_free(list);
+                return NULL;
+            }
+            if (tail == NULL) {
+                list->head = block;
+            } else {
+                tail->next = block;
+            }
+            tail = block;
+        }
+        Passenger* payload = (Passenger*)slab_alloc(&list->payloads);
+        if (payload == NULL) {
+            fprintf(stderr, "Memory allocation failed for unrolled passenger record\n");
+            free(keys);
+            unrolled_free(list);
+            return NULL;
+        }
+        *payload = passengers[keys[i].index];
+        tail->ids[tail->count] = keys[i].id;
+        tail->payloads[tail->count] = payload;
+        tail->count++;
+        list->count++;
+    }
+    
+    free(keys);
+    return list;
+}
+
+// Insert a passenger, splitting its block if full
+int unrolled_insert(UnrolledPassengerList* list, Passenger passenger) {
+    if (list == NULL) return -1;
+    
+    // The first passenger starts the first block
+    if (list->head == NULL) {
+        list->head = new_block(list);
+        if (list->head == NULL) {
+            fprintf(stderr, "Memory allocation failed for unrolled passenger block\n");
+            return -1;
+        }
+    }
+    
+    PassengerBlock* block = find_block(list, passenger.id, NULL);
+    int position = find_position(block, passenger.id);
+    
+    // If passenger with same ID exists, update the data
+    if (position < block->count && block->ids[position] == passenger.id) {
+        *block->payloads[position] = passenger;
+        return 0;
+    }
+    
+    Passenger* payload = (Passenger*)slab_alloc(&list->payloads);
+    if (payload == NULL) {
+        fprintf(stderr, "Memory allocation failed for unrolled passenger record\n");
+        return -1;
+    }
+    
+    // A full block moves its upper half into a new block after it
+    if (block->count == UNROLLED_BLOCK_CAPACITY) {
+        PassengerBlock* upper = new_block(list);
+        if (upper == NULL) {
+            fprintf(stderr, "Memory allocation failed for unrolled passenger block\n");
+            slab_free(&list->payloads, payload);
+            return -1;
+        }
+        int half = UNROLLED_BLOCK_CAPACITY / 2;
+        upper->count = UNROLLED_BLOCK_CAPACITY - half;
+        memcpy(upper->ids, block->ids + half, upper->count * sizeof(int));
+        memcpy(upper->payloads, block->payloads + half, upper->count * sizeof(Passenger*));
+        upper->next = block->next;
+        block->next = upper;
+        block->count = half;
+        if (position > half) {
+            block = upper;
+            position -= half;
+        }
+    }
+    
+    // Shift the larger IDs up one place
+    int moved = block->count - position;
+    memmove(block->ids + position + 1, block->ids + position, moved * sizeof(int));
+    memmove(block->payloads + position + 1, block->payloads + position, moved * sizeof(Passenger*));
+    *payload = passenger;
+    block->ids[position] = passenger.id;
+    block->payloads[position] = payload;
+    block->count++;
+    list->count++;
+    return 1;
+}
+
+// Remove a passenger, merging its block with the next one once they fit
+int unrolled_remove(UnrolledPassengerList* list, int id) {
+    if (list == NULL || list->head == NULL) return 0;
+    
+    PassengerBlock* previous = NULL;
+    PassengerBlock* block = find_block(list, id, &previous);
+    int position = find_position(block, id);
+    if (position == block->count || block->ids[position] != id) {
+        return 0;
+    }
+    
+    slab_free(&list->payloads, block->payloads[position]);
+    int moved = block->count - position - 1;
+    memmove(block->ids + position, block->ids + position + 1, moved * sizeof(int));
+    memmove(block->payloads + position, block->payloads + position + 1, moved * sizeof(Passenger*));
+    block->count--;
+    list->count--;
+    
+    // Unlink an empty block
+    if (block->count == 0) {
+        if (previous == NULL) {
+            list->head = block->next;
+        } else {
+            previous->next = block->next;
+        }
+        release_block(list, block);
+        return 1;
+    }
+    
+    // A block below half full absorbs the next block if both fit in one, or else takes
+    // passengers from it until the two are even, so every block but the last stays half full
+    PassengerBlock* next = block->next;
+    if (next == NULL || block->count >= UNROLLED_BLOCK_CAPACITY / 2) {
+        return 1;
+    }
+    int taken = next->count;
+    if (block->count + next->count > UNROLLED_BLOCK_CAPACITY) {
+        taken = (next->count - block->count) / 2;
+    }
+    memcpy(block->ids + block->count, next->ids, taken * sizeof(int));
+    memcpy(block->payloads + block->count, next->payloads, taken * sizeof(Passenger*));
+    block->count += taken;
+    if (taken == next->count) {
+        block->next = next->next;
+        release_block(list, next);
+    } else {
+        next->count -= taken;
+        memmove(next->ids, next->ids + taken, next->count * sizeof(int));
+        memmove(next->payloads, next->payloads + taken, next->count * sizeof(Passenger*));
+    }
+    return 1;
+}
+
+// Find a passenger by ID
+Passenger* unrolled_find(UnrolledPassengerList* list, int id) {
+    if (list == NULL || list->head == NULL) return NULL;
+    
+    PassengerBlock* block = find_block(list, id, NULL);
+    int position = find_position(block, id);
+    if (position < block->count && block->ids[position] == id) {
+        return block->payloads[position];
+    }
+    return NULL;
+}
+
+// Prefetch a whole block
+static void prefetch_block(const PassengerBlock* block) {
+    for (size_t offset = 0; offset < sizeof(PassengerBlock); offset += 64) {
+        __builtin_prefetch((const char*)block + offset);
+    }
+}
+
+// First passenger in ID order whose name contains `name`
+Passenger* unrolled_find_by_name(UnrolledPassengerList* list, const char* name) {
+    if (list == NULL) return NULL;
+    
+    for (PassengerBlock* block = list->head; block != NULL; block = block->next) {
+        // The block after next comes into cache while the next block's records are
+        // requested, all while this block's names are compared
+        PassengerBlock* next = block->next;
+        if (next != NULL) {
+            if (next->next != NULL) {
+                prefetch_block(next->next);
+            }
+            for (int i = 0; i < next->count; i++) {
+                __builtin_prefetch(next->payloads[i]);
+            }
+        }
+        for (int i = 0; i < block->count; i++) {
+            // Case-insensitive substring search
+            if (strcasestr(block->payloads[i]->name, name) != NULL) {
+                return block->payloads[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+// Print all passengers in ID order
+void unrolled_print(UnrolledPassengerList* list) {
+    if (list == NULL) return;
+    
+    for (PassengerBlock* block = list->head; block != NULL; block = block->next) {
+        if (block->next != NULL) {
+            prefetch_block(block->next);
+        }
+        for (int i = 0; i < block->count; i++) {
+            const Passenger* passenger = block->payloads[i];
+            printf("Passenger ID: %d, Name: %s, Passport: %s\n",
+                   passenger->id, passenger->name, passenger->passportNumber);
+        }
+    }
+}
+
+// Free the list
+void unrolled_free(UnrolledPassengerList* list) {
+    if (list == NULL) return;
+    
+    slab_destroy(&list->blocks);
+    slab_destroy(&list->payloads);
+    mem_free(MEM_PASSENGER_UNROLLED, list, sizeof(UnrolledPassengerList));
+}
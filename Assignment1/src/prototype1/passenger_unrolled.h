@@ -0,0 +1,71 @@
+#ifndef PASSENGER_UNROLLED_H
+#define PASSENGER_UNROLLED_H
+
+#include <stddef.h>
+#include "../airline_types.h"
+
+// Passengers per block: with the link, the count and the payload pointers a block is four
+// 64-byte cache lines
+#define UNROLLED_BLOCK_CAPACITY 20
+
+// Passengers per block after a bulk build, leaving room for inserts before a split
+#define UNROLLED_BUILD_FILL 15
+
+// A block of passengers in ID order: the IDs sit together so an ordered scan reads
+// UNROLLED_BLOCK_CAPACITY IDs per link followed, and the passenger records are out of line
+typedef struct PassengerBlock {
+    struct PassengerBlock* next;
+    int count;
+    int ids[UNROLLED_BLOCK_CAPACITY];
+    Passenger* payloads[UNROLLED_BLOCK_CAPACITY];
+} PassengerBlock;
+
+// Fixed-size slots carved 64-byte aligned out of large chunks, with a free list
+typedef struct {
+    void* chunks;      // Chunk allocations, linked through their first word
+    void* free_slots;  // Freed slots, linked through their first word
+    char* cursor;      // Unused slots of the newest chunk
+    char* end;
+    size_t slot_size;
+} UnrolledSlab;
+
+// Unrolled linked list of passengers, an alternative to prototype 1's LL_Node list for
+// full scans. Finding a passenger's block walks the blocks, so inserts and lookups are
+// O(n / UNROLLED_BLOCK_CAPACITY); load large lists with unrolled_build
+typedef struct {
+    PassengerBlock* head;
+    long long count;
+    int block_count;
+    UnrolledSlab blocks;
+    UnrolledSlab payloads;
+} UnrolledPassengerList;
+
+// Create an empty list. Returns NULL on failure
+UnrolledPassengerList* unrolled_create();
+
+// Build a list from passengers in any order (a later duplicate ID replaces an earlier one),
+// with blocks UNROLLED_BUILD_FILL full and records laid out in ID order. Returns NULL on failure
+UnrolledPassengerList* unrolled_build(const Passenger* passengers, int count);
+
+// Insert a passenger, splitting its block if full. Returns 1 if added, 0 if a passenger with
+// the same ID was replaced, -1 on failure
+int unrolled_insert(UnrolledPassengerList* list, Passenger passenger);
+
+// Remove a passenger. A block that falls below half full absorbs the next block, or takes
+// passengers from it when both do not fit in one. Returns 1 if it was present
+int unrolled_remove(UnrolledPassengerList* list, int id);
+
+// Find a passenger by ID
+Passenger* unrolled_find(UnrolledPassengerList* list, int id);
+
+// First passenger in ID order whose name contains `name` (case-insensitive), like
+// find_passenger_by_name. The next block and its records are prefetched during the scan
+Passenger* unrolled_find_by_name(UnrolledPassengerList* list, const char* name);
+
+// Print all passengers in ID order, like print_passengers
+void unrolled_print(UnrolledPassengerList* list);
+
+// Free the list
+void unrolled_free(UnrolledPassengerList* list);
+
+#endif
@@ -8,17 +8,62 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include "reservation_management.h"
+#include "../mem_stats.h"
+#include "../radix_sort.h"
+#include "../simd_scan.h"
+
+// Free the columns
+static void release_columns(ReservationArray* array) {
+    size_t capacity = (size_t)array->capacity;
+    mem_free(MEM_RESERVATION_ARRAY, array->flightIds, capacity * sizeof(int));
+    mem_free(MEM_RESERVATION_ARRAY, array->passengerIds, capacity * sizeof(int));
+    mem_free(MEM_RESERVATION_ARRAY, array->bookingDates, capacity * sizeof(time_t));
+    mem_free(MEM_RESERVATION_ARRAY, array->seatNumbers, capacity * sizeof(*array->seatNumbers));
+    mem_free(MEM_RESERVATION_ARRAY, array->passenger_order, capacity * sizeof(int));
+}
+
+// Move the columns to a new capacity of at least count rows. Returns 0, leaving them as they
+// were, if memory runs out
+static int resize_columns(ReservationArray* array, int capacity) {
+    ReservationArray resized = *array;
+    resized.capacity = capacity;
+    resized.flightIds = (int*)mem_alloc(MEM_RESERVATION_ARRAY, (size_t)capacity * sizeof(int));
+    resized.passengerIds = (int*)mem_alloc(MEM_RESERVATION_ARRAY, (size_t)capacity * sizeof(int));
+    resized.bookingDates = (time_t*)mem_alloc(MEM_RESERVATION_ARRAY, (size_t)capacity * sizeof(time_t));
+    resized.seatNumbers = (char (*)[MAX_SEAT_NUMBER_LENGTH])mem_alloc(MEM_RESERVATION_ARRAY,
+                                                                      (size_t)capacity * sizeof(*resized.seatNumbers));
+    resized.passenger_order = (int*)mem_alloc(MEM_RESERVATION_ARRAY, (size_t)capacity * sizeof(int));
+    if (resized.flightIds == NULL || resized.passengerIds == NULL || resized.bookingDates == NULL ||
+        resized.seatNumbers == NULL || resized.passenger_order == NULL) {
+        release_columns(&resized);
+        return 0;
+    }
+    
+    size_t count = (size_t)array->count;
+    if (count > 0) {
+        memcpy(resized.flightIds, array->flightIds, count * sizeof(int));
+        memcpy(resized.passengerIds, array->passengerIds, count * sizeof(int));
+        memcpy(resized.bookingDates, array->bookingDates, count * sizeof(time_t));
+        memcpy(resized.seatNumbers, array->seatNumbers, count * sizeof(*array->seatNumbers));
+        memcpy(resized.passenger_order, array->passenger_order, (size_t)array->sorted * sizeof(int));
+    }
+    release_columns(array);
+    *array = resized;
+    return 1;
+}
 
 // Initialize reservations array with a given capacity - optimized for large datasets
 ReservationArray* init_reservations(int capacity) {
     // Allocate the array structure
-    ReservationArray* array = (ReservationArray*)malloc(sizeof(ReservationArray));
+    ReservationArray* array = (ReservationArray*)mem_alloc(MEM_RESERVATION_ARRAY, sizeof(ReservationArray));
     if (array == NULL) {
         fprintf(stderr, "Memory allocation failed for reservations array structure\n");
         return NULL;  // Return NULL instead of exit for better error handling
     }
+    memset(array, 0, sizeof(ReservationArray));
     
     // For large datasets, ensure we allocate with sufficient initial capacity
     // to avoid costly reallocations later
@@ -26,19 +71,17 @@ ReservationArray* init_reservations(int capacity) {
         // Add a 10% buffer to avoid frequent reallocations
         capacity = (int)(capacity * 1.1);
         printf("Optimizing reservation array for large dataset with capacity: %d\n", capacity);
+    } else if (capacity < 1) {
+        capacity = 1;
     }
     
-    // Allocate the records array
-    array->records = (ReservationRecord*)malloc(capacity * sizeof(ReservationRecord));
-    if (array->records == NULL) {
+    // Allocate the columns
+    if (!resize_columns(array, capacity)) {
         fprintf(stderr, "Memory allocation failed for %d reservation records\n", capacity);
-        free(array);
+        mem_free(MEM_RESERVATION_ARRAY, array, sizeof(ReservationArray));
         return NULL;  // Return NULL instead of exit for better error handling
     }
     
-    array->capacity = capacity;
-    array->count = 0;
-    
     return array;
 }
 
@@ -66,29 +109,287 @@ void add_reservation(ReservationArray* array, ReservationRecord record) {
             new_capacity = array->capacity * 2;
         }
         
-        // Try to reallocate with new capacity
-        ReservationRecord* new_records = (ReservationRecord*)realloc(array->records, 
-                                                                 new_capacity * sizeof(ReservationRecord));
-        if (new_records == NULL) {
+        // Try to move the columns to the new capacity
+        if (!resize_columns(array, new_capacity)) {
             fprintf(stderr, "Memory allocation failed while resizing reservations array to %d elements\n", 
                    new_capacity);
             
             // Try a smaller increment as a fallback
-            new_capacity = array->capacity + (array->capacity / 10); // Add 10%
-            new_records = (ReservationRecord*)realloc(array->records, 
-                                                 new_capacity * sizeof(ReservationRecord));
-            if (new_records == NULL) {
+            new_capacity = array->capacity + (array->capacity / 10) + 1; // Add 10%
+            if (!resize_columns(array, new_capacity)) {
                 fprintf(stderr, "Critical error: Cannot resize reservation array\n");
                 return;
             }
         }
-        
-        array->records = new_records;
-        array->capacity = new_capacity;
     }
     
-    // Add the record at the end
-    array->records[array->count++] = record;
+    // Add the record at the end, after the sorted rows
+    int row = array->count++;
+    array->flightIds[row] = record.flightId;
+    array->passengerIds[row] = record.passengerId;
+    array->bookingDates[row] = record.bookingDate;
+    memcpy(array->seatNumbers[row], record.seatNumber, MAX_SEAT_NUMBER_LENGTH);
+}
+
+// Copy a row out as a record
+static ReservationRecord row_record(const ReservationArray* array, int row) {
+    ReservationRecord record;
+    record.flightId = array->flightIds[row];
+    record.passengerId = array->passengerIds[row];
+    record.bookingDate = array->bookingDates[row];
+    memcpy(record.seatNumber, array->seatNumbers[row], MAX_SEAT_NUMBER_LENGTH);
+    return record;
+}
+
+// Sort key of a booking: the flight ID above the passenger ID
+static uint64_t booking_key(int flightId, int passengerId) {
+    return ((uint64_t)radix_key_i32(flightId) << 32) | radix_key_i32(passengerId);
+}
+
+static uint64_t row_key(const ReservationArray* array, int row) {
+    return booking_key(array->flightIds[row], array->passengerIds[row]);
+}
+
+// Copy the width-byte entries of a column at rows order[0..moved) to rows first onwards
+static void gather_column(void* column, size_t width, int first, const int* order, int moved, char* scratch) {
+    char* base = (char*)column;
+    for (int i = 0; i < moved; i++) {
+        memcpy(scratch + (size_t)i * width, base + (size_t)order[i] * width, width);
+    }
+    memcpy(base + (size_t)first * width, scratch, (size_t)moved * width);
+}
+
+// Merge the recent rows into the sorted rows: radix sort them, then merge the two runs from
+// the first sorted row that has to move (sorted rows win ties, keeping booking order).
+// Returns 0, leaving the rows as they were, if memory runs out
+static int merge_recent(ReservationArray* array) {
+    int recent = array->count - array->sorted;
+    if (recent == 0) {
+        return 1;
+    }
+    
+    RadixPair* pairs = (RadixPair*)malloc((size_t)recent * sizeof(RadixPair));
+    if (pairs == NULL) {
+        fprintf(stderr, "Memory allocation failed when sorting %d reservations\n", recent);
+        return 0;
+    }
+    for (int i = 0; i < recent; i++) {
+        pairs[i].key = row_key(array, array->sorted + i);
+        pairs[i].value = (uint32_t)(array->sorted + i);
+    }
+    if (!radix_sort_pairs(pairs, recent, 0)) {
+        free(pairs);
+        return 0;
+    }
+    
+    // Sorted rows with keys up to the smallest recent key keep their place
+    int first = 0;
+    int high = array->sorted;
+    while (first < high) {
+        int mid = first + (high - first) / 2;
+        if (row_key(array, mid) <= pairs[0].key) {
+            first = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    int moved = array->count - first;
+    int* order = (int*)malloc((size_t)moved * sizeof(int));
+    size_t widest = sizeof(time_t) > sizeof(*array->seatNumbers) ? sizeof(time_t) : sizeof(*array->seatNumbers);
+    char* scratch = (char*)malloc((size_t)moved * widest);
+    if (order == NULL || scratch == NULL) {
+        fprintf(stderr, "Memory allocation failed when merging %d reservations\n", moved);
+        free(pairs);
+        free(order);
+        free(scratch);
+        return 0;
+    }
+    
+    int next = 0;
+    int row = first;
+    int pair = 0;
+    while (row < array->sorted && pair < recent) {
+        if (row_key(array, row) <= pairs[pair].key) {
+            order[next++] = row++;
+        } else {
+            order[next++] = (int)pairs[pair++].value;
+        }
+    }
+    while (row < array->sorted) {
+        order[next++] = row++;
+    }
+    while (pair < recent) {
+        order[next++] = (int)pairs[pair++].value;
+    }
+    
+    gather_column(array->flightIds, sizeof(int), first, order, moved, scratch);
+    gather_column(array->passengerIds, sizeof(int), first, order, moved, scratch);
+    gather_column(array->bookingDates, sizeof(time_t), first, order, moved, scratch);
+    gather_column(array->seatNumbers, sizeof(*array->seatNumbers), first, order, moved, scratch);
+    array->sorted = array->count;
+    array->passenger_order_valid = 0;
+    
+    free(pairs);
+    free(order);
+    free(scratch);
+    return 1;
+}
+
+// Merge every recent booking into the sorted rows
+int sort_reservations(ReservationArray* array) {
+    if (array == NULL) {
+        return 0;
+    }
+    return merge_recent(array);
+}
+
+// Ready the rows for a query: recent rows are scanned until they outgrow the tail limit,
+// then merged. If the merge fails they stay recent and are still scanned
+static void prepare_rows(ReservationArray* array) {
+    int limit = array->sorted / RESERVATION_TAIL_RATIO;
+    if (limit < RESERVATION_TAIL_MIN) {
+        limit = RESERVATION_TAIL_MIN;
+    }
+    if (array->count - array->sorted > limit) {
+        merge_recent(array);
+    }
+}
+
+// Radix sort the sorted rows by passenger ID into passenger_order if it is stale.
+// Returns 0 if memory runs out
+static int prepare_passenger_order(ReservationArray* array) {
+    if (array->passenger_order_valid) {
+        return 1;
+    }
+    if (array->sorted > 0) {
+        RadixPair* pairs = (RadixPair*)malloc((size_t)array->sorted * sizeof(RadixPair));
+        if (pairs == NULL) {
+            fprintf(stderr, "Memory allocation failed for the passenger order of %d reservations\n", array->sorted);
+            free(pairs);
+            return 0;
+        }
+        for (int row = 0; row < array->sorted; row++) {
+            pairs[row].key = radix_key_i32(array->passengerIds[row]);
+            pairs[row].value = (uint32_t)row;
+        }
+        if (!radix_sort_pairs(pairs, array->sorted, 0)) {
+            free(pairs);
+            return 0;
+        }
+        for (int i = 0; i < array->sorted; i++) {
+            array->passenger_order[i] = (int)pairs[i].value;
+        }
+        free(pairs);
+    }
+    array->passenger_order_valid = 1;
+    return 1;
+}
+
+// First index in [low, high) whose value is at least key (the values there ascending)
+static int lower_bound(const int* values, int low, int high, int key) {
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (values[mid] < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// First index in [low, high) whose value is above key
+static int upper_bound(const int* values, int low, int high, int key) {
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (values[mid] <= key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Next row in [from, end) whose column value equals key, or -1
+static int next_match(const int* column, int from, int end, int key) {
+    int found = simd_find_equal_i32(column + from, end - from, key);
+    return found < 0 ? -1 : from + found;
+}
+
+// Sorted rows [*first, *last) on a flight. Returns the first row left to scan
+static int flight_range(ReservationArray* array, int flightId, int* first, int* last) {
+    *first = lower_bound(array->flightIds, 0, array->sorted, flightId);
+    *last = upper_bound(array->flightIds, *first, array->sorted, flightId);
+    return array->sorted;
+}
+
+// Entries [*first, *last) of passenger_order for a passenger. Returns the first row left to
+// scan: the recent rows, or every row if there is no passenger order
+static int passenger_range(ReservationArray* array, int passengerId, int* first, int* last) {
+    *first = 0;
+    *last = 0;
+    if (!prepare_passenger_order(array)) {
+        return 0;
+    }
+    int low = 0;
+    int high = array->sorted;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (array->passengerIds[array->passenger_order[mid]] < passengerId) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    *first = low;
+    high = array->sorted;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (array->passengerIds[array->passenger_order[mid]] <= passengerId) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    *last = low;
+    return array->sorted;
+}
+
+// Whether a recent row's passenger already has a booking on the same flight, among the
+// flight's sorted rows [first, last) and the recent rows before it
+static int booked_earlier(ReservationArray* array, int first, int last, int row) {
+    int passengerId = array->passengerIds[row];
+    int at = lower_bound(array->passengerIds, first, last, passengerId);
+    if (at < last && array->passengerIds[at] == passengerId) {
+        return 1;
+    }
+    for (int i = next_match(array->passengerIds, array->sorted, row, passengerId); i >= 0;
+         i = next_match(array->passengerIds, i + 1, row, passengerId)) {
+        if (array->flightIds[i] == array->flightIds[row]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Row of a passenger's earliest booking on a flight, or -1
+static int find_booking(ReservationArray* array, int flightId, int passengerId) {
+    prepare_rows(array);
+    int first, last;
+    int scan_from = flight_range(array, flightId, &first, &last);
+    int at = lower_bound(array->passengerIds, first, last, passengerId);
+    if (at < last && array->passengerIds[at] == passengerId) {
+        return at;
+    }
+    for (int row = next_match(array->passengerIds, scan_from, array->count, passengerId); row >= 0;
+         row = next_match(array->passengerIds, row + 1, array->count, passengerId)) {
+        if (array->flightIds[row] == flightId) {
+            return row;
+        }
+    }
+    return -1;
 }
 
 // Format date to a readable string
@@ -99,20 +400,30 @@ char* format_reservation_date(time_t timestamp) {
     return buffer;
 }
 
+// Print one of a passenger's bookings if its flight exists
+static void print_passenger_flight(ReservationArray* array, BST_Node* flights_root, int row, int* count) {
+    Flight* flight = find_flight(flights_root, array->flightIds[row]);
+    if (flight != NULL) {
+        printf("Flight ID: %d, Number: %s, From: %s, To: %s, Seat: %s, Booked on: %s\n", 
+               flight->id, flight->flightNumber, flight->origin, flight->destination,
+               array->seatNumbers[row], format_reservation_date(array->bookingDates[row]));
+        (*count)++;
+    }
+}
+
 // Print all flights booked by a specific passenger
 void print_passenger_flights(ReservationArray* array, BST_Node* flights_root, int passengerId) {
     int count = 0;
     
-    for (int i = 0; i < array->count; i++) {
-        if (array->records[i].passengerId == passengerId) {
-            Flight* flight = find_flight(flights_root, array->records[i].flightId);
-            if (flight != NULL) {
-                printf("Flight ID: %d, Number: %s, From: %s, To: %s, Seat: %s, Booked on: %s\n", 
-                       flight->id, flight->flightNumber, flight->origin, flight->destination,
-                       array->records[i].seatNumber, format_reservation_date(array->records[i].bookingDate));
-                count++;
-            }
-        }
+    prepare_rows(array);
+    int first, last;
+    int scan_from = passenger_range(array, passengerId, &first, &last);
+    for (int i = first; i < last; i++) {
+        print_passenger_flight(array, flights_root, array->passenger_order[i], &count);
+    }
+    for (int row = next_match(array->passengerIds, scan_from, array->count, passengerId); row >= 0;
+         row = next_match(array->passengerIds, row + 1, array->count, passengerId)) {
+        print_passenger_flight(array, flights_root, row, &count);
     }
     
     if (count == 0) {
@@ -122,63 +433,42 @@ void print_passenger_flights(ReservationArray* array, BST_Node* flights_root, in
     }
 }
 
+// Print one booking on a flight: the passenger's details the first time, the extra seat after
+static void print_flight_passenger(ReservationArray* array, LL_Node* passengers_head, int row, int repeat, int* count) {
+    int passenger_id = array->passengerIds[row];
+    Passenger* passenger = find_passenger(passengers_head, passenger_id);
+    if (passenger == NULL) {
+        return;
+    }
+    if (!repeat) {
+        printf("Passenger ID: %d, Name: %s, Passport: %s, Seat: %s, Booked on: %s\n", 
+               passenger->id, passenger->name, passenger->passportNumber,
+               array->seatNumbers[row], format_reservation_date(array->bookingDates[row]));
+        (*count)++;
+    } else {
+        // This is a duplicate booking by the same passenger (multiple seats)
+        printf("  Additional seat for Passenger ID: %d, Seat: %s\n", 
+               passenger_id, array->seatNumbers[row]);
+    }
+}
+
 // Print all passengers who booked a specific flight
 void print_flight_passengers(ReservationArray* array, LL_Node* passengers_head, int flightId) {
     int count = 0;
-    int max_passenger_id = 0;
-    int* counted_passengers = NULL;
     
-    // First pass: find the maximum passenger ID to allocate tracking array
-    for (int i = 0; i < array->count; i++) {
-        if (array->records[i].flightId == flightId && array->records[i].passengerId > max_passenger_id) {
-            max_passenger_id = array->records[i].passengerId;
-        }
-    }
-    
-    // If no passengers found for this flight
-    if (max_passenger_id == 0) {
-        printf("Flight with ID %d has no passengers.\n", flightId);
-        return;
-    }
-    
-    // Allocate tracking array for unique passenger IDs
-    counted_passengers = (int*)calloc(max_passenger_id + 1, sizeof(int));
-    if (counted_passengers == NULL) {
-        fprintf(stderr, "Memory allocation failed for passenger tracking\n");
-        return;
+    // A passenger's sorted rows on the flight are adjacent, so repeats follow the first booking
+    prepare_rows(array);
+    int first, last;
+    int scan_from = flight_range(array, flightId, &first, &last);
+    for (int row = first; row < last; row++) {
+        int repeat = row > first && array->passengerIds[row] == array->passengerIds[row - 1];
+        print_flight_passenger(array, passengers_head, row, repeat, &count);
     }
-    
-    // Process reservations and track unique passengers
-    for (int i = 0; i < array->count; i++) {
-        if (array->records[i].flightId == flightId) {
-            int passenger_id = array->records[i].passengerId;
-            
-            // Check if this passenger has already been counted
-            if (counted_passengers[passenger_id] == 0) {
-                Passenger* passenger = find_passenger(passengers_head, passenger_id);
-                if (passenger != NULL) {
-                    printf("Passenger ID: %d, Name: %s, Passport: %s, Seat: %s, Booked on: %s\n", 
-                           passenger->id, passenger->name, passenger->passportNumber,
-                           array->records[i].seatNumber, format_reservation_date(array->records[i].bookingDate));
-                    
-                    // Mark this passenger as counted
-                    counted_passengers[passenger_id] = 1;
-                    count++;
-                }
-            } else {
-                // This is a duplicate booking by the same passenger (multiple seats)
-                Passenger* passenger = find_passenger(passengers_head, passenger_id);
-                if (passenger != NULL) {
-                    printf("  Additional seat for Passenger ID: %d, Seat: %s\n", 
-                           passenger_id, array->records[i].seatNumber);
-                }
-            }
-        }
+    for (int row = next_match(array->flightIds, scan_from, array->count, flightId); row >= 0;
+         row = next_match(array->flightIds, row + 1, array->count, flightId)) {
+        print_flight_passenger(array, passengers_head, row, booked_earlier(array, first, last, row), &count);
     }
     
-    // Free tracking array
-    free(counted_passengers);
-    
     if (count == 0) {
         printf("Flight with ID %d has no passengers.\n", flightId);
     } else {
@@ -192,43 +482,17 @@ int count_passengers_by_flight_array(ReservationArray* array, int flightId) {
         return 0;
     }
     
-    // Find maximum passenger ID to determine tracking array size
-    int max_passenger_id = 0;
-    for (int i = 0; i < array->count; i++) {
-        if (array->records[i].flightId == flightId && 
-            array->records[i].passengerId > max_passenger_id) {
-            max_passenger_id = array->records[i].passengerId;
-        }
-    }
-    
-    // If no reservations found for this flight
-    if (max_passenger_id == 0) {
-        return 0;
-    }
-    
-    // Allocate tracking array for unique passenger IDs
-    int* counted_passengers = (int*)calloc(max_passenger_id + 1, sizeof(int));
-    if (counted_passengers == NULL) {
-        fprintf(stderr, "Memory allocation failed for passenger counting\n");
-        return 0;
-    }
-    
-    // Count unique passengers
-    int unique_count = 0;
-    for (int i = 0; i < array->count; i++) {
-        if (array->records[i].flightId == flightId) {
-            int passenger_id = array->records[i].passengerId;
-            
-            // Check if this passenger has already been counted
-            if (counted_passengers[passenger_id] == 0) {
-                counted_passengers[passenger_id] = 1;
-                unique_count++;
-            }
+    // The flight's sorted rows are in passenger order, so each run is one passenger
+    prepare_rows(array);
+    int first, last;
+    int scan_from = flight_range(array, flightId, &first, &last);
+    int unique_count = simd_count_runs_i32(array->passengerIds + first, last - first);
+    for (int row = next_match(array->flightIds, scan_from, array->count, flightId); row >= 0;
+         row = next_match(array->flightIds, row + 1, array->count, flightId)) {
+        if (!booked_earlier(array, first, last, row)) {
+            unique_count++;
         }
     }
-    
-    // Free tracking array
-    free(counted_passengers);
     return unique_count;
 }
 
@@ -274,63 +538,245 @@ int add_reservation_with_validation(ReservationArray* array, BST_Node* flights_r
         return 0;
     }
     
-    // Count current unique passengers for this flight
-    int current_passengers = count_passengers_by_flight_array(array, record.flightId);
+    // A passenger already booked doesn't count as new; anyone else needs a free seat
+    if (!has_reservation_array(array, record.flightId, record.passengerId) &&
+        count_passengers_by_flight_array(array, record.flightId) >= flight->capacity) {
+        printf("ERROR: Cannot add reservation. Flight %d has reached capacity of %d passengers.\n", 
+               record.flightId, flight->capacity);
+        return 0;
+    }
     
-    // Check if passenger is already booked (doesn't count as new)
-    int passenger_already_booked = 0;
-    int max_passenger_id = 0;
+    // Add the reservation
+    add_reservation(array, record);
+    return 1;
+}
+
+// Count the number of reservations held by a passenger
+int count_flights_by_passenger_array(ReservationArray* array, int passengerId) {
+    if (array == NULL) {
+        return 0;
+    }
     
-    // Find max passenger ID for the tracking array
-    for (int i = 0; i < array->count; i++) {
-        if (array->records[i].flightId == record.flightId && 
-            array->records[i].passengerId > max_passenger_id) {
-            max_passenger_id = array->records[i].passengerId;
+    prepare_rows(array);
+    int first, last;
+    int scan_from = passenger_range(array, passengerId, &first, &last);
+    return (last - first) + simd_count_equal_i32(array->passengerIds + scan_from, array->count - scan_from, passengerId);
+}
+
+// Append a record to a caller-owned result array, doubling it when full. Returns 1 on success
+static int append_result(ReservationRecord** records, int* capacity, int count, ReservationRecord record) {
+    if (count >= *capacity) {
+        int new_capacity = *capacity > 0 ? *capacity * 2 : 16;
+        ReservationRecord* grown = (ReservationRecord*)realloc(*records, new_capacity * sizeof(ReservationRecord));
+        if (grown == NULL) {
+            fprintf(stderr, "Memory allocation failed when collecting reservations\n");
+            return 0;
         }
+        *records = grown;
+        *capacity = new_capacity;
+    }
+    (*records)[count] = record;
+    return 1;
+}
+
+// Copy every reservation of a passenger into *records (grown as needed), in flight order
+// followed by recent bookings
+int find_reservations_by_passenger_array(ReservationArray* array, int passengerId, ReservationRecord** records, int* capacity) {
+    int count = 0;
+    prepare_rows(array);
+    int first, last;
+    int scan_from = passenger_range(array, passengerId, &first, &last);
+    for (int i = first; i < last; i++) {
+        if (!append_result(records, capacity, count, row_record(array, array->passenger_order[i]))) return -1;
+        count++;
+    }
+    for (int row = next_match(array->passengerIds, scan_from, array->count, passengerId); row >= 0;
+         row = next_match(array->passengerIds, row + 1, array->count, passengerId)) {
+        if (!append_result(records, capacity, count, row_record(array, row))) return -1;
+        count++;
+    }
+    return count;
+}
+
+// Copy every reservation on a flight into *records (grown as needed), in passenger order
+// followed by recent bookings
+int find_reservations_by_flight_array(ReservationArray* array, int flightId, ReservationRecord** records, int* capacity) {
+    int count = 0;
+    prepare_rows(array);
+    int first, last;
+    int scan_from = flight_range(array, flightId, &first, &last);
+    for (int row = first; row < last; row++) {
+        if (!append_result(records, capacity, count, row_record(array, row))) return -1;
+        count++;
+    }
+    for (int row = next_match(array->flightIds, scan_from, array->count, flightId); row >= 0;
+         row = next_match(array->flightIds, row + 1, array->count, flightId)) {
+        if (!append_result(records, capacity, count, row_record(array, row))) return -1;
+        count++;
+    }
+    return count;
+}
+
+// Check whether a passenger holds any reservation on a flight
+int has_reservation_array(ReservationArray* array, int flightId, int passengerId) {
+    if (array == NULL) {
+        return 0;
+    }
+    return find_booking(array, flightId, passengerId) >= 0;
+}
+
+// Cancel one reservation of a passenger on a flight
+int cancel_reservation(ReservationArray* array, int flightId, int passengerId) {
+    if (array == NULL) {
+        return 0;
     }
     
-    // Create a tracking array if there are existing passengers
-    if (max_passenger_id > 0) {
-        int* counted_passengers = (int*)calloc(max_passenger_id + 1, sizeof(int));
-        if (counted_passengers == NULL) {
-            fprintf(stderr, "Memory allocation failed for passenger counting\n");
-            return 0;
+    int row = find_booking(array, flightId, passengerId);
+    if (row < 0) {
+        return 0;
+    }
+    
+    // Shift the rest of each column down to keep the order
+    size_t after = (size_t)(array->count - row - 1);
+    memmove(&array->flightIds[row], &array->flightIds[row + 1], after * sizeof(int));
+    memmove(&array->passengerIds[row], &array->passengerIds[row + 1], after * sizeof(int));
+    memmove(&array->bookingDates[row], &array->bookingDates[row + 1], after * sizeof(time_t));
+    memmove(&array->seatNumbers[row], &array->seatNumbers[row + 1], after * sizeof(*array->seatNumbers));
+    array->count--;
+    
+    // A sorted row also leaves the passenger order, where the rows after it move down one
+    if (row < array->sorted) {
+        array->sorted--;
+        if (array->passenger_order_valid) {
+            int kept = 0;
+            for (int i = 0; i <= array->sorted; i++) {
+                int entry = array->passenger_order[i];
+                if (entry != row) {
+                    array->passenger_order[kept++] = entry > row ? entry - 1 : entry;
+                }
+            }
         }
-        
-        // Mark existing passengers
-        for (int i = 0; i < array->count; i++) {
-            if (array->records[i].flightId == record.flightId) {
-                int passenger_id = array->records[i].passengerId;
-                counted_passengers[passenger_id] = 1;
+    }
+    return 1;
+}
+
+// Compare two flight IDs for qsort and bsearch
+static int compare_ids(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Remove every reservation on the flights in `ids` (sorted) in one pass, keeping the rest in
+// order and copying the removed ones into *records. Returns the number removed,
+// or -1 if they could not all be copied (they are removed either way)
+static int remove_flights_reservations(ReservationArray* array, const int* ids, int id_count,
+                                       ReservationRecord** records, int* capacity) {
+    int kept = 0;
+    int kept_sorted = 0;
+    int count = 0;
+    int failed = 0;
+    for (int row = 0; row < array->count; row++) {
+        if (bsearch(&array->flightIds[row], ids, id_count, sizeof(int), compare_ids) == NULL) {
+            if (kept != row) {
+                array->flightIds[kept] = array->flightIds[row];
+                array->passengerIds[kept] = array->passengerIds[row];
+                array->bookingDates[kept] = array->bookingDates[row];
+                memcpy(array->seatNumbers[kept], array->seatNumbers[row], MAX_SEAT_NUMBER_LENGTH);
             }
+            kept++;
+        } else if (!failed && append_result(records, capacity, count, row_record(array, row))) {
+            count++;
+        } else {
+            failed = 1;
         }
         
-        // Check if this passenger is already booked
-        if (record.passengerId <= max_passenger_id && counted_passengers[record.passengerId]) {
-            passenger_already_booked = 1;
+        // The kept rows stay in order, so the sorted ones are still first
+        if (row + 1 == array->sorted) {
+            kept_sorted = kept;
         }
-        
-        free(counted_passengers);
     }
-    
-    // If this would add a new passenger, check capacity
-    if (!passenger_already_booked && current_passengers >= flight->capacity) {
-        printf("ERROR: Cannot add reservation. Flight %d has reached capacity of %d passengers.\n", 
-               record.flightId, flight->capacity);
+    if (kept_sorted != array->sorted) {
+        array->passenger_order_valid = 0;
+    }
+    array->count = kept;
+    array->sorted = kept_sorted;
+    return failed ? -1 : count;
+}
+
+// Remove every reservation on a flight and copy them into *records (grown as needed)
+int cancel_flight_reservations(ReservationArray* array, int flightId, ReservationRecord** records, int* capacity) {
+    if (array == NULL) {
+        return 0;
+    }
+    return remove_flights_reservations(array, &flightId, 1, records, capacity);
+}
+
+// Cancel a flight: delete it from the BST and remove all of its reservations
+int cancel_flight(ReservationArray* array, BST_Node** flights_root, int flightId, ReservationRecord** records, int* capacity) {
+    int deleted = 0;
+    *flights_root = delete_flight(*flights_root, flightId, &deleted);
+    if (!deleted) {
+        return -1;
+    }
+    return cancel_flight_reservations(array, flightId, records, capacity);
+}
+
+// Collect the IDs of flights departing in [from, to), in ID order
+static int collect_departures(BST_Node* root, time_t from, time_t to, int** ids, int* count, int* capacity) {
+    if (root == NULL) {
+        return 1;
+    }
+    if (!collect_departures(root->left, from, to, ids, count, capacity)) {
         return 0;
     }
+    if (root->data.departureTime >= from && root->data.departureTime < to) {
+        if (*count >= *capacity) {
+            *capacity = *capacity > 0 ? *capacity * 2 : 16;
+            int* grown = (int*)realloc(*ids, *capacity * sizeof(int));
+            if (grown == NULL) {
+                return 0;
+            }
+            *ids = grown;
+        }
+        (*ids)[(*count)++] = root->data.id;
+    }
+    return collect_departures(root->right, from, to, ids, count, capacity);
+}
+
+// Cancel every flight departing in [from, to) along with its reservations
+int cancel_departures(ReservationArray* array, BST_Node** flights_root, time_t from, time_t to,
+                      int* flights_cancelled, ReservationRecord** records, int* capacity) {
+    *flights_cancelled = 0;
     
-    // Add the reservation
-    add_reservation(array, record);
-    return 1;
+    int* ids = NULL;
+    int id_count = 0;
+    int id_capacity = 0;
+    if (!collect_departures(*flights_root, from, to, &ids, &id_count, &id_capacity)) {
+        fprintf(stderr, "Memory allocation failed when collecting departures\n");
+        free(ids);
+        return -1;
+    }
+    
+    for (int i = 0; i < id_count; i++) {
+        int deleted = 0;
+        *flights_root = delete_flight(*flights_root, ids[i], &deleted);
+    }
+    *flights_cancelled = id_count;
+    
+    // Removing rows shifts the rest anyway, so all of the day's flights share one pass
+    int count = 0;
+    if (array != NULL && id_count > 0) {
+        count = remove_flights_reservations(array, ids, id_count, records, capacity);
+    }
+    free(ids);
+    return count;
 }
 
 // Free reservations array memory
 void free_reservations(ReservationArray* array) {
     if (array != NULL) {
-        if (array->records != NULL) {
-            free(array->records);
-        }
-        free(array);
+        release_columns(array);
+        mem_free(MEM_RESERVATION_ARRAY, array, sizeof(ReservationArray));
     }
 }
@@ -5,12 +5,24 @@
 #include "flight_management.h"
 #include "passenger_management.h"
 
+// Recent bookings a query scans before merging them into the sorted rows: the larger of
+// RESERVATION_TAIL_MIN and one RESERVATION_TAIL_RATIO-th of the sorted rows
+#define RESERVATION_TAIL_MIN 1024
+#define RESERVATION_TAIL_RATIO 256
+
 // Initialize reservations array with a given capacity
 ReservationArray* init_reservations(int capacity);
 
 // Add a reservation record to the array
 void add_reservation(ReservationArray* array, ReservationRecord record);
 
+// Merge every recent booking into the sorted rows now (for example after a bulk load) rather
+// than in the first query. Returns 1 on success, 0 if memory ran out
+int sort_reservations(ReservationArray* array);
+
+// The queries below binary search the sorted rows and scan the recent ones, merging those
+// first once there are too many, so they reorganise the array and must not run concurrently
+
 // Add a reservation with capacity validation
 int add_reservation_with_validation(ReservationArray* array, BST_Node* flights_root, ReservationRecord record);
 
@@ -26,6 +38,35 @@ int count_passengers_by_flight_array(ReservationArray* array, int flightId);
 // Validate that a flight doesn't exceed its passenger capacity
 int validate_flight_capacity_array(ReservationArray* array, BST_Node* flights_root, int flightId);
 
+// Count the number of reservations held by a passenger
+int count_flights_by_passenger_array(ReservationArray* array, int passengerId);
+
+// Copy every reservation of a passenger (or on a flight) into *records, growing the caller's
+// array as needed: the sorted rows in flight (or passenger) order, then recent bookings.
+// Returns the number found, or -1 on failure
+int find_reservations_by_passenger_array(ReservationArray* array, int passengerId, ReservationRecord** records, int* capacity);
+int find_reservations_by_flight_array(ReservationArray* array, int flightId, ReservationRecord** records, int* capacity);
+
+// Check whether a passenger holds any reservation on a flight
+int has_reservation_array(ReservationArray* array, int flightId, int passengerId);
+
+// Cancel one reservation of a passenger on a flight (returns 1 if one was removed)
+int cancel_reservation(ReservationArray* array, int flightId, int passengerId);
+
+// Remove every reservation on a flight with one pass over the array, copying the removed records
+// into *records (grown as needed). Returns the number removed, or -1 if they could not all be
+// copied (they are removed either way)
+int cancel_flight_reservations(ReservationArray* array, int flightId, ReservationRecord** records, int* capacity);
+
+// Cancel a flight: delete it from the BST and remove its reservations as above.
+// Returns the number of reservations cancelled, or -1 if there is no such flight
+int cancel_flight(ReservationArray* array, BST_Node** flights_root, int flightId, ReservationRecord** records, int* capacity);
+
+// Cancel every flight departing in [from, to) (for example one day) with its reservations.
+// Sets *flights_cancelled and returns the number of reservations cancelled, or -1 on failure
+int cancel_departures(ReservationArray* array, BST_Node** flights_root, time_t from, time_t to,
+                      int* flights_cancelled, ReservationRecord** records, int* capacity);
+
 // Free reservations array memory
 void free_reservations(ReservationArray* array);
 
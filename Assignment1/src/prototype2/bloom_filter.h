@@ -0,0 +1,49 @@
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 64-bit words in one block: a block is one 64-byte cache line
+#define BLOOM_BLOCK_WORDS 8
+
+// False-positive rate used when none is configured
+#define BLOOM_DEFAULT_FP_RATE 0.01
+
+// Blocked Bloom filter: all the bits of a key are in one cache line, so a lookup costs at
+// most one cache miss. Keys cannot be removed; a removed key just becomes a false positive
+// until the owner rebuilds the filter
+typedef struct BloomFilter {
+    uint64_t* blocks;     // block_count blocks, 64-byte aligned
+    void* allocation;     // Start of the allocation (blocks is aligned inside it)
+    uint32_t block_count;
+    int hashes;           // Bits set per key
+    long long capacity;   // Keys the filter was sized for
+    long long count;      // Keys added
+    double fp_rate;       // Target false-positive rate at capacity
+} BloomFilter;
+
+// Create a filter sized for `expected` keys at the given false-positive rate (0 < rate < 1).
+// Returns NULL on failure
+BloomFilter* bloom_create(long long expected, double fp_rate);
+
+// Add a key
+void bloom_add(BloomFilter* filter, uint64_t key);
+
+// Return 0 if the key was certainly never added, 1 if it may have been
+int bloom_may_contain(const BloomFilter* filter, uint64_t key);
+
+// Check whether more keys were added than the filter was sized for, so its false-positive
+// rate has risen above the target and it should be rebuilt larger
+int bloom_needs_rebuild(const BloomFilter* filter);
+
+// Key for a (flight, passenger) pair
+uint64_t bloom_pair_key(int flightId, int passengerId);
+
+// Bytes used by the filter's bit array
+size_t bloom_bytes(const BloomFilter* filter);
+
+// Free the filter
+void bloom_free(BloomFilter* filter);
+
+#endif
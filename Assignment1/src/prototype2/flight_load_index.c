@@ -0,0 +1,438 @@
+/*
+ * Flight Load Index Implementation (Prototype 2)
+ *
+ * Keeps every flight in an AVL tree ordered by load factor so the fullest and emptiest
+ * flights can be listed without counting the reservations of every flight. Load factors are
+ * compared as fractions by cross-multiplying, so no rounding can reorder two flights. A hash
+ * from flight ID to tree node finds the flight a booking moves; the node is unlinked,
+ * updated and inserted again, so a booking costs two O(log n) tree walks and no allocation.
+ *
+ * Sources used:
+ * 1. Introduction to Algorithms by Cormen et al. - Balanced search trees, open addressing
+ * 2. Data Structures and Algorithm Analysis by Mark Allen Weiss - AVL insertion and deletion
+ * 3. "The Art of Computer Programming, Vol. 3" by Knuth - Deletion with linear probing (Algorithm R)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flight_load_index.h"
+#include "../mem_stats.h"
+
+// Tallest AVL tree the explicit traversal stacks must hold (1.44 log2 n stays below this)
+#define LOAD_INDEX_MAX_HEIGHT 64
+
+//--- ORDERING ---//
+
+// Compare two loads: negative if a is emptier than b, positive if fuller. A flight without
+// seats counts as empty until booked, then as fuller than any flight with seats
+static int compare_load(int booked_a, int capacity_a, int booked_b, int capacity_b) {
+    int unlimited_a = capacity_a <= 0 && booked_a > 0;
+    int unlimited_b = capacity_b <= 0 && booked_b > 0;
+    if (unlimited_a || unlimited_b) {
+        if (unlimited_a != unlimited_b) return unlimited_a ? 1 : -1;
+        return (booked_a > booked_b) - (booked_a < booked_b);
+    }
+    if (capacity_a <= 0) {
+        booked_a = 0;
+        capacity_a = 1;
+    }
+    if (capacity_b <= 0) {
+        booked_b = 0;
+        capacity_b = 1;
+    }
+    long long left = (long long)booked_a * capacity_b;
+    long long right = (long long)booked_b * capacity_a;
+    return (left > right) - (left < right);
+}
+
+// Tree order: load factor, then flight ID
+static int compare_nodes(const FlightLoadNode* a, const FlightLoadNode* b) {
+    int cmp = compare_load(a->booked, a->capacity, b->booked, b->capacity);
+    if (cmp != 0) return cmp;
+    return (a->flightId > b->flightId) - (a->flightId < b->flightId);
+}
+
+// qsort adapter for an array of node pointers
+static int compare_node_pointers(const void* a, const void* b) {
+    return compare_nodes(*(FlightLoadNode* const*)a, *(FlightLoadNode* const*)b);
+}
+
+//--- AVL TREE ---//
+
+static int node_height(FlightLoadNode* node) {
+    return node != NULL ? node->height : 0;
+}
+
+static void update_height(FlightLoadNode* node) {
+    int left = node_height(node->left);
+    int right = node_height(node->right);
+    node->height = 1 + (left > right ? left : right);
+}
+
+static FlightLoadNode* rotate_right(FlightLoadNode* y) {
+    FlightLoadNode* x = y->left;
+    y->left = x->right;
+    x->right = y;
+    update_height(y);
+    update_height(x);
+    return x;
+}
+
+static FlightLoadNode* rotate_left(FlightLoadNode* x) {
+    FlightLoadNode* y = x->right;
+    x->right = y->left;
+    y->left = x;
+    update_height(x);
+    update_height(y);
+    return y;
+}
+
+// Restore the AVL balance at a node whose subtrees differ in height by at most two
+static FlightLoadNode* rebalance(FlightLoadNode* node) {
+    update_height(node);
+    int balance = node_height(node->left) - node_height(node->right);
+    if (balance > 1) {
+        if (node_height(node->left->left) < node_height(node->left->right)) {
+            node->left = rotate_left(node->left);
+        }
+        return rotate_right(node);
+    }
+    if (balance < -1) {
+        if (node_height(node->right->right) < node_height(node->right->left)) {
+            node->right = rotate_right(node->right);
+        }
+        return rotate_left(node);
+    }
+    return node;
+}
+
+// Link a detached node into a subtree. Returns the new subtree root
+static FlightLoadNode* tree_insert(FlightLoadNode* root, FlightLoadNode* node) {
+    if (root == NULL) {
+        node->left = NULL;
+        node->right = NULL;
+        node->height = 1;
+        return node;
+    }
+    if (compare_nodes(node, root) < 0) {
+        root->left = tree_insert(root->left, node);
+    } else {
+        root->right = tree_insert(root->right, node);
+    }
+    return rebalance(root);
+}
+
+// Unlink the smallest node of a subtree into *smallest. Returns the new subtree root
+static FlightLoadNode* tree_remove_smallest(FlightLoadNode* root, FlightLoadNode** smallest) {
+    if (root->left == NULL) {
+        *smallest = root;
+        return root->right;
+    }
+    root->left = tree_remove_smallest(root->left, smallest);
+    return rebalance(root);
+}
+
+// Unlink a node (found by its current order) from a subtree without freeing it.
+// Returns the new subtree root
+static FlightLoadNode* tree_remove(FlightLoadNode* root, FlightLoadNode* node) {
+    if (root == NULL) {
+        return NULL;
+    }
+    if (root != node) {
+        if (compare_nodes(node, root) < 0) {
+            root->left = tree_remove(root->left, node);
+        } else {
+            root->right = tree_remove(root->right, node);
+        }
+        return rebalance(root);
+    }
+    if (root->left == NULL) return root->right;
+    if (root->right == NULL) return root->left;
+    
+    // Two children: the in-order successor takes the node's place
+    FlightLoadNode* successor = NULL;
+    FlightLoadNode* right = tree_remove_smallest(root->right, &successor);
+    successor->left = root->left;
+    successor->right = right;
+    return rebalance(successor);
+}
+
+// Build a balanced tree from nodes[first..last) sorted in tree order
+static FlightLoadNode* tree_from_sorted(FlightLoadNode** nodes, int first, int last) {
+    if (first >= last) {
+        return NULL;
+    }
+    int middle = first + (last - first) / 2;
+    FlightLoadNode* node = nodes[middle];
+    node->left = tree_from_sorted(nodes, first, middle);
+    node->right = tree_from_sorted(nodes, middle + 1, last);
+    update_height(node);
+    return node;
+}
+
+//--- ID HASH ---//
+
+// Home slot of a flight ID
+static int home_slot(const FlightLoadIndex* index, int flightId) {
+    unsigned int hash = (unsigned int)flightId * 2654435761u;
+    hash ^= hash >> 15;
+    return (int)(hash & (unsigned int)(index->slot_capacity - 1));
+}
+
+// Slot holding a flight, or the empty slot where it would go
+static int find_slot(const FlightLoadIndex* index, int flightId) {
+    int slot = home_slot(index, flightId);
+    while (index->slots[slot] != NULL && index->slots[slot]->flightId != flightId) {
+        slot = (slot + 1) & (index->slot_capacity - 1);
+    }
+    return slot;
+}
+
+// Double the hash table. Returns 1 on success
+static int grow_slots(FlightLoadIndex* index) {
+    int old_capacity = index->slot_capacity;
+    FlightLoadNode** old_slots = index->slots;
+    int capacity = old_capacity * 2;
+    FlightLoadNode** slots = (FlightLoadNode**)mem_alloc(MEM_FLIGHT_LOAD_INDEX, capacity * sizeof(FlightLoadNode*));
+    if (slots == NULL) {
+        fprintf(stderr, "Memory allocation failed for flight load index\n");
+        return 0;
+    }
+    memset(slots, 0, capacity * sizeof(FlightLoadNode*));
+    index->slots = slots;
+    index->slot_capacity = capacity;
+    for (int i = 0; i < old_capacity; i++) {
+        if (old_slots[i] != NULL) {
+            index->slots[find_slot(index, old_slots[i]->flightId)] = old_slots[i];
+        }
+    }
+    mem_free(MEM_FLIGHT_LOAD_INDEX, old_slots, old_capacity * sizeof(FlightLoadNode*));
+    return 1;
+}
+
+// Empty a slot, shifting later entries of the same probe run back so lookups still find them
+static void clear_slot(FlightLoadIndex* index, int slot) {
+    int mask = index->slot_capacity - 1;
+    int hole = slot;
+    int next = (slot + 1) & mask;
+    while (index->slots[next] != NULL) {
+        // An entry may fill the hole only if its home slot is not between the hole and it
+        int home = home_slot(index, index->slots[next]->flightId);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            index->slots[hole] = index->slots[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    index->slots[hole] = NULL;
+}
+
+//--- INDEX ---//
+
+// Allocate an empty index with room for `expected` flights
+static FlightLoadIndex* create_index(int expected) {
+    FlightLoadIndex* index = (FlightLoadIndex*)mem_alloc(MEM_FLIGHT_LOAD_INDEX, sizeof(FlightLoadIndex));
+    if (index == NULL) {
+        fprintf(stderr, "Memory allocation failed for flight load index\n");
+        return NULL;
+    }
+    index->root = NULL;
+    index->count = 0;
+    index->slot_capacity = 16;
+    while (index->slot_capacity < expected * 2) {
+        index->slot_capacity *= 2;
+    }
+    index->slots = (FlightLoadNode**)mem_alloc(MEM_FLIGHT_LOAD_INDEX, index->slot_capacity * sizeof(FlightLoadNode*));
+    if (index->slots == NULL) {
+        fprintf(stderr, "Memory allocation failed for flight load index\n");
+        mem_free(MEM_FLIGHT_LOAD_INDEX, index, sizeof(FlightLoadIndex));
+        return NULL;
+    }
+    memset(index->slots, 0, index->slot_capacity * sizeof(FlightLoadNode*));
+    return index;
+}
+
+// Create a detached node for a flight and enter it in the hash. Returns NULL if the flight
+// is already present or memory ran out
+static FlightLoadNode* add_node(FlightLoadIndex* index, const Flight* flight, int booked) {
+    if (2 * (index->count + 1) > index->slot_capacity && !grow_slots(index)) {
+        return NULL;
+    }
+    int slot = find_slot(index, flight->id);
+    if (index->slots[slot] != NULL) {
+        return NULL;
+    }
+    FlightLoadNode* node = (FlightLoadNode*)mem_alloc(MEM_FLIGHT_LOAD_INDEX, sizeof(FlightLoadNode));
+    if (node == NULL) {
+        fprintf(stderr, "Memory allocation failed for flight load node\n");
+        return NULL;
+    }
+    node->flightId = flight->id;
+    node->booked = booked > 0 ? booked : 0;
+    node->capacity = flight->capacity;
+    node->departureTime = flight->departureTime;
+    node->left = NULL;
+    node->right = NULL;
+    node->height = 1;
+    index->slots[slot] = node;
+    index->count++;
+    return node;
+}
+
+// Build an index of `count` flights with their booked seats
+FlightLoadIndex* load_index_build(const Flight* flights, const int* booked, int count) {
+    FlightLoadIndex* index = create_index(count);
+    FlightLoadNode** nodes = (FlightLoadNode**)malloc((count + 1) * sizeof(FlightLoadNode*));
+    if (index == NULL || nodes == NULL) {
+        fprintf(stderr, "Memory allocation failed for flight load index\n");
+        free(nodes);
+        load_index_free(index);
+        return NULL;
+    }
+    
+    // A repeated flight ID keeps its first flight, as the search structures do
+    int added = 0;
+    for (int i = 0; i < count; i++) {
+        FlightLoadNode* node = add_node(index, &flights[i], booked != NULL ? booked[i] : 0);
+        if (node != NULL) {
+            nodes[added++] = node;
+        } else if (index->slots[find_slot(index, flights[i].id)] == NULL) {
+            free(nodes);
+            load_index_free(index);
+            return NULL;
+        }
+    }
+    
+    // Sorting once and building a balanced tree beats one rebalancing insert per flight
+    qsort(nodes, added, sizeof(FlightLoadNode*), compare_node_pointers);
+    index->root = tree_from_sorted(nodes, 0, added);
+    free(nodes);
+    return index;
+}
+
+// Add a flight with `booked` seats
+int load_index_add_flight(FlightLoadIndex* index, const Flight* flight, int booked) {
+    if (index == NULL || flight == NULL) {
+        return 0;
+    }
+    FlightLoadNode* node = add_node(index, flight, booked);
+    if (node == NULL) {
+        return 0;
+    }
+    index->root = tree_insert(index->root, node);
+    return 1;
+}
+
+// Remove a flight
+int load_index_remove_flight(FlightLoadIndex* index, int flightId) {
+    if (index == NULL) {
+        return 0;
+    }
+    int slot = find_slot(index, flightId);
+    FlightLoadNode* node = index->slots[slot];
+    if (node == NULL) {
+        return 0;
+    }
+    index->root = tree_remove(index->root, node);
+    clear_slot(index, slot);
+    index->count--;
+    mem_free(MEM_FLIGHT_LOAD_INDEX, node, sizeof(FlightLoadNode));
+    return 1;
+}
+
+// Change a flight's booked seats and move it to its new place
+int load_index_adjust(FlightLoadIndex* index, int flightId, int delta) {
+    if (index == NULL) {
+        return 0;
+    }
+    FlightLoadNode* node = index->slots[find_slot(index, flightId)];
+    if (node == NULL) {
+        return 0;
+    }
+    int booked = node->booked + delta;
+    if (booked < 0) booked = 0;
+    if (booked == node->booked) {
+        return 1;
+    }
+    index->root = tree_remove(index->root, node);
+    node->booked = booked;
+    index->root = tree_insert(index->root, node);
+    return 1;
+}
+
+// Copy a node into a query result
+static void copy_load(const FlightLoadNode* node, FlightLoad* load) {
+    load->flightId = node->flightId;
+    load->booked = node->booked;
+    load->capacity = node->capacity;
+    load->departureTime = node->departureTime;
+}
+
+// Look up one flight's load
+int load_index_get(FlightLoadIndex* index, int flightId, FlightLoad* load) {
+    if (index == NULL) {
+        return 0;
+    }
+    FlightLoadNode* node = index->slots[find_slot(index, flightId)];
+    if (node == NULL) {
+        return 0;
+    }
+    copy_load(node, load);
+    return 1;
+}
+
+// Walk the tree in order (fullest = 0) or in reverse order (fullest = 1), copying up to k
+// flights departing in [from, to). Returns the number copied
+static int walk_loads(FlightLoadIndex* index, int fullest, int k, time_t from, time_t to, FlightLoad* out) {
+    if (index == NULL || k <= 0) {
+        return 0;
+    }
+    int any_time = from == 0 && to == 0;
+    FlightLoadNode* stack[LOAD_INDEX_MAX_HEIGHT];
+    int top = 0;
+    int found = 0;
+    FlightLoadNode* node = index->root;
+    while ((node != NULL || top > 0) && found < k) {
+        // Go as far as possible towards the end the walk starts from
+        while (node != NULL) {
+            stack[top++] = node;
+            node = fullest ? node->right : node->left;
+        }
+        node = stack[--top];
+        if (any_time || (node->departureTime >= from && node->departureTime < to)) {
+            copy_load(node, &out[found++]);
+        }
+        node = fullest ? node->left : node->right;
+    }
+    return found;
+}
+
+// The fullest k flights departing in [from, to), fullest first
+int load_index_fullest(FlightLoadIndex* index, int k, time_t from, time_t to, FlightLoad* out) {
+    return walk_loads(index, 1, k, from, to, out);
+}
+
+// The emptiest k flights departing in [from, to), emptiest first
+int load_index_emptiest(FlightLoadIndex* index, int k, time_t from, time_t to, FlightLoad* out) {
+    return walk_loads(index, 0, k, from, to, out);
+}
+
+// Load factor of a reported flight
+double load_factor(const FlightLoad* load) {
+    return load->capacity > 0 ? (double)load->booked / load->capacity : 0.0;
+}
+
+// Free the index. Every node is in the ID hash, so no tree walk is needed
+void load_index_free(FlightLoadIndex* index) {
+    if (index == NULL) {
+        return;
+    }
+    for (int i = 0; i < index->slot_capacity; i++) {
+        if (index->slots[i] != NULL) {
+            mem_free(MEM_FLIGHT_LOAD_INDEX, index->slots[i], sizeof(FlightLoadNode));
+        }
+    }
+    mem_free(MEM_FLIGHT_LOAD_INDEX, index->slots, index->slot_capacity * sizeof(FlightLoadNode*));
+    mem_free(MEM_FLIGHT_LOAD_INDEX, index, sizeof(FlightLoadIndex));
+}
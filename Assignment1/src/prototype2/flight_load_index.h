@@ -0,0 +1,66 @@
+#ifndef FLIGHT_LOAD_INDEX_H
+#define FLIGHT_LOAD_INDEX_H
+
+#include <time.h>
+#include "../airline_types.h"
+
+// A flight in the load index, ordered by load factor (booked / capacity), then by ID
+typedef struct FlightLoadNode {
+    int flightId;
+    int booked;      // Seats booked (reservations on the flight)
+    int capacity;
+    time_t departureTime;
+    struct FlightLoadNode* left;
+    struct FlightLoadNode* right;
+    int height;
+} FlightLoadNode;
+
+// Flights kept in load-factor order in an AVL tree, with a hash from flight ID to node so
+// a booking or cancellation moves its flight in O(log n). The fullest and emptiest k flights
+// are an in-order walk from either end: O(log n + k), plus the flights skipped by a
+// departure window
+typedef struct FlightLoadIndex {
+    FlightLoadNode* root;
+    FlightLoadNode** slots;  // Open addressing by flight ID; the size is a power of two
+    int slot_capacity;
+    int count;
+} FlightLoadIndex;
+
+// One flight's load as reported by a query
+typedef struct {
+    int flightId;
+    int booked;
+    int capacity;
+    time_t departureTime;
+} FlightLoad;
+
+// Build an index of `count` flights, where booked[i] is the seats booked on flights[i]
+// (booked may be NULL for empty flights). Returns NULL on failure
+FlightLoadIndex* load_index_build(const Flight* flights, const int* booked, int count);
+
+// Add a flight with `booked` seats. Returns 1 on success, 0 if it is already present or on failure
+int load_index_add_flight(FlightLoadIndex* index, const Flight* flight, int booked);
+
+// Remove a flight. Returns 1 if it was present
+int load_index_remove_flight(FlightLoadIndex* index, int flightId);
+
+// Change a flight's booked seats by `delta` and move it to its new place in O(log n).
+// Returns 1 if the flight is in the index
+int load_index_adjust(FlightLoadIndex* index, int flightId, int delta);
+
+// Look up one flight's load. Returns 1 if it is in the index
+int load_index_get(FlightLoadIndex* index, int flightId, FlightLoad* load);
+
+// Copy up to k of the fullest (highest load factor first) or emptiest (lowest first) flights
+// departing in [from, to) into `out`; from = to = 0 takes every flight. Ties go to the higher
+// (fullest) or lower (emptiest) flight ID. Returns the number copied
+int load_index_fullest(FlightLoadIndex* index, int k, time_t from, time_t to, FlightLoad* out);
+int load_index_emptiest(FlightLoadIndex* index, int k, time_t from, time_t to, FlightLoad* out);
+
+// Load factor of a reported flight (booked seats over capacity; 0 for a flight without seats)
+double load_factor(const FlightLoad* load);
+
+// Free the index
+void load_index_free(FlightLoadIndex* index);
+
+#endif
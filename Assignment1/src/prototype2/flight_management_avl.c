@@ -10,10 +10,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "flight_management_avl.h"
+#include "../mem_stats.h"
 
 // Create a new AVL node
 AVL_Node* avl_create_node(Flight flight) {
-    AVL_Node* node = (AVL_Node*)malloc(sizeof(AVL_Node));
+    AVL_Node* node = (AVL_Node*)mem_alloc(MEM_FLIGHT_AVL, sizeof(AVL_Node));
     if (node == NULL) {
         fprintf(stderr, "Memory allocation failed for AVL node\n");
         exit(1);
@@ -23,6 +24,7 @@ AVL_Node* avl_create_node(Flight flight) {
     node->left = NULL;
     node->right = NULL;
     node->height = 1;  // New node is initially at height 1
+    node->size = 1;
     
     return node;
 }
@@ -34,6 +36,13 @@ int avl_height(AVL_Node* node) {
     return node->height;
 }
 
+// Get the number of flights in a subtree
+int avl_size(AVL_Node* node) {
+    if (node == NULL)
+        return 0;
+    return node->size;
+}
+
 // Get balance factor of an AVL node
 int avl_get_balance(AVL_Node* node) {
     if (node == NULL)
@@ -55,9 +64,11 @@ AVL_Node* avl_right_rotate(AVL_Node* y) {
     x->right = y;
     y->left = T2;
     
-    // Update heights
+    // Update heights and sizes (y is now below x)
     y->height = max_value(avl_height(y->left), avl_height(y->right)) + 1;
     x->height = max_value(avl_height(x->left), avl_height(x->right)) + 1;
+    y->size = avl_size(y->left) + avl_size(y->right) + 1;
+    x->size = avl_size(x->left) + avl_size(x->right) + 1;
     
     // Return new root
     return x;
@@ -72,9 +83,11 @@ AVL_Node* avl_left_rotate(AVL_Node* x) {
     y->left = x;
     x->right = T2;
     
-    // Update heights
+    // Update heights and sizes (x is now below y)
     x->height = max_value(avl_height(x->left), avl_height(x->right)) + 1;
     y->height = max_value(avl_height(y->left), avl_height(y->right)) + 1;
+    x->size = avl_size(x->left) + avl_size(x->right) + 1;
+    y->size = avl_size(y->left) + avl_size(y->right) + 1;
     
     // Return new root
     return y;
@@ -95,8 +108,9 @@ AVL_Node* avl_insert(AVL_Node* root, Flight flight) {
         return root;
     }
     
-    // 2. Update height of this ancestor node
+    // 2. Update height and size of this ancestor node
     root->height = 1 + max_value(avl_height(root->left), avl_height(root->right));
+    root->size = 1 + avl_size(root->left) + avl_size(root->right);
     
     // 3. Get the balance factor to check if this node became unbalanced
     int balance = avl_get_balance(root);
@@ -125,6 +139,61 @@ AVL_Node* avl_insert(AVL_Node* root, Flight flight) {
     return root;
 }
 
+// Restore the height, size and balance of a node after a deletion below it. Returns the
+// root of the subtree
+static AVL_Node* avl_rebalance(AVL_Node* root) {
+    root->height = 1 + max_value(avl_height(root->left), avl_height(root->right));
+    root->size = 1 + avl_size(root->left) + avl_size(root->right);
+    
+    int balance = avl_get_balance(root);
+    
+    // Left heavy: Left Left or Left Right Case
+    if (balance > 1) {
+        if (avl_get_balance(root->left) < 0)
+            root->left = avl_left_rotate(root->left);
+        return avl_right_rotate(root);
+    }
+    
+    // Right heavy: Right Right or Right Left Case
+    if (balance < -1) {
+        if (avl_get_balance(root->right) > 0)
+            root->right = avl_right_rotate(root->right);
+        return avl_left_rotate(root);
+    }
+    
+    return root;
+}
+
+// Delete a flight from the AVL tree
+AVL_Node* avl_delete(AVL_Node* root, int id, int* deleted) {
+    if (root == NULL)
+        return NULL;
+    
+    if (id < root->data.id)
+        root->left = avl_delete(root->left, id, deleted);
+    else if (id > root->data.id)
+        root->right = avl_delete(root->right, id, deleted);
+    else {
+        *deleted = 1;
+        
+        // Zero or one child: the child's subtree is already balanced
+        if (root->left == NULL || root->right == NULL) {
+            AVL_Node* child = root->left != NULL ? root->left : root->right;
+            mem_free(MEM_FLIGHT_AVL, root, sizeof(AVL_Node));
+            return child;
+        }
+        
+        // Two children: take over the in-order successor's flight, then delete the successor
+        AVL_Node* successor = root->right;
+        while (successor->left != NULL)
+            successor = successor->left;
+        root->data = successor->data;
+        root->right = avl_delete(root->right, successor->data.id, deleted);
+    }
+    
+    return avl_rebalance(root);
+}
+
 // Find a flight in the AVL tree
 Flight* avl_find_flight(AVL_Node* root, int id) {
     if (root == NULL)
@@ -139,6 +208,42 @@ Flight* avl_find_flight(AVL_Node* root, int id) {
         return avl_find_flight(root->right, id);
 }
 
+// Look up a batch of flight IDs a group at a time. Every lookup in the group descends one level
+// per pass and prefetches the child it moves to, so the misses of the group overlap
+void avl_find_flight_batch(AVL_Node* root, const int* ids, int count, Flight** results) {
+    for (int base = 0; base < count; base += AVL_BATCH_GROUP) {
+        int group = count - base < AVL_BATCH_GROUP ? count - base : AVL_BATCH_GROUP;
+        AVL_Node* cursor[AVL_BATCH_GROUP];
+        for (int j = 0; j < group; j++) {
+            results[base + j] = NULL;
+            cursor[j] = root;
+        }
+        
+        int active = root != NULL ? group : 0;
+        while (active > 0) {
+            active = 0;
+            for (int j = 0; j < group; j++) {
+                AVL_Node* node = cursor[j];
+                if (node == NULL) continue;
+                int id = ids[base + j];
+                if (id == node->data.id) {
+                    results[base + j] = &(node->data);
+                    cursor[j] = NULL;
+                    continue;
+                }
+                
+                // The ID and the child links are on different cache lines
+                cursor[j] = id < node->data.id ? node->left : node->right;
+                if (cursor[j] != NULL) {
+                    __builtin_prefetch(cursor[j]);
+                    __builtin_prefetch(&cursor[j]->left);
+                    active++;
+                }
+            }
+        }
+    }
+}
+
 // Print all flights in the AVL tree (in-order traversal)
 void avl_print_flights(AVL_Node* root) {
     if (root != NULL) {
@@ -155,6 +260,6 @@ void free_avl_tree(AVL_Node* root) {
     if (root != NULL) {
         free_avl_tree(root->left);
         free_avl_tree(root->right);
-        free(root);
+        mem_free(MEM_FLIGHT_AVL, root, sizeof(AVL_Node));
     }
 }
@@ -9,6 +9,9 @@ AVL_Node* avl_create_node(Flight flight);
 // Get height of an AVL node
 int avl_height(AVL_Node* node);
 
+// Get the number of flights in a subtree
+int avl_size(AVL_Node* node);
+
 // Get balance factor of an AVL node
 int avl_get_balance(AVL_Node* node);
 
@@ -21,9 +24,20 @@ AVL_Node* avl_left_rotate(AVL_Node* x);
 // Insert a flight into the AVL tree
 AVL_Node* avl_insert(AVL_Node* root, Flight flight);
 
+// Delete a flight from the AVL tree, rebalancing on the way up. Sets *deleted to 1 if the
+// flight was found. Returns the new root; Flight pointers into the tree are invalidated
+AVL_Node* avl_delete(AVL_Node* root, int id, int* deleted);
+
 // Find a flight in the AVL tree
 Flight* avl_find_flight(AVL_Node* root, int id);
 
+// Lookups interleaved per group by avl_find_flight_batch
+#define AVL_BATCH_GROUP 16
+
+// Find a batch of flights: results[i] is the flight with ids[i], or NULL. Much faster than
+// one avl_find_flight call per ID when the tree does not fit in cache
+void avl_find_flight_batch(AVL_Node* root, const int* ids, int count, Flight** results);
+
 // Print all flights in the AVL tree (in-order traversal)
 void avl_print_flights(AVL_Node* root);
 
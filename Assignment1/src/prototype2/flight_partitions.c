@@ -0,0 +1,512 @@
+/*
+ * Time-Partitioned Flight Store (Prototype 2)
+ *
+ * Flights are grouped by the local day they depart on. Each day has its own
+ * AVL tree of flights, reservation BST and set of passengers, so a query for
+ * a time window only touches the days that overlap it, and a query for a
+ * passenger skips days the passenger has no reservation on. A map from
+ * flight ID to departure day finds the partition of any flight directly.
+ *
+ * Days that have departed can be archived: the partition's flights and
+ * reservations are written to a binary snapshot file and freed, leaving only
+ * the small summary in memory. A query that needs an archived day reads it
+ * back on demand. Reservations are written in pre-order, so a reload rebuilds
+ * exactly the same BST.
+ *
+ * Sources used:
+ * 1. "Database System Concepts" by Silberschatz, Korth and Sudarshan - Range partitioning and partition pruning
+ * 2. Introduction to Algorithms by Cormen et al. - Open addressing with linear probing
+ * 3. The C Programming Language (K&R) - Binary file I/O
+ */
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flight_partitions.h"
+#include "flight_management_avl.h"
+#include "reservation_management_bst.h"
+#include "../snapshot.h"
+
+//--- ID MAPS ---//
+
+// Create an empty map, with a day per key if with_days is set
+static int id_map_init(IdMap* map, int with_days) {
+    map->capacity = 16;
+    map->count = 0;
+    map->keys = (int*)malloc(map->capacity * sizeof(int));
+    map->days = with_days ? (time_t*)malloc(map->capacity * sizeof(time_t)) : NULL;
+    if (map->keys == NULL || (with_days && map->days == NULL)) {
+        fprintf(stderr, "Memory allocation failed for partition ID map\n");
+        free(map->keys);
+        free(map->days);
+        map->keys = NULL;
+        map->days = NULL;
+        return 0;
+    }
+    for (int i = 0; i < map->capacity; i++) {
+        map->keys[i] = ID_MAP_EMPTY;
+    }
+    return 1;
+}
+
+// Slot holding `id`, or the empty slot where it would go
+static int id_map_slot(const IdMap* map, int id) {
+    unsigned int mask = (unsigned int)map->capacity - 1;
+    unsigned int slot = ((unsigned int)id * 2654435761u) & mask;
+    while (map->keys[slot] != id && map->keys[slot] != ID_MAP_EMPTY) {
+        slot = (slot + 1) & mask;
+    }
+    return (int)slot;
+}
+
+// Look up an ID. Returns 1 if present (and sets *day when the map has days)
+static int id_map_get(const IdMap* map, int id, time_t* day) {
+    int slot = id_map_slot(map, id);
+    if (map->keys[slot] == ID_MAP_EMPTY) {
+        return 0;
+    }
+    if (day != NULL && map->days != NULL) {
+        *day = map->days[slot];
+    }
+    return 1;
+}
+
+// Insert or update an ID, doubling the table when it is half full. Returns 1 on success
+static int id_map_put(IdMap* map, int id, time_t day) {
+    if ((map->count + 1) * 2 > map->capacity) {
+        IdMap grown;
+        grown.capacity = map->capacity * 2;
+        grown.count = 0;
+        grown.keys = (int*)malloc(grown.capacity * sizeof(int));
+        grown.days = map->days != NULL ? (time_t*)malloc(grown.capacity * sizeof(time_t)) : NULL;
+        if (grown.keys == NULL || (map->days != NULL && grown.days == NULL)) {
+            fprintf(stderr, "Memory allocation failed for partition ID map\n");
+            free(grown.keys);
+            free(grown.days);
+            return 0;
+        }
+        for (int i = 0; i < grown.capacity; i++) {
+            grown.keys[i] = ID_MAP_EMPTY;
+        }
+        for (int i = 0; i < map->capacity; i++) {
+            if (map->keys[i] == ID_MAP_EMPTY) continue;
+            int slot = id_map_slot(&grown, map->keys[i]);
+            grown.keys[slot] = map->keys[i];
+            if (grown.days != NULL) grown.days[slot] = map->days[i];
+            grown.count++;
+        }
+        free(map->keys);
+        free(map->days);
+        *map = grown;
+    }
+    
+    int slot = id_map_slot(map, id);
+    if (map->keys[slot] == ID_MAP_EMPTY) {
+        map->keys[slot] = id;
+        map->count++;
+    }
+    if (map->days != NULL) {
+        map->days[slot] = day;
+    }
+    return 1;
+}
+
+// Free a map's tables
+static void id_map_free(IdMap* map) {
+    free(map->keys);
+    free(map->days);
+    map->keys = NULL;
+    map->days = NULL;
+}
+
+//--- PARTITION DIRECTORY ---//
+
+// Local midnight at the start of the day containing `t`, and the next midnight
+static void day_bounds(time_t t, time_t* start, time_t* end) {
+    struct tm day;
+    localtime_r(&t, &day);
+    day.tm_hour = 0;
+    day.tm_min = 0;
+    day.tm_sec = 0;
+    day.tm_isdst = -1;
+    struct tm next = day;
+    next.tm_mday++;
+    *start = mktime(&day);
+    *end = mktime(&next);
+}
+
+// Index of the first partition whose day ends after `t` (count if there is none)
+static int first_partition_after(const PartitionedFlightStore* store, time_t t) {
+    int low = 0;
+    int high = store->count;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (store->partitions[middle].day_end <= t) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// Partition of the day containing `t`, created if it does not exist yet. NULL on failure
+static FlightPartition* partition_for_time(PartitionedFlightStore* store, time_t t) {
+    int index = first_partition_after(store, t);
+    if (index < store->count && store->partitions[index].day_start <= t) {
+        return &store->partitions[index];
+    }
+    
+    if (store->count == store->capacity) {
+        int capacity = store->capacity > 0 ? store->capacity * 2 : 16;
+        FlightPartition* grown = (FlightPartition*)realloc(store->partitions, capacity * sizeof(FlightPartition));
+        if (grown == NULL) {
+            fprintf(stderr, "Memory allocation failed for flight partitions\n");
+            return NULL;
+        }
+        store->partitions = grown;
+        store->capacity = capacity;
+    }
+    
+    FlightPartition partition;
+    memset(&partition, 0, sizeof(partition));
+    day_bounds(t, &partition.day_start, &partition.day_end);
+    partition.reservations = init_reservation_bst();
+    if (partition.reservations == NULL || !id_map_init(&partition.passengers, 0)) {
+        free_reservation_bst(partition.reservations);
+        return NULL;
+    }
+    partition.resident = 1;
+    
+    memmove(&store->partitions[index + 1], &store->partitions[index],
+            (store->count - index) * sizeof(FlightPartition));
+    store->partitions[index] = partition;
+    store->count++;
+    store->resident_count++;
+    return &store->partitions[index];
+}
+
+// Partition a known flight departs in, or NULL if the flight is unknown
+static FlightPartition* partition_of_flight(PartitionedFlightStore* store, int flightId) {
+    time_t day = 0;
+    if (!id_map_get(&store->flight_days, flightId, &day)) {
+        return NULL;
+    }
+    int index = first_partition_after(store, day);
+    return index < store->count ? &store->partitions[index] : NULL;
+}
+
+//--- ARCHIVING ---//
+
+// Archive file of a partition, named after its day
+static void partition_path(const PartitionedFlightStore* store, const FlightPartition* partition,
+                           char* path, size_t size) {
+    struct tm day;
+    localtime_r(&partition->day_start, &day);
+    snprintf(path, size, "%s/flights_%04d%02d%02d.snap", store->archive_dir,
+             day.tm_year + 1900, day.tm_mon + 1, day.tm_mday);
+}
+
+// Copy the flights of a subtree in ID order
+static void collect_flights(AVL_Node* node, Flight* out, int* count) {
+    if (node == NULL) return;
+    collect_flights(node->left, out, count);
+    out[(*count)++] = node->data;
+    collect_flights(node->right, out, count);
+}
+
+// Copy the reservations of a BST in pre-order (inserting them in this order rebuilds the
+// same tree). Returns the number copied, or -1 on failure
+static int collect_reservations_preorder(ReservationBST* bst, ReservationRecord* out) {
+    if (bst->root == NULL) return 0;
+    
+    int capacity = 64;
+    int top = 0;
+    ReservationBST_Node** stack = (ReservationBST_Node**)malloc(capacity * sizeof(ReservationBST_Node*));
+    if (stack == NULL) return -1;
+    
+    int count = 0;
+    stack[top++] = bst->root;
+    while (top > 0) {
+        ReservationBST_Node* node = stack[--top];
+        out[count++] = node->data;
+        if (top + 2 > capacity) {
+            capacity *= 2;
+            ReservationBST_Node** grown = (ReservationBST_Node**)realloc(stack, capacity * sizeof(ReservationBST_Node*));
+            if (grown == NULL) {
+                free(stack);
+                return -1;
+            }
+            stack = grown;
+        }
+        if (node->right != NULL) stack[top++] = node->right;
+        if (node->left != NULL) stack[top++] = node->left;
+    }
+    free(stack);
+    return count;
+}
+
+// Write a resident partition to its archive file. Returns 1 on success
+static int write_partition(PartitionedFlightStore* store, FlightPartition* partition) {
+    Flight* flights = (Flight*)malloc((partition->flight_count + 1) * sizeof(Flight));
+    ReservationRecord* records = (ReservationRecord*)malloc((partition->reservation_count + 1) * sizeof(ReservationRecord));
+    if (flights == NULL || records == NULL) {
+        fprintf(stderr, "Memory allocation failed when archiving a flight partition\n");
+        free(flights);
+        free(records);
+        return 0;
+    }
+    
+    int flight_count = 0;
+    collect_flights(partition->flights, flights, &flight_count);
+    int record_count = collect_reservations_preorder(partition->reservations, records);
+    
+    char path[MAX_LINE_LENGTH + 64];
+    partition_path(store, partition, path, sizeof(path));
+    int ok = record_count >= 0 &&
+             save_data_to_snapshot(flights, flight_count, NULL, 0, records, record_count, path);
+    free(flights);
+    free(records);
+    if (ok) {
+        partition->on_disk = 1;
+    }
+    return ok;
+}
+
+// Free a partition's flights and reservations, keeping its summary
+static void release_partition(PartitionedFlightStore* store, FlightPartition* partition) {
+    if (!partition->resident) return;
+    free_avl_tree(partition->flights);
+    free_reservation_bst(partition->reservations);
+    partition->flights = NULL;
+    partition->reservations = NULL;
+    partition->resident = 0;
+    store->resident_count--;
+}
+
+// Make sure a partition is in memory, reading it back from its archive file. Returns 1 on success
+static int ensure_resident(PartitionedFlightStore* store, FlightPartition* partition) {
+    if (partition->resident) return 1;
+    
+    char path[MAX_LINE_LENGTH + 64];
+    partition_path(store, partition, path, sizeof(path));
+    Flight* flights;
+    Passenger* passengers;
+    ReservationRecord* records;
+    int flight_count, passenger_count, record_count;
+    if (!load_data_from_snapshot(path, &flights, &flight_count, &passengers, &passenger_count,
+                                 &records, &record_count)) {
+        fprintf(stderr, "Could not reload flight partition %s\n", path);
+        return 0;
+    }
+    
+    partition->reservations = init_reservation_bst();
+    if (partition->reservations == NULL) {
+        free(flights);
+        free(passengers);
+        free(records);
+        return 0;
+    }
+    for (int i = 0; i < flight_count; i++) {
+        partition->flights = avl_insert(partition->flights, flights[i]);
+    }
+    for (int i = 0; i < record_count; i++) {
+        add_reservation_bst(partition->reservations, records[i]);
+    }
+    free(flights);
+    free(passengers);
+    free(records);
+    
+    partition->resident = 1;
+    store->resident_count++;
+    store->reloads++;
+    return 1;
+}
+
+//--- PUBLIC OPERATIONS ---//
+
+// Create an empty store
+PartitionedFlightStore* partition_store_create(const char* archive_dir) {
+    PartitionedFlightStore* store = (PartitionedFlightStore*)calloc(1, sizeof(PartitionedFlightStore));
+    if (store == NULL || !id_map_init(&store->flight_days, 1)) {
+        fprintf(stderr, "Memory allocation failed for partitioned flight store\n");
+        free(store);
+        return NULL;
+    }
+    strncpy(store->archive_dir, archive_dir, sizeof(store->archive_dir) - 1);
+    return store;
+}
+
+// Add a flight to the partition of its departure day
+int partition_store_add_flight(PartitionedFlightStore* store, Flight flight) {
+    FlightPartition* partition = partition_for_time(store, flight.departureTime);
+    if (partition == NULL) {
+        return 0;
+    }
+    
+    // Moving a flight to another day would strand its reservations in the old partition
+    time_t day = 0;
+    if (id_map_get(&store->flight_days, flight.id, &day) && day != partition->day_start) {
+        return 0;
+    }
+    if (!ensure_resident(store, partition) || !id_map_put(&store->flight_days, flight.id, partition->day_start)) {
+        return 0;
+    }
+    
+    partition->flights = avl_insert(partition->flights, flight);
+    partition->flight_count = avl_size(partition->flights);
+    partition->on_disk = 0;
+    return 1;
+}
+
+// Add a reservation to the partition of its flight
+int partition_store_add_reservation(PartitionedFlightStore* store, ReservationRecord record) {
+    FlightPartition* partition = partition_of_flight(store, record.flightId);
+    if (partition == NULL || !ensure_resident(store, partition) ||
+        !id_map_put(&partition->passengers, record.passengerId, 0)) {
+        return 0;
+    }
+    
+    add_reservation_bst(partition->reservations, record);
+    partition->reservation_count = partition->reservations->count;
+    partition->on_disk = 0;
+    return 1;
+}
+
+// Find a flight by ID
+Flight* partition_find_flight(PartitionedFlightStore* store, int flightId) {
+    FlightPartition* partition = partition_of_flight(store, flightId);
+    if (partition == NULL || !ensure_resident(store, partition)) {
+        return NULL;
+    }
+    return avl_find_flight(partition->flights, flightId);
+}
+
+// Copy the reservations on a flight into *records
+int partition_flight_reservations(PartitionedFlightStore* store, int flightId,
+                                  ReservationRecord** records, int* capacity) {
+    FlightPartition* partition = partition_of_flight(store, flightId);
+    if (partition == NULL) {
+        return 0;
+    }
+    if (!ensure_resident(store, partition)) {
+        return -1;
+    }
+    return find_reservations_by_flight_bst(partition->reservations, flightId, records, capacity);
+}
+
+// Append a flight to a growing array. Returns 1 on success
+static int append_flight(Flight** flights, int* capacity, int count, Flight flight) {
+    if (count >= *capacity) {
+        int grown_capacity = *capacity > 0 ? *capacity * 2 : 64;
+        Flight* grown = (Flight*)realloc(*flights, grown_capacity * sizeof(Flight));
+        if (grown == NULL) {
+            fprintf(stderr, "Memory allocation failed when listing departures\n");
+            return 0;
+        }
+        *flights = grown;
+        *capacity = grown_capacity;
+    }
+    (*flights)[count] = flight;
+    return 1;
+}
+
+// Append the flights of a subtree departing in [from, to), in ID order. Returns 0 on failure
+static int collect_departures(AVL_Node* node, time_t from, time_t to, Flight** flights, int* capacity, int* count) {
+    if (node == NULL) return 1;
+    if (!collect_departures(node->left, from, to, flights, capacity, count)) return 0;
+    if (node->data.departureTime >= from && node->data.departureTime < to) {
+        if (!append_flight(flights, capacity, *count, node->data)) return 0;
+        (*count)++;
+    }
+    return collect_departures(node->right, from, to, flights, capacity, count);
+}
+
+// Copy the flights departing in [from, to) into *flights
+int partition_list_departures(PartitionedFlightStore* store, time_t from, time_t to,
+                              Flight** flights, int* capacity) {
+    int count = 0;
+    for (int i = first_partition_after(store, from); i < store->count && store->partitions[i].day_start < to; i++) {
+        FlightPartition* partition = &store->partitions[i];
+        if (partition->flight_count == 0) continue;
+        if (!ensure_resident(store, partition) ||
+            !collect_departures(partition->flights, from, to, flights, capacity, &count)) {
+            return -1;
+        }
+    }
+    return count;
+}
+
+// Copy a passenger's reservations on flights departing in [from, to) into *records
+int partition_passenger_reservations(PartitionedFlightStore* store, int passengerId, time_t from, time_t to,
+                                     ReservationRecord** records, int* capacity) {
+    ReservationRecord* found = NULL;
+    int found_capacity = 0;
+    int count = 0;
+    for (int i = first_partition_after(store, from); i < store->count && store->partitions[i].day_start < to; i++) {
+        FlightPartition* partition = &store->partitions[i];
+        if (!id_map_get(&partition->passengers, passengerId, NULL)) continue;
+        if (!ensure_resident(store, partition)) {
+            count = -1;
+            break;
+        }
+        
+        int found_count = find_reservations_by_passenger_bst(partition->reservations, passengerId,
+                                                             &found, &found_capacity);
+        if (found_count < 0) {
+            count = -1;
+            break;
+        }
+        
+        // Only days cut by the window need each flight's departure checked
+        int whole_day = partition->day_start >= from && partition->day_end <= to;
+        for (int j = 0; j < found_count; j++) {
+            if (!whole_day) {
+                Flight* flight = avl_find_flight(partition->flights, found[j].flightId);
+                if (flight == NULL || flight->departureTime < from || flight->departureTime >= to) continue;
+            }
+            if (count >= *capacity) {
+                int grown_capacity = *capacity > 0 ? *capacity * 2 : 16;
+                ReservationRecord* grown = (ReservationRecord*)realloc(*records, grown_capacity * sizeof(ReservationRecord));
+                if (grown == NULL) {
+                    fprintf(stderr, "Memory allocation failed when collecting reservations\n");
+                    free(found);
+                    return -1;
+                }
+                *records = grown;
+                *capacity = grown_capacity;
+            }
+            (*records)[count++] = found[j];
+        }
+    }
+    free(found);
+    return count;
+}
+
+// Archive and free every partition whose day ends at or before `cutoff`
+int partition_archive_before(PartitionedFlightStore* store, time_t cutoff) {
+    int released = 0;
+    for (int i = 0; i < store->count && store->partitions[i].day_end <= cutoff; i++) {
+        FlightPartition* partition = &store->partitions[i];
+        if (!partition->resident) continue;
+        if (!partition->on_disk && !write_partition(store, partition)) {
+            return -1;
+        }
+        release_partition(store, partition);
+        released++;
+    }
+    return released;
+}
+
+// Free the store
+void partition_store_free(PartitionedFlightStore* store) {
+    if (store == NULL) return;
+    for (int i = 0; i < store->count; i++) {
+        release_partition(store, &store->partitions[i]);
+        id_map_free(&store->partitions[i].passengers);
+    }
+    id_map_free(&store->flight_days);
+    free(store->partitions);
+    free(store);
+}
@@ -0,0 +1,82 @@
+#ifndef FLIGHT_PARTITIONS_H
+#define FLIGHT_PARTITIONS_H
+
+#include <time.h>
+#include "../airline_types.h"
+
+// Key of an unused slot in an IdMap
+#define ID_MAP_EMPTY (-2147483647 - 1)
+
+// Open-addressing map from an ID to a departure day (or a plain set of IDs when days is NULL)
+typedef struct {
+    int* keys;
+    time_t* days;
+    int capacity;  // Power of two
+    int count;
+} IdMap;
+
+// Flights departing on one local day with their reservations. An archived partition keeps
+// only its summary in memory (passenger set and counts); its flights and reservations are
+// read back from its file the first time a query needs them
+typedef struct {
+    time_t day_start;              // Local midnight
+    time_t day_end;                // The next local midnight
+    AVL_Node* flights;             // NULL while not resident
+    ReservationBST* reservations;  // NULL while not resident
+    IdMap passengers;              // Passengers holding a reservation in this partition
+    int flight_count;
+    int reservation_count;
+    int resident;                  // Flights and reservations are in memory
+    int on_disk;                   // The archive file matches the partition
+} FlightPartition;
+
+// Flights and reservations partitioned by departure day. Time-window queries only visit
+// the partitions that overlap the window, and departed days can be archived to disk
+typedef struct {
+    FlightPartition* partitions;   // Sorted by day
+    int count;
+    int capacity;
+    IdMap flight_days;             // Flight ID to departure day, for every flight
+    char archive_dir[MAX_LINE_LENGTH];
+    int resident_count;
+    long long reloads;             // Archived partitions read back so far
+} PartitionedFlightStore;
+
+// Create an empty store that archives into `archive_dir` (which must exist). Returns NULL on failure
+PartitionedFlightStore* partition_store_create(const char* archive_dir);
+
+// Add a flight to the partition of its departure day (or replace the flight with the same ID
+// and day). Returns 1 on success, 0 if the ID already departs on another day or on failure
+int partition_store_add_flight(PartitionedFlightStore* store, Flight flight);
+
+// Add a reservation to the partition of its flight. Returns 1 on success, 0 if the flight is unknown
+int partition_store_add_reservation(PartitionedFlightStore* store, ReservationRecord record);
+
+// Find a flight by ID, reloading its partition if it is archived. The pointer stays valid until
+// the next archive or change of the store
+Flight* partition_find_flight(PartitionedFlightStore* store, int flightId);
+
+// Copy the reservations on a flight into *records (grown as needed).
+// Returns the number found, or -1 on failure
+int partition_flight_reservations(PartitionedFlightStore* store, int flightId,
+                                  ReservationRecord** records, int* capacity);
+
+// Copy the flights departing in [from, to) into *flights (grown as needed), day by day and in
+// ID order within a day. Returns the number found, or -1 on failure
+int partition_list_departures(PartitionedFlightStore* store, time_t from, time_t to,
+                              Flight** flights, int* capacity);
+
+// Copy a passenger's reservations on flights departing in [from, to) into *records (grown as
+// needed), skipping days the passenger has no reservation on. Returns the number found, or -1
+int partition_passenger_reservations(PartitionedFlightStore* store, int passengerId, time_t from, time_t to,
+                                     ReservationRecord** records, int* capacity);
+
+// Write every partition whose day ends at or before `cutoff` to the archive directory (unless
+// its file is already up to date) and free its flights and reservations.
+// Returns the number of partitions released, or -1 if one could not be written
+int partition_archive_before(PartitionedFlightStore* store, time_t cutoff);
+
+// Free the store. Archive files are left on disk
+void partition_store_free(PartitionedFlightStore* store);
+
+#endif
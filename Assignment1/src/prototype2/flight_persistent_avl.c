@@ -0,0 +1,191 @@
+/*
+ * Persistent Flight AVL Tree Implementation (Prototype 2)
+ *
+ * An insert never modifies a published node: it copies every node on the
+ * path from the root, inserts below the copies and rebalances them (only
+ * nodes on the insertion path ever rotate, so the rotations touch copies
+ * alone), then publishes the new root with one atomic store. A reader
+ * announces the global epoch in its slot and loads the root; everything
+ * reachable from that root stays untouched until it clears the slot.
+ *
+ * The originals of the copied nodes are retired with the epoch in which they
+ * were replaced. After publishing, the writer advances the epoch and frees
+ * every retired node older than the oldest epoch a reader still announces.
+ * All epoch and root accesses are sequentially consistent, so a reader whose
+ * announcement the writer missed is guaranteed to load the new root.
+ *
+ * Sources used:
+ * 1. "Purely Functional Data Structures" by Chris Okasaki - Path copying
+ * 2. Keir Fraser, "Practical lock-freedom" (PhD thesis) - Epoch-based reclamation
+ * 3. Data Structures and Algorithm Analysis by Mark Allen Weiss - AVL rotations
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flight_persistent_avl.h"
+#include "flight_management_avl.h"
+#include "../mem_stats.h"
+
+// Get maximum of two integers
+static int max_value(int a, int b) {
+    return (a > b) ? a : b;
+}
+
+// Remember a replaced node (writer lock held)
+static void retire_node(PersistentFlightTree* tree, AVL_Node* node) {
+    if (tree->retired_count >= tree->retired_capacity) {
+        int new_capacity = tree->retired_capacity > 0 ? tree->retired_capacity * 2 : 256;
+        PavlRetired* grown = (PavlRetired*)realloc(tree->retired, new_capacity * sizeof(PavlRetired));
+        if (grown == NULL) {
+            fprintf(stderr, "Memory allocation failed for retired AVL nodes\n");
+            exit(1);
+        }
+        tree->retired = grown;
+        tree->retired_capacity = new_capacity;
+    }
+    tree->retired[tree->retired_count].node = node;
+    tree->retired[tree->retired_count].epoch = __atomic_load_n(&tree->epoch, __ATOMIC_SEQ_CST);
+    tree->retired_count++;
+}
+
+// Private copy of a published node; the original is retired
+static AVL_Node* copy_node(PersistentFlightTree* tree, AVL_Node* node) {
+    AVL_Node* copy = avl_create_node(node->data);
+    copy->left = node->left;
+    copy->right = node->right;
+    copy->height = node->height;
+    copy->size = node->size;
+    retire_node(tree, node);
+    return copy;
+}
+
+// Insert below a copy of `root`, returning the root of the new subtree
+static AVL_Node* insert_copy(PersistentFlightTree* tree, AVL_Node* root, Flight flight) {
+    if (root == NULL) {
+        tree->count++;
+        return avl_create_node(flight);
+    }
+    
+    AVL_Node* node = copy_node(tree, root);
+    if (flight.id < node->data.id) {
+        node->left = insert_copy(tree, node->left, flight);
+    } else if (flight.id > node->data.id) {
+        node->right = insert_copy(tree, node->right, flight);
+    } else {
+        node->data = flight;
+        return node;
+    }
+    
+    node->height = 1 + max_value(avl_height(node->left), avl_height(node->right));
+    node->size = 1 + avl_size(node->left) + avl_size(node->right);
+    int balance = avl_get_balance(node);
+    
+    // The same four cases as avl_insert. Every node rotated is on the insertion path,
+    // so it is one of this insert's copies
+    if (balance > 1 && flight.id < node->left->data.id) {
+        return avl_right_rotate(node);
+    }
+    if (balance < -1 && flight.id > node->right->data.id) {
+        return avl_left_rotate(node);
+    }
+    if (balance > 1 && flight.id > node->left->data.id) {
+        node->left = avl_left_rotate(node->left);
+        return avl_right_rotate(node);
+    }
+    if (balance < -1 && flight.id < node->right->data.id) {
+        node->right = avl_right_rotate(node->right);
+        return avl_left_rotate(node);
+    }
+    return node;
+}
+
+// Create an empty tree
+PersistentFlightTree* pavl_create() {
+    PersistentFlightTree* tree = NULL;
+    // Cache-line aligned so every reader slot sits on its own line
+    if (posix_memalign((void**)&tree, 64, sizeof(PersistentFlightTree)) != 0) {
+        fprintf(stderr, "Memory allocation failed for persistent flight tree\n");
+        return NULL;
+    }
+    memset(tree, 0, sizeof(PersistentFlightTree));
+    for (int i = 0; i < PAVL_MAX_READERS; i++) {
+        tree->readers[i].epoch = PAVL_IDLE;
+    }
+    if (pthread_mutex_init(&tree->writer_lock, NULL) != 0) {
+        fprintf(stderr, "Could not create the persistent flight tree lock\n");
+        free(tree);
+        return NULL;
+    }
+    return tree;
+}
+
+// Insert a flight and publish the new version
+int pavl_insert(PersistentFlightTree* tree, Flight flight) {
+    if (tree == NULL) {
+        return 0;
+    }
+    
+    pthread_mutex_lock(&tree->writer_lock);
+    AVL_Node* root = __atomic_load_n(&tree->root, __ATOMIC_SEQ_CST);
+    AVL_Node* new_root = insert_copy(tree, root, flight);
+    __atomic_store_n(&tree->root, new_root, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&tree->epoch, 1, __ATOMIC_SEQ_CST);
+    pavl_reclaim(tree);
+    pthread_mutex_unlock(&tree->writer_lock);
+    return 1;
+}
+
+// Start reading: announce the epoch, then load the root
+AVL_Node* pavl_read_begin(PersistentFlightTree* tree, int reader) {
+    unsigned long epoch = __atomic_load_n(&tree->epoch, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&tree->readers[reader].epoch, epoch, __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&tree->root, __ATOMIC_SEQ_CST);
+}
+
+// Finish reading
+void pavl_read_end(PersistentFlightTree* tree, int reader) {
+    __atomic_store_n(&tree->readers[reader].epoch, PAVL_IDLE, __ATOMIC_SEQ_CST);
+}
+
+// Free retired nodes older than every active reader (writer lock held)
+void pavl_reclaim(PersistentFlightTree* tree) {
+    unsigned long oldest = PAVL_IDLE;
+    for (int i = 0; i < PAVL_MAX_READERS; i++) {
+        unsigned long epoch = __atomic_load_n(&tree->readers[i].epoch, __ATOMIC_SEQ_CST);
+        if (epoch < oldest) oldest = epoch;
+    }
+    
+    int kept = 0;
+    for (int i = 0; i < tree->retired_count; i++) {
+        if (tree->retired[i].epoch < oldest) {
+            mem_free(MEM_FLIGHT_AVL, tree->retired[i].node, sizeof(AVL_Node));
+            tree->reclaimed++;
+        } else {
+            tree->retired[kept++] = tree->retired[i];
+        }
+    }
+    tree->retired_count = kept;
+}
+
+// Number of flights in a snapshot
+int pavl_count_flights(AVL_Node* snapshot) {
+    if (snapshot == NULL) {
+        return 0;
+    }
+    return pavl_count_flights(snapshot->left) + 1 + pavl_count_flights(snapshot->right);
+}
+
+// Free the tree and all retired nodes
+void pavl_free(PersistentFlightTree* tree) {
+    if (tree == NULL) {
+        return;
+    }
+    free_avl_tree(tree->root);
+    for (int i = 0; i < tree->retired_count; i++) {
+        mem_free(MEM_FLIGHT_AVL, tree->retired[i].node, sizeof(AVL_Node));
+    }
+    free(tree->retired);
+    pthread_mutex_destroy(&tree->writer_lock);
+    free(tree);
+}
@@ -0,0 +1,64 @@
+#ifndef FLIGHT_PERSISTENT_AVL_H
+#define FLIGHT_PERSISTENT_AVL_H
+
+#include <pthread.h>
+#include "../airline_types.h"
+
+// Most readers that can hold a snapshot at the same time (reader numbers 0..PAVL_MAX_READERS-1)
+#define PAVL_MAX_READERS 64
+
+// Epoch a reader slot holds while it is not reading
+#define PAVL_IDLE ((unsigned long)-1)
+
+// Epoch announced by one reader, alone on its cache line
+typedef struct {
+    unsigned long epoch;
+} __attribute__((aligned(64))) PavlReaderSlot;
+
+// A replaced node waiting until no reader can still reach it
+typedef struct {
+    AVL_Node* node;
+    unsigned long epoch;  // Global epoch when it was replaced
+} PavlRetired;
+
+// Persistent (path-copying) AVL tree of flights. Nodes reachable from a published root are
+// never modified: an insert copies the path from the root to the new node, rebalances the
+// copies and publishes the new root atomically. Readers take a snapshot root and may walk
+// it for as long as they like without blocking writers; replaced nodes are freed once every
+// reader that could still see them has finished (epoch-based reclamation)
+typedef struct {
+    AVL_Node* root;       // Latest published version (read and written atomically)
+    unsigned long epoch;  // Global epoch, advanced after every publish
+    PavlReaderSlot readers[PAVL_MAX_READERS];
+    pthread_mutex_t writer_lock;  // Writers are serialised
+    PavlRetired* retired;
+    int retired_count;
+    int retired_capacity;
+    int count;                    // Flights in the latest version
+    long long reclaimed;          // Nodes freed so far
+} PersistentFlightTree;
+
+// Create an empty tree. Returns NULL on failure
+PersistentFlightTree* pavl_create();
+
+// Insert a flight (or replace the flight with the same ID) and publish the new version.
+// Safe to call from several threads. Returns 1 on success
+int pavl_insert(PersistentFlightTree* tree, Flight flight);
+
+// Start reading as reader number `reader` and return the current root. The snapshot and
+// every Flight found in it stay valid and unchanged until pavl_read_end
+AVL_Node* pavl_read_begin(PersistentFlightTree* tree, int reader);
+
+// Finish reading as reader number `reader`
+void pavl_read_end(PersistentFlightTree* tree, int reader);
+
+// Free retired nodes no active reader can reach. Called by every insert
+void pavl_reclaim(PersistentFlightTree* tree);
+
+// Number of flights in a snapshot (an in-order walk, for scans)
+int pavl_count_flights(AVL_Node* snapshot);
+
+// Free the tree and all retired nodes. No reader may be active
+void pavl_free(PersistentFlightTree* tree);
+
+#endif
@@ -1,8 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include "../airline_types.h"
 #include "flight_management_avl.h"
+#include "flight_search_avl.h"
 
 // Search for a flight by flight number in AVL tree
 Flight* avl_find_flight_by_number(AVL_Node* root, const char* flight_number) {
@@ -23,3 +25,131 @@ Flight* avl_find_flight_by_number(AVL_Node* root, const char* flight_number) {
     
     return avl_find_flight_by_number(root->right, flight_number);
 }
+
+// Get the k-th flight in ID order
+Flight* avl_select(AVL_Node* root, int k) {
+    AVL_Node* current = root;
+    while (current != NULL) {
+        int left_size = avl_size(current->left);
+        if (k < left_size) {
+            current = current->left;
+        } else if (k == left_size) {
+            return &(current->data);
+        } else {
+            k -= left_size + 1;
+            current = current->right;
+        }
+    }
+    return NULL;
+}
+
+// Get the number of flights with an ID below `id`
+int avl_rank(AVL_Node* root, int id) {
+    int rank = 0;
+    AVL_Node* current = root;
+    while (current != NULL) {
+        if (id <= current->data.id) {
+            current = current->left;
+        } else {
+            // This node and its whole left subtree come before `id`
+            rank += avl_size(current->left) + 1;
+            current = current->right;
+        }
+    }
+    return rank;
+}
+
+// Count the flights with IDs in [low, high]
+int avl_count_range(AVL_Node* root, int low, int high) {
+    if (low > high) {
+        return 0;
+    }
+    int up_to_high = high == INT_MAX ? avl_size(root) : avl_rank(root, high + 1);
+    return up_to_high - avl_rank(root, low);
+}
+
+// Push a node onto a cursor's path
+static void cursor_push(AvlCursor* cursor, AVL_Node* node) {
+    if (cursor->depth < AVL_CURSOR_DEPTH) {
+        cursor->path[cursor->depth++] = node;
+    }
+}
+
+// Position a cursor at the first flight with an ID of at least `id`
+void avl_cursor_seek(AvlCursor* cursor, AVL_Node* root, int id) {
+    cursor->depth = 0;
+    AVL_Node* current = root;
+    while (current != NULL) {
+        if (current->data.id >= id) {
+            // Visited after everything smaller in its left subtree
+            cursor_push(cursor, current);
+            current = current->left;
+        } else {
+            current = current->right;
+        }
+    }
+}
+
+// Position a cursor at the k-th flight in ID order
+void avl_cursor_seek_rank(AvlCursor* cursor, AVL_Node* root, int k) {
+    cursor->depth = 0;
+    AVL_Node* current = root;
+    while (current != NULL) {
+        int left_size = avl_size(current->left);
+        if (k < left_size) {
+            cursor_push(cursor, current);
+            current = current->left;
+        } else if (k == left_size) {
+            cursor_push(cursor, current);
+            return;
+        } else {
+            k -= left_size + 1;
+            current = current->right;
+        }
+    }
+}
+
+// Return the flight at the cursor and advance
+Flight* avl_cursor_next(AvlCursor* cursor) {
+    if (cursor->depth == 0) {
+        return NULL;
+    }
+    AVL_Node* node = cursor->path[--cursor->depth];
+    
+    // The next flight is the leftmost one of the right subtree, or else the nearest ancestor
+    // already on the path
+    for (AVL_Node* current = node->right; current != NULL; current = current->left) {
+        cursor_push(cursor, current);
+    }
+    return &(node->data);
+}
+
+// Copy a page from a positioned cursor
+static int copy_page(AvlCursor* cursor, Flight* page, int limit) {
+    int count = 0;
+    Flight* flight;
+    while (count < limit && (flight = avl_cursor_next(cursor)) != NULL) {
+        page[count++] = *flight;
+    }
+    return count;
+}
+
+// Copy up to `limit` flights after flight `after_id`
+int avl_list_flights_after(AVL_Node* root, int after_id, Flight* page, int limit) {
+    if (after_id == INT_MAX) {
+        return 0;
+    }
+    AvlCursor cursor;
+    avl_cursor_seek(&cursor, root, after_id + 1);
+    return copy_page(&cursor, page, limit);
+}
+
+// Copy up to `limit` flights starting at position `start`
+int avl_list_flights_from_rank(AVL_Node* root, int start, Flight* page, int limit) {
+    if (start < 0) {
+        start = 0;
+    }
+    AvlCursor cursor;
+    avl_cursor_seek_rank(&cursor, root, start);
+    return copy_page(&cursor, page, limit);
+}
@@ -3,7 +3,40 @@
 
 #include "../airline_types.h"
 
+// Deepest path a cursor can hold. An AVL tree of 2^31 flights is under 46 levels deep
+#define AVL_CURSOR_DEPTH 64
+
+// Position in an in-order walk of the AVL tree: the nodes still to be visited on the
+// path from the root, next flight on top
+typedef struct {
+    AVL_Node* path[AVL_CURSOR_DEPTH];
+    int depth;
+} AvlCursor;
+
 // Search for a flight by flight number in AVL tree
 Flight* avl_find_flight_by_number(AVL_Node* root, const char* flight_number);
 
+// Get the k-th flight in ID order (counting from 0), or NULL if there are not that many
+Flight* avl_select(AVL_Node* root, int k);
+
+// Get the number of flights with an ID below `id` (the rank of `id`)
+int avl_rank(AVL_Node* root, int id);
+
+// Count the flights with IDs in [low, high] in O(log n)
+int avl_count_range(AVL_Node* root, int low, int high);
+
+// Position a cursor at the first flight with an ID of at least `id`
+void avl_cursor_seek(AvlCursor* cursor, AVL_Node* root, int id);
+
+// Position a cursor at the k-th flight in ID order (counting from 0)
+void avl_cursor_seek_rank(AvlCursor* cursor, AVL_Node* root, int k);
+
+// Return the flight at the cursor and advance, or NULL at the end
+Flight* avl_cursor_next(AvlCursor* cursor);
+
+// Copy up to `limit` flights into `page` in ID order, starting after flight `after_id`
+// or at position `start`. O(log n + limit). Return the number copied
+int avl_list_flights_after(AVL_Node* root, int after_id, Flight* page, int limit);
+int avl_list_flights_from_rank(AVL_Node* root, int start, Flight* page, int limit);
+
 #endif
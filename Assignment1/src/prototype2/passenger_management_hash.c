@@ -12,6 +12,8 @@
 #include <string.h>
 #include <math.h>
 #include "passenger_management_hash.h"
+#include "bloom_filter.h"
+#include "../mem_stats.h"
 
 // Check if a number is prime
 static int is_prime(int n) {
@@ -59,7 +61,7 @@ PassengerHashTable* init_hash_table(int size) {
     size = find_next_prime(size);
     
     // Allocate the hash table structure
-    PassengerHashTable* table = (PassengerHashTable*)malloc(sizeof(PassengerHashTable));
+    PassengerHashTable* table = (PassengerHashTable*)mem_alloc(MEM_PASSENGER_HASH, sizeof(PassengerHashTable));
     if (table == NULL) {
         fprintf(stderr, "Memory allocation failed for hash table\n");
         return NULL;  // Return NULL instead of exit for better error handling
@@ -68,12 +70,13 @@ PassengerHashTable* init_hash_table(int size) {
     // Initialize table values
     table->size = size;
     table->count = 0;
+    table->filter = NULL;
     
     // Allocate the hash table entries with error handling
-    table->table = (HashEntry*)calloc(size, sizeof(HashEntry));
+    table->table = (HashEntry*)mem_calloc(MEM_PASSENGER_HASH, size, sizeof(HashEntry));
     if (table->table == NULL) {
         fprintf(stderr, "Memory allocation failed for hash table entries (requested size: %d)\n", size);
-        free(table);
+        mem_free(MEM_PASSENGER_HASH, table, sizeof(PassengerHashTable));
         return NULL;  // Return NULL instead of exit for better error handling
     }
     
@@ -89,6 +92,46 @@ int hash_function(int id, int table_size) {
     return id % table_size;
 }
 
+// Replace the table's Bloom filter with one sized for `expected` IDs holding every ID present.
+// Returns 1 on success; on failure the table keeps its old filter
+static int rebuild_passenger_filter(PassengerHashTable* table, long long expected, double fp_rate) {
+    BloomFilter* filter = bloom_create(expected, fp_rate);
+    if (filter == NULL) {
+        return 0;
+    }
+    for (int i = 0; i < table->size; i++) {
+        for (HashEntry* entry = &table->table[i]; entry != NULL; entry = entry->next) {
+            if (entry->occupied == 1) {
+                bloom_add(filter, (uint64_t)(uint32_t)entry->data.id);
+            }
+        }
+    }
+    bloom_free(table->filter);
+    table->filter = filter;
+    return 1;
+}
+
+// Add a newly inserted ID to the filter, rebuilding it twice as large once it is full
+static void filter_new_passenger(PassengerHashTable* table, int id) {
+    if (table->filter == NULL) {
+        return;
+    }
+    bloom_add(table->filter, (uint64_t)(uint32_t)id);
+    if (bloom_needs_rebuild(table->filter)) {
+        rebuild_passenger_filter(table, 2LL * table->count, table->filter->fp_rate);
+    }
+}
+
+// Put a Bloom filter in front of hash_find_passenger, sized for the table's capacity or the
+// passengers already in it (whichever is larger)
+int hash_enable_filter(PassengerHashTable* table, double fp_rate) {
+    if (table == NULL) {
+        return 0;
+    }
+    long long expected = table->count > table->size ? table->count : table->size;
+    return rebuild_passenger_filter(table, expected, fp_rate);
+}
+
 // Insert a passenger into the hash table
 void hash_insert_passenger(PassengerHashTable* table, Passenger passenger) {
     int index = hash_function(passenger.id, table->size);
@@ -98,6 +141,7 @@ void hash_insert_passenger(PassengerHashTable* table, Passenger passenger) {
         table->table[index].data = passenger;
         table->table[index].occupied = 1;
         table->count++;
+        filter_new_passenger(table, passenger.id);
         return;
     }
     
@@ -120,7 +164,7 @@ void hash_insert_passenger(PassengerHashTable* table, Passenger passenger) {
     }
     
     // Insert at the end of the chain
-    HashEntry* new_entry = (HashEntry*)malloc(sizeof(HashEntry));
+    HashEntry* new_entry = (HashEntry*)mem_alloc(MEM_PASSENGER_HASH_CHAINS, sizeof(HashEntry));
     if (new_entry == NULL) {
         fprintf(stderr, "Memory allocation failed for hash entry\n");
         return;
@@ -131,6 +175,7 @@ void hash_insert_passenger(PassengerHashTable* table, Passenger passenger) {
     new_entry->next = NULL;
     current->next = new_entry;
     table->count++;
+    filter_new_passenger(table, passenger.id);
 }
 
 // Find a passenger in the hash table
@@ -139,6 +184,11 @@ Passenger* hash_find_passenger(PassengerHashTable* table, int id) {
         return NULL;
     }
     
+    // An ID the filter has never seen costs one cache line instead of a bucket and chain
+    if (table->filter != NULL && !bloom_may_contain(table->filter, (uint64_t)(uint32_t)id)) {
+        return NULL;
+    }
+    
     int index = hash_function(id, table->size);
     
     // Check if the ID is in the main slot
@@ -159,6 +209,52 @@ Passenger* hash_find_passenger(PassengerHashTable* table, int id) {
     return NULL;
 }
 
+// Look up a batch of passenger IDs a group at a time. Every lookup in the group is advanced by
+// one entry per pass and the entry it needs next is prefetched, so the cache misses of the
+// group overlap instead of being paid one after another
+void hash_find_passenger_batch(PassengerHashTable* table, const int* ids, int count, Passenger** results) {
+    for (int base = 0; base < count; base += HASH_BATCH_GROUP) {
+        int group = count - base < HASH_BATCH_GROUP ? count - base : HASH_BATCH_GROUP;
+        HashEntry* cursor[HASH_BATCH_GROUP];
+        
+        // Hash every key of the group and prefetch its bucket (the ID and the chain link
+        // are on different cache lines)
+        for (int j = 0; j < group; j++) {
+            results[base + j] = NULL;
+            cursor[j] = table != NULL ? &table->table[hash_function(ids[base + j], table->size)] : NULL;
+            if (cursor[j] != NULL && table->filter != NULL &&
+                !bloom_may_contain(table->filter, (uint64_t)(uint32_t)ids[base + j])) {
+                cursor[j] = NULL;
+            }
+            if (cursor[j] != NULL) {
+                __builtin_prefetch(cursor[j]);
+                __builtin_prefetch(&cursor[j]->next);
+            }
+        }
+        
+        // Check one entry of every unfinished lookup per pass
+        int active = table != NULL ? group : 0;
+        while (active > 0) {
+            active = 0;
+            for (int j = 0; j < group; j++) {
+                HashEntry* entry = cursor[j];
+                if (entry == NULL) continue;
+                if (entry->occupied == 1 && entry->data.id == ids[base + j]) {
+                    results[base + j] = &entry->data;
+                    cursor[j] = NULL;
+                    continue;
+                }
+                cursor[j] = entry->next;
+                if (cursor[j] != NULL) {
+                    __builtin_prefetch(cursor[j]);
+                    __builtin_prefetch(&cursor[j]->next);
+                    active++;
+                }
+            }
+        }
+    }
+}
+
 // Print all passengers in the hash table
 void print_hash_passengers(PassengerHashTable* table) {
     if (table == NULL) {
@@ -201,11 +297,12 @@ void free_hash_table(PassengerHashTable* table) {
         while (current != NULL) {
             HashEntry* tmp = current;
             current = current->next;
-            free(tmp);
+            mem_free(MEM_PASSENGER_HASH_CHAINS, tmp, sizeof(HashEntry));
         }
     }
     
-    // Free the main table array and the table struct
-    free(table->table);
-    free(table);
+    // Free the filter, the main table array and the table struct
+    bloom_free(table->filter);
+    mem_free(MEM_PASSENGER_HASH, table->table, table->size * sizeof(HashEntry));
+    mem_free(MEM_PASSENGER_HASH, table, sizeof(PassengerHashTable));
 }
@@ -15,9 +15,21 @@ int hash_function(int id, int table_size);
 // Insert a passenger into the hash table
 void hash_insert_passenger(PassengerHashTable* table, Passenger passenger);
 
+// Put a Bloom filter with the given false-positive rate in front of hash_find_passenger, so
+// lookups of absent IDs usually cost one cache miss. The filter grows with the table (rebuilt
+// when full) and is freed with it. Calling again rebuilds it. Returns 1 on success
+int hash_enable_filter(PassengerHashTable* table, double fp_rate);
+
 // Find a passenger in the hash table
 Passenger* hash_find_passenger(PassengerHashTable* table, int id);
 
+// Lookups interleaved per group by hash_find_passenger_batch
+#define HASH_BATCH_GROUP 16
+
+// Find a batch of passengers: results[i] is the passenger with ids[i], or NULL. Much faster than
+// one hash_find_passenger call per ID when the table does not fit in cache
+void hash_find_passenger_batch(PassengerHashTable* table, const int* ids, int count, Passenger** results);
+
 // Print all passengers in the hash table
 void print_hash_passengers(PassengerHashTable* table);
 
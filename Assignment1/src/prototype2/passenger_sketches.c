@@ -0,0 +1,605 @@
+/*
+ * Distinct Passenger Sketches (Prototype 2)
+ *
+ * Counting distinct passengers exactly over a group of flights needs a set
+ * of every passenger seen, as print_flight_passengers_bst does with its
+ * tracking array. A HyperLogLog sketch estimates the same count with about
+ * 1% error in a fixed 16 KB, and two sketches merge by taking the larger of
+ * each register, so one sketch per flight answers any grouping of flights
+ * (an origin, a route, a day or week) by merging.
+ *
+ * Most flights have a few hundred passengers at most, so a flight's sketch
+ * starts sparse: a sorted list of only the registers that are set. It turns
+ * into the full register array once the list would grow past half its size.
+ * While sparse, the estimate is linear counting over the registers set,
+ * which is accurate at these sizes.
+ *
+ * Snapshot section layout (one byte blob): uint32 flight count, then per flight
+ *   int32 id, char origin[50], char destination[50], int64 departure,
+ *   int32 entry count (-1 for dense), then the uint32 entries or the 16384 registers
+ *
+ * Sources used:
+ * 1. "HyperLogLog: the analysis of a near-optimal cardinality estimation algorithm" by Flajolet et al. - Estimator
+ * 2. "HyperLogLog in Practice" by Heule, Nunkesser and Hall - Sparse representation and 64-bit hashing
+ * 3. The C Programming Language (K&R) - Binary file I/O
+ */
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "passenger_sketches.h"
+#include "../snapshot.h"
+#include "../mem_stats.h"
+
+//--- HYPERLOGLOG ---//
+
+// Mix a key into 64 well-distributed bits (the splitmix64 finalizer)
+static uint64_t sketch_hash(uint64_t key) {
+    key += 0x9E3779B97F4A7C15ULL;
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+    return key ^ (key >> 31);
+}
+
+// Start an empty sketch
+void hll_init(HyperLogLog* sketch) {
+    sketch->registers = NULL;
+    sketch->sparse = NULL;
+    sketch->sparse_count = 0;
+    sketch->sparse_capacity = 0;
+}
+
+// Switch a sketch to dense registers. Returns 1 on success
+static int hll_make_dense(HyperLogLog* sketch) {
+    if (sketch->registers != NULL) return 1;
+    sketch->registers = (uint8_t*)mem_calloc(MEM_PASSENGER_SKETCHES, HLL_REGISTERS, 1);
+    if (sketch->registers == NULL) {
+        fprintf(stderr, "Memory allocation failed for HyperLogLog registers\n");
+        return 0;
+    }
+    for (int i = 0; i < sketch->sparse_count; i++) {
+        sketch->registers[sketch->sparse[i] >> 8] = (uint8_t)(sketch->sparse[i] & 0xFF);
+    }
+    mem_free(MEM_PASSENGER_SKETCHES, sketch->sparse, sketch->sparse_capacity * sizeof(uint32_t));
+    sketch->sparse = NULL;
+    sketch->sparse_count = 0;
+    sketch->sparse_capacity = 0;
+    return 1;
+}
+
+// Raise one register to at least `rank`. Returns 1 on success
+static int hll_set(HyperLogLog* sketch, uint32_t index, uint8_t rank) {
+    if (sketch->registers != NULL) {
+        if (rank > sketch->registers[index]) sketch->registers[index] = rank;
+        return 1;
+    }
+    
+    // Binary search the sparse entries for the register
+    int low = 0;
+    int high = sketch->sparse_count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if ((sketch->sparse[mid] >> 8) < index) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low < sketch->sparse_count && (sketch->sparse[low] >> 8) == index) {
+        if (rank > (sketch->sparse[low] & 0xFF)) sketch->sparse[low] = index << 8 | rank;
+        return 1;
+    }
+    
+    if (sketch->sparse_count >= HLL_SPARSE_LIMIT) {
+        return hll_make_dense(sketch) && hll_set(sketch, index, rank);
+    }
+    if (sketch->sparse_count == sketch->sparse_capacity) {
+        int capacity = sketch->sparse_capacity > 0 ? sketch->sparse_capacity * 2 : 4;
+        uint32_t* grown = (uint32_t*)mem_realloc(MEM_PASSENGER_SKETCHES, sketch->sparse,
+                                                 sketch->sparse_capacity * sizeof(uint32_t),
+                                                 capacity * sizeof(uint32_t));
+        if (grown == NULL) {
+            fprintf(stderr, "Memory allocation failed for HyperLogLog entries\n");
+            return 0;
+        }
+        sketch->sparse = grown;
+        sketch->sparse_capacity = capacity;
+    }
+    memmove(sketch->sparse + low + 1, sketch->sparse + low, (sketch->sparse_count - low) * sizeof(uint32_t));
+    sketch->sparse[low] = index << 8 | rank;
+    sketch->sparse_count++;
+    return 1;
+}
+
+// Add a key: the top bits of its hash pick a register, and the register keeps the longest run
+// of leading zeros seen in the remaining bits
+int hll_add(HyperLogLog* sketch, uint64_t key) {
+    uint64_t hash = sketch_hash(key);
+    uint32_t index = (uint32_t)(hash >> (64 - HLL_PRECISION));
+    uint64_t rest = (hash << HLL_PRECISION) | (1ULL << (HLL_PRECISION - 1));
+    return hll_set(sketch, index, (uint8_t)(__builtin_clzll(rest) + 1));
+}
+
+// Merge one sketch into another, register by register
+int hll_merge(HyperLogLog* into, const HyperLogLog* from) {
+    if (!hll_make_dense(into)) {
+        return 0;
+    }
+    if (from->registers != NULL) {
+        for (int i = 0; i < HLL_REGISTERS; i++) {
+            if (from->registers[i] > into->registers[i]) into->registers[i] = from->registers[i];
+        }
+    } else {
+        for (int i = 0; i < from->sparse_count; i++) {
+            uint32_t index = from->sparse[i] >> 8;
+            uint8_t rank = (uint8_t)(from->sparse[i] & 0xFF);
+            if (rank > into->registers[index]) into->registers[index] = rank;
+        }
+    }
+    return 1;
+}
+
+// Estimated number of distinct keys: linear counting while few registers are set,
+// the harmonic-mean estimator above that
+double hll_estimate(const HyperLogLog* sketch) {
+    double m = HLL_REGISTERS;
+    if (sketch->registers == NULL) {
+        return m * log(m / (m - sketch->sparse_count));
+    }
+    
+    double sum = 0.0;
+    int zeros = 0;
+    for (int i = 0; i < HLL_REGISTERS; i++) {
+        sum += ldexp(1.0, -sketch->registers[i]);
+        zeros += sketch->registers[i] == 0;
+    }
+    double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * log(m / zeros);
+    }
+    return estimate;
+}
+
+// Empty a sketch, keeping its memory
+void hll_clear(HyperLogLog* sketch) {
+    if (sketch->registers != NULL) {
+        memset(sketch->registers, 0, HLL_REGISTERS);
+    }
+    sketch->sparse_count = 0;
+}
+
+// Free a sketch's memory
+void hll_free(HyperLogLog* sketch) {
+    if (sketch->registers != NULL) {
+        mem_free(MEM_PASSENGER_SKETCHES, sketch->registers, HLL_REGISTERS);
+    }
+    if (sketch->sparse != NULL) {
+        mem_free(MEM_PASSENGER_SKETCHES, sketch->sparse, sketch->sparse_capacity * sizeof(uint32_t));
+    }
+    hll_init(sketch);
+}
+
+//--- PER-FLIGHT INDEX ---//
+
+// Binary search for a flight. Returns its position, or where it would be inserted
+static int find_position(const PassengerSketchIndex* index, int flightId, int* found) {
+    int low = 0;
+    int high = index->count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (index->flights[mid].flightId < flightId) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    *found = low < index->count && index->flights[low].flightId == flightId;
+    return low;
+}
+
+// Make room for at least `needed` flights. Returns 1 on success
+static int reserve_flights(PassengerSketchIndex* index, int needed) {
+    if (needed <= index->capacity) return 1;
+    int capacity = index->capacity > 0 ? index->capacity : 64;
+    while (capacity < needed) capacity *= 2;
+    FlightSketch* grown = (FlightSketch*)mem_realloc(MEM_PASSENGER_SKETCHES, index->flights,
+                                                     index->capacity * sizeof(FlightSketch),
+                                                     capacity * sizeof(FlightSketch));
+    if (grown == NULL) {
+        fprintf(stderr, "Memory allocation failed for flight sketches\n");
+        return 0;
+    }
+    index->flights = grown;
+    index->capacity = capacity;
+    return 1;
+}
+
+// Fill in a flight's sketch entry
+static void init_flight_sketch(FlightSketch* sketch, const Flight* flight) {
+    sketch->flightId = flight->id;
+    memcpy(sketch->origin, flight->origin, sizeof(sketch->origin));
+    memcpy(sketch->destination, flight->destination, sizeof(sketch->destination));
+    sketch->origin[sizeof(sketch->origin) - 1] = '\0';
+    sketch->destination[sizeof(sketch->destination) - 1] = '\0';
+    sketch->departureTime = flight->departureTime;
+    hll_init(&sketch->passengers);
+}
+
+// Create an empty index
+PassengerSketchIndex* sketch_index_create() {
+    PassengerSketchIndex* index = (PassengerSketchIndex*)calloc(1, sizeof(PassengerSketchIndex));
+    if (index == NULL) {
+        fprintf(stderr, "Memory allocation failed for passenger sketch index\n");
+    }
+    return index;
+}
+
+// Sort flights by ID for the bulk build
+static int compare_sketch_ids(const void* a, const void* b) {
+    int left = ((const FlightSketch*)a)->flightId;
+    int right = ((const FlightSketch*)b)->flightId;
+    return (left > right) - (left < right);
+}
+
+// Build an index in one pass: append every flight, sort once, then count the reservations
+PassengerSketchIndex* sketch_index_build(const Flight* flights, int flight_count,
+                                         const ReservationRecord* reservations, int reservation_count) {
+    PassengerSketchIndex* index = sketch_index_create();
+    if (index == NULL) {
+        return NULL;
+    }
+    if (!reserve_flights(index, flight_count)) {
+        sketch_index_free(index);
+        return NULL;
+    }
+    for (int i = 0; i < flight_count; i++) {
+        init_flight_sketch(&index->flights[i], &flights[i]);
+    }
+    qsort(index->flights, flight_count, sizeof(FlightSketch), compare_sketch_ids);
+    
+    // Keep the first of any duplicate IDs
+    for (int i = 0; i < flight_count; i++) {
+        if (index->count == 0 || index->flights[index->count - 1].flightId != index->flights[i].flightId) {
+            index->flights[index->count++] = index->flights[i];
+        }
+    }
+    
+    for (int i = 0; i < reservation_count; i++) {
+        FlightSketch* sketch = sketch_index_find(index, reservations[i].flightId);
+        if (sketch != NULL && !hll_add(&sketch->passengers, (uint64_t)(uint32_t)reservations[i].passengerId)) {
+            sketch_index_free(index);
+            return NULL;
+        }
+    }
+    return index;
+}
+
+// Add a flight with an empty sketch, keeping the flights sorted by ID
+int sketch_index_add_flight(PassengerSketchIndex* index, const Flight* flight) {
+    int found;
+    int position = find_position(index, flight->id, &found);
+    if (found) return 1;
+    if (!reserve_flights(index, index->count + 1)) return 0;
+    
+    memmove(index->flights + position + 1, index->flights + position,
+            (index->count - position) * sizeof(FlightSketch));
+    init_flight_sketch(&index->flights[position], flight);
+    index->count++;
+    index->orders_valid = 0;
+    return 1;
+}
+
+// Count a reservation's passenger on its flight
+int sketch_index_add_reservation(PassengerSketchIndex* index, int flightId, int passengerId) {
+    FlightSketch* sketch = sketch_index_find(index, flightId);
+    if (sketch == NULL) {
+        return 0;
+    }
+    return hll_add(&sketch->passengers, (uint64_t)(uint32_t)passengerId);
+}
+
+// Drop a cancelled flight's sketch
+int sketch_index_remove_flight(PassengerSketchIndex* index, int flightId) {
+    int found;
+    int position = find_position(index, flightId, &found);
+    if (!found) return 0;
+    
+    hll_free(&index->flights[position].passengers);
+    memmove(index->flights + position, index->flights + position + 1,
+            (index->count - position - 1) * sizeof(FlightSketch));
+    index->count--;
+    index->orders_valid = 0;
+    return 1;
+}
+
+// Find a flight's sketch
+FlightSketch* sketch_index_find(PassengerSketchIndex* index, int flightId) {
+    int found;
+    int position = find_position(index, flightId, &found);
+    return found ? &index->flights[position] : NULL;
+}
+
+// Order by origin, then departure
+static int compare_origin_order(const void* a, const void* b) {
+    const SketchOrder* left = (const SketchOrder*)a;
+    const SketchOrder* right = (const SketchOrder*)b;
+    int cmp = strcmp(left->origin, right->origin);
+    if (cmp != 0) return cmp;
+    return (left->departureTime > right->departureTime) - (left->departureTime < right->departureTime);
+}
+
+// Order by departure
+static int compare_departure_order(const void* a, const void* b) {
+    const SketchOrder* left = (const SketchOrder*)a;
+    const SketchOrder* right = (const SketchOrder*)b;
+    return (left->departureTime > right->departureTime) - (left->departureTime < right->departureTime);
+}
+
+// Rebuild both query orders after flights were added or removed. Returns 1 on success
+static int rebuild_orders(PassengerSketchIndex* index) {
+    free(index->by_origin);
+    free(index->by_departure);
+    index->by_origin = (SketchOrder*)malloc((index->count + 1) * sizeof(SketchOrder));
+    index->by_departure = (SketchOrder*)malloc((index->count + 1) * sizeof(SketchOrder));
+    if (index->by_origin == NULL || index->by_departure == NULL) {
+        fprintf(stderr, "Memory allocation failed for sketch query orders\n");
+        free(index->by_origin);
+        free(index->by_departure);
+        index->by_origin = NULL;
+        index->by_departure = NULL;
+        return 0;
+    }
+    for (int i = 0; i < index->count; i++) {
+        SketchOrder order = {index->flights[i].origin, index->flights[i].departureTime, i};
+        index->by_origin[i] = order;
+        index->by_departure[i] = order;
+    }
+    qsort(index->by_origin, index->count, sizeof(SketchOrder), compare_origin_order);
+    qsort(index->by_departure, index->count, sizeof(SketchOrder), compare_departure_order);
+    index->orders_valid = 1;
+    return 1;
+}
+
+// First position in an order at or after `key`
+static int lower_bound(const SketchOrder* order, int count, const SketchOrder* key,
+                       int (*compare)(const void*, const void*)) {
+    int low = 0;
+    int high = count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (compare(&order[mid], key) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Merge the selected flights' sketches. With an origin only that origin's flights in the window
+// are visited; without one, only the flights in the window
+int sketch_index_merge(PassengerSketchIndex* index, const char* origin, const char* destination,
+                       time_t from, time_t to, HyperLogLog* out) {
+    if (!index->orders_valid && !rebuild_orders(index)) {
+        return -1;
+    }
+    int by_origin = origin != NULL && origin[0] != '\0';
+    const SketchOrder* order = by_origin ? index->by_origin : index->by_departure;
+    SketchOrder key = {by_origin ? origin : "", from, 0};
+    int position = lower_bound(order, index->count, &key,
+                               by_origin ? compare_origin_order : compare_departure_order);
+    
+    int merged = 0;
+    for (; position < index->count; position++) {
+        if (by_origin && strcmp(order[position].origin, origin) != 0) break;
+        if (order[position].departureTime >= to) break;
+        
+        const FlightSketch* sketch = &index->flights[order[position].position];
+        if (destination != NULL && destination[0] != '\0' && strcmp(sketch->destination, destination) != 0) {
+            continue;
+        }
+        if (!hll_merge(out, &sketch->passengers)) {
+            return -1;
+        }
+        merged++;
+    }
+    return merged;
+}
+
+// Estimated distinct passengers on the selected flights
+double sketch_distinct_passengers(PassengerSketchIndex* index, const char* origin, const char* destination,
+                                  time_t from, time_t to) {
+    HyperLogLog total;
+    hll_init(&total);
+    if (!hll_make_dense(&total) || sketch_index_merge(index, origin, destination, from, to, &total) < 0) {
+        hll_free(&total);
+        return -1.0;
+    }
+    double estimate = hll_estimate(&total);
+    hll_free(&total);
+    return estimate;
+}
+
+//--- SNAPSHOTS ---//
+
+// Size of one flight's record in the snapshot blob
+static size_t sketch_record_size(const FlightSketch* sketch) {
+    size_t size = sizeof(int32_t) + sizeof(sketch->origin) + sizeof(sketch->destination) + sizeof(int64_t) +
+                  sizeof(int32_t);
+    if (sketch->passengers.registers != NULL) {
+        return size + HLL_REGISTERS;
+    }
+    return size + sketch->passengers.sparse_count * sizeof(uint32_t);
+}
+
+// Append bytes to the blob being written
+static void put_bytes(char** cursor, const void* data, size_t size) {
+    memcpy(*cursor, data, size);
+    *cursor += size;
+}
+
+// Save a dataset snapshot with the sketches as a fourth section
+int sketch_index_save_snapshot(const PassengerSketchIndex* index,
+                               const Flight* flights, int flight_count,
+                               const Passenger* passengers, int passenger_count,
+                               const ReservationRecord* reservations, int reservation_count,
+                               const char* path) {
+    size_t bytes = sizeof(uint32_t);
+    for (int i = 0; i < index->count; i++) {
+        bytes += sketch_record_size(&index->flights[i]);
+    }
+    char* blob = (char*)malloc(bytes);
+    if (blob == NULL) {
+        fprintf(stderr, "Memory allocation failed for sketch snapshot (%zu bytes)\n", bytes);
+        return 0;
+    }
+    
+    char* cursor = blob;
+    uint32_t count = (uint32_t)index->count;
+    put_bytes(&cursor, &count, sizeof(count));
+    for (int i = 0; i < index->count; i++) {
+        const FlightSketch* sketch = &index->flights[i];
+        int32_t id = sketch->flightId;
+        int64_t departure = (int64_t)sketch->departureTime;
+        int32_t entries = sketch->passengers.registers != NULL ? -1 : sketch->passengers.sparse_count;
+        put_bytes(&cursor, &id, sizeof(id));
+        put_bytes(&cursor, sketch->origin, sizeof(sketch->origin));
+        put_bytes(&cursor, sketch->destination, sizeof(sketch->destination));
+        put_bytes(&cursor, &departure, sizeof(departure));
+        put_bytes(&cursor, &entries, sizeof(entries));
+        if (entries < 0) {
+            put_bytes(&cursor, sketch->passengers.registers, HLL_REGISTERS);
+        } else {
+            put_bytes(&cursor, sketch->passengers.sparse, entries * sizeof(uint32_t));
+        }
+    }
+    
+    FILE* file = snapshot_create(path, 4);
+    int ok = file != NULL &&
+             snapshot_write_section(file, SNAPSHOT_SECTION_FLIGHTS, sizeof(Flight), flights, flight_count) &&
+             snapshot_write_section(file, SNAPSHOT_SECTION_PASSENGERS, sizeof(Passenger), passengers, passenger_count) &&
+             snapshot_write_section(file, SNAPSHOT_SECTION_RESERVATIONS, sizeof(ReservationRecord),
+                                    reservations, reservation_count) &&
+             snapshot_write_section(file, SNAPSHOT_SECTION_PASSENGER_SKETCHES, 1, blob, bytes);
+    if (file != NULL && fclose(file) != 0) {
+        ok = 0;
+    }
+    if (!ok) {
+        fprintf(stderr, "Error writing snapshot %s\n", path);
+    }
+    free(blob);
+    return ok;
+}
+
+// Read bytes from the blob being decoded. Returns 0 if it is too short
+static int get_bytes(const char** cursor, const char* end, void* data, size_t size) {
+    if ((size_t)(end - *cursor) < size) return 0;
+    memcpy(data, *cursor, size);
+    *cursor += size;
+    return 1;
+}
+
+// Decode the sketch blob into a new index. Returns NULL if it is malformed
+static PassengerSketchIndex* decode_sketches(const char* blob, size_t bytes) {
+    const char* cursor = blob;
+    const char* end = blob + bytes;
+    uint32_t count;
+    PassengerSketchIndex* index = sketch_index_create();
+    size_t smallest_record = sizeof(int32_t) * 2 + sizeof(index->flights[0].origin) * 2 + sizeof(int64_t);
+    if (index == NULL || !get_bytes(&cursor, end, &count, sizeof(count)) || count > bytes / smallest_record ||
+        !reserve_flights(index, (int)count)) {
+        sketch_index_free(index);
+        return NULL;
+    }
+    
+    int ok = 1;
+    for (uint32_t i = 0; i < count && ok; i++) {
+        FlightSketch* sketch = &index->flights[index->count];
+        int32_t id;
+        int64_t departure;
+        int32_t entries;
+        hll_init(&sketch->passengers);
+        ok = get_bytes(&cursor, end, &id, sizeof(id)) &&
+             get_bytes(&cursor, end, sketch->origin, sizeof(sketch->origin)) &&
+             get_bytes(&cursor, end, sketch->destination, sizeof(sketch->destination)) &&
+             get_bytes(&cursor, end, &departure, sizeof(departure)) &&
+             get_bytes(&cursor, end, &entries, sizeof(entries)) &&
+             entries >= -1 && entries <= HLL_SPARSE_LIMIT &&
+             (index->count == 0 || index->flights[index->count - 1].flightId < id);
+        if (!ok) break;
+        sketch->flightId = id;
+        sketch->departureTime = (time_t)departure;
+        sketch->origin[sizeof(sketch->origin) - 1] = '\0';
+        sketch->destination[sizeof(sketch->destination) - 1] = '\0';
+        index->count++;
+        
+        if (entries < 0) {
+            ok = hll_make_dense(&sketch->passengers) &&
+                 get_bytes(&cursor, end, sketch->passengers.registers, HLL_REGISTERS);
+        } else if (entries > 0) {
+            sketch->passengers.sparse = (uint32_t*)mem_alloc(MEM_PASSENGER_SKETCHES, entries * sizeof(uint32_t));
+            ok = sketch->passengers.sparse != NULL;
+            if (ok) {
+                sketch->passengers.sparse_capacity = entries;
+                sketch->passengers.sparse_count = entries;
+                ok = get_bytes(&cursor, end, sketch->passengers.sparse, entries * sizeof(uint32_t));
+            }
+        }
+    }
+    if (!ok) {
+        fprintf(stderr, "Passenger sketch section is malformed\n");
+        sketch_index_free(index);
+        return NULL;
+    }
+    return index;
+}
+
+// Read the sketches saved in a snapshot
+PassengerSketchIndex* sketch_index_load_snapshot(const char* path) {
+    int section_count;
+    FILE* file = snapshot_open(path, &section_count);
+    if (file == NULL) {
+        return NULL;
+    }
+    
+    PassengerSketchIndex* index = NULL;
+    for (int i = 0; i < section_count; i++) {
+        SnapshotSectionHeader header;
+        if (!snapshot_read_section_header(file, &header)) break;
+        if (header.type != SNAPSHOT_SECTION_PASSENGER_SKETCHES || header.record_size != 1) {
+            if (!snapshot_skip_section(file, &header)) break;
+            continue;
+        }
+        char* blob = (char*)snapshot_read_section(file, &header);
+        if (blob != NULL) {
+            index = decode_sketches(blob, (size_t)header.count);
+            free(blob);
+        }
+        break;
+    }
+    fclose(file);
+    
+    if (index == NULL) {
+        fprintf(stderr, "Snapshot %s has no passenger sketches\n", path);
+    }
+    return index;
+}
+
+// Free the index
+void sketch_index_free(PassengerSketchIndex* index) {
+    if (index == NULL) {
+        return;
+    }
+    for (int i = 0; i < index->count; i++) {
+        hll_free(&index->flights[i].passengers);
+    }
+    if (index->flights != NULL) {
+        mem_free(MEM_PASSENGER_SKETCHES, index->flights, index->capacity * sizeof(FlightSketch));
+    }
+    free(index->by_origin);
+    free(index->by_departure);
+    free(index);
+}
@@ -0,0 +1,114 @@
+#ifndef PASSENGER_SKETCHES_H
+#define PASSENGER_SKETCHES_H
+
+#include <stdint.h>
+#include <time.h>
+#include "../airline_types.h"
+
+// HyperLogLog precision: 2^14 registers give a standard error of 1.04 / 128, about 0.8%
+#define HLL_PRECISION 14
+#define HLL_REGISTERS (1 << HLL_PRECISION)
+
+// A sparse sketch switches to dense registers past this many entries (4 bytes each)
+#define HLL_SPARSE_LIMIT 2048
+
+// Snapshot section holding the per-flight sketches (a byte blob, see passenger_sketches.c)
+#define SNAPSHOT_SECTION_PASSENGER_SKETCHES 4
+
+// HyperLogLog sketch of distinct passenger IDs. Small sketches keep a sorted list of
+// (register, rank) entries; larger ones a full array of 8-bit registers
+typedef struct {
+    uint8_t* registers;   // HLL_REGISTERS registers once dense, NULL while sparse
+    uint32_t* sparse;     // Entries (register << 8 | rank) sorted by register, while sparse
+    int sparse_count;
+    int sparse_capacity;
+} HyperLogLog;
+
+// The passengers booked on one flight, with what a grouping needs to know about the flight
+typedef struct {
+    int flightId;
+    char origin[50];
+    char destination[50];
+    time_t departureTime;
+    HyperLogLog passengers;
+} FlightSketch;
+
+// Position of a flight in a query order
+typedef struct {
+    const char* origin;
+    time_t departureTime;
+    int position;
+} SketchOrder;
+
+// Per-flight passenger sketches, mergeable by origin, route and departure window
+typedef struct {
+    FlightSketch* flights;     // Sorted by flight ID
+    int count;
+    int capacity;
+    SketchOrder* by_origin;    // Sorted by origin, then departure
+    SketchOrder* by_departure; // Sorted by departure
+    int orders_valid;          // The orders match the flights (rebuilt by the next query if not)
+} PassengerSketchIndex;
+
+// Start an empty sketch
+void hll_init(HyperLogLog* sketch);
+
+// Add a key. Returns 1 on success, 0 if memory ran out
+int hll_add(HyperLogLog* sketch, uint64_t key);
+
+// Merge `from` into `into` (into becomes dense). Returns 1 on success
+int hll_merge(HyperLogLog* into, const HyperLogLog* from);
+
+// Estimated number of distinct keys added
+double hll_estimate(const HyperLogLog* sketch);
+
+// Empty a sketch, keeping its memory
+void hll_clear(HyperLogLog* sketch);
+
+// Free a sketch's memory
+void hll_free(HyperLogLog* sketch);
+
+// Create an empty index. Returns NULL on failure
+PassengerSketchIndex* sketch_index_create();
+
+// Build an index from a dataset in one pass. Returns NULL on failure
+PassengerSketchIndex* sketch_index_build(const Flight* flights, int flight_count,
+                                         const ReservationRecord* reservations, int reservation_count);
+
+// Add a flight with an empty sketch (a flight already present keeps its sketch).
+// Returns 1 on success
+int sketch_index_add_flight(PassengerSketchIndex* index, const Flight* flight);
+
+// Count a reservation's passenger on its flight. Returns 1 on success, 0 if the flight is unknown
+int sketch_index_add_reservation(PassengerSketchIndex* index, int flightId, int passengerId);
+
+// Drop a cancelled flight's sketch. Returns 1 if the flight was present
+int sketch_index_remove_flight(PassengerSketchIndex* index, int flightId);
+
+// Find a flight's sketch, or NULL
+FlightSketch* sketch_index_find(PassengerSketchIndex* index, int flightId);
+
+// Merge the sketches of the flights from `origin` to `destination` (NULL or "" for any) departing
+// in [from, to) into `out`. Returns the number of flights merged, or -1 on failure
+int sketch_index_merge(PassengerSketchIndex* index, const char* origin, const char* destination,
+                       time_t from, time_t to, HyperLogLog* out);
+
+// Estimated distinct passengers on the flights selected as in sketch_index_merge, or -1 on failure
+double sketch_distinct_passengers(PassengerSketchIndex* index, const char* origin, const char* destination,
+                                  time_t from, time_t to);
+
+// Save a dataset snapshot (as save_data_to_snapshot) with the sketches as an extra section.
+// Returns 1 on success
+int sketch_index_save_snapshot(const PassengerSketchIndex* index,
+                               const Flight* flights, int flight_count,
+                               const Passenger* passengers, int passenger_count,
+                               const ReservationRecord* reservations, int reservation_count,
+                               const char* path);
+
+// Read the sketches saved in a snapshot. Returns NULL if there are none or on failure
+PassengerSketchIndex* sketch_index_load_snapshot(const char* path);
+
+// Free the index
+void sketch_index_free(PassengerSketchIndex* index);
+
+#endif
@@ -12,6 +12,9 @@
 #include <string.h>
 #include <time.h>
 #include "reservation_management_bst.h"
+#include "bloom_filter.h"
+#include "flight_load_index.h"
+#include "../mem_stats.h"
 
 // Format date to a readable string
 static char* format_reservation_date(time_t timestamp) {
@@ -23,7 +26,7 @@ static char* format_reservation_date(time_t timestamp) {
 
 // Initialize reservation BST with improved memory handling for large datasets
 ReservationBST* init_reservation_bst() {
-    ReservationBST* bst = (ReservationBST*)malloc(sizeof(ReservationBST));
+    ReservationBST* bst = (ReservationBST*)mem_alloc(MEM_RESERVATION_BST, sizeof(ReservationBST));
     if (bst == NULL) {
         fprintf(stderr, "Memory allocation failed for reservation BST\n");
         return NULL;  // Return NULL instead of exit for better error handling
@@ -43,13 +46,15 @@ ReservationBST* init_reservation_bst() {
     bst->passenger_index.max_passenger_id = 0;
     
     bst->index_enabled = 0;
+    bst->pair_filter = NULL;
+    bst->load_index = NULL;
     
     return bst;
 }
 
 // Create a new reservation BST node
 static ReservationBST_Node* create_reservation_node(ReservationRecord record) {
-    ReservationBST_Node* node = (ReservationBST_Node*)malloc(sizeof(ReservationBST_Node));
+    ReservationBST_Node* node = (ReservationBST_Node*)mem_alloc(MEM_RESERVATION_BST, sizeof(ReservationBST_Node));
     if (node == NULL) {
         fprintf(stderr, "Memory allocation failed for reservation BST node\n");
         exit(1);
@@ -62,12 +67,153 @@ static ReservationBST_Node* create_reservation_node(ReservationRecord record) {
     return node;
 }
 
+// Replace the BST's pair filter with one sized for `expected` pairs holding every pair present.
+// Returns 1 on success; on failure the BST keeps its old filter
+static int rebuild_pair_filter(ReservationBST* bst, long long expected, double fp_rate) {
+    BloomFilter* filter = bloom_create(expected, fp_rate);
+    if (filter == NULL) {
+        return 0;
+    }
+    
+    // Pre-order walk with an explicit stack, since the tree can be deep
+    int capacity = 64;
+    int top = 0;
+    ReservationBST_Node** stack = (ReservationBST_Node**)malloc(capacity * sizeof(ReservationBST_Node*));
+    if (stack == NULL) {
+        fprintf(stderr, "Memory allocation failed for pair filter rebuild\n");
+        bloom_free(filter);
+        return 0;
+    }
+    if (bst->root != NULL) stack[top++] = bst->root;
+    while (top > 0) {
+        ReservationBST_Node* node = stack[--top];
+        bloom_add(filter, bloom_pair_key(node->data.flightId, node->data.passengerId));
+        if (top + 2 > capacity) {
+            capacity *= 2;
+            ReservationBST_Node** grown = (ReservationBST_Node**)realloc(stack, capacity * sizeof(ReservationBST_Node*));
+            if (grown == NULL) {
+                fprintf(stderr, "Memory allocation failed for pair filter rebuild\n");
+                free(stack);
+                bloom_free(filter);
+                return 0;
+            }
+            stack = grown;
+        }
+        if (node->left != NULL) stack[top++] = node->left;
+        if (node->right != NULL) stack[top++] = node->right;
+    }
+    free(stack);
+    
+    bloom_free(bst->pair_filter);
+    bst->pair_filter = filter;
+    return 1;
+}
+
+// Put a Bloom filter of (flight, passenger) pairs in front of has_reservation_bst, sized for
+// `expected` reservations or the ones already in the BST (whichever is larger)
+int reservation_bst_enable_filter(ReservationBST* bst, long long expected, double fp_rate) {
+    if (bst == NULL) {
+        return 0;
+    }
+    return rebuild_pair_filter(bst, bst->count > expected ? bst->count : expected, fp_rate);
+}
+
+// Count the reservations on each flight of an array sorted by ID into counts (reservations on
+// other flights are ignored). Returns 1 on success
+static int count_by_flight(ReservationBST* bst, const Flight* flights, int flight_count, int* counts) {
+    // Pre-order walk with an explicit stack, since the tree can be deep
+    int capacity = 64;
+    int top = 0;
+    ReservationBST_Node** stack = (ReservationBST_Node**)malloc(capacity * sizeof(ReservationBST_Node*));
+    if (stack == NULL) {
+        return 0;
+    }
+    if (bst->root != NULL) stack[top++] = bst->root;
+    while (top > 0) {
+        ReservationBST_Node* node = stack[--top];
+        int low = 0;
+        int high = flight_count - 1;
+        while (low <= high) {
+            int middle = low + (high - low) / 2;
+            if (flights[middle].id == node->data.flightId) {
+                counts[middle]++;
+                break;
+            }
+            if (flights[middle].id < node->data.flightId) low = middle + 1;
+            else high = middle - 1;
+        }
+        if (top + 2 > capacity) {
+            capacity *= 2;
+            ReservationBST_Node** grown = (ReservationBST_Node**)realloc(stack, capacity * sizeof(ReservationBST_Node*));
+            if (grown == NULL) {
+                free(stack);
+                return 0;
+            }
+            stack = grown;
+        }
+        if (node->left != NULL) stack[top++] = node->left;
+        if (node->right != NULL) stack[top++] = node->right;
+    }
+    free(stack);
+    return 1;
+}
+
+// Copy the flights of an AVL subtree in ID order
+static void copy_flights_in_order(AVL_Node* node, Flight* flights, int* count) {
+    if (node == NULL) {
+        return;
+    }
+    copy_flights_in_order(node->left, flights, count);
+    flights[(*count)++] = node->data;
+    copy_flights_in_order(node->right, flights, count);
+}
+
+// Keep the flights in load-factor order from now on, counting the reservations already present
+int reservation_bst_enable_load_index(ReservationBST* bst, AVL_Node* flights_root) {
+    if (bst == NULL) {
+        return 0;
+    }
+    int flight_count = avl_size(flights_root);
+    Flight* flights = (Flight*)malloc((flight_count + 1) * sizeof(Flight));
+    int* counts = (int*)calloc(flight_count + 1, sizeof(int));
+    int count = 0;
+    if (flights == NULL || counts == NULL) {
+        fprintf(stderr, "Memory allocation failed for flight load index\n");
+        free(flights);
+        free(counts);
+        return 0;
+    }
+    copy_flights_in_order(flights_root, flights, &count);
+    FlightLoadIndex* index = count_by_flight(bst, flights, count, counts) ? load_index_build(flights, counts, count) : NULL;
+    free(flights);
+    free(counts);
+    if (index == NULL) {
+        return 0;
+    }
+    load_index_free(bst->load_index);
+    bst->load_index = index;
+    return 1;
+}
+
+// Add a newly booked pair to the filter, rebuilding it twice as large once it is full
+static void filter_new_pair(ReservationBST* bst, ReservationRecord record) {
+    if (bst->pair_filter == NULL) {
+        return;
+    }
+    bloom_add(bst->pair_filter, bloom_pair_key(record.flightId, record.passengerId));
+    if (bloom_needs_rebuild(bst->pair_filter)) {
+        rebuild_pair_filter(bst, 2LL * bst->count, bst->pair_filter->fp_rate);
+    }
+}
+
 // Add a reservation record to the BST
 void add_reservation_bst(ReservationBST* bst, ReservationRecord record) {
     // Use an iterative approach to prevent stack overflow with large datasets
     if (bst->root == NULL) {
         bst->root = create_reservation_node(record);
         bst->count++;
+        filter_new_pair(bst, record);
+        load_index_adjust(bst->load_index, record.flightId, 1);
         return;
     }
     
@@ -126,6 +272,8 @@ void add_reservation_bst(ReservationBST* bst, ReservationRecord record) {
     }
     
     bst->count++;
+    filter_new_pair(bst, record);
+    load_index_adjust(bst->load_index, record.flightId, 1);
 }
 
 // Find reservations by flight ID (iterative implementation to avoid stack overflow)
@@ -434,12 +582,461 @@ int count_flights_by_passenger(ReservationBST* bst, int passengerId) {
     return count;
 }
 
+// Compare a (flight, passenger) key with a node, ignoring the seat
+static int compare_flight_passenger(int flightId, int passengerId, const ReservationRecord* data) {
+    if (flightId != data->flightId) {
+        return flightId < data->flightId ? -1 : 1;
+    }
+    if (passengerId != data->passengerId) {
+        return passengerId < data->passengerId ? -1 : 1;
+    }
+    return 0;
+}
+
+// Copy the records of matching nodes into a caller-owned array, growing it as needed.
+// Returns the number copied, or -1 on failure
+static int copy_results(ReservationBST_Node** results, int count, ReservationRecord** records, int* capacity) {
+    if (count > *capacity) {
+        ReservationRecord* grown = (ReservationRecord*)realloc(*records, count * sizeof(ReservationRecord));
+        if (grown == NULL) {
+            fprintf(stderr, "Memory allocation failed when collecting reservations\n");
+            return -1;
+        }
+        *records = grown;
+        *capacity = count;
+    }
+    for (int i = 0; i < count; i++) {
+        (*records)[i] = results[i]->data;
+    }
+    return count;
+}
+
+// Copy every reservation of a passenger into *records (grown as needed)
+int find_reservations_by_passenger_bst(ReservationBST* bst, int passengerId, ReservationRecord** records, int* capacity) {
+    if (bst == NULL || bst->root == NULL) return 0;
+    
+    int result_capacity = 32;
+    int count = 0;
+    ReservationBST_Node** results = (ReservationBST_Node**)malloc(result_capacity * sizeof(ReservationBST_Node*));
+    if (results == NULL) {
+        fprintf(stderr, "Memory allocation failed for results array\n");
+        return -1;
+    }
+    
+    find_by_passenger_id_iterative(bst->root, passengerId, &results, &count, &result_capacity);
+    count = copy_results(results, count, records, capacity);
+    free(results);
+    return count;
+}
+
+// Copy every reservation on a flight into *records (grown as needed)
+int find_reservations_by_flight_bst(ReservationBST* bst, int flightId, ReservationRecord** records, int* capacity) {
+    if (bst == NULL || bst->root == NULL) return 0;
+    
+    int result_capacity = 32;
+    int count = 0;
+    ReservationBST_Node** results = (ReservationBST_Node**)malloc(result_capacity * sizeof(ReservationBST_Node*));
+    if (results == NULL) {
+        fprintf(stderr, "Memory allocation failed for results array\n");
+        return -1;
+    }
+    
+    find_by_flight_id_iterative(bst->root, flightId, &results, &count, &result_capacity);
+    count = copy_results(results, count, records, capacity);
+    free(results);
+    return count;
+}
+
+// Check whether a passenger holds any reservation on a flight
+int has_reservation_bst(ReservationBST* bst, int flightId, int passengerId) {
+    if (bst == NULL) {
+        return 0;
+    }
+    
+    // A pair that was never booked usually stops at the filter's single cache line
+    if (bst->pair_filter != NULL && !bloom_may_contain(bst->pair_filter, bloom_pair_key(flightId, passengerId))) {
+        return 0;
+    }
+    
+    // All seats of one (flight, passenger) pair sit on a single search path,
+    // so the first node with a matching prefix answers the question
+    ReservationBST_Node* current = bst->root;
+    while (current != NULL) {
+        int cmp = compare_flight_passenger(flightId, passengerId, &current->data);
+        if (cmp == 0) {
+            return 1;
+        }
+        current = cmp < 0 ? current->left : current->right;
+    }
+    return 0;
+}
+
+// Check whether any passenger holds a given seat on a flight
+int is_seat_taken_bst(ReservationBST* bst, int flightId, const char* seatNumber) {
+    if (bst == NULL || bst->root == NULL) {
+        return 0;
+    }
+    
+    // Only nodes of the flight branch both ways; the rest of the walk is a single search path,
+    // so the stack only ever holds nodes of this flight
+    int capacity = 64;
+    int top = 0;
+    ReservationBST_Node** stack = (ReservationBST_Node**)malloc(capacity * sizeof(ReservationBST_Node*));
+    if (stack == NULL) {
+        fprintf(stderr, "Memory allocation failed for seat search\n");
+        return 1;  // Report the seat as taken rather than risk a double booking
+    }
+    
+    int taken = 0;
+    stack[top++] = bst->root;
+    while (top > 0 && !taken) {
+        ReservationBST_Node* current = stack[--top];
+        while (current != NULL && current->data.flightId != flightId) {
+            current = flightId < current->data.flightId ? current->left : current->right;
+        }
+        if (current == NULL) continue;
+        
+        if (strcmp(current->data.seatNumber, seatNumber) == 0) {
+            taken = 1;
+            break;
+        }
+        if (top + 2 > capacity) {
+            capacity *= 2;
+            ReservationBST_Node** grown = (ReservationBST_Node**)realloc(stack, capacity * sizeof(ReservationBST_Node*));
+            if (grown == NULL) {
+                fprintf(stderr, "Memory allocation failed for seat search\n");
+                taken = 1;
+                break;
+            }
+            stack = grown;
+        }
+        if (current->left != NULL) stack[top++] = current->left;
+        if (current->right != NULL) stack[top++] = current->right;
+    }
+    
+    free(stack);
+    return taken;
+}
+
+// Count the reservations on a batch of flights. The searches for the topmost node of each flight
+// are interleaved a group at a time with the next node prefetched; the flight's nodes below it
+// are then counted with a walk that, like is_seat_taken_bst, only branches at nodes of the flight
+int count_reservations_by_flight_batch_bst(ReservationBST* bst, const int* flightIds, int count, int* counts) {
+    for (int i = 0; i < count; i++) {
+        counts[i] = 0;
+    }
+    if (bst == NULL || bst->root == NULL || count <= 0) {
+        return 1;
+    }
+    
+    int capacity = 64;
+    ReservationBST_Node** stack = (ReservationBST_Node**)malloc(capacity * sizeof(ReservationBST_Node*));
+    if (stack == NULL) {
+        fprintf(stderr, "Memory allocation failed for batch reservation count\n");
+        return 0;
+    }
+    
+    for (int base = 0; base < count; base += RESERVATION_BATCH_GROUP) {
+        int group = count - base < RESERVATION_BATCH_GROUP ? count - base : RESERVATION_BATCH_GROUP;
+        ReservationBST_Node* cursor[RESERVATION_BATCH_GROUP];
+        int found[RESERVATION_BATCH_GROUP];
+        for (int j = 0; j < group; j++) {
+            cursor[j] = bst->root;
+            found[j] = 0;
+        }
+        
+        // Descend every search one level per pass until it reaches a node of its flight
+        int active = group;
+        while (active > 0) {
+            active = 0;
+            for (int j = 0; j < group; j++) {
+                ReservationBST_Node* node = cursor[j];
+                if (node == NULL || found[j]) continue;
+                int flightId = flightIds[base + j];
+                if (node->data.flightId == flightId) {
+                    found[j] = 1;
+                    continue;
+                }
+                cursor[j] = flightId < node->data.flightId ? node->left : node->right;
+                if (cursor[j] != NULL) {
+                    __builtin_prefetch(cursor[j]);
+                    active++;
+                }
+            }
+        }
+        
+        // Count the flight's nodes in the subtree of each node found
+        for (int j = 0; j < group; j++) {
+            if (!found[j]) continue;
+            int flightId = flightIds[base + j];
+            int top = 0;
+            stack[top++] = cursor[j];
+            while (top > 0) {
+                ReservationBST_Node* current = stack[--top];
+                while (current != NULL && current->data.flightId != flightId) {
+                    current = flightId < current->data.flightId ? current->left : current->right;
+                }
+                if (current == NULL) continue;
+                
+                counts[base + j]++;
+                if (top + 2 > capacity) {
+                    capacity *= 2;
+                    ReservationBST_Node** grown = (ReservationBST_Node**)realloc(stack, capacity * sizeof(ReservationBST_Node*));
+                    if (grown == NULL) {
+                        fprintf(stderr, "Memory allocation failed for batch reservation count\n");
+                        free(stack);
+                        return 0;
+                    }
+                    stack = grown;
+                }
+                if (current->left != NULL) {
+                    __builtin_prefetch(current->left);
+                    stack[top++] = current->left;
+                }
+                if (current->right != NULL) {
+                    __builtin_prefetch(current->right);
+                    stack[top++] = current->right;
+                }
+            }
+        }
+    }
+    
+    free(stack);
+    return 1;
+}
+
+// Cancel one reservation of a passenger on a flight
+int cancel_reservation_bst(ReservationBST* bst, int flightId, int passengerId) {
+    if (bst == NULL) {
+        return 0;
+    }
+    
+    // Find the first node on the search path for (flight, passenger)
+    ReservationBST_Node** link = &bst->root;
+    while (*link != NULL) {
+        int cmp = compare_flight_passenger(flightId, passengerId, &(*link)->data);
+        if (cmp == 0) {
+            break;
+        }
+        link = cmp < 0 ? &(*link)->left : &(*link)->right;
+    }
+    
+    ReservationBST_Node* node = *link;
+    if (node == NULL) {
+        return 0;
+    }
+    
+    if (node->left == NULL || node->right == NULL) {
+        // Zero or one child: splice the node out
+        *link = node->left != NULL ? node->left : node->right;
+        mem_free(MEM_RESERVATION_BST, node, sizeof(ReservationBST_Node));
+    } else {
+        // Two children: replace with the in-order successor and unlink that instead
+        ReservationBST_Node** successor_link = &node->right;
+        while ((*successor_link)->left != NULL) {
+            successor_link = &(*successor_link)->left;
+        }
+        ReservationBST_Node* successor = *successor_link;
+        node->data = successor->data;
+        *successor_link = successor->right;
+        mem_free(MEM_RESERVATION_BST, successor, sizeof(ReservationBST_Node));
+    }
+    
+    bst->count--;
+    load_index_adjust(bst->load_index, flightId, -1);
+    return 1;
+}
+
+// Append a removed reservation to the caller's array, doubling it as needed
+static int append_removed(ReservationRecord record, ReservationRecord** records, int* capacity, int* count) {
+    if (*count >= *capacity) {
+        int grown_capacity = *capacity > 0 ? *capacity * 2 : 32;
+        ReservationRecord* grown = (ReservationRecord*)realloc(*records, grown_capacity * sizeof(ReservationRecord));
+        if (grown == NULL) {
+            return 0;
+        }
+        *records = grown;
+        *capacity = grown_capacity;
+    }
+    (*records)[(*count)++] = record;
+    return 1;
+}
+
+// Free a subtree whose reservations are all being removed, appending them in key order.
+// Rotating left children up turns the subtree into a list as it goes, so no stack is needed
+static void remove_whole_subtree(ReservationBST_Node* node, ReservationRecord** records, int* capacity,
+                                 int* count, int* removed, int* failed) {
+    while (node != NULL) {
+        if (node->left != NULL) {
+            ReservationBST_Node* left = node->left;
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        } else {
+            ReservationBST_Node* next = node->right;
+            if (!append_removed(node->data, records, capacity, count)) *failed = 1;
+            mem_free(MEM_RESERVATION_BST, node, sizeof(ReservationBST_Node));
+            (*removed)++;
+            node = next;
+        }
+    }
+}
+
+// Remove every reservation on a flight, appending them to (*records)[*count...].
+// Returns 1 if every removed record was copied
+static int remove_flight_nodes(ReservationBST* bst, int flightId, ReservationRecord** records, int* capacity, int* count) {
+    // The flight's nodes are contiguous in key order, so they all sit below the first one
+    // on the search path
+    ReservationBST_Node** link = &bst->root;
+    while (*link != NULL && (*link)->data.flightId != flightId) {
+        link = flightId < (*link)->data.flightId ? &(*link)->left : &(*link)->right;
+    }
+    ReservationBST_Node* top = *link;
+    if (top == NULL) {
+        return 1;
+    }
+    
+    int removed = 0;
+    int failed = 0;
+    
+    // Left of the top node the flight's reservations are a suffix: every match found on the way
+    // down has only matches to its right, and the walk continues into its left child
+    ReservationBST_Node** side = &top->left;
+    while (*side != NULL) {
+        ReservationBST_Node* node = *side;
+        if (node->data.flightId != flightId) {
+            side = &node->right;
+            continue;
+        }
+        remove_whole_subtree(node->right, records, capacity, count, &removed, &failed);
+        *side = node->left;
+        if (!append_removed(node->data, records, capacity, count)) failed = 1;
+        mem_free(MEM_RESERVATION_BST, node, sizeof(ReservationBST_Node));
+        removed++;
+    }
+    
+    // The mirror image on the right
+    side = &top->right;
+    while (*side != NULL) {
+        ReservationBST_Node* node = *side;
+        if (node->data.flightId != flightId) {
+            side = &node->left;
+            continue;
+        }
+        remove_whole_subtree(node->left, records, capacity, count, &removed, &failed);
+        *side = node->right;
+        if (!append_removed(node->data, records, capacity, count)) failed = 1;
+        mem_free(MEM_RESERVATION_BST, node, sizeof(ReservationBST_Node));
+        removed++;
+    }
+    
+    // What is left below the top node is smaller on the left and larger on the right:
+    // hang the right part off the largest node on the left
+    if (top->left == NULL) {
+        *link = top->right;
+    } else {
+        ReservationBST_Node* largest = top->left;
+        while (largest->right != NULL) {
+            largest = largest->right;
+        }
+        largest->right = top->right;
+        *link = top->left;
+    }
+    if (!append_removed(top->data, records, capacity, count)) failed = 1;
+    mem_free(MEM_RESERVATION_BST, top, sizeof(ReservationBST_Node));
+    removed++;
+    
+    bst->count -= removed;
+    load_index_adjust(bst->load_index, flightId, -removed);
+    if (failed) {
+        fprintf(stderr, "Memory allocation failed when collecting cancelled reservations\n");
+    }
+    return !failed;
+}
+
+// Remove every reservation on a flight and copy them into *records (grown as needed)
+int cancel_flight_reservations_bst(ReservationBST* bst, int flightId, ReservationRecord** records, int* capacity) {
+    if (bst == NULL) return 0;
+    
+    int count = 0;
+    if (!remove_flight_nodes(bst, flightId, records, capacity, &count)) {
+        return -1;
+    }
+    return count;
+}
+
+// Cancel a flight: delete it from the AVL tree and remove all of its reservations
+int cancel_flight_bst(ReservationBST* bst, AVL_Node** flights_root, int flightId, ReservationRecord** records, int* capacity) {
+    int deleted = 0;
+    *flights_root = avl_delete(*flights_root, flightId, &deleted);
+    if (!deleted) {
+        return -1;
+    }
+    if (bst != NULL) {
+        load_index_remove_flight(bst->load_index, flightId);
+    }
+    return cancel_flight_reservations_bst(bst, flightId, records, capacity);
+}
+
+// Collect the IDs of flights departing in [from, to), in ID order
+static int collect_departures(AVL_Node* root, time_t from, time_t to, int** ids, int* count, int* capacity) {
+    if (root == NULL) {
+        return 1;
+    }
+    if (!collect_departures(root->left, from, to, ids, count, capacity)) {
+        return 0;
+    }
+    if (root->data.departureTime >= from && root->data.departureTime < to) {
+        if (*count >= *capacity) {
+            *capacity = *capacity > 0 ? *capacity * 2 : 16;
+            int* grown = (int*)realloc(*ids, *capacity * sizeof(int));
+            if (grown == NULL) {
+                return 0;
+            }
+            *ids = grown;
+        }
+        (*ids)[(*count)++] = root->data.id;
+    }
+    return collect_departures(root->right, from, to, ids, count, capacity);
+}
+
+// Cancel every flight departing in [from, to) along with its reservations
+int cancel_departures_bst(ReservationBST* bst, AVL_Node** flights_root, time_t from, time_t to,
+                          int* flights_cancelled, ReservationRecord** records, int* capacity) {
+    *flights_cancelled = 0;
+    
+    // The tree is ordered by ID, not departure time, so finding the day's flights is a full walk
+    int* ids = NULL;
+    int id_count = 0;
+    int id_capacity = 0;
+    if (!collect_departures(*flights_root, from, to, &ids, &id_count, &id_capacity)) {
+        fprintf(stderr, "Memory allocation failed when collecting departures\n");
+        free(ids);
+        return -1;
+    }
+    
+    int count = 0;
+    int ok = 1;
+    for (int i = 0; i < id_count; i++) {
+        int deleted = 0;
+        *flights_root = avl_delete(*flights_root, ids[i], &deleted);
+        if (bst != NULL) {
+            load_index_remove_flight(bst->load_index, ids[i]);
+            ok &= remove_flight_nodes(bst, ids[i], records, capacity, &count);
+        }
+    }
+    *flights_cancelled = id_count;
+    
+    free(ids);
+    return ok ? count : -1;
+}
+
 // Free reservation BST subtree
 static void free_reservation_subtree(ReservationBST_Node* node) {
     if (node != NULL) {
         free_reservation_subtree(node->left);
         free_reservation_subtree(node->right);
-        free(node);
+        mem_free(MEM_RESERVATION_BST, node, sizeof(ReservationBST_Node));
     }
 }
 
@@ -447,7 +1044,9 @@ static void free_reservation_subtree(ReservationBST_Node* node) {
 void free_reservation_bst(ReservationBST* bst) {
     if (bst != NULL) {
         free_reservation_subtree(bst->root);
-        free(bst);
+        bloom_free(bst->pair_filter);
+        load_index_free(bst->load_index);
+        mem_free(MEM_RESERVATION_BST, bst, sizeof(ReservationBST));
     }
 }
 
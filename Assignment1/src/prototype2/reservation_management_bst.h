@@ -29,6 +29,54 @@ int count_flights_by_passenger(ReservationBST* bst, int passengerId);
 // Validate that a flight doesn't exceed its passenger capacity
 int validate_flight_capacity_bst(ReservationBST* bst, AVL_Node* flights_root, int flightId);
 
+// Copy every reservation of a passenger (or on a flight) into *records, growing the caller's
+// array as needed. Returns the number found, or -1 on failure
+int find_reservations_by_passenger_bst(ReservationBST* bst, int passengerId, ReservationRecord** records, int* capacity);
+int find_reservations_by_flight_bst(ReservationBST* bst, int flightId, ReservationRecord** records, int* capacity);
+
+// Put a Bloom filter of booked (flight, passenger) pairs with the given false-positive rate in
+// front of has_reservation_bst, so the duplicate-booking check for a new pair usually costs one
+// cache miss. It is sized for `expected` reservations (more if the BST already holds more),
+// grows with the BST (rebuilt when full) and is freed with it. Returns 1 on success
+int reservation_bst_enable_filter(ReservationBST* bst, long long expected, double fp_rate);
+
+// Keep the flights of `flights_root` in load-factor order (seats booked over capacity) from
+// now on, counting the reservations already in the BST. Every booking, cancellation and
+// flight cancellation through this BST then moves its flight in O(log n), so the fullest and
+// emptiest flights come from load_index_fullest/emptiest on bst->load_index. Flights added
+// to the tree later are not tracked. Returns 1 on success
+int reservation_bst_enable_load_index(ReservationBST* bst, AVL_Node* flights_root);
+
+// Check whether a passenger holds any reservation on a flight
+int has_reservation_bst(ReservationBST* bst, int flightId, int passengerId);
+
+// Check whether any passenger holds a given seat on a flight
+int is_seat_taken_bst(ReservationBST* bst, int flightId, const char* seatNumber);
+
+// Lookups interleaved per group by count_reservations_by_flight_batch_bst
+#define RESERVATION_BATCH_GROUP 16
+
+// Count the reservations (seats booked) on each flight of a batch into counts[i].
+// Returns 1 on success, 0 on failure
+int count_reservations_by_flight_batch_bst(ReservationBST* bst, const int* flightIds, int count, int* counts);
+
+// Cancel one reservation of a passenger on a flight (returns 1 if one was removed)
+int cancel_reservation_bst(ReservationBST* bst, int flightId, int passengerId);
+
+// Remove every reservation on a flight in O(depth + k), copying the removed records into
+// *records (grown as needed) so the passengers can be rebooked. Returns the number removed,
+// or -1 if they could not all be copied (they are removed either way)
+int cancel_flight_reservations_bst(ReservationBST* bst, int flightId, ReservationRecord** records, int* capacity);
+
+// Cancel a flight: delete it from the AVL tree and remove its reservations as above.
+// Returns the number of reservations cancelled, or -1 if there is no such flight
+int cancel_flight_bst(ReservationBST* bst, AVL_Node** flights_root, int flightId, ReservationRecord** records, int* capacity);
+
+// Cancel every flight departing in [from, to) (for example one day) with its reservations.
+// Sets *flights_cancelled and returns the number of reservations cancelled, or -1 on failure
+int cancel_departures_bst(ReservationBST* bst, AVL_Node** flights_root, time_t from, time_t to,
+                          int* flights_cancelled, ReservationRecord** records, int* capacity);
+
 // Free reservation BST memory
 void free_reservation_bst(ReservationBST* bst);
 
@@ -0,0 +1,508 @@
+/*
+ * Multi-Version Reservation Store (Prototype 2)
+ *
+ * Reservations are kept in a BST ordered by (flight, passenger, seat) like
+ * the prototype 2 reservation BST, but each node holds a chain of versions
+ * instead of one record. A version is visible to snapshots in [begin, end):
+ * a booking ends the current version (if any) and pushes a new one, and a
+ * cancellation only sets the end timestamp. Writers hold one mutex and
+ * publish a commit by storing its timestamp in the clock, after every
+ * version it created is linked in.
+ *
+ * A reader announces its snapshot timestamp in its slot and re-reads the
+ * clock to make sure the collector could not have missed it. It then walks
+ * the tree and each chain from the newest version to the first one that
+ * began at or before the snapshot; it never looks further. The collector
+ * frees everything behind that point for the oldest open snapshot, and
+ * unlinks chains that ended before it, freeing them only once every
+ * snapshot that might still be reading them has closed.
+ *
+ * Sources used:
+ * 1. Bernstein and Goodman, "Multiversion Concurrency Control - Theory and Algorithms"
+ * 2. "Database System Concepts" by Silberschatz, Korth and Sudarshan - Snapshot isolation
+ * 3. Keir Fraser, "Practical lock-freedom" (PhD thesis) - Epoch-based reclamation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "reservation_mvcc.h"
+#include "../mem_stats.h"
+
+//--- WRITER SIDE (store->writer_lock held) ---//
+
+// Compare a reservation key with a node
+static int compare_key(int flightId, int passengerId, const char* seatNumber, const MvccNode* node) {
+    if (flightId != node->flightId) {
+        return flightId < node->flightId ? -1 : 1;
+    }
+    if (passengerId != node->passengerId) {
+        return passengerId < node->passengerId ? -1 : 1;
+    }
+    return strcmp(seatNumber, node->seatNumber);
+}
+
+// Find the node of a key, inserting an empty one if there is none. New nodes are fully
+// initialised before the link to them is published, so readers never see a partial node
+static MvccNode* find_or_insert_node(MvccReservationStore* store, const ReservationRecord* record) {
+    MvccNode** link = &store->root;
+    while (*link != NULL) {
+        int cmp = compare_key(record->flightId, record->passengerId, record->seatNumber, *link);
+        if (cmp == 0) {
+            return *link;
+        }
+        link = cmp < 0 ? &(*link)->left : &(*link)->right;
+    }
+    
+    MvccNode* node = (MvccNode*)mem_alloc(MEM_RESERVATION_MVCC, sizeof(MvccNode));
+    if (node == NULL) {
+        fprintf(stderr, "Memory allocation failed for reservation version node\n");
+        exit(1);
+    }
+    node->flightId = record->flightId;
+    node->passengerId = record->passengerId;
+    strncpy(node->seatNumber, record->seatNumber, MAX_SEAT_NUMBER_LENGTH - 1);
+    node->seatNumber[MAX_SEAT_NUMBER_LENGTH - 1] = '\0';
+    node->versions = NULL;
+    node->left = NULL;
+    node->right = NULL;
+    __atomic_store_n(link, node, __ATOMIC_RELEASE);
+    return node;
+}
+
+// End the node's live version (if any) and push a new one stamped with `timestamp`
+static void push_version(MvccReservationStore* store, MvccNode* node, ReservationRecord record, unsigned long timestamp) {
+    MvccVersion* version = (MvccVersion*)mem_alloc(MEM_RESERVATION_MVCC, sizeof(MvccVersion));
+    if (version == NULL) {
+        fprintf(stderr, "Memory allocation failed for reservation version\n");
+        exit(1);
+    }
+    
+    MvccVersion* head = node->versions;
+    if (head != NULL && head->end == MVCC_INFINITY) {
+        __atomic_store_n(&head->end, timestamp, __ATOMIC_RELEASE);
+    } else {
+        store->live_count++;
+    }
+    version->data = record;
+    version->begin = timestamp;
+    version->end = MVCC_INFINITY;
+    version->older = head;
+    __atomic_store_n(&node->versions, version, __ATOMIC_RELEASE);
+    store->version_count++;
+}
+
+// Oldest snapshot any reader has open (MVCC_INFINITY if none)
+static unsigned long oldest_open_snapshot(MvccReservationStore* store) {
+    unsigned long oldest = MVCC_INFINITY;
+    for (int i = 0; i < MVCC_MAX_READERS; i++) {
+        unsigned long snapshot = __atomic_load_n(&store->readers[i].snapshot, __ATOMIC_SEQ_CST);
+        if (snapshot < oldest) oldest = snapshot;
+    }
+    return oldest;
+}
+
+// Free a chain of versions
+static int free_chain(MvccReservationStore* store, MvccVersion* version) {
+    int freed = 0;
+    while (version != NULL) {
+        MvccVersion* older = version->older;
+        mem_free(MEM_RESERVATION_MVCC, version, sizeof(MvccVersion));
+        version = older;
+        freed++;
+    }
+    store->version_count -= freed;
+    store->collected += freed;
+    return freed;
+}
+
+// Park an unlinked chain until the snapshots that might be reading it have closed
+static void add_to_limbo(MvccReservationStore* store, MvccVersion* chain, unsigned long unlinked_at) {
+    if (store->limbo_count >= store->limbo_capacity) {
+        int new_capacity = store->limbo_capacity > 0 ? store->limbo_capacity * 2 : 64;
+        MvccLimbo* grown = (MvccLimbo*)realloc(store->limbo, new_capacity * sizeof(MvccLimbo));
+        if (grown == NULL) {
+            fprintf(stderr, "Memory allocation failed for reservation version limbo\n");
+            exit(1);
+        }
+        store->limbo = grown;
+        store->limbo_capacity = new_capacity;
+    }
+    store->limbo[store->limbo_count].chain = chain;
+    store->limbo[store->limbo_count].unlinked_at = unlinked_at;
+    store->limbo_count++;
+}
+
+// Grow an explicit traversal stack. Returns 0 on failure
+static int grow_stack(MvccNode*** stack, int* capacity) {
+    int new_capacity = *capacity * 2;
+    MvccNode** grown = (MvccNode**)realloc(*stack, new_capacity * sizeof(MvccNode*));
+    if (grown == NULL) {
+        fprintf(stderr, "Memory allocation failed for reservation version traversal\n");
+        return 0;
+    }
+    *stack = grown;
+    *capacity = new_capacity;
+    return 1;
+}
+
+// Collect garbage with the writer lock held
+static int collect_locked(MvccReservationStore* store) {
+    unsigned long clock = store->clock;
+    unsigned long oldest = oldest_open_snapshot(store);
+    if (oldest > clock) oldest = clock;
+    
+    int capacity = 64;
+    int top = 0;
+    MvccNode** stack = (MvccNode**)malloc(capacity * sizeof(MvccNode*));
+    if (stack == NULL) {
+        fprintf(stderr, "Memory allocation failed for reservation version traversal\n");
+        return 0;
+    }
+    
+    int freed = 0;
+    if (store->root != NULL) stack[top++] = store->root;
+    while (top > 0) {
+        MvccNode* node = stack[--top];
+        if (top + 2 > capacity && !grow_stack(&stack, &capacity)) break;
+        if (node->left != NULL) stack[top++] = node->left;
+        if (node->right != NULL) stack[top++] = node->right;
+        
+        MvccVersion* head = node->versions;
+        if (head == NULL) continue;
+        
+        // Ended before every open snapshot: unlink the whole chain. A reader that loaded the
+        // head already may still look at it, so it waits in limbo
+        if (head->end <= oldest) {
+            __atomic_store_n(&node->versions, NULL, __ATOMIC_SEQ_CST);
+            add_to_limbo(store, head, clock);
+            continue;
+        }
+        
+        // Every snapshot stops at or before the first version that began by `oldest`,
+        // so nothing behind it can be reached
+        MvccVersion* cut = head;
+        while (cut != NULL && cut->begin > oldest) {
+            cut = cut->older;
+        }
+        if (cut != NULL && cut->older != NULL) {
+            MvccVersion* tail = cut->older;
+            __atomic_store_n(&cut->older, NULL, __ATOMIC_RELEASE);
+            freed += free_chain(store, tail);
+        }
+    }
+    free(stack);
+    
+    // Snapshots open now were either already open when a chain was unlinked (and announced a
+    // timestamp no later than the clock then) or can't reach it
+    unsigned long still_open = oldest_open_snapshot(store);
+    int kept = 0;
+    for (int i = 0; i < store->limbo_count; i++) {
+        if (store->limbo[i].unlinked_at < still_open) {
+            freed += free_chain(store, store->limbo[i].chain);
+        } else {
+            store->limbo[kept++] = store->limbo[i];
+        }
+    }
+    store->limbo_count = kept;
+    store->commits_since_gc = 0;
+    return freed;
+}
+
+// Publish the commit with timestamp `timestamp`, collecting garbage when it is due
+static void commit_locked(MvccReservationStore* store, unsigned long timestamp) {
+    __atomic_store_n(&store->clock, timestamp, __ATOMIC_SEQ_CST);
+    if (++store->commits_since_gc >= MVCC_GC_INTERVAL) {
+        collect_locked(store);
+    }
+}
+
+//--- PUBLIC WRITER API ---//
+
+// Create an empty store
+MvccReservationStore* mvcc_create() {
+    MvccReservationStore* store = NULL;
+    // Cache-line aligned so every reader slot sits on its own line
+    if (posix_memalign((void**)&store, 64, sizeof(MvccReservationStore)) != 0) {
+        fprintf(stderr, "Memory allocation failed for reservation version store\n");
+        return NULL;
+    }
+    memset(store, 0, sizeof(MvccReservationStore));
+    for (int i = 0; i < MVCC_MAX_READERS; i++) {
+        store->readers[i].snapshot = MVCC_INFINITY;
+    }
+    if (pthread_mutex_init(&store->writer_lock, NULL) != 0) {
+        fprintf(stderr, "Could not create the reservation version store lock\n");
+        free(store);
+        return NULL;
+    }
+    return store;
+}
+
+// Copy a reservation BST into the store as one commit. Nodes are visited parent first,
+// so the store's tree gets the same shape as the BST's
+unsigned long mvcc_import_bst(MvccReservationStore* store, ReservationBST* bst) {
+    if (store == NULL || bst == NULL) {
+        return 0;
+    }
+    
+    int capacity = 64;
+    int top = 0;
+    ReservationBST_Node** stack = (ReservationBST_Node**)malloc(capacity * sizeof(ReservationBST_Node*));
+    if (stack == NULL) {
+        fprintf(stderr, "Memory allocation failed for reservation import\n");
+        return 0;
+    }
+    
+    pthread_mutex_lock(&store->writer_lock);
+    unsigned long timestamp = store->clock + 1;
+    if (bst->root != NULL) stack[top++] = bst->root;
+    while (top > 0) {
+        ReservationBST_Node* current = stack[--top];
+        push_version(store, find_or_insert_node(store, &current->data), current->data, timestamp);
+        
+        if (top + 2 > capacity) {
+            capacity *= 2;
+            ReservationBST_Node** grown = (ReservationBST_Node**)realloc(stack, capacity * sizeof(ReservationBST_Node*));
+            if (grown == NULL) {
+                fprintf(stderr, "Memory allocation failed for reservation import\n");
+                break;
+            }
+            stack = grown;
+        }
+        if (current->right != NULL) stack[top++] = current->right;
+        if (current->left != NULL) stack[top++] = current->left;
+    }
+    commit_locked(store, timestamp);
+    pthread_mutex_unlock(&store->writer_lock);
+    
+    free(stack);
+    return timestamp;
+}
+
+// Book a reservation as a new version
+unsigned long mvcc_book(MvccReservationStore* store, ReservationRecord record) {
+    pthread_mutex_lock(&store->writer_lock);
+    unsigned long timestamp = store->clock + 1;
+    push_version(store, find_or_insert_node(store, &record), record, timestamp);
+    commit_locked(store, timestamp);
+    pthread_mutex_unlock(&store->writer_lock);
+    return timestamp;
+}
+
+// End one live reservation of a passenger on a flight
+unsigned long mvcc_cancel(MvccReservationStore* store, int flightId, int passengerId) {
+    int capacity = 64;
+    int top = 0;
+    MvccNode** stack = (MvccNode**)malloc(capacity * sizeof(MvccNode*));
+    if (stack == NULL) {
+        fprintf(stderr, "Memory allocation failed for reservation version traversal\n");
+        return 0;
+    }
+    
+    pthread_mutex_lock(&store->writer_lock);
+    unsigned long timestamp = 0;
+    
+    // The seats of one (flight, passenger) pair all lie below the first node with that prefix,
+    // but cancelled seats keep their nodes, so every node with the prefix may need a look
+    if (store->root != NULL) stack[top++] = store->root;
+    while (top > 0 && timestamp == 0) {
+        MvccNode* current = stack[--top];
+        while (current != NULL) {
+            int cmp = flightId != current->flightId ? (flightId < current->flightId ? -1 : 1)
+                    : passengerId != current->passengerId ? (passengerId < current->passengerId ? -1 : 1) : 0;
+            if (cmp == 0) break;
+            current = cmp < 0 ? current->left : current->right;
+        }
+        if (current == NULL) continue;
+        
+        MvccVersion* head = current->versions;
+        if (head != NULL && head->end == MVCC_INFINITY) {
+            timestamp = store->clock + 1;
+            __atomic_store_n(&head->end, timestamp, __ATOMIC_RELEASE);
+            store->live_count--;
+            commit_locked(store, timestamp);
+            break;
+        }
+        if (top + 2 > capacity && !grow_stack(&stack, &capacity)) break;
+        if (current->left != NULL) stack[top++] = current->left;
+        if (current->right != NULL) stack[top++] = current->right;
+    }
+    
+    pthread_mutex_unlock(&store->writer_lock);
+    free(stack);
+    return timestamp;
+}
+
+// Free versions no open snapshot can see
+int mvcc_collect_garbage(MvccReservationStore* store) {
+    pthread_mutex_lock(&store->writer_lock);
+    int freed = collect_locked(store);
+    pthread_mutex_unlock(&store->writer_lock);
+    return freed;
+}
+
+//--- READER SIDE (no locks) ---//
+
+// Open a snapshot at the latest commit
+unsigned long mvcc_snapshot_begin(MvccReservationStore* store, int reader) {
+    // If the clock moved while announcing, a collector may have missed the announcement
+    // and judged by the newer clock, so announce again
+    for (;;) {
+        unsigned long snapshot = __atomic_load_n(&store->clock, __ATOMIC_SEQ_CST);
+        __atomic_store_n(&store->readers[reader].snapshot, snapshot, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&store->clock, __ATOMIC_SEQ_CST) == snapshot) {
+            return snapshot;
+        }
+    }
+}
+
+// Close a snapshot
+void mvcc_snapshot_end(MvccReservationStore* store, int reader) {
+    __atomic_store_n(&store->readers[reader].snapshot, MVCC_INFINITY, __ATOMIC_SEQ_CST);
+}
+
+// Version of a node visible at a snapshot, or NULL. Stops at the first version that began by
+// the snapshot, which is as far as the collector guarantees the chain is intact
+static const MvccVersion* visible_version(const MvccNode* node, unsigned long snapshot) {
+    const MvccVersion* version = __atomic_load_n(&node->versions, __ATOMIC_ACQUIRE);
+    while (version != NULL) {
+        if (version->begin <= snapshot) {
+            return snapshot < __atomic_load_n(&version->end, __ATOMIC_ACQUIRE) ? version : NULL;
+        }
+        version = __atomic_load_n(&version->older, __ATOMIC_ACQUIRE);
+    }
+    return NULL;
+}
+
+// In-order walk of the nodes with flights in [low_flight, high_flight] (and one passenger,
+// unless passengerId is negative), visiting every reservation visible at the snapshot
+static int walk_visible(MvccReservationStore* store, unsigned long snapshot, int low_flight, int high_flight,
+                        int passengerId, void (*visit)(const ReservationRecord*, void*), void* context) {
+    int capacity = 64;
+    int top = 0;
+    MvccNode** stack = (MvccNode**)malloc(capacity * sizeof(MvccNode*));
+    if (stack == NULL) {
+        fprintf(stderr, "Memory allocation failed for reservation version traversal\n");
+        return -1;
+    }
+    
+    int visited = 0;
+    MvccNode* current = __atomic_load_n(&store->root, __ATOMIC_ACQUIRE);
+    while (current != NULL || top > 0) {
+        while (current != NULL) {
+            // Flights below the range can only have matches to the right
+            if (current->flightId < low_flight) {
+                current = __atomic_load_n(&current->right, __ATOMIC_ACQUIRE);
+                continue;
+            }
+            if (top >= capacity && !grow_stack(&stack, &capacity)) {
+                free(stack);
+                return -1;
+            }
+            stack[top++] = current;
+            current = __atomic_load_n(&current->left, __ATOMIC_ACQUIRE);
+        }
+        
+        if (top > 0) {
+            current = stack[--top];
+            if (current->flightId <= high_flight && (passengerId < 0 || current->passengerId == passengerId)) {
+                const MvccVersion* version = visible_version(current, snapshot);
+                if (version != NULL) {
+                    visit(&version->data, context);
+                    visited++;
+                }
+            }
+            
+            // Flights above the range can only have matches to the left
+            current = current->flightId > high_flight ? NULL : __atomic_load_n(&current->right, __ATOMIC_ACQUIRE);
+        }
+    }
+    
+    free(stack);
+    return visited;
+}
+
+// Visit every reservation visible at a snapshot
+int mvcc_scan(MvccReservationStore* store, unsigned long snapshot,
+              void (*visit)(const ReservationRecord* record, void* context), void* context) {
+    if (store == NULL) return -1;
+    return walk_visible(store, snapshot, INT_MIN, INT_MAX, -1, visit, context);
+}
+
+// Caller-owned array that matching reservations are copied into
+typedef struct {
+    ReservationRecord** records;
+    int* capacity;
+    int count;
+    int failed;
+} RecordCollector;
+
+static void collect_record(const ReservationRecord* record, void* context) {
+    RecordCollector* collector = (RecordCollector*)context;
+    if (collector->failed) return;
+    
+    if (collector->count >= *collector->capacity) {
+        int new_capacity = *collector->capacity > 0 ? *collector->capacity * 2 : 16;
+        ReservationRecord* grown = (ReservationRecord*)realloc(*collector->records, new_capacity * sizeof(ReservationRecord));
+        if (grown == NULL) {
+            fprintf(stderr, "Memory allocation failed when collecting reservations\n");
+            collector->failed = 1;
+            return;
+        }
+        *collector->records = grown;
+        *collector->capacity = new_capacity;
+    }
+    (*collector->records)[collector->count++] = *record;
+}
+
+// Copy the reservations on a flight visible at a snapshot
+int mvcc_find_by_flight(MvccReservationStore* store, unsigned long snapshot, int flightId,
+                        ReservationRecord** records, int* capacity) {
+    if (store == NULL) return 0;
+    RecordCollector collector = {records, capacity, 0, 0};
+    if (walk_visible(store, snapshot, flightId, flightId, -1, collect_record, &collector) < 0 || collector.failed) {
+        return -1;
+    }
+    return collector.count;
+}
+
+// Copy the reservations of a passenger visible at a snapshot
+int mvcc_find_by_passenger(MvccReservationStore* store, unsigned long snapshot, int passengerId,
+                           ReservationRecord** records, int* capacity) {
+    if (store == NULL) return 0;
+    RecordCollector collector = {records, capacity, 0, 0};
+    if (walk_visible(store, snapshot, INT_MIN, INT_MAX, passengerId, collect_record, &collector) < 0 || collector.failed) {
+        return -1;
+    }
+    return collector.count;
+}
+
+// Free the store, its nodes and every version
+void mvcc_free(MvccReservationStore* store) {
+    if (store == NULL) {
+        return;
+    }
+    
+    int capacity = 64;
+    int top = 0;
+    MvccNode** stack = (MvccNode**)malloc(capacity * sizeof(MvccNode*));
+    if (stack != NULL && store->root != NULL) stack[top++] = store->root;
+    while (stack != NULL && top > 0) {
+        MvccNode* node = stack[--top];
+        if (top + 2 > capacity && !grow_stack(&stack, &capacity)) break;
+        if (node->left != NULL) stack[top++] = node->left;
+        if (node->right != NULL) stack[top++] = node->right;
+        free_chain(store, node->versions);
+        mem_free(MEM_RESERVATION_MVCC, node, sizeof(MvccNode));
+    }
+    free(stack);
+    
+    for (int i = 0; i < store->limbo_count; i++) {
+        free_chain(store, store->limbo[i].chain);
+    }
+    free(store->limbo);
+    pthread_mutex_destroy(&store->writer_lock);
+    free(store);
+}
@@ -0,0 +1,105 @@
+#ifndef RESERVATION_MVCC_H
+#define RESERVATION_MVCC_H
+
+#include <pthread.h>
+#include "../airline_types.h"
+
+// Most readers that can hold a snapshot at the same time (reader numbers 0..MVCC_MAX_READERS-1)
+#define MVCC_MAX_READERS 64
+
+// End timestamp of a version that is still live (and the idle value of a reader slot)
+#define MVCC_INFINITY ((unsigned long)-1)
+
+// Commits between automatic garbage collections
+#define MVCC_GC_INTERVAL 1024
+
+// One version of a reservation, visible to snapshots in [begin, end)
+typedef struct MvccVersion {
+    ReservationRecord data;
+    unsigned long begin;         // Commit timestamp that created it
+    unsigned long end;           // Commit timestamp that replaced or cancelled it
+    struct MvccVersion* older;   // Previous version of the same reservation
+} MvccVersion;
+
+// Tree node for one (flight, passenger, seat) key, ordered like the prototype 2 reservation BST.
+// Nodes are never removed while the store exists, so readers can walk the tree without locks
+typedef struct MvccNode {
+    int flightId;
+    int passengerId;
+    char seatNumber[MAX_SEAT_NUMBER_LENGTH];
+    MvccVersion* versions;       // Newest first
+    struct MvccNode* left;
+    struct MvccNode* right;
+} MvccNode;
+
+// Snapshot timestamp announced by one reader, alone on its cache line
+typedef struct {
+    unsigned long snapshot;
+} __attribute__((aligned(64))) MvccReaderSlot;
+
+// Version chain unlinked by the collector, freed once older snapshots are gone
+typedef struct {
+    MvccVersion* chain;
+    unsigned long unlinked_at;
+} MvccLimbo;
+
+// Multi-version reservation store. Writers are serialised and stamp every change with the next
+// commit timestamp; a cancellation ends the live version instead of deleting it. A report opens
+// a snapshot and sees exactly the reservations committed at or before it, without taking a lock
+// and without blocking writers. The collector frees versions no open snapshot can see
+typedef struct {
+    MvccNode* root;
+    unsigned long clock;  // Last commit timestamp (read and written atomically)
+    MvccReaderSlot readers[MVCC_MAX_READERS];
+    pthread_mutex_t writer_lock;
+    MvccLimbo* limbo;
+    int limbo_count;
+    int limbo_capacity;
+    int live_count;          // Reservations live in the latest state
+    long long version_count; // Versions currently allocated
+    long long collected;     // Versions freed so far
+    int commits_since_gc;
+} MvccReservationStore;
+
+// Create an empty store. Returns NULL on failure
+MvccReservationStore* mvcc_create();
+
+// Copy every reservation of a prototype 2 reservation BST into the store as one commit,
+// keeping the BST's tree shape. Returns the commit timestamp, or 0 on failure
+unsigned long mvcc_import_bst(MvccReservationStore* store, ReservationBST* bst);
+
+// Book a reservation (a booking with the same flight, passenger and seat replaces the record).
+// Returns the commit timestamp
+unsigned long mvcc_book(MvccReservationStore* store, ReservationRecord record);
+
+// End one live reservation of a passenger on a flight. Returns its commit timestamp,
+// or 0 if the passenger holds no reservation on the flight
+unsigned long mvcc_cancel(MvccReservationStore* store, int flightId, int passengerId);
+
+// Open a snapshot as reader number `reader` and return its timestamp. Everything read with the
+// timestamp stays consistent and allocated until mvcc_snapshot_end
+unsigned long mvcc_snapshot_begin(MvccReservationStore* store, int reader);
+
+// Close the snapshot of reader number `reader`
+void mvcc_snapshot_end(MvccReservationStore* store, int reader);
+
+// Call visit for every reservation visible at `snapshot`, in (flight, passenger, seat) order.
+// Returns the number visited, or -1 on failure
+int mvcc_scan(MvccReservationStore* store, unsigned long snapshot,
+              void (*visit)(const ReservationRecord* record, void* context), void* context);
+
+// Copy the reservations visible at `snapshot` for a flight (or a passenger) into *records,
+// growing the caller's array as needed. Returns the number found, or -1 on failure
+int mvcc_find_by_flight(MvccReservationStore* store, unsigned long snapshot, int flightId,
+                        ReservationRecord** records, int* capacity);
+int mvcc_find_by_passenger(MvccReservationStore* store, unsigned long snapshot, int passengerId,
+                           ReservationRecord** records, int* capacity);
+
+// Free versions no open snapshot can see. Runs every MVCC_GC_INTERVAL commits on its own.
+// Returns the number of versions freed
+int mvcc_collect_garbage(MvccReservationStore* store);
+
+// Free the store. No snapshot may be open
+void mvcc_free(MvccReservationStore* store);
+
+#endif
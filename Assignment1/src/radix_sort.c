@@ -0,0 +1,159 @@
+/*
+ * Parallel LSD Radix Sort
+ *
+ * Each pass orders the pairs by one 11-bit digit of the key, starting with the lowest. A
+ * pass counts the digits of every thread's slice, turns the counts into a starting offset
+ * per (digit, thread), and lets each thread scatter its slice to those offsets, so the
+ * threads never write the same place and equal digits keep their order.
+ *
+ * Sources used:
+ * 1. Introduction to Algorithms (CLRS) - Counting sort and radix sort
+ * 2. "Fast Sort on CPUs and GPUs" by Satish et al. - Per-thread histograms and scatter
+ * 3. POSIX Threads Programming (Lawrence Livermore National Laboratory) - pthread_create/join
+ */
+#define _POSIX_C_SOURCE 200809L  // For sysconf
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "radix_sort.h"
+
+// Bits per digit and buckets per pass
+#define RADIX_BITS 11
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+
+// Passes to cover a 64-bit key
+#define RADIX_PASSES ((64 + RADIX_BITS - 1) / RADIX_BITS)
+
+// Pairs per thread below which extra threads cost more than they save
+#define RADIX_PAIRS_PER_THREAD 65536
+
+// One thread's slice of a pass
+typedef struct {
+    const RadixPair* source;
+    RadixPair* target;
+    size_t first;
+    size_t last;
+    int shift;
+    size_t counts[RADIX_BUCKETS];  // Digit counts, then this slice's write offsets
+} RadixSlice;
+
+// Count the digits of a slice
+static void* count_slice(void* arg) {
+    RadixSlice* slice = (RadixSlice*)arg;
+    memset(slice->counts, 0, sizeof(slice->counts));
+    for (size_t i = slice->first; i < slice->last; i++) {
+        slice->counts[(slice->source[i].key >> slice->shift) & (RADIX_BUCKETS - 1)]++;
+    }
+    return NULL;
+}
+
+// Move a slice's pairs to their offsets
+static void* scatter_slice(void* arg) {
+    RadixSlice* slice = (RadixSlice*)arg;
+    for (size_t i = slice->first; i < slice->last; i++) {
+        RadixPair pair = slice->source[i];
+        slice->target[slice->counts[(pair.key >> slice->shift) & (RADIX_BUCKETS - 1)]++] = pair;
+    }
+    return NULL;
+}
+
+// Run one step on every slice, the first on this thread
+static void run_slices(void* (*step)(void*), RadixSlice* slices, int threads) {
+    pthread_t handles[RADIX_MAX_THREADS];
+    int started[RADIX_MAX_THREADS];
+    for (int t = 1; t < threads; t++) {
+        started[t] = pthread_create(&handles[t], NULL, step, &slices[t]) == 0;
+        // Fall back to this thread if a worker can't be started
+        if (!started[t]) {
+            step(&slices[t]);
+        }
+    }
+    step(&slices[0]);
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) {
+            pthread_join(handles[t], NULL);
+        }
+    }
+}
+
+// Number of threads for `count` pairs
+static int radix_thread_count(size_t count, int threads) {
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus < 1 ? 1 : (int)cpus;
+    }
+    if (threads > RADIX_MAX_THREADS) threads = RADIX_MAX_THREADS;
+    size_t useful = count / RADIX_PAIRS_PER_THREAD + 1;
+    return (size_t)threads < useful ? threads : (int)useful;
+}
+
+// Stable ascending sort of the pairs by key
+int radix_sort_pairs(RadixPair* pairs, size_t count, int threads) {
+    if (count < 2) {
+        return 1;
+    }
+    
+    // Digits where every key agrees with the first would be a pass that moves nothing
+    uint64_t varying = 0;
+    for (size_t i = 1; i < count; i++) {
+        varying |= pairs[i].key ^ pairs[0].key;
+    }
+    if (varying == 0) {
+        return 1;
+    }
+    
+    RadixPair* scratch = (RadixPair*)malloc(count * sizeof(RadixPair));
+    threads = radix_thread_count(count, threads);
+    RadixSlice* slices = (RadixSlice*)malloc(threads * sizeof(RadixSlice));
+    if (scratch == NULL || slices == NULL) {
+        fprintf(stderr, "Memory allocation failed for radix sort of %zu pairs\n", count);
+        free(scratch);
+        free(slices);
+        return 0;
+    }
+    for (int t = 0; t < threads; t++) {
+        slices[t].first = count * t / threads;
+        slices[t].last = count * (t + 1) / threads;
+    }
+    
+    RadixPair* source = pairs;
+    RadixPair* target = scratch;
+    for (int pass = 0; pass < RADIX_PASSES; pass++) {
+        int shift = pass * RADIX_BITS;
+        if (((varying >> shift) & (RADIX_BUCKETS - 1)) == 0) {
+            continue;
+        }
+        for (int t = 0; t < threads; t++) {
+            slices[t].source = source;
+            slices[t].target = target;
+            slices[t].shift = shift;
+        }
+        run_slices(count_slice, slices, threads);
+        
+        // Digit by digit, each thread's pairs go after the previous threads' pairs
+        size_t offset = 0;
+        for (int digit = 0; digit < RADIX_BUCKETS; digit++) {
+            for (int t = 0; t < threads; t++) {
+                size_t digit_count = slices[t].counts[digit];
+                slices[t].counts[digit] = offset;
+                offset += digit_count;
+            }
+        }
+        run_slices(scatter_slice, slices, threads);
+        
+        RadixPair* sorted = target;
+        target = source;
+        source = sorted;
+    }
+    
+    // An odd number of passes leaves the result in the scratch buffer
+    if (source != pairs) {
+        memcpy(pairs, source, count * sizeof(RadixPair));
+    }
+    free(scratch);
+    free(slices);
+    return 1;
+}
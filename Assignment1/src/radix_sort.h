@@ -0,0 +1,27 @@
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Most threads one sort uses
+#define RADIX_MAX_THREADS 16
+
+// A key and the row (or any value) it carries
+typedef struct {
+    uint64_t key;
+    uint32_t value;
+} RadixPair;
+
+// Key of a signed int, ordered the same way as unsigned
+static inline uint32_t radix_key_i32(int value) {
+    return (uint32_t)value ^ 0x80000000u;
+}
+
+// Stable ascending sort of the pairs by key: an LSD radix sort on 11-bit digits that skips
+// the digits all keys share. Large inputs split each pass's counting and scattering over
+// `threads` threads (0 = one per CPU). Returns 1 on success, 0 if the scratch buffer could
+// not be allocated (the pairs are left as they were)
+int radix_sort_pairs(RadixPair* pairs, size_t count, int threads);
+
+#endif
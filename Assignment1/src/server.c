@@ -0,0 +1,522 @@
+/*
+ * Query Server Implementation
+ *
+ * Keeps one engine resident and answers binary protocol requests from many
+ * clients over a Unix domain socket or loopback TCP. A single thread runs a
+ * non-blocking, level-triggered epoll loop: every readable connection has all
+ * complete frames in its input decoded and answered in one go, and the answers
+ * are written back with one send, so pipelined requests share system calls.
+ * A connection whose client stops reading is throttled once
+ * SERVER_MAX_PENDING_OUTPUT bytes are queued for it.
+ *
+ * Sources used:
+ * 1. "Unix Network Programming" by W. Richard Stevens - Non-blocking sockets and Unix domain sockets
+ * 2. The Linux man-pages project - epoll(7), eventfd(2)
+ */
+#define _GNU_SOURCE  // For accept4 and SOCK_NONBLOCK
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "server.h"
+#include "protocol.h"
+#include "csv_writer.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+// Events handled per epoll_wait call
+#define SERVER_MAX_EVENTS 64
+
+// Bytes read per recv call
+#define SERVER_READ_CHUNK (64 * 1024)
+
+// One client connection
+typedef struct Connection {
+    int fd;
+    char* input;
+    size_t input_length;
+    size_t input_capacity;
+    OutputBuffer output;        // In-memory buffer of encoded responses
+    size_t output_sent;         // Bytes of `output` already written
+    unsigned int events;        // Events currently registered with epoll
+    struct Connection* prev;
+    struct Connection* next;
+} Connection;
+
+struct QueryServer {
+    int listen_fd;
+    int epoll_fd;
+    int wake_fd;                // eventfd written by server_stop
+    char unix_path[108];        // Socket file to remove on close (empty for TCP)
+    Connection* connections;
+    ReservationRecord* records; // Reused result array for bookings requests
+    int record_capacity;
+    Flight* flights;            // Page for LIST_FLIGHTS requests (allocated on first use)
+    ServerStats stats;
+};
+
+// Parse "unix:<path>" or "tcp:<port>" into a socket address. Returns 1 on success
+static int parse_address(const char* address, struct sockaddr_storage* storage, socklen_t* length) {
+    memset(storage, 0, sizeof(*storage));
+    
+    if (strncmp(address, "unix:", 5) == 0) {
+        struct sockaddr_un* un = (struct sockaddr_un*)storage;
+        const char* path = address + 5;
+        if (path[0] == '\0' || strlen(path) >= sizeof(un->sun_path)) {
+            fprintf(stderr, "Invalid Unix socket path: %s\n", path);
+            return 0;
+        }
+        un->sun_family = AF_UNIX;
+        strcpy(un->sun_path, path);
+        *length = sizeof(struct sockaddr_un);
+        return 1;
+    }
+    
+    if (strncmp(address, "tcp:", 4) == 0) {
+        int port = atoi(address + 4);
+        if (port <= 0 || port > 65535) {
+            fprintf(stderr, "Invalid TCP port: %s\n", address + 4);
+            return 0;
+        }
+        struct sockaddr_in* in = (struct sockaddr_in*)storage;
+        in->sin_family = AF_INET;
+        in->sin_port = htons((uint16_t)port);
+        in->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        *length = sizeof(struct sockaddr_in);
+        return 1;
+    }
+    
+    fprintf(stderr, "Unknown address %s (use unix:<path> or tcp:<port>)\n", address);
+    return 0;
+}
+
+// Register a file descriptor with epoll
+static int watch(int epoll_fd, int fd, unsigned int events, void* data, int operation) {
+    struct epoll_event event;
+    event.events = events;
+    event.data.ptr = data;
+    return epoll_ctl(epoll_fd, operation, fd, &event) == 0;
+}
+
+// Bind and listen on an address
+QueryServer* server_open(const char* address) {
+    struct sockaddr_storage storage;
+    socklen_t length;
+    if (!parse_address(address, &storage, &length)) {
+        return NULL;
+    }
+    
+    QueryServer* server = (QueryServer*)calloc(1, sizeof(QueryServer));
+    if (server == NULL) {
+        fprintf(stderr, "Memory allocation failed for query server\n");
+        return NULL;
+    }
+    server->listen_fd = -1;
+    server->epoll_fd = -1;
+    server->wake_fd = -1;
+    
+    server->listen_fd = socket(storage.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (server->listen_fd < 0) {
+        perror("socket");
+        server_close(server);
+        return NULL;
+    }
+    
+    if (storage.ss_family == AF_UNIX) {
+        // Replace a socket file left behind by an earlier run
+        strcpy(server->unix_path, ((struct sockaddr_un*)&storage)->sun_path);
+        unlink(server->unix_path);
+    } else {
+        int reuse = 1;
+        setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    }
+    
+    if (bind(server->listen_fd, (struct sockaddr*)&storage, length) != 0 ||
+        listen(server->listen_fd, SOMAXCONN) != 0) {
+        fprintf(stderr, "Could not listen on %s: %s\n", address, strerror(errno));
+        server->unix_path[0] = '\0';  // Not ours to remove
+        server_close(server);
+        return NULL;
+    }
+    
+    server->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    server->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (server->epoll_fd < 0 || server->wake_fd < 0 ||
+        !watch(server->epoll_fd, server->listen_fd, EPOLLIN, &server->listen_fd, EPOLL_CTL_ADD) ||
+        !watch(server->epoll_fd, server->wake_fd, EPOLLIN, &server->wake_fd, EPOLL_CTL_ADD)) {
+        perror("epoll");
+        server_close(server);
+        return NULL;
+    }
+    return server;
+}
+
+// Remove a connection from the server and free it
+static void close_connection(QueryServer* server, Connection* connection) {
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_DEL, connection->fd, NULL);
+    close(connection->fd);
+    if (connection->prev != NULL) {
+        connection->prev->next = connection->next;
+    } else {
+        server->connections = connection->next;
+    }
+    if (connection->next != NULL) {
+        connection->next->prev = connection->prev;
+    }
+    free(connection->input);
+    output_buffer_free(&connection->output);
+    free(connection);
+}
+
+// Accept every pending connection
+static void accept_connections(QueryServer* server) {
+    for (;;) {
+        int fd = accept4(server->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                perror("accept");
+            }
+            return;
+        }
+        
+        // Responses are written in batches, so Nagle's algorithm would only add delay
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        
+        Connection* connection = (Connection*)calloc(1, sizeof(Connection));
+        if (connection == NULL || !output_buffer_init(&connection->output, NULL, 64 * 1024)) {
+            fprintf(stderr, "Memory allocation failed for connection\n");
+            free(connection);
+            close(fd);
+            continue;
+        }
+        connection->fd = fd;
+        connection->events = EPOLLIN;
+        if (!watch(server->epoll_fd, fd, connection->events, connection, EPOLL_CTL_ADD)) {
+            perror("epoll_ctl");
+            output_buffer_free(&connection->output);
+            free(connection);
+            close(fd);
+            continue;
+        }
+        
+        connection->next = server->connections;
+        if (server->connections != NULL) server->connections->prev = connection;
+        server->connections = connection;
+        server->stats.connections++;
+    }
+}
+
+// Answer one request by appending its response to the connection's output
+static int handle_request(QueryServer* server, QueryEngine* engine, Connection* connection,
+                          const ProtocolRequest* request) {
+    OutputBuffer* out = &connection->output;
+    void* state = engine->state;
+    
+    switch (request->op) {
+        case PROTOCOL_FLIGHT_BY_ID:
+        case PROTOCOL_FLIGHT_BY_NUMBER: {
+            Flight* flight = request->op == PROTOCOL_FLIGHT_BY_ID
+                             ? engine->find_flight(state, request->flightId)
+                             : engine->find_flight_by_number(state, request->key);
+            return flight != NULL ? protocol_encode_flight(out, request->id, flight)
+                                  : protocol_encode_status(out, request->id, PROTOCOL_NOT_FOUND);
+        }
+        case PROTOCOL_PASSENGER_BY_ID:
+        case PROTOCOL_PASSENGER_BY_NAME: {
+            Passenger* passenger = request->op == PROTOCOL_PASSENGER_BY_ID
+                                   ? engine->find_passenger(state, request->passengerId)
+                                   : engine->find_passenger_by_name(state, request->key);
+            return passenger != NULL ? protocol_encode_passenger(out, request->id, passenger)
+                                     : protocol_encode_status(out, request->id, PROTOCOL_NOT_FOUND);
+        }
+        case PROTOCOL_FLIGHT_BOOKINGS:
+        case PROTOCOL_PASSENGER_BOOKINGS: {
+            int count = request->op == PROTOCOL_FLIGHT_BOOKINGS
+                        ? engine->flight_reservations(state, request->flightId, &server->records, &server->record_capacity)
+                        : engine->passenger_reservations(state, request->passengerId, &server->records, &server->record_capacity);
+            // A list too long for one frame is reported as an error rather than split
+            if (count < 0 || (long long)count * PROTOCOL_BOOKING_SIZE + 16 > PROTOCOL_MAX_PAYLOAD) {
+                return protocol_encode_status(out, request->id, PROTOCOL_ERROR);
+            }
+            return protocol_encode_bookings(out, request->id, server->records, count);
+        }
+        case PROTOCOL_BOOK: {
+            ReservationRecord record;
+            record.flightId = request->flightId;
+            record.passengerId = request->passengerId;
+            record.bookingDate = time(NULL);
+            strncpy(record.seatNumber, request->key, sizeof(record.seatNumber) - 1);
+            record.seatNumber[sizeof(record.seatNumber) - 1] = '\0';
+            int booked = engine->book(state, record);
+            return protocol_encode_status(out, request->id, booked ? PROTOCOL_OK : PROTOCOL_REJECTED);
+        }
+        case PROTOCOL_CANCEL: {
+            int cancelled = engine->cancel(state, request->flightId, request->passengerId);
+            return protocol_encode_status(out, request->id, cancelled ? PROTOCOL_OK : PROTOCOL_NOT_FOUND);
+        }
+        case PROTOCOL_LIST_FLIGHTS: {
+            if (server->flights == NULL) {
+                server->flights = (Flight*)malloc(PROTOCOL_MAX_FLIGHT_PAGE * sizeof(Flight));
+                if (server->flights == NULL) {
+                    return protocol_encode_status(out, request->id, PROTOCOL_ERROR);
+                }
+            }
+            int limit = request->limit < 0 || request->limit > PROTOCOL_MAX_FLIGHT_PAGE ? PROTOCOL_MAX_FLIGHT_PAGE
+                                                                                       : request->limit;
+            int count = engine->list_flights(state, request->flightId, server->flights, limit);
+            return protocol_encode_flights(out, request->id, server->flights, count);
+        }
+        case PROTOCOL_COUNT_FLIGHTS:
+            return protocol_encode_count(out, request->id,
+                                         engine->count_flights(state, request->flightId, request->highId));
+        default:
+            return protocol_encode_status(out, request->id, PROTOCOL_ERROR);
+    }
+}
+
+// Answer every complete request in the input buffer, stopping early if too much output is queued.
+// Returns 0 if the connection sent a malformed frame and must be closed
+static int process_requests(QueryServer* server, QueryEngine* engine, Connection* connection) {
+    size_t offset = 0;
+    while (connection->output.length - connection->output_sent < SERVER_MAX_PENDING_OUTPUT) {
+        long frame = protocol_frame_length(connection->input + offset, connection->input_length - offset);
+        if (frame == 0) break;
+        
+        ProtocolRequest request;
+        if (frame < 0 ||
+            !protocol_decode_request(connection->input + offset + PROTOCOL_HEADER_SIZE,
+                                     (size_t)frame - PROTOCOL_HEADER_SIZE, &request) ||
+            !handle_request(server, engine, connection, &request)) {
+            server->stats.errors++;
+            return 0;
+        }
+        server->stats.requests++;
+        offset += (size_t)frame;
+    }
+    
+    // Keep any partial frame at the front of the buffer
+    connection->input_length -= offset;
+    memmove(connection->input, connection->input + offset, connection->input_length);
+    return 1;
+}
+
+// Read everything available. Returns 0 if the peer closed the connection or an error occurred
+static int read_input(QueryServer* server, Connection* connection) {
+    for (;;) {
+        if (connection->input_capacity - connection->input_length < SERVER_READ_CHUNK) {
+            size_t new_capacity = connection->input_capacity > 0 ? connection->input_capacity * 2 : 2 * SERVER_READ_CHUNK;
+            char* grown = (char*)realloc(connection->input, new_capacity);
+            if (grown == NULL) {
+                fprintf(stderr, "Memory allocation failed for connection input\n");
+                return 0;
+            }
+            connection->input = grown;
+            connection->input_capacity = new_capacity;
+        }
+        
+        ssize_t received = recv(connection->fd, connection->input + connection->input_length,
+                                connection->input_capacity - connection->input_length, 0);
+        if (received > 0) {
+            connection->input_length += (size_t)received;
+            server->stats.bytes_in += received;
+            // Stop once a full frame or more is buffered; the rest is read after answering
+            if (connection->input_length >= PROTOCOL_HEADER_SIZE + PROTOCOL_MAX_PAYLOAD) return 1;
+            continue;
+        }
+        if (received == 0) return 0;
+        if (errno == EINTR) continue;
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+}
+
+// Write as much queued output as the socket accepts. Returns 0 on a write error
+static int flush_output(QueryServer* server, Connection* connection) {
+    OutputBuffer* out = &connection->output;
+    while (connection->output_sent < out->length) {
+        ssize_t sent = send(connection->fd, out->data + connection->output_sent,
+                            out->length - connection->output_sent, MSG_NOSIGNAL);
+        if (sent > 0) {
+            connection->output_sent += (size_t)sent;
+            server->stats.bytes_out += sent;
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        return 0;
+    }
+    
+    if (connection->output_sent == out->length) {
+        out->length = 0;
+        connection->output_sent = 0;
+    }
+    return 1;
+}
+
+// Watch for writability only while output is queued, and stop reading while too much is queued
+static int update_events(QueryServer* server, Connection* connection) {
+    size_t pending = connection->output.length - connection->output_sent;
+    unsigned int events = 0;
+    if (pending < SERVER_MAX_PENDING_OUTPUT) events |= EPOLLIN;
+    if (pending > 0) events |= EPOLLOUT;
+    
+    if (events == connection->events) return 1;
+    connection->events = events;
+    return watch(server->epoll_fd, connection->fd, events, connection, EPOLL_CTL_MOD);
+}
+
+// Handle readiness of one client connection. Returns 0 if it should be closed
+static int service_connection(QueryServer* server, QueryEngine* engine, Connection* connection, unsigned int events) {
+    int open = 1;
+    if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        open = read_input(server, connection);
+    }
+    
+    // Answer whatever arrived (also after the peer half-closed), then write the answers in one go.
+    // If throttling left whole requests unanswered and the output has since drained, carry on,
+    // since a client waiting for those answers will send nothing more to wake us up
+    do {
+        if (!process_requests(server, engine, connection) || !flush_output(server, connection)) {
+            return 0;
+        }
+    } while (connection->output.length == 0 &&
+             protocol_frame_length(connection->input, connection->input_length) != 0);
+    return open && update_events(server, connection);
+}
+
+// Serve requests with the engine until server_stop is called
+int server_run(QueryServer* server, QueryEngine* engine) {
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    int running = 1;
+    
+    while (running) {
+        int ready = epoll_wait(server->epoll_fd, events, SERVER_MAX_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            return 0;
+        }
+        
+        for (int i = 0; i < ready; i++) {
+            void* source = events[i].data.ptr;
+            if (source == &server->wake_fd) {
+                uint64_t value;
+                if (read(server->wake_fd, &value, sizeof(value)) < 0) {
+                    // Already drained: the stop request still stands
+                }
+                running = 0;
+            } else if (source == &server->listen_fd) {
+                accept_connections(server);
+            } else {
+                Connection* connection = (Connection*)source;
+                if (!service_connection(server, engine, connection, events[i].events)) {
+                    close_connection(server, connection);
+                }
+            }
+        }
+    }
+    return 1;
+}
+
+// Ask a running server to stop (write(2) is async-signal-safe)
+void server_stop(QueryServer* server) {
+    uint64_t one = 1;
+    if (server != NULL && write(server->wake_fd, &one, sizeof(one)) < 0) {
+        // The counter is already non-zero, so the loop will wake anyway
+    }
+}
+
+// Totals so far
+ServerStats server_stats(const QueryServer* server) {
+    return server->stats;
+}
+
+// Close every connection and the listening socket, and free the server
+void server_close(QueryServer* server) {
+    if (server == NULL) return;
+    while (server->connections != NULL) {
+        close_connection(server, server->connections);
+    }
+    if (server->listen_fd >= 0) close(server->listen_fd);
+    if (server->epoll_fd >= 0) close(server->epoll_fd);
+    if (server->wake_fd >= 0) close(server->wake_fd);
+    if (server->unix_path[0] != '\0') unlink(server->unix_path);
+    free(server->records);
+    free(server->flights);
+    free(server);
+}
+
+// Connect to a server address as a client
+int server_connect(const char* address) {
+    struct sockaddr_storage storage;
+    socklen_t length;
+    if (!parse_address(address, &storage, &length)) {
+        return -1;
+    }
+    
+    int fd = socket(storage.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    
+    // Connect while blocking, then switch to non-blocking for the event loop
+    if (connect(fd, (struct sockaddr*)&storage, length) != 0) {
+        fprintf(stderr, "Could not connect to %s: %s\n", address, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+#else
+
+// epoll is Linux-only; other platforms get a server that cannot be opened
+
+QueryServer* server_open(const char* address) {
+    fprintf(stderr, "Query server is only supported on Linux (cannot listen on %s)\n", address);
+    return NULL;
+}
+
+int server_run(QueryServer* server, QueryEngine* engine) {
+    (void)server;
+    (void)engine;
+    return 0;
+}
+
+void server_stop(QueryServer* server) {
+    (void)server;
+}
+
+ServerStats server_stats(const QueryServer* server) {
+    ServerStats stats;
+    (void)server;
+    memset(&stats, 0, sizeof(stats));
+    return stats;
+}
+
+void server_close(QueryServer* server) {
+    (void)server;
+}
+
+int server_connect(const char* address) {
+    fprintf(stderr, "Query server is only supported on Linux (cannot connect to %s)\n", address);
+    return -1;
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "engine.h"
+
+// Addresses accepted by the server and the load generator:
+//   unix:<path>          Unix domain socket
+//   tcp:<port>           loopback TCP (127.0.0.1 only)
+
+// Output queued for one connection before the server stops reading its requests (bytes)
+#define SERVER_MAX_PENDING_OUTPUT (8 * 1024 * 1024)
+
+// Totals kept while serving
+typedef struct {
+    long long connections;
+    long long requests;
+    long long errors;  // Malformed requests (the connection is closed)
+    long long bytes_in;
+    long long bytes_out;
+} ServerStats;
+
+typedef struct QueryServer QueryServer;
+
+// Bind and listen on an address. Returns NULL on failure
+QueryServer* server_open(const char* address);
+
+// Serve requests with the engine until server_stop is called. Returns 1 on a clean stop
+int server_run(QueryServer* server, QueryEngine* engine);
+
+// Ask a running server to stop. Safe to call from another thread or a signal handler
+void server_stop(QueryServer* server);
+
+// Totals so far
+ServerStats server_stats(const QueryServer* server);
+
+// Close the listening socket (removing a Unix socket file) and free the server
+void server_close(QueryServer* server);
+
+// Connect to a server address as a client. Returns a non-blocking socket, or -1 on failure
+int server_connect(const char* address);
+
+#endif
@@ -0,0 +1,363 @@
+/*
+ * Sharded Booking Engine
+ *
+ * Reservations are partitioned into shards by flight ID, each with its own
+ * mutex, reservation BST and a table of its flights' passenger counts. Every
+ * decision about a flight (is it full, is the seat free) and the insert that
+ * follows happen under that flight's shard lock, so bookings are linearizable
+ * per flight while bookings on other shards proceed in parallel. Keeping the
+ * passenger count alongside the shard turns the capacity check into a lookup
+ * instead of a walk over the flight's reservations.
+ *
+ * Itineraries lock all of their shards in ascending order before checking any
+ * leg (two-phase locking with a global lock order), so they are all-or-nothing
+ * and can never deadlock against each other.
+ *
+ * Sources used:
+ * 1. "The Art of Multiprocessor Programming" by Herlihy and Shavit - Lock striping and linearizability
+ * 2. "Concurrency Control and Recovery in Database Systems" by Bernstein et al. - Two-phase locking
+ * 3. POSIX Threads Programming (Lawrence Livermore National Laboratory) - pthread mutexes
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "sharded_engine.h"
+#include "prototype2/flight_management_avl.h"
+#include "prototype2/passenger_management_hash.h"
+#include "prototype2/reservation_management_bst.h"
+#include "prototype2/flight_search_avl.h"
+#include "prototype2/passenger_search_hash.h"
+
+// Passenger count of one flight
+typedef struct {
+    int flightId;
+    int capacity;
+    int passengers;  // Distinct passengers holding a reservation
+} FlightLoad;
+
+// One shard, padded to a cache line so shard locks don't share lines
+typedef struct {
+    pthread_mutex_t lock;
+    ReservationBST* reservations;
+    FlightLoad* loads;  // Sorted by flight ID
+    int load_count;
+} __attribute__((aligned(64))) BookingShard;
+
+typedef struct {
+    BookingShard shards[SHARDED_ENGINE_SHARDS];
+    AVL_Node* flights_root;
+    PassengerHashTable* passengers_table;
+    int locks_ready;
+} ShardedState;
+
+static int shard_index(int flightId) {
+    return (int)((unsigned int)flightId % SHARDED_ENGINE_SHARDS);
+}
+
+static BookingShard* shard_for(ShardedState* state, int flightId) {
+    return &state->shards[shard_index(flightId)];
+}
+
+// Binary search for a flight's load in its shard
+static FlightLoad* find_load(BookingShard* shard, int flightId) {
+    int low = 0;
+    int high = shard->load_count - 1;
+    while (low <= high) {
+        int mid = low + (high - low) / 2;
+        if (shard->loads[mid].flightId == flightId) {
+            return &shard->loads[mid];
+        }
+        if (shard->loads[mid].flightId < flightId) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return NULL;
+}
+
+// Comparison function for qsort
+static int compare_loads(const void* a, const void* b) {
+    int x = ((const FlightLoad*)a)->flightId;
+    int y = ((const FlightLoad*)b)->flightId;
+    return (x > y) - (x < y);
+}
+
+//--- BOOKING (shard lock held) ---//
+
+// Check a booking against its shard. Sets *new_passenger if the passenger isn't on the flight yet
+static int booking_allowed(BookingShard* shard, const ReservationRecord* record, int* new_passenger) {
+    FlightLoad* load = find_load(shard, record->flightId);
+    if (load == NULL) {
+        return 0;
+    }
+    if (record->seatNumber[0] != '\0' && is_seat_taken_bst(shard->reservations, record->flightId, record->seatNumber)) {
+        return 0;
+    }
+    *new_passenger = !has_reservation_bst(shard->reservations, record->flightId, record->passengerId);
+    return !*new_passenger || load->passengers < load->capacity;
+}
+
+static void apply_booking(BookingShard* shard, const ReservationRecord* record, int new_passenger) {
+    add_reservation_bst(shard->reservations, *record);
+    if (new_passenger) {
+        find_load(shard, record->flightId)->passengers++;
+    }
+}
+
+//--- OPERATIONS ---//
+
+// Flights and passengers are never modified after the build, so lookups need no lock
+static Flight* s_find_flight(void* state, int flightId) {
+    return avl_find_flight(((ShardedState*)state)->flights_root, flightId);
+}
+
+static Flight* s_find_flight_by_number(void* state, const char* flightNumber) {
+    return avl_find_flight_by_number(((ShardedState*)state)->flights_root, flightNumber);
+}
+
+static int s_list_flights(void* state, int afterId, Flight* page, int limit) {
+    return avl_list_flights_after(((ShardedState*)state)->flights_root, afterId, page, limit);
+}
+
+static int s_count_flights(void* state, int lowId, int highId) {
+    return avl_count_range(((ShardedState*)state)->flights_root, lowId, highId);
+}
+
+static Passenger* s_find_passenger(void* state, int passengerId) {
+    return hash_find_passenger(((ShardedState*)state)->passengers_table, passengerId);
+}
+
+static Passenger* s_find_passenger_by_name(void* state, const char* name) {
+    return hash_find_passenger_by_name(((ShardedState*)state)->passengers_table, name);
+}
+
+// A passenger's bookings are spread over every shard; flights never span shards,
+// so the per-shard flight counts add up
+static int s_count_passenger_bookings(void* state, int passengerId) {
+    ShardedState* s = (ShardedState*)state;
+    int total = 0;
+    for (int i = 0; i < SHARDED_ENGINE_SHARDS; i++) {
+        pthread_mutex_lock(&s->shards[i].lock);
+        total += count_flights_by_passenger(s->shards[i].reservations, passengerId);
+        pthread_mutex_unlock(&s->shards[i].lock);
+    }
+    return total;
+}
+
+static int s_passenger_reservations(void* state, int passengerId, ReservationRecord** records, int* capacity) {
+    ShardedState* s = (ShardedState*)state;
+    ReservationRecord* part = NULL;
+    int part_capacity = 0;
+    int total = 0;
+    for (int i = 0; i < SHARDED_ENGINE_SHARDS && total >= 0; i++) {
+        pthread_mutex_lock(&s->shards[i].lock);
+        int count = find_reservations_by_passenger_bst(s->shards[i].reservations, passengerId, &part, &part_capacity);
+        pthread_mutex_unlock(&s->shards[i].lock);
+        if (count <= 0) {
+            if (count < 0) total = -1;
+            continue;
+        }
+        
+        if (total + count > *capacity) {
+            ReservationRecord* grown = (ReservationRecord*)realloc(*records, (total + count) * sizeof(ReservationRecord));
+            if (grown == NULL) {
+                fprintf(stderr, "Memory allocation failed when collecting reservations\n");
+                total = -1;
+                continue;
+            }
+            *records = grown;
+            *capacity = total + count;
+        }
+        memcpy(*records + total, part, count * sizeof(ReservationRecord));
+        total += count;
+    }
+    free(part);
+    return total;
+}
+
+static int s_flight_reservations(void* state, int flightId, ReservationRecord** records, int* capacity) {
+    BookingShard* shard = shard_for((ShardedState*)state, flightId);
+    pthread_mutex_lock(&shard->lock);
+    int count = find_reservations_by_flight_bst(shard->reservations, flightId, records, capacity);
+    pthread_mutex_unlock(&shard->lock);
+    return count;
+}
+
+static int s_book(void* state, ReservationRecord record) {
+    BookingShard* shard = shard_for((ShardedState*)state, record.flightId);
+    int new_passenger = 0;
+    pthread_mutex_lock(&shard->lock);
+    int allowed = booking_allowed(shard, &record, &new_passenger);
+    if (allowed) {
+        apply_booking(shard, &record, new_passenger);
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return allowed;
+}
+
+static int s_cancel(void* state, int flightId, int passengerId) {
+    BookingShard* shard = shard_for((ShardedState*)state, flightId);
+    pthread_mutex_lock(&shard->lock);
+    int cancelled = cancel_reservation_bst(shard->reservations, flightId, passengerId);
+    // The passenger only leaves the flight once their last seat on it is gone
+    if (cancelled && !has_reservation_bst(shard->reservations, flightId, passengerId)) {
+        FlightLoad* load = find_load(shard, flightId);
+        if (load != NULL) load->passengers--;
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return cancelled;
+}
+
+static void s_destroy(void* state) {
+    ShardedState* s = (ShardedState*)state;
+    for (int i = 0; i < SHARDED_ENGINE_SHARDS; i++) {
+        if (s->locks_ready) pthread_mutex_destroy(&s->shards[i].lock);
+        free_reservation_bst(s->shards[i].reservations);
+        free(s->shards[i].loads);
+    }
+    free_avl_tree(s->flights_root);
+    free_hash_table(s->passengers_table);
+    free(s);
+}
+
+// Book every leg of an itinerary or none of them
+int sharded_book_itinerary(QueryEngine* engine, const ReservationRecord* legs, int leg_count) {
+    if (engine == NULL || legs == NULL || leg_count < 1 || leg_count > SHARDED_MAX_LEGS) {
+        return 0;
+    }
+    ShardedState* state = (ShardedState*)engine->state;
+    
+    // A flight may appear only once; collect the distinct shards in ascending order
+    int shards[SHARDED_MAX_LEGS];
+    int shard_count = 0;
+    for (int i = 0; i < leg_count; i++) {
+        for (int j = 0; j < i; j++) {
+            if (legs[j].flightId == legs[i].flightId) return 0;
+        }
+        int index = shard_index(legs[i].flightId);
+        int position = shard_count;
+        while (position > 0 && shards[position - 1] > index) position--;
+        if (position > 0 && shards[position - 1] == index) continue;
+        memmove(&shards[position + 1], &shards[position], (shard_count - position) * sizeof(int));
+        shards[position] = index;
+        shard_count++;
+    }
+    
+    // Growing phase: take every lock before looking at any leg
+    for (int i = 0; i < shard_count; i++) {
+        pthread_mutex_lock(&state->shards[shards[i]].lock);
+    }
+    
+    int new_passenger[SHARDED_MAX_LEGS];
+    int allowed = 1;
+    for (int i = 0; i < leg_count && allowed; i++) {
+        allowed = booking_allowed(shard_for(state, legs[i].flightId), &legs[i], &new_passenger[i]);
+    }
+    if (allowed) {
+        for (int i = 0; i < leg_count; i++) {
+            apply_booking(shard_for(state, legs[i].flightId), &legs[i], new_passenger[i]);
+        }
+    }
+    
+    // Shrinking phase
+    for (int i = shard_count - 1; i >= 0; i--) {
+        pthread_mutex_unlock(&state->shards[shards[i]].lock);
+    }
+    return allowed;
+}
+
+// Build the sharded engine from the given data
+QueryEngine* create_sharded_engine(const Flight* flights, int flight_count,
+                                   const Passenger* passengers, int passenger_count,
+                                   const ReservationRecord* reservations, int reservation_count) {
+    QueryEngine* engine = (QueryEngine*)malloc(sizeof(QueryEngine));
+    // Cache-line aligned so every shard sits on its own line
+    ShardedState* state = NULL;
+    if (posix_memalign((void**)&state, 64, sizeof(ShardedState)) != 0) {
+        state = NULL;
+    }
+    if (engine == NULL || state == NULL) {
+        fprintf(stderr, "Memory allocation failed for sharded engine\n");
+        free(engine);
+        free(state);
+        return NULL;
+    }
+    memset(state, 0, sizeof(ShardedState));
+    
+    int ok = 1;
+    for (int i = 0; i < SHARDED_ENGINE_SHARDS; i++) {
+        ok &= pthread_mutex_init(&state->shards[i].lock, NULL) == 0;
+    }
+    state->locks_ready = ok;
+    
+    // Size each shard's flight table, then fill and sort it
+    for (int i = 0; i < flight_count; i++) {
+        shard_for(state, flights[i].id)->load_count++;
+    }
+    for (int i = 0; ok && i < SHARDED_ENGINE_SHARDS; i++) {
+        BookingShard* shard = &state->shards[i];
+        shard->reservations = init_reservation_bst();
+        shard->loads = (FlightLoad*)malloc((shard->load_count > 0 ? shard->load_count : 1) * sizeof(FlightLoad));
+        ok = shard->reservations != NULL && shard->loads != NULL;
+        shard->load_count = 0;
+    }
+    state->passengers_table = init_hash_table(passenger_count > 0 ? passenger_count * 2 : 16);
+    if (!ok || state->passengers_table == NULL) {
+        fprintf(stderr, "Could not set up the sharded engine\n");
+        s_destroy(state);
+        free(engine);
+        return NULL;
+    }
+    
+    for (int i = 0; i < flight_count; i++) {
+        state->flights_root = avl_insert(state->flights_root, flights[i]);
+        BookingShard* shard = shard_for(state, flights[i].id);
+        FlightLoad load = {flights[i].id, flights[i].capacity, 0};
+        shard->loads[shard->load_count++] = load;
+    }
+    for (int i = 0; i < SHARDED_ENGINE_SHARDS; i++) {
+        qsort(state->shards[i].loads, state->shards[i].load_count, sizeof(FlightLoad), compare_loads);
+    }
+    for (int i = 0; i < passenger_count; i++) {
+        hash_insert_passenger(state->passengers_table, passengers[i]);
+    }
+    
+    // Filters go on before the reservations so the load's duplicate checks use them too
+    if (engine_bloom_fp_rate() > 0.0) {
+        hash_enable_filter(state->passengers_table, engine_bloom_fp_rate());
+        for (int i = 0; i < SHARDED_ENGINE_SHARDS; i++) {
+            reservation_bst_enable_filter(state->shards[i].reservations, reservation_count / SHARDED_ENGINE_SHARDS + 1,
+                                          engine_bloom_fp_rate());
+        }
+    }
+    
+    // Loaded reservations are taken as they are, but still counted towards their flights
+    for (int i = 0; i < reservation_count; i++) {
+        BookingShard* shard = shard_for(state, reservations[i].flightId);
+        FlightLoad* load = find_load(shard, reservations[i].flightId);
+        if (load != NULL && !has_reservation_bst(shard->reservations, reservations[i].flightId,
+                                                 reservations[i].passengerId)) {
+            load->passengers++;
+        }
+        add_reservation_bst(shard->reservations, reservations[i]);
+    }
+    
+    engine->name = "Sharded Bookings (AVL Tree / Hash Table / per-flight BST shards)";
+    engine->state = state;
+    engine->find_flight = s_find_flight;
+    engine->find_flight_by_number = s_find_flight_by_number;
+    engine->find_passenger = s_find_passenger;
+    engine->find_passenger_by_name = s_find_passenger_by_name;
+    engine->count_passenger_bookings = s_count_passenger_bookings;
+    engine->passenger_reservations = s_passenger_reservations;
+    engine->flight_reservations = s_flight_reservations;
+    engine->list_flights = s_list_flights;
+    engine->count_flights = s_count_flights;
+    engine->book = s_book;
+    engine->cancel = s_cancel;
+    engine->destroy = s_destroy;
+    return engine;
+}
@@ -0,0 +1,26 @@
+#ifndef SHARDED_ENGINE_H
+#define SHARDED_ENGINE_H
+
+#include "engine.h"
+
+// Number of reservation shards (flight ID modulo this picks the shard)
+#define SHARDED_ENGINE_SHARDS 64
+
+// Most legs accepted in one itinerary booking
+#define SHARDED_MAX_LEGS 8
+
+// Build a booking engine that partitions reservations by flight into independently locked
+// shards. Each shard keeps its own reservation BST and the passenger count of each of its
+// flights, so a booking checks capacity and seat availability and inserts under one shard
+// lock: bookings on flights in different shards never wait for each other.
+// Bookings are rejected if the flight is full or the seat is already held on that flight
+QueryEngine* create_sharded_engine(const Flight* flights, int flight_count,
+                                   const Passenger* passengers, int passenger_count,
+                                   const ReservationRecord* reservations, int reservation_count);
+
+// Book every leg of an itinerary or none of them. Shard locks are taken in ascending shard
+// order and all released after the inserts, so concurrent itineraries can't deadlock.
+// The engine must come from create_sharded_engine. Returns 1 if every leg was booked
+int sharded_book_itinerary(QueryEngine* engine, const ReservationRecord* legs, int leg_count);
+
+#endif
@@ -0,0 +1,322 @@
+/*
+ * Vectorised Column Scans
+ *
+ * Equality scans compare 4 (SSE2) or 8 (AVX2) ints per instruction; counts accumulate the
+ * all-ones compare results in vector registers and add the lanes once at the end. Substring
+ * search compares 16 or 32 starting positions at once against the pattern's first and last
+ * bytes and only checks the bytes between for positions where both match. AVX2 is compiled
+ * per function and picked at run time, so the binary still runs on SSE2-only CPUs.
+ *
+ * Sources used:
+ * 1. Intel Intrinsics Guide - SSE2 and AVX2 compare, movemask and arithmetic intrinsics
+ * 2. GCC manual - Function target attributes and __builtin_cpu_supports
+ * 3. "SIMD-friendly algorithms for substring searching" by Wojciech Mula - First/last byte filter
+ */
+
+#include <string.h>
+#include "simd_scan.h"
+
+// Occurrences of the pattern from position i on, one position at a time. Returns where the
+// scan ended, or -1 if the callback stopped it
+static long scan_bytes_scalar(const char* text, long length, const char* pattern, long pattern_length, long i,
+                              SimdMatchFn on_match, void* context, long* calls) {
+    while (i + pattern_length <= length) {
+        if (text[i] == pattern[0] && memcmp(text + i, pattern, pattern_length) == 0) {
+            (*calls)++;
+            long resume = on_match(i, context);
+            if (resume < 0) return -1;
+            i = resume > i ? resume : i + 1;
+        } else {
+            i++;
+        }
+    }
+    return i;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_SCAN_X86 1
+#else
+#define SIMD_SCAN_X86 0
+#endif
+
+#if SIMD_SCAN_X86
+
+// 2 when the CPU has AVX2, 1 otherwise (SSE2 is part of x86-64); -1 until checked
+static int simd_level = -1;
+
+// Check the CPU once
+static int detect_level() {
+    if (simd_level < 0) {
+        __builtin_cpu_init();
+        simd_level = __builtin_cpu_supports("avx2") ? 2 : 1;
+    }
+    return simd_level;
+}
+
+// First match, 4 ints at a time
+static int find_equal_sse2(const int* values, int count, int key) {
+    __m128i wanted = _mm_set1_epi32(key);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(values + i));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block, wanted)));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    for (; i < count; i++) {
+        if (values[i] == key) return i;
+    }
+    return -1;
+}
+
+// Matches, 4 ints at a time: each all-ones lane subtracts -1 from its counter
+static int count_equal_sse2(const int* values, int count, int key) {
+    __m128i wanted = _mm_set1_epi32(key);
+    __m128i counts = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(values + i));
+        counts = _mm_sub_epi32(counts, _mm_cmpeq_epi32(block, wanted));
+    }
+    int lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, counts);
+    int total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < count; i++) {
+        total += values[i] == key;
+    }
+    return total;
+}
+
+// Neighbours that are equal, 4 pairs at a time
+static int count_repeats_sse2(const int* values, int count) {
+    __m128i counts = _mm_setzero_si128();
+    int i = 1;
+    for (; i + 4 <= count; i += 4) {
+        __m128i current = _mm_loadu_si128((const __m128i*)(values + i));
+        __m128i previous = _mm_loadu_si128((const __m128i*)(values + i - 1));
+        counts = _mm_sub_epi32(counts, _mm_cmpeq_epi32(current, previous));
+    }
+    int lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, counts);
+    int total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < count; i++) {
+        total += values[i] == values[i - 1];
+    }
+    return total;
+}
+
+// Occurrences of the pattern (at least 1 byte) from position i on, testing 16 starting
+// positions at a time; candidates before the callback's resume position are dropped. Returns
+// where the vector loop ended, or -1 if the callback stopped the scan
+static long scan_bytes_sse2(const char* text, long length, const char* pattern, long pattern_length, long i,
+                            SimdMatchFn on_match, void* context, long* calls) {
+    __m128i first = _mm_set1_epi8(pattern[0]);
+    __m128i last = _mm_set1_epi8(pattern[pattern_length - 1]);
+    long middle = pattern_length > 2 ? pattern_length - 2 : 0;
+    while (i + pattern_length - 1 + 16 <= length) {
+        __m128i heads = _mm_loadu_si128((const __m128i*)(text + i));
+        __m128i tails = _mm_loadu_si128((const __m128i*)(text + i + pattern_length - 1));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(heads, first), _mm_cmpeq_epi8(tails, last)));
+        long next = i + 16;
+        while (mask != 0) {
+            int bit = __builtin_ctz(mask);
+            mask &= mask - 1;
+            if (memcmp(text + i + bit + 1, pattern + 1, middle) != 0) continue;
+            (*calls)++;
+            long resume = on_match(i + bit, context);
+            if (resume < 0) return -1;
+            if (resume >= next) {
+                next = resume;
+                break;
+            }
+            if (resume > i + bit + 1) mask &= ~0u << (resume - i);
+        }
+        i = next;
+    }
+    return i;
+}
+
+// First match, 16 ints per iteration in two 8-lane compares
+__attribute__((target("avx2")))
+static int find_equal_avx2(const int* values, int count, int key) {
+    __m256i wanted = _mm256_set1_epi32(key);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i low = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(values + i)), wanted);
+        __m256i high = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(values + i + 8)), wanted);
+        if (!_mm256_testz_si256(_mm256_or_si256(low, high), _mm256_or_si256(low, high))) {
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(low));
+            if (mask != 0) return i + __builtin_ctz(mask);
+            return i + 8 + __builtin_ctz(_mm256_movemask_ps(_mm256_castsi256_ps(high)));
+        }
+    }
+    int rest = find_equal_sse2(values + i, count - i, key);
+    return rest < 0 ? -1 : i + rest;
+}
+
+// Matches, 8 ints at a time
+__attribute__((target("avx2")))
+static int count_equal_avx2(const int* values, int count, int key) {
+    __m256i wanted = _mm256_set1_epi32(key);
+    __m256i counts = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(values + i));
+        counts = _mm256_sub_epi32(counts, _mm256_cmpeq_epi32(block, wanted));
+    }
+    int lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, counts);
+    int total = 0;
+    for (int l = 0; l < 8; l++) {
+        total += lanes[l];
+    }
+    return total + count_equal_sse2(values + i, count - i, key);
+}
+
+// Neighbours that are equal, 8 pairs at a time
+__attribute__((target("avx2")))
+static int count_repeats_avx2(const int* values, int count) {
+    __m256i counts = _mm256_setzero_si256();
+    int i = 1;
+    for (; i + 8 <= count; i += 8) {
+        __m256i current = _mm256_loadu_si256((const __m256i*)(values + i));
+        __m256i previous = _mm256_loadu_si256((const __m256i*)(values + i - 1));
+        counts = _mm256_sub_epi32(counts, _mm256_cmpeq_epi32(current, previous));
+    }
+    int lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, counts);
+    int total = 0;
+    for (int l = 0; l < 8; l++) {
+        total += lanes[l];
+    }
+    for (; i < count; i++) {
+        total += values[i] == values[i - 1];
+    }
+    return total;
+}
+
+// Occurrences of the pattern (at least 1 byte) from position i on, 32 starting positions at a time
+__attribute__((target("avx2")))
+static long scan_bytes_avx2(const char* text, long length, const char* pattern, long pattern_length, long i,
+                            SimdMatchFn on_match, void* context, long* calls) {
+    __m256i first = _mm256_set1_epi8(pattern[0]);
+    __m256i last = _mm256_set1_epi8(pattern[pattern_length - 1]);
+    long middle = pattern_length > 2 ? pattern_length - 2 : 0;
+    while (i + pattern_length - 1 + 32 <= length) {
+        __m256i heads = _mm256_loadu_si256((const __m256i*)(text + i));
+        __m256i tails = _mm256_loadu_si256((const __m256i*)(text + i + pattern_length - 1));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(heads, first), _mm256_cmpeq_epi8(tails, last)));
+        long next = i + 32;
+        while (mask != 0) {
+            int bit = __builtin_ctz(mask);
+            mask &= mask - 1;
+            if (memcmp(text + i + bit + 1, pattern + 1, middle) != 0) continue;
+            (*calls)++;
+            long resume = on_match(i + bit, context);
+            if (resume < 0) return -1;
+            if (resume >= next) {
+                next = resume;
+                break;
+            }
+            if (resume > i + bit + 1) mask &= ~0u << (resume - i);
+        }
+        i = next;
+    }
+    return i;
+}
+
+#endif
+
+// Index of the first value equal to `key`, or -1
+int simd_find_equal_i32(const int* values, int count, int key) {
+#if SIMD_SCAN_X86
+    return detect_level() == 2 ? find_equal_avx2(values, count, key) : find_equal_sse2(values, count, key);
+#else
+    for (int i = 0; i < count; i++) {
+        if (values[i] == key) return i;
+    }
+    return -1;
+#endif
+}
+
+// Number of values equal to `key`
+int simd_count_equal_i32(const int* values, int count, int key) {
+#if SIMD_SCAN_X86
+    return detect_level() == 2 ? count_equal_avx2(values, count, key) : count_equal_sse2(values, count, key);
+#else
+    int total = 0;
+    for (int i = 0; i < count; i++) {
+        total += values[i] == key;
+    }
+    return total;
+#endif
+}
+
+// Number of runs of equal values
+int simd_count_runs_i32(const int* values, int count) {
+    if (count <= 0) return 0;
+#if SIMD_SCAN_X86
+    int repeats = detect_level() == 2 ? count_repeats_avx2(values, count) : count_repeats_sse2(values, count);
+#else
+    int repeats = 0;
+    for (int i = 1; i < count; i++) {
+        repeats += values[i] == values[i - 1];
+    }
+#endif
+    return count - repeats;
+}
+
+// Report occurrences of a byte pattern to a callback, resuming where it says
+long simd_scan_bytes(const char* text, long length, const char* pattern, long pattern_length,
+                     SimdMatchFn on_match, void* context) {
+    long calls = 0;
+    long i = 0;
+    if (pattern_length <= 0) {
+        // The empty pattern occurs everywhere, so only the callback moves the scan on
+        while (i <= length) {
+            calls++;
+            long resume = on_match(i, context);
+            if (resume < 0) break;
+            i = resume > i ? resume : i + 1;
+        }
+        return calls;
+    }
+#if SIMD_SCAN_X86
+    if (detect_level() == 2) {
+        i = scan_bytes_avx2(text, length, pattern, pattern_length, i, on_match, context, &calls);
+    }
+    if (i >= 0) {
+        i = scan_bytes_sse2(text, length, pattern, pattern_length, i, on_match, context, &calls);
+    }
+#endif
+    if (i >= 0) {
+        scan_bytes_scalar(text, length, pattern, pattern_length, i, on_match, context, &calls);
+    }
+    return calls;
+}
+
+// Keep the first occurrence and stop
+static long stop_at_first(long position, void* context) {
+    *(long*)context = position;
+    return -1;
+}
+
+// Offset of the first occurrence of a byte pattern in text, or -1
+long simd_find_bytes(const char* text, long length, const char* pattern, long pattern_length) {
+    long found = -1;
+    simd_scan_bytes(text, length, pattern, pattern_length, stop_at_first, &found);
+    return found;
+}
+
+// Name of the instruction set the scans use
+const char* simd_scan_isa() {
+#if SIMD_SCAN_X86
+    return detect_level() == 2 ? "avx2" : "sse2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,32 @@
+#ifndef SIMD_SCAN_H
+#define SIMD_SCAN_H
+
+// Scans over int columns and byte strings, with SSE2 and (when the CPU has it) AVX2 versions on x86-64 and
+// plain loops elsewhere
+
+// Index of the first value equal to `key`, or -1
+int simd_find_equal_i32(const int* values, int count, int key);
+
+// Number of values equal to `key`
+int simd_count_equal_i32(const int* values, int count, int key);
+
+// Number of runs of equal values (for sorted values, the number of distinct values)
+int simd_count_runs_i32(const int* values, int count);
+
+// Called with the offset of each occurrence; returns the offset to resume the search from
+// (occurrences before it are skipped), or a negative value to stop
+typedef long (*SimdMatchFn)(long position, void* context);
+
+// Report the occurrences of a byte pattern in text (exact bytes; fold case first for a
+// case-insensitive search) to on_match, left to right, without leaving the vector loop between
+// them. Never reads past text + length. Returns the number of occurrences reported
+long simd_scan_bytes(const char* text, long length, const char* pattern, long pattern_length,
+                     SimdMatchFn on_match, void* context);
+
+// Offset of the first occurrence of a byte pattern in text, or -1. An empty pattern matches at 0
+long simd_find_bytes(const char* text, long length, const char* pattern, long pattern_length);
+
+// Name of the instruction set the scans use ("avx2", "sse2" or "scalar")
+const char* simd_scan_isa();
+
+#endif
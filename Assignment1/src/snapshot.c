@@ -0,0 +1,196 @@
+/*
+ * Binary Snapshot Implementation
+ * 
+ * Writes and reads datasets as raw record arrays, which avoids CSV formatting and
+ * parsing entirely when a dataset only needs to be reloaded by this program.
+ * 
+ * Sources used:
+ * 1. The C Programming Language (K&R) - Binary file I/O with fread/fwrite
+ * 2. "C Interfaces and Implementations" by David R. Hanson - Self-describing file headers
+ */
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "snapshot.h"
+
+// Create a snapshot file and write its header
+FILE* snapshot_create(const char* path, int section_count) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Could not open snapshot %s for writing\n", path);
+        return NULL;
+    }
+    
+    uint32_t version = SNAPSHOT_VERSION;
+    uint32_t sections = (uint32_t)section_count;
+    if (fwrite(SNAPSHOT_MAGIC, 1, 8, file) != 8 ||
+        fwrite(&version, sizeof(version), 1, file) != 1 ||
+        fwrite(&sections, sizeof(sections), 1, file) != 1) {
+        fprintf(stderr, "Error writing snapshot header to %s\n", path);
+        fclose(file);
+        return NULL;
+    }
+    return file;
+}
+
+// Append one section
+int snapshot_write_section(FILE* file, uint32_t type, uint32_t record_size, const void* records, uint64_t count) {
+    SnapshotSectionHeader header;
+    header.type = type;
+    header.record_size = record_size;
+    header.count = count;
+    
+    if (fwrite(&header, sizeof(header), 1, file) != 1) {
+        return 0;
+    }
+    if (count > 0 && fwrite(records, record_size, (size_t)count, file) != (size_t)count) {
+        return 0;
+    }
+    return 1;
+}
+
+// Open a snapshot and validate its header
+FILE* snapshot_open(const char* path, int* section_count) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Could not open snapshot %s\n", path);
+        return NULL;
+    }
+    
+    char magic[8];
+    uint32_t version;
+    uint32_t sections;
+    if (fread(magic, 1, 8, file) != 8 || memcmp(magic, SNAPSHOT_MAGIC, 8) != 0 ||
+        fread(&version, sizeof(version), 1, file) != 1 || version != SNAPSHOT_VERSION ||
+        fread(&sections, sizeof(sections), 1, file) != 1) {
+        fprintf(stderr, "%s is not a version %d snapshot\n", path, SNAPSHOT_VERSION);
+        fclose(file);
+        return NULL;
+    }
+    
+    *section_count = (int)sections;
+    return file;
+}
+
+// Read the next section header
+int snapshot_read_section_header(FILE* file, SnapshotSectionHeader* header) {
+    return fread(header, sizeof(*header), 1, file) == 1;
+}
+
+// Read the records of the section whose header was just read
+void* snapshot_read_section(FILE* file, const SnapshotSectionHeader* header) {
+    size_t bytes = (size_t)header->count * header->record_size;
+    void* records = malloc(bytes > 0 ? bytes : 1);
+    if (records == NULL) {
+        fprintf(stderr, "Memory allocation failed for snapshot section (%zu bytes)\n", bytes);
+        return NULL;
+    }
+    if (bytes > 0 && fread(records, 1, bytes, file) != bytes) {
+        fprintf(stderr, "Snapshot section is truncated\n");
+        free(records);
+        return NULL;
+    }
+    return records;
+}
+
+// Skip the records of the section whose header was just read
+int snapshot_skip_section(FILE* file, const SnapshotSectionHeader* header) {
+    long bytes = (long)(header->count * header->record_size);
+    return fseek(file, bytes, SEEK_CUR) == 0;
+}
+
+// Save flights, passengers and reservations as one snapshot
+int save_data_to_snapshot(const Flight* flights, int flight_count,
+                          const Passenger* passengers, int passenger_count,
+                          const ReservationRecord* reservations, int reservation_count,
+                          const char* path) {
+    FILE* file = snapshot_create(path, 3);
+    if (file == NULL) {
+        return 0;
+    }
+    
+    int ok = snapshot_write_section(file, SNAPSHOT_SECTION_FLIGHTS, sizeof(Flight), flights, flight_count) &&
+             snapshot_write_section(file, SNAPSHOT_SECTION_PASSENGERS, sizeof(Passenger), passengers, passenger_count) &&
+             snapshot_write_section(file, SNAPSHOT_SECTION_RESERVATIONS, sizeof(ReservationRecord),
+                                    reservations, reservation_count);
+    if (fclose(file) != 0) {
+        ok = 0;
+    }
+    if (!ok) {
+        fprintf(stderr, "Error writing snapshot %s\n", path);
+    }
+    return ok;
+}
+
+// Load a snapshot written by save_data_to_snapshot
+int load_data_from_snapshot(const char* path,
+                            Flight** flights, int* flight_count,
+                            Passenger** passengers, int* passenger_count,
+                            ReservationRecord** reservations, int* reservation_count) {
+    int section_count;
+    FILE* file = snapshot_open(path, &section_count);
+    if (file == NULL) {
+        return 0;
+    }
+    
+    *flights = NULL;
+    *passengers = NULL;
+    *reservations = NULL;
+    *flight_count = 0;
+    *passenger_count = 0;
+    *reservation_count = 0;
+    
+    int ok = 1;
+    for (int i = 0; i < section_count && ok; i++) {
+        SnapshotSectionHeader header;
+        if (!snapshot_read_section_header(file, &header)) {
+            ok = 0;
+            break;
+        }
+        
+        // Sections we don't know about (or with a different record layout) are skipped
+        void** target = NULL;
+        int* target_count = NULL;
+        uint32_t expected_size = 0;
+        if (header.type == SNAPSHOT_SECTION_FLIGHTS) {
+            target = (void**)flights;
+            target_count = flight_count;
+            expected_size = sizeof(Flight);
+        } else if (header.type == SNAPSHOT_SECTION_PASSENGERS) {
+            target = (void**)passengers;
+            target_count = passenger_count;
+            expected_size = sizeof(Passenger);
+        } else if (header.type == SNAPSHOT_SECTION_RESERVATIONS) {
+            target = (void**)reservations;
+            target_count = reservation_count;
+            expected_size = sizeof(ReservationRecord);
+        }
+        
+        if (target == NULL || header.record_size != expected_size) {
+            ok = snapshot_skip_section(file, &header);
+            continue;
+        }
+        
+        *target = snapshot_read_section(file, &header);
+        *target_count = (int)header.count;
+        ok = *target != NULL;
+    }
+    fclose(file);
+    
+    if (!ok || *flights == NULL || *passengers == NULL || *reservations == NULL) {
+        fprintf(stderr, "Snapshot %s is incomplete\n", path);
+        free(*flights);
+        free(*passengers);
+        free(*reservations);
+        *flights = NULL;
+        *passengers = NULL;
+        *reservations = NULL;
+        *flight_count = 0;
+        *passenger_count = 0;
+        *reservation_count = 0;
+        return 0;
+    }
+    return 1;
+}
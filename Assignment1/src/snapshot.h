@@ -0,0 +1,58 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "airline_types.h"
+
+// Binary snapshot format:
+//   header:  magic "AIRSNAP1", uint32 version, uint32 section count
+//   section: uint32 type, uint32 record size, uint64 record count, then the raw records
+// Records are written in host byte order and struct layout, so a snapshot is only
+// meant to be read back by a build for the same platform
+#define SNAPSHOT_MAGIC "AIRSNAP1"
+#define SNAPSHOT_VERSION 1
+
+// Section types
+#define SNAPSHOT_SECTION_FLIGHTS 1
+#define SNAPSHOT_SECTION_PASSENGERS 2
+#define SNAPSHOT_SECTION_RESERVATIONS 3
+
+// Header that precedes each section's records
+typedef struct {
+    uint32_t type;
+    uint32_t record_size;
+    uint64_t count;
+} SnapshotSectionHeader;
+
+// Create a snapshot file and write its header. Returns NULL on failure
+FILE* snapshot_create(const char* path, int section_count);
+
+// Append one section. Returns 1 on success, 0 on failure
+int snapshot_write_section(FILE* file, uint32_t type, uint32_t record_size, const void* records, uint64_t count);
+
+// Open a snapshot and validate its header. Returns NULL on failure
+FILE* snapshot_open(const char* path, int* section_count);
+
+// Read the next section header. Returns 1 on success, 0 at end of file or on error
+int snapshot_read_section_header(FILE* file, SnapshotSectionHeader* header);
+
+// Read the records of the section whose header was just read (caller frees). NULL on failure
+void* snapshot_read_section(FILE* file, const SnapshotSectionHeader* header);
+
+// Skip the records of the section whose header was just read. Returns 1 on success
+int snapshot_skip_section(FILE* file, const SnapshotSectionHeader* header);
+
+// Save flights, passengers and reservations as one snapshot. Returns 1 on success
+int save_data_to_snapshot(const Flight* flights, int flight_count,
+                          const Passenger* passengers, int passenger_count,
+                          const ReservationRecord* reservations, int reservation_count,
+                          const char* path);
+
+// Load a snapshot written by save_data_to_snapshot. Returns 1 on success
+int load_data_from_snapshot(const char* path,
+                            Flight** flights, int* flight_count,
+                            Passenger** passengers, int* passenger_count,
+                            ReservationRecord** reservations, int* reservation_count);
+
+#endif
@@ -0,0 +1,423 @@
+/*
+ * Structure Health Statistics Implementation
+ *
+ * Walks the data structures of both prototypes and reports how far each one is
+ * from its ideal shape: tree heights against log2(n), depth distributions, hash
+ * chain lengths and the most heavily booked flights and passengers.
+ *
+ * Sources used:
+ * 1. "Introduction to Algorithms" (CLRS) - Tree height and hashing analysis
+ * 2. Prometheus documentation - Text-based exposition format
+ */
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "structure_health.h"
+
+// Node waiting to be visited during a tree walk
+typedef struct {
+    const char* node;
+    int depth;
+} WalkEntry;
+
+// Map a depth or chain length to its power-of-two histogram bucket
+static int health_bucket(long long value) {
+    int bucket = 0;
+    while (bucket < HEALTH_HISTOGRAM_BUCKETS - 1 && health_bucket_upper_bound(bucket) < value) {
+        bucket++;
+    }
+    return bucket;
+}
+
+// Upper bound of a histogram bucket (0, 1, 2, 4, 8, ...)
+long long health_bucket_upper_bound(int bucket) {
+    return bucket == 0 ? 0 : 1LL << (bucket - 1);
+}
+
+// Walk any binary tree iteratively, given the offsets of its child pointers.
+// An explicit stack keeps degenerate (list-shaped) trees from overflowing the call stack
+static int measure_tree(const void* root, size_t left_offset, size_t right_offset, TreeShape* shape) {
+    memset(shape, 0, sizeof(TreeShape));
+    if (root == NULL) return 1;
+    
+    int capacity = 64;
+    int top = 0;
+    WalkEntry* stack = (WalkEntry*)malloc(capacity * sizeof(WalkEntry));
+    if (stack == NULL) {
+        fprintf(stderr, "Memory allocation failed for tree walk\n");
+        return 0;
+    }
+    
+    stack[top].node = (const char*)root;
+    stack[top].depth = 1;
+    top++;
+    
+    while (top > 0) {
+        WalkEntry entry = stack[--top];
+        shape->nodes++;
+        shape->depth_sum += entry.depth;
+        shape->depth_counts[health_bucket(entry.depth)]++;
+        if (entry.depth > shape->height) shape->height = entry.depth;
+        
+        // Make room for both children
+        if (top + 2 > capacity) {
+            capacity *= 2;
+            WalkEntry* grown = (WalkEntry*)realloc(stack, capacity * sizeof(WalkEntry));
+            if (grown == NULL) {
+                fprintf(stderr, "Memory allocation failed for tree walk\n");
+                free(stack);
+                return 0;
+            }
+            stack = grown;
+        }
+        
+        const char* left = *(const char* const*)(entry.node + left_offset);
+        const char* right = *(const char* const*)(entry.node + right_offset);
+        if (left != NULL) {
+            stack[top].node = left;
+            stack[top].depth = entry.depth + 1;
+            top++;
+        }
+        if (right != NULL) {
+            stack[top].node = right;
+            stack[top].depth = entry.depth + 1;
+            top++;
+        }
+    }
+    free(stack);
+    
+    while ((1LL << shape->optimal_height) - 1 < shape->nodes) {
+        shape->optimal_height++;
+    }
+    return 1;
+}
+
+// Measure chain lengths of the hash table (the first entry of each chain lives in the bucket array)
+static void measure_hash_table(PassengerHashTable* table, ChainShape* shape) {
+    memset(shape, 0, sizeof(ChainShape));
+    shape->buckets = table->size;
+    
+    for (int i = 0; i < table->size; i++) {
+        int length = 0;
+        if (table->table[i].occupied == 1) {
+            length = 1;
+            for (HashEntry* entry = table->table[i].next; entry != NULL; entry = entry->next) {
+                length++;
+            }
+        }
+        
+        // Finding the k-th entry of a chain takes k probes
+        shape->entries += length;
+        shape->probe_sum += (long long)length * (length + 1) / 2;
+        shape->length_counts[health_bucket(length)]++;
+        if (length > shape->longest_chain) shape->longest_chain = length;
+    }
+}
+
+// Compare two IDs for qsort
+static int compare_ids(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Sort the IDs and keep the `HEALTH_TOP_FANOUTS` most frequent ones. Returns the number kept
+static int top_fanouts(int* ids, long long count, FanOut top[HEALTH_TOP_FANOUTS]) {
+    qsort(ids, (size_t)count, sizeof(int), compare_ids);
+    
+    int kept = 0;
+    long long i = 0;
+    while (i < count) {
+        long long run_end = i;
+        while (run_end < count && ids[run_end] == ids[i]) run_end++;
+        int reservations = (int)(run_end - i);
+        
+        // Insert into the sorted top list, dropping the smallest if it is full
+        if (kept < HEALTH_TOP_FANOUTS || reservations > top[kept - 1].reservations) {
+            int pos = kept < HEALTH_TOP_FANOUTS ? kept++ : kept - 1;
+            while (pos > 0 && top[pos - 1].reservations < reservations) {
+                top[pos] = top[pos - 1];
+                pos--;
+            }
+            top[pos].id = ids[i];
+            top[pos].reservations = reservations;
+        }
+        i = run_end;
+    }
+    return kept;
+}
+
+// Collect flight and passenger IDs of every reservation in the BST (iterative in-order walk)
+static long long collect_bst_ids(ReservationBST* bst, int* flight_ids, int* passenger_ids) {
+    long long count = 0;
+    int capacity = 64;
+    int top = 0;
+    ReservationBST_Node** stack = (ReservationBST_Node**)malloc(capacity * sizeof(ReservationBST_Node*));
+    if (stack == NULL) return -1;
+    
+    ReservationBST_Node* current = bst->root;
+    while (current != NULL || top > 0) {
+        while (current != NULL) {
+            if (top == capacity) {
+                capacity *= 2;
+                ReservationBST_Node** grown = (ReservationBST_Node**)realloc(stack, capacity * sizeof(ReservationBST_Node*));
+                if (grown == NULL) {
+                    free(stack);
+                    return -1;
+                }
+                stack = grown;
+            }
+            stack[top++] = current;
+            current = current->left;
+        }
+        current = stack[--top];
+        if (count < bst->count) {
+            flight_ids[count] = current->data.flightId;
+            passenger_ids[count] = current->data.passengerId;
+            count++;
+        }
+        current = current->right;
+    }
+    free(stack);
+    return count;
+}
+
+// Find the flights and passengers holding the most reservations
+static int measure_fanouts(StructureHealth* health, ReservationArray* array, ReservationBST* bst) {
+    long long count = bst != NULL ? bst->count : (array != NULL ? array->count : 0);
+    if (count == 0) return 1;
+    
+    int* flight_ids = (int*)malloc(count * sizeof(int));
+    int* passenger_ids = (int*)malloc(count * sizeof(int));
+    if (flight_ids == NULL || passenger_ids == NULL) {
+        fprintf(stderr, "Memory allocation failed for fan-out statistics\n");
+        free(flight_ids);
+        free(passenger_ids);
+        return 0;
+    }
+    
+    if (bst != NULL) {
+        count = collect_bst_ids(bst, flight_ids, passenger_ids);
+    } else {
+        for (long long i = 0; i < count; i++) {
+            flight_ids[i] = array->flightIds[i];
+            passenger_ids[i] = array->passengerIds[i];
+        }
+    }
+    
+    if (count >= 0) {
+        health->top_flight_count = top_fanouts(flight_ids, count, health->top_flights);
+        health->top_passenger_count = top_fanouts(passenger_ids, count, health->top_passengers);
+    }
+    free(flight_ids);
+    free(passenger_ids);
+    return count >= 0;
+}
+
+// Walk the given structures without modifying them
+int collect_structure_health(StructureHealth* health, BST_Node* flight_bst, LL_Node* passenger_list,
+                             ReservationArray* reservation_array, AVL_Node* flight_avl,
+                             PassengerHashTable* passenger_hash, ReservationBST* reservation_bst) {
+    memset(health, 0, sizeof(StructureHealth));
+    int ok = 1;
+    
+    if (flight_bst != NULL) {
+        health->has_flight_bst = 1;
+        ok &= measure_tree(flight_bst, offsetof(BST_Node, left), offsetof(BST_Node, right), &health->flight_bst);
+    }
+    if (flight_avl != NULL) {
+        health->has_flight_avl = 1;
+        ok &= measure_tree(flight_avl, offsetof(AVL_Node, left), offsetof(AVL_Node, right), &health->flight_avl);
+    }
+    if (reservation_bst != NULL) {
+        health->has_reservation_bst = 1;
+        ok &= measure_tree(reservation_bst->root, offsetof(ReservationBST_Node, left),
+                           offsetof(ReservationBST_Node, right), &health->reservation_bst);
+    }
+    if (passenger_hash != NULL) {
+        health->has_passenger_hash = 1;
+        measure_hash_table(passenger_hash, &health->passenger_hash);
+    }
+    if (passenger_list != NULL) {
+        health->has_passenger_list = 1;
+        for (LL_Node* node = passenger_list; node != NULL; node = node->next) {
+            health->passenger_list_length++;
+            if (node == passenger_list) continue;
+            health->passenger_list_pointers += node->level;
+            if (node->level > health->passenger_list_levels) {
+                health->passenger_list_levels = node->level;
+            }
+        }
+    }
+    
+    ok &= measure_fanouts(health, reservation_array, reservation_bst);
+    return ok;
+}
+
+// Print one power-of-two histogram, skipping empty buckets
+static void print_buckets(FILE* file, const char* label, const long long counts[HEALTH_HISTOGRAM_BUCKETS]) {
+    fprintf(file, "    %s:", label);
+    for (int b = 0; b < HEALTH_HISTOGRAM_BUCKETS; b++) {
+        if (counts[b] == 0) continue;
+        if (b <= 2) {
+            fprintf(file, " [%lld] %lld", health_bucket_upper_bound(b), counts[b]);
+        } else {
+            fprintf(file, " [%lld-%lld] %lld", health_bucket_upper_bound(b - 1) + 1,
+                    health_bucket_upper_bound(b), counts[b]);
+        }
+    }
+    fprintf(file, "\n");
+}
+
+// Print the shape of one tree
+static void print_tree_shape(FILE* file, const char* name, const TreeShape* shape) {
+    double mean_depth = shape->nodes > 0 ? (double)shape->depth_sum / shape->nodes : 0.0;
+    double ratio = shape->optimal_height > 0 ? (double)shape->height / shape->optimal_height : 0.0;
+    
+    fprintf(file, "  %s: %lld nodes, height %d (optimal %d, %.2fx), mean depth %.2f\n",
+            name, shape->nodes, shape->height, shape->optimal_height, ratio, mean_depth);
+    print_buckets(file, "depth", shape->depth_counts);
+}
+
+// Print a human-readable report
+void print_structure_health(FILE* file, const StructureHealth* health) {
+    fprintf(file, "Trees:\n");
+    if (health->has_flight_bst) print_tree_shape(file, "flight_bst", &health->flight_bst);
+    if (health->has_flight_avl) print_tree_shape(file, "flight_avl", &health->flight_avl);
+    if (health->has_reservation_bst) print_tree_shape(file, "reservation_bst", &health->reservation_bst);
+    
+    if (health->has_passenger_hash) {
+        const ChainShape* shape = &health->passenger_hash;
+        double load_factor = shape->buckets > 0 ? (double)shape->entries / shape->buckets : 0.0;
+        double mean_probes = shape->entries > 0 ? (double)shape->probe_sum / shape->entries : 0.0;
+        
+        fprintf(file, "Hash table:\n");
+        fprintf(file, "  passenger_hash: %lld entries in %d buckets, load factor %.2f, "
+                "longest chain %d, mean probes per hit %.2f\n",
+                shape->entries, shape->buckets, load_factor, shape->longest_chain, mean_probes);
+        print_buckets(file, "chain length", shape->length_counts);
+    }
+    
+    if (health->has_passenger_list) {
+        fprintf(file, "Lists:\n");
+        long long others = health->passenger_list_length - 1;
+        fprintf(file, "  passenger_list: %lld nodes in a skip list of %d levels, %.2f forward pointers per node\n",
+                health->passenger_list_length, health->passenger_list_levels,
+                others > 0 ? (double)health->passenger_list_pointers / others : 0.0);
+    }
+    
+    fprintf(file, "Largest reservation fan-outs:\n");
+    fprintf(file, "  flights:   ");
+    for (int i = 0; i < health->top_flight_count; i++) {
+        fprintf(file, " %d (%d)", health->top_flights[i].id, health->top_flights[i].reservations);
+    }
+    fprintf(file, "\n  passengers:");
+    for (int i = 0; i < health->top_passenger_count; i++) {
+        fprintf(file, " %d (%d)", health->top_passengers[i].id, health->top_passengers[i].reservations);
+    }
+    fprintf(file, "\n");
+}
+
+// Write one power-of-two histogram as a cumulative Prometheus histogram
+static void write_prometheus_histogram(FILE* file, const char* metric, const char* structure,
+                                       const long long counts[HEALTH_HISTOGRAM_BUCKETS],
+                                       long long sum, long long total) {
+    long long cumulative = 0;
+    for (int b = 0; b < HEALTH_HISTOGRAM_BUCKETS; b++) {
+        cumulative += counts[b];
+        fprintf(file, "%s_bucket{structure=\"%s\",le=\"%lld\"} %lld\n",
+                metric, structure, health_bucket_upper_bound(b), cumulative);
+        if (cumulative == total) break;
+    }
+    fprintf(file, "%s_bucket{structure=\"%s\",le=\"+Inf\"} %lld\n", metric, structure, total);
+    fprintf(file, "%s_sum{structure=\"%s\"} %lld\n", metric, structure, sum);
+    fprintf(file, "%s_count{structure=\"%s\"} %lld\n", metric, structure, total);
+}
+
+// Write the metrics in the Prometheus text exposition format
+int write_structure_health_prometheus(const char* path, const StructureHealth* health) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Could not open %s for writing\n", path);
+        return 0;
+    }
+    
+    // Every metric family must be written as one group, so collect the trees first
+    const char* names[3];
+    const TreeShape* trees[3];
+    int tree_count = 0;
+    if (health->has_flight_bst) {
+        names[tree_count] = "flight_bst";
+        trees[tree_count++] = &health->flight_bst;
+    }
+    if (health->has_flight_avl) {
+        names[tree_count] = "flight_avl";
+        trees[tree_count++] = &health->flight_avl;
+    }
+    if (health->has_reservation_bst) {
+        names[tree_count] = "reservation_bst";
+        trees[tree_count++] = &health->reservation_bst;
+    }
+    
+    fprintf(file, "# HELP airline_tree_nodes Nodes in the tree\n# TYPE airline_tree_nodes gauge\n");
+    for (int t = 0; t < tree_count; t++) {
+        fprintf(file, "airline_tree_nodes{structure=\"%s\"} %lld\n", names[t], trees[t]->nodes);
+    }
+    fprintf(file, "# HELP airline_tree_height Longest root-to-leaf path (root = 1)\n"
+            "# TYPE airline_tree_height gauge\n");
+    for (int t = 0; t < tree_count; t++) {
+        fprintf(file, "airline_tree_height{structure=\"%s\"} %d\n", names[t], trees[t]->height);
+    }
+    fprintf(file, "# HELP airline_tree_optimal_height Height of a perfectly balanced tree with the same nodes\n"
+            "# TYPE airline_tree_optimal_height gauge\n");
+    for (int t = 0; t < tree_count; t++) {
+        fprintf(file, "airline_tree_optimal_height{structure=\"%s\"} %d\n", names[t], trees[t]->optimal_height);
+    }
+    fprintf(file, "# HELP airline_tree_depth Depth of every node\n# TYPE airline_tree_depth histogram\n");
+    for (int t = 0; t < tree_count; t++) {
+        write_prometheus_histogram(file, "airline_tree_depth", names[t], trees[t]->depth_counts,
+                                   trees[t]->depth_sum, trees[t]->nodes);
+    }
+    
+    if (health->has_passenger_hash) {
+        const ChainShape* shape = &health->passenger_hash;
+        fprintf(file, "# HELP airline_hash_buckets Buckets in the hash table\n# TYPE airline_hash_buckets gauge\n");
+        fprintf(file, "airline_hash_buckets{structure=\"passenger_hash\"} %d\n", shape->buckets);
+        fprintf(file, "# HELP airline_hash_load_factor Entries per bucket\n# TYPE airline_hash_load_factor gauge\n");
+        fprintf(file, "airline_hash_load_factor{structure=\"passenger_hash\"} %.6f\n",
+                shape->buckets > 0 ? (double)shape->entries / shape->buckets : 0.0);
+        fprintf(file, "# HELP airline_hash_probes_per_hit Mean probes to find a stored entry\n"
+                "# TYPE airline_hash_probes_per_hit gauge\n");
+        fprintf(file, "airline_hash_probes_per_hit{structure=\"passenger_hash\"} %.6f\n",
+                shape->entries > 0 ? (double)shape->probe_sum / shape->entries : 0.0);
+        fprintf(file, "# HELP airline_hash_chain_length Entries per bucket chain\n"
+                "# TYPE airline_hash_chain_length histogram\n");
+        write_prometheus_histogram(file, "airline_hash_chain_length", "passenger_hash", shape->length_counts,
+                                   shape->entries, shape->buckets);
+    }
+    
+    if (health->has_passenger_list) {
+        fprintf(file, "# HELP airline_list_length Nodes in the list\n# TYPE airline_list_length gauge\n");
+        fprintf(file, "airline_list_length{structure=\"passenger_list\"} %lld\n", health->passenger_list_length);
+        fprintf(file, "# HELP airline_list_levels Skip list levels in use\n# TYPE airline_list_levels gauge\n");
+        fprintf(file, "airline_list_levels{structure=\"passenger_list\"} %d\n", health->passenger_list_levels);
+    }
+    
+    fprintf(file, "# HELP airline_reservation_fanout Reservations held by the most booked IDs\n"
+            "# TYPE airline_reservation_fanout gauge\n");
+    for (int i = 0; i < health->top_flight_count; i++) {
+        fprintf(file, "airline_reservation_fanout{key=\"flight\",rank=\"%d\",id=\"%d\"} %d\n",
+                i + 1, health->top_flights[i].id, health->top_flights[i].reservations);
+    }
+    for (int i = 0; i < health->top_passenger_count; i++) {
+        fprintf(file, "airline_reservation_fanout{key=\"passenger\",rank=\"%d\",id=\"%d\"} %d\n",
+                i + 1, health->top_passengers[i].id, health->top_passengers[i].reservations);
+    }
+    
+    int ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
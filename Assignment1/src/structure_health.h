@@ -0,0 +1,68 @@
+#ifndef STRUCTURE_HEALTH_H
+#define STRUCTURE_HEALTH_H
+
+#include <stdio.h>
+#include "airline_types.h"
+
+// Number of histogram buckets: depths/lengths are grouped by powers of two (0, 1, 2, 4, ... 2^30)
+#define HEALTH_HISTOGRAM_BUCKETS 32
+
+// Number of largest reservation fan-outs reported per key
+#define HEALTH_TOP_FANOUTS 5
+
+// Shape of one binary tree. Depths count the root as 1, matching avl_height
+typedef struct {
+    long long nodes;
+    int height;
+    int optimal_height;                              // ceil(log2(nodes + 1))
+    long long depth_sum;                             // Sum of all node depths
+    long long depth_counts[HEALTH_HISTOGRAM_BUCKETS]; // Nodes per depth bucket
+} TreeShape;
+
+// Shape of the chained passenger hash table
+typedef struct {
+    int buckets;
+    long long entries;
+    int longest_chain;
+    long long probe_sum;                              // Probes needed to find every entry once
+    long long length_counts[HEALTH_HISTOGRAM_BUCKETS]; // Buckets per chain length bucket
+} ChainShape;
+
+// Number of reservations held under one flight or passenger ID
+typedef struct {
+    int id;
+    int reservations;
+} FanOut;
+
+// Structural metrics for every structure that was present
+typedef struct {
+    int has_flight_bst, has_flight_avl, has_reservation_bst, has_passenger_hash, has_passenger_list;
+    TreeShape flight_bst;
+    TreeShape flight_avl;
+    TreeShape reservation_bst;
+    ChainShape passenger_hash;
+    long long passenger_list_length;
+    int passenger_list_levels;                 // Highest skip list level below the head's
+    long long passenger_list_pointers;         // Forward pointers of every node but the head
+    FanOut top_flights[HEALTH_TOP_FANOUTS];
+    FanOut top_passengers[HEALTH_TOP_FANOUTS];
+    int top_flight_count;
+    int top_passenger_count;
+} StructureHealth;
+
+// Walk the given structures (any may be NULL) without modifying them. Fan-outs come from the
+// reservation BST if given, otherwise from the reservation array. Returns 1 on success, 0 on failure
+int collect_structure_health(StructureHealth* health, BST_Node* flight_bst, LL_Node* passenger_list,
+                             ReservationArray* reservation_array, AVL_Node* flight_avl,
+                             PassengerHashTable* passenger_hash, ReservationBST* reservation_bst);
+
+// Upper bound of a histogram bucket (0, 1, 2, 4, 8, ...)
+long long health_bucket_upper_bound(int bucket);
+
+// Print a human-readable report
+void print_structure_health(FILE* file, const StructureHealth* health);
+
+// Write the metrics in the Prometheus text exposition format. Returns 1 on success, 0 on failure
+int write_structure_health_prometheus(const char* path, const StructureHealth* health);
+
+#endif
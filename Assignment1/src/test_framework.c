@@ -12,16 +12,51 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
 #include <assert.h>
+#include <pthread.h>
+#include <limits.h>
+#include <unistd.h>
 #include "test_framework.h"
 #include "airline_types.h"
 #include "data_generator.h" 
+#include "csv_writer.h"
+#include "snapshot.h"
+#include "engine.h"
+#include "trace.h"
+#include "histogram.h"
+#include "perf_counters.h"
+#include "timing.h"
+#include "mem_stats.h"
+#include "structure_health.h"
+#include "batch.h"
+#include "aggregate.h"
+#include "protocol.h"
+#include "server.h"
+#include "loadgen.h"
+#include "concurrent_engine.h"
+#include "sharded_engine.h"
+#include "radix_sort.h"
+#include "simd_scan.h"
+#include "name_heap.h"
 #include "prototype1/flight_management.h"
+#include "prototype1/flight_search.h"
 #include "prototype1/passenger_management.h"
+#include "prototype1/passenger_search.h"
+#include "prototype1/passenger_unrolled.h"
 #include "prototype1/reservation_management.h"
 #include "prototype2/flight_management_avl.h"
+#include "prototype2/flight_search_avl.h"
 #include "prototype2/passenger_management_hash.h"
+#include "prototype2/passenger_search_hash.h"
 #include "prototype2/reservation_management_bst.h"
+#include "prototype2/flight_persistent_avl.h"
+#include "prototype2/reservation_mvcc.h"
+#include "prototype2/flight_partitions.h"
+#include "prototype2/bloom_filter.h"
+#include "prototype2/passenger_sketches.h"
+#include "prototype2/flight_load_index.h"
 
 // Helper function to check test results
 void report_test_result(const char* test_name, int result) {
@@ -152,7 +187,7 @@ void test_reservation_array_operations() {
     
     // Count manually for verification
     for (int i = 0; i < array->count; i++) {
-        if (array->records[i].flightId == 101) {
+        if (array->flightIds[i] == 101) {
             reservation_count++;
         }
     }
@@ -160,8 +195,8 @@ void test_reservation_array_operations() {
     // Create a tracking array
     int counted[4] = {0}; // Enough for passengers 1-3
     for (int i = 0; i < array->count; i++) {
-        if (array->records[i].flightId == 101) {
-            int passenger_id = array->records[i].passengerId;
+        if (array->flightIds[i] == 101) {
+            int passenger_id = array->passengerIds[i];
             if (counted[passenger_id] == 0) {
                 counted[passenger_id] = 1;
                 unique_count++;
@@ -550,6 +585,2196 @@ void test_reservation_capacity_validation() {
     free_reservation_bst(bst);
 }
 
+// Test skewed workload generation (Zipf flights, booking curve, name clusters)
+void test_skewed_data_generation() {
+    printf("\nTesting Skewed Data Generation:\n");
+    
+    GeneratorConfig config = skewed_generator_config();
+    srand(config.seed);
+    
+    int flight_count = 50;
+    int passenger_count = 200;
+    int reservation_count = 2000;
+    Flight* flights = generate_flights(flight_count, config.reference_time);
+    Passenger* passengers = generate_passengers_clustered(passenger_count, &config);
+    ReservationRecord* reservations = generate_reservations_skewed(reservation_count, flights, flight_count,
+                                                                   passenger_count, &config, &reservation_count);
+    
+    int* per_flight = (int*)calloc(flight_count, sizeof(int));
+    int ids_valid = 1;
+    int dates_valid = 1;
+    for (int i = 0; i < reservation_count; i++) {
+        int flight_index = reservations[i].flightId - flights[0].id;
+        if (flight_index < 0 || flight_index >= flight_count ||
+            reservations[i].passengerId < 2000 || reservations[i].passengerId >= 2000 + passenger_count) {
+            ids_valid = 0;
+            continue;
+        }
+        per_flight[flight_index]++;
+        if (reservations[i].bookingDate > flights[flight_index].departureTime) {
+            dates_valid = 0;
+        }
+    }
+    
+    // With Zipf(1) over 50 flights the hottest flight takes ~22% of bookings, far above 1/50
+    int busiest = 0;
+    for (int i = 0; i < flight_count; i++) {
+        if (per_flight[i] > busiest) busiest = per_flight[i];
+    }
+    
+    // The most common clustered name should repeat well beyond chance
+    int max_repeats = 0;
+    for (int i = 0; i < passenger_count; i++) {
+        int repeats = 0;
+        for (int j = 0; j < passenger_count; j++) {
+            if (strcmp(passengers[i].name, passengers[j].name) == 0) repeats++;
+        }
+        if (repeats > max_repeats) max_repeats = repeats;
+    }
+    
+    report_test_result("Skewed Generator IDs In Range", ids_valid);
+    report_test_result("Skewed Generator Bookings Precede Departure", dates_valid);
+    report_test_result("Skewed Generator Hot Flight", busiest > 4 * (reservation_count / flight_count));
+    report_test_result("Skewed Generator Name Clusters", max_repeats >= 3);
+    
+    // Asking for more bookings than there are seats stops once every flight is full
+    int total_capacity = 0;
+    for (int i = 0; i < flight_count; i++) {
+        total_capacity += flights[i].capacity;
+    }
+    int overbooked_count = 0;
+    ReservationRecord* overbooked = generate_reservations_skewed(total_capacity * 2, flights, flight_count,
+                                                                 passenger_count, &config, &overbooked_count);
+    int within_capacity = overbooked != NULL && overbooked_count == total_capacity;
+    memset(per_flight, 0, flight_count * sizeof(int));
+    for (int i = 0; within_capacity && i < overbooked_count; i++) {
+        int flight_index = overbooked[i].flightId - flights[0].id;
+        per_flight[flight_index]++;
+        within_capacity = per_flight[flight_index] <= flights[flight_index].capacity;
+    }
+    report_test_result("Skewed Generator Stops When Flights Are Full", within_capacity);
+    
+    // The same seed and reference time give the same dataset, however much later it is rebuilt
+    srand(config.seed);
+    Flight* first_flights = generate_flights(flight_count, config.reference_time);
+    int first_count = 0;
+    ReservationRecord* first = generate_reservations_skewed(reservation_count, first_flights, flight_count,
+                                                            passenger_count, &config, &first_count);
+    srand(config.seed);
+    Flight* second_flights = generate_flights(flight_count, config.reference_time);
+    int second_count = 0;
+    ReservationRecord* second = generate_reservations_skewed(reservation_count, second_flights, flight_count,
+                                                             passenger_count, &config, &second_count);
+    int reproduced = first_flights != NULL && second_flights != NULL && first != NULL && second != NULL &&
+                     first_count == second_count;
+    for (int i = 0; reproduced && i < flight_count; i++) {
+        reproduced = first_flights[i].departureTime == second_flights[i].departureTime &&
+                     first_flights[i].capacity == second_flights[i].capacity &&
+                     strcmp(first_flights[i].flightNumber, second_flights[i].flightNumber) == 0 &&
+                     strcmp(first_flights[i].origin, second_flights[i].origin) == 0;
+    }
+    for (int i = 0; reproduced && i < first_count; i++) {
+        reproduced = first[i].flightId == second[i].flightId && first[i].passengerId == second[i].passengerId &&
+                     first[i].bookingDate == second[i].bookingDate &&
+                     strcmp(first[i].seatNumber, second[i].seatNumber) == 0;
+    }
+    report_test_result("Generator Reproduces A Seeded Dataset", reproduced);
+    free(first_flights);
+    free(second_flights);
+    free(first);
+    free(second);
+    
+    free(overbooked);
+    free(per_flight);
+    free(flights);
+    free(passengers);
+    free(reservations);
+}
+
+// Test the buffered CSV writer and binary snapshot round trip
+void test_csv_writer_and_snapshot() {
+    printf("\nTesting Buffered CSV Writer and Snapshots:\n");
+    
+    // Hand-written formatting must match printf/strftime
+    char out[CSV_MAX_ROW_LENGTH];
+    char expected[CSV_MAX_ROW_LENGTH];
+    int values[] = {0, 7, 42, 1000, -15, 2147483647, -2147483647 - 1};
+    int ints_match = 1;
+    for (int i = 0; i < (int)(sizeof(values) / sizeof(values[0])); i++) {
+        size_t length = csv_format_int(out, values[i]);
+        out[length] = '\0';
+        snprintf(expected, sizeof(expected), "%d", values[i]);
+        ints_match = ints_match && strcmp(out, expected) == 0;
+    }
+    report_test_result("CSV Writer Integer Formatting", ints_match);
+    
+    DateCache cache;
+    date_cache_init(&cache);
+    int dates_match = 1;
+    time_t base = time(NULL);
+    for (int i = 0; i < 2000; i++) {
+        time_t value = base + (time_t)i * 7919;  // Crosses many days (and possibly DST changes)
+        size_t length = csv_format_datetime(out, &cache, value);
+        out[length] = '\0';
+        strftime(expected, sizeof(expected), "%Y-%m-%d %H:%M:%S", localtime(&value));
+        dates_match = dates_match && strcmp(out, expected) == 0;
+    }
+    report_test_result("CSV Writer Cached Date Formatting", dates_match);
+    
+    Flight flight = {1001, "QF123", "Hobart", "Sydney", base, 180};
+    size_t length = csv_format_flight_row(out, &flight, &cache);
+    out[length] = '\0';
+    char departure[32];
+    strftime(departure, sizeof(departure), "%Y-%m-%d %H:%M:%S", localtime(&flight.departureTime));
+    snprintf(expected, sizeof(expected), "1001,QF123,Hobart,Sydney,%s,180\n", departure);
+    report_test_result("CSV Writer Flight Row", strcmp(out, expected) == 0);
+    
+    // Parallel formatting must produce exactly the single-threaded output
+    int count = 3 * CSV_BLOCK_ROWS / 2;
+    ReservationRecord* records = (ReservationRecord*)malloc(count * sizeof(ReservationRecord));
+    for (int i = 0; i < count; i++) {
+        records[i].flightId = 1000 + i % 97;
+        records[i].passengerId = 2000 + i;
+        records[i].bookingDate = base - i * 61;
+        snprintf(records[i].seatNumber, sizeof(records[i].seatNumber), "%d%c", 1 + i % 50, 'A' + i % 6);
+    }
+    FILE* serial = tmpfile();
+    FILE* parallel = tmpfile();
+    long long serial_bytes = write_reservations_csv(serial, records, count, 1);
+    long long parallel_bytes = write_reservations_csv(parallel, records, count, 4);
+    int same = serial != NULL && parallel != NULL && serial_bytes > 0 && serial_bytes == parallel_bytes;
+    if (same) {
+        rewind(serial);
+        rewind(parallel);
+        int a, b;
+        do {
+            a = fgetc(serial);
+            b = fgetc(parallel);
+        } while (a == b && a != EOF);
+        same = a == b;
+    }
+    report_test_result("CSV Writer Parallel Output Matches Serial", same);
+    if (serial) fclose(serial);
+    if (parallel) fclose(parallel);
+    
+    // A full disk makes both paths fail instead of reporting the bytes they formatted
+    FILE* full = fopen("/dev/full", "wb");
+    if (full != NULL) {
+        int serial_failed = write_reservations_csv(full, records, count, 1) == -1;
+        int parallel_failed = write_reservations_csv(full, records, count, 4) == -1;
+        report_test_result("CSV Writer Reports Short Writes", serial_failed && parallel_failed);
+        fclose(full);
+    }
+    
+    // Snapshot round trip
+    Passenger passenger = {2001, "Jane Doe", "CD789012"};
+    const char* path = "test_snapshot.tmp";
+    int saved = save_data_to_snapshot(&flight, 1, &passenger, 1, records, count, path);
+    Flight* loaded_flights = NULL;
+    Passenger* loaded_passengers = NULL;
+    ReservationRecord* loaded_reservations = NULL;
+    int loaded_flight_count, loaded_passenger_count, loaded_reservation_count;
+    int loaded = saved && load_data_from_snapshot(path, &loaded_flights, &loaded_flight_count,
+                                                  &loaded_passengers, &loaded_passenger_count,
+                                                  &loaded_reservations, &loaded_reservation_count);
+    report_test_result("Snapshot Round Trip",
+                       loaded && loaded_flight_count == 1 && loaded_passenger_count == 1 &&
+                       loaded_reservation_count == count &&
+                       memcmp(loaded_flights, &flight, sizeof(Flight)) == 0 &&
+                       strcmp(loaded_passengers[0].name, "Jane Doe") == 0 &&
+                       memcmp(loaded_reservations, records, count * sizeof(ReservationRecord)) == 0);
+    remove(path);
+    
+    free(loaded_flights);
+    free(loaded_passengers);
+    free(loaded_reservations);
+    free(records);
+}
+
+// Test trace generation, the trace file format and replay against both prototypes
+void test_trace_replay() {
+    printf("\nTesting Operation Traces and Replay:\n");
+    
+    srand(42);
+    int flight_count = 100, passenger_count = 500, reservation_count = 1000;
+    time_t reference_time = time(NULL);
+    Flight* flights = generate_flights(flight_count, reference_time);
+    Passenger* passengers = generate_passengers(passenger_count);
+    ReservationRecord* reservations = generate_reservations(reservation_count, flight_count, passenger_count,
+                                                            reference_time);
+    
+    // Cancellation removes exactly one booking in both prototypes
+    ReservationArray* array = init_reservations(16);
+    ReservationBST* bst = init_reservation_bst();
+    for (int i = 0; i < 40; i++) {
+        add_reservation(array, reservations[i]);
+        add_reservation_bst(bst, reservations[i]);
+    }
+    int flightId = reservations[7].flightId, passengerId = reservations[7].passengerId;
+    int before1 = count_passengers_by_flight_array(array, flightId);
+    int before2 = count_passengers_by_flight(bst, flightId);
+    int cancelled = cancel_reservation(array, flightId, passengerId) &&
+                    cancel_reservation_bst(bst, flightId, passengerId);
+    report_test_result("Cancel Reservation (Array and BST)",
+                       cancelled && array->count == 39 && bst->count == 39 &&
+                       count_passengers_by_flight_array(array, flightId) == before1 - 1 &&
+                       count_passengers_by_flight(bst, flightId) == before2 - 1 &&
+                       !cancel_reservation(array, -1, passengerId) && !cancel_reservation_bst(bst, -1, passengerId));
+    free_reservations(array);
+    free_reservation_bst(bst);
+    
+    // Generated traces follow the requested mix and survive a save/load round trip
+    TraceConfig config = default_trace_config();
+    config.op_count = 5000;
+    config.mix[TRACE_FLIGHT_BY_NUMBER] = 0;
+    Trace* trace = generate_trace(&config, flights, flight_count, passengers, passenger_count,
+                                  reservations, reservation_count);
+    int mix_ok = trace != NULL && trace->count == config.op_count;
+    for (int i = 0; mix_ok && i < trace->count; i++) {
+        mix_ok = trace->ops[i].type != TRACE_FLIGHT_BY_NUMBER &&
+                 (i == 0 || trace->ops[i].timestamp_us >= trace->ops[i - 1].timestamp_us);
+    }
+    report_test_result("Trace Generation Follows Mix", mix_ok);
+    
+    const char* path = "test_trace.tmp";
+    Trace* loaded = trace != NULL && save_trace(trace, path) ? load_trace(path) : NULL;
+    int same = loaded != NULL && loaded->count == trace->count;
+    for (int i = 0; same && i < trace->count; i++) {
+        same = loaded->ops[i].type == trace->ops[i].type &&
+               loaded->ops[i].timestamp_us == trace->ops[i].timestamp_us &&
+               loaded->ops[i].flightId == trace->ops[i].flightId &&
+               loaded->ops[i].passengerId == trace->ops[i].passengerId &&
+               strcmp(loaded->ops[i].key, trace->ops[i].key) == 0;
+    }
+    report_test_result("Trace Save/Load Round Trip", same);
+    remove(path);
+    
+    // Both prototypes must give the same answers to the same trace
+    ReplayStats stats1, stats2;
+    QueryEngine* engine1 = create_engine(1, flights, flight_count, passengers, passenger_count,
+                                         reservations, reservation_count);
+    QueryEngine* engine2 = create_engine(2, flights, flight_count, passengers, passenger_count,
+                                         reservations, reservation_count);
+    int replayed = loaded != NULL && engine1 != NULL && engine2 != NULL &&
+                   replay_trace(engine1, loaded, REPLAY_CLOSED_LOOP, 1.0, &stats1) &&
+                   replay_trace(engine2, loaded, REPLAY_CLOSED_LOOP, 1.0, &stats2);
+    report_test_result("Trace Replay Matches Across Prototypes",
+                       replayed && memcmp(stats1.count, stats2.count, sizeof(stats1.count)) == 0 &&
+                       memcmp(stats1.hits, stats2.hits, sizeof(stats1.hits)) == 0 &&
+                       stats1.hits[TRACE_FLIGHT_BY_ID] == stats1.count[TRACE_FLIGHT_BY_ID] &&
+                       stats1.p50_ns[TRACE_PASSENGER_BY_ID] <= stats1.p99_ns[TRACE_PASSENGER_BY_ID]);
+    
+    destroy_engine(engine1);
+    destroy_engine(engine2);
+    free_trace(trace);
+    free_trace(loaded);
+    free(flights);
+    free(passengers);
+    free(reservations);
+}
+
+// Test the HDR-style latency histogram against exact percentiles
+void test_latency_histogram() {
+    printf("\nTesting Latency Histogram:\n");
+    
+    LatencyHistogram* histogram = histogram_create();
+    LatencyHistogram* other = histogram_create();
+    if (histogram == NULL || other == NULL) {
+        report_test_result("Latency Histogram Allocation", 0);
+        histogram_free(histogram);
+        histogram_free(other);
+        return;
+    }
+    
+    // Small values are exact
+    for (uint64_t v = 1; v <= 100; v++) {
+        histogram_record(histogram, v);
+    }
+    report_test_result("Histogram Exact Small Values",
+                       histogram_percentile(histogram, 50.0) == 50 &&
+                       histogram_percentile(histogram, 99.0) == 99 &&
+                       histogram->min == 1 && histogram->max == 100 && histogram_mean(histogram) == 50.5);
+    
+    // Large values stay within the bucket precision (1 part in 64) of the exact percentile
+    histogram_reset(histogram);
+    int count = 20000;
+    uint64_t* values = (uint64_t*)malloc(count * sizeof(uint64_t));
+    for (int i = 0; i < count; i++) {
+        values[i] = 100 + (uint64_t)rand() * 37 % 5000000;
+        histogram_record(i % 2 ? histogram : other, values[i]);
+    }
+    histogram_merge(histogram, other);
+    timing_sort_ns(values, count);
+    
+    double percentiles[] = {50.0, 90.0, 99.0, 99.9};
+    int precise = histogram->total_count == (uint64_t)count;
+    for (int i = 0; i < 4; i++) {
+        uint64_t exact = timing_percentile_ns(values, count, percentiles[i]);
+        uint64_t estimate = histogram_percentile(histogram, percentiles[i]);
+        precise = precise && estimate >= exact && estimate - exact <= exact / 64 + 1;
+    }
+    report_test_result("Histogram Percentiles Within Precision After Merge", precise);
+    
+    free(values);
+    histogram_free(histogram);
+    histogram_free(other);
+}
+
+// Test that hardware counters either count or degrade to invalid samples
+void test_perf_counters() {
+    printf("\nTesting Hardware Performance Counters:\n");
+    
+    PerfCounters counters;
+    int available = perf_counters_open(&counters);
+    
+    PerfSample sample;
+    perf_counters_begin(&counters);
+    volatile long sum = 0;
+    for (int i = 0; i < 100000; i++) {
+        sum += i;
+    }
+    perf_counters_end(&counters, &sample);
+    
+    // Unavailable events must be marked invalid; available instruction counts must see the loop
+    int valid_events = 0;
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        valid_events += sample.valid[e];
+    }
+    int consistent = valid_events <= available &&
+                     (!sample.valid[PERF_INSTRUCTIONS] || sample.values[PERF_INSTRUCTIONS] >= 100000.0);
+    printf("%d of %d hardware events available\n", available, PERF_EVENT_COUNT);
+    report_test_result("Perf Counters Count Or Degrade Gracefully", consistent);
+    
+    perf_counters_close(&counters);
+}
+
+// Test that tagged allocations are counted per structure and return to zero when freed
+void test_memory_accounting() {
+    printf("\nTesting Memory Accounting:\n");
+    
+    const int count = 200;
+    MemStats avl_before = mem_stats_get(MEM_FLIGHT_AVL);
+    MemStats array_before = mem_stats_get(MEM_RESERVATION_ARRAY);
+    
+    AVL_Node* root = NULL;
+    ReservationArray* array = init_reservations(4);
+    for (int i = 0; i < count; i++) {
+        Flight flight = {i + 1, "MS100", "Oslo", "Rome", time(NULL) + i * 60, 150};
+        root = avl_insert(root, flight);
+        
+        ReservationRecord record = {i + 1, i + 1, time(NULL), "1A"};
+        add_reservation(array, record);
+    }
+    
+    // Every AVL node is accounted at exactly its own size; the array grew by reallocating
+    MemStats avl_built = mem_stats_get(MEM_FLIGHT_AVL);
+    MemStats array_built = mem_stats_get(MEM_RESERVATION_ARRAY);
+    report_test_result("Memory Accounting Counts Bytes Per AVL Node",
+                       avl_built.live_bytes - avl_before.live_bytes == (long long)(count * sizeof(AVL_Node)) &&
+                       avl_built.allocations - avl_before.allocations == count);
+    report_test_result("Memory Accounting Tracks Array Growth",
+                       array_built.live_bytes - array_before.live_bytes >=
+                       (long long)(count * sizeof(ReservationRecord)) &&
+                       array_built.peak_bytes >= array_built.live_bytes);
+    
+    free_avl_tree(root);
+    free_reservations(array);
+    
+    MemStats avl_after = mem_stats_get(MEM_FLIGHT_AVL);
+    MemStats array_after = mem_stats_get(MEM_RESERVATION_ARRAY);
+    report_test_result("Memory Accounting Returns To Baseline After Free",
+                       avl_after.live_bytes == avl_before.live_bytes &&
+                       array_after.live_bytes == array_before.live_bytes &&
+                       avl_after.frees - avl_before.frees == count);
+}
+
+// Test that structure health reports degenerate trees, chain lengths and fan-outs
+void test_structure_health() {
+    printf("\nTesting Structure Health Statistics:\n");
+    
+    // Sorted inserts turn the plain BST into a list, while the AVL tree stays balanced
+    const int count = 64;
+    BST_Node* bst = NULL;
+    AVL_Node* avl = NULL;
+    for (int i = 0; i < count; i++) {
+        Flight flight = {i + 1, "SH100", "Perth", "Hobart", time(NULL), 100};
+        bst = insert(bst, flight);
+        avl = avl_insert(avl, flight);
+    }
+    
+    PassengerHashTable* table = init_hash_table(count);
+    for (int i = 0; i < count; i++) {
+        Passenger passenger = {i * 7 + 1, "Health Test", "P0000000"};
+        hash_insert_passenger(table, passenger);
+    }
+    
+    // Flight 7 holds the most reservations, passenger 3 the second most
+    ReservationArray* array = init_reservations(16);
+    for (int i = 0; i < 6; i++) {
+        ReservationRecord record = {7, 100 + i, time(NULL), "1A"};
+        add_reservation(array, record);
+    }
+    for (int i = 0; i < 3; i++) {
+        ReservationRecord record = {20 + i, 3, time(NULL), "2B"};
+        add_reservation(array, record);
+    }
+    
+    StructureHealth health;
+    int collected = collect_structure_health(&health, bst, NULL, array, avl, table, NULL);
+    report_test_result("Health Reports Degenerate BST Height",
+                       collected && health.flight_bst.height == count && health.flight_bst.optimal_height == 7);
+    report_test_result("Health Reports Balanced AVL Height",
+                       collected && health.flight_avl.height <= 8 && health.flight_avl.nodes == count);
+    report_test_result("Health Counts Every Hash Entry Once",
+                       collected && health.passenger_hash.entries == count &&
+                       health.passenger_hash.buckets == table->size);
+    report_test_result("Health Finds Largest Fan-Outs",
+                       collected && health.top_flight_count > 0 && health.top_flights[0].id == 7 &&
+                       health.top_flights[0].reservations == 6 && health.top_passengers[0].id == 3);
+    
+    const char* path = "test_health.tmp";
+    int written = write_structure_health_prometheus(path, &health);
+    char line[256];
+    int found = 0;
+    FILE* file = written ? fopen(path, "r") : NULL;
+    while (file != NULL && fgets(line, sizeof(line), file) != NULL) {
+        if (strcmp(line, "airline_tree_height{structure=\"flight_bst\"} 64\n") == 0) found = 1;
+    }
+    if (file != NULL) fclose(file);
+    report_test_result("Health Exports Prometheus Metrics", found);
+    remove(path);
+    
+    free_tree(bst);
+    free_avl_tree(avl);
+    free_hash_table(table);
+    free_reservations(array);
+}
+
+// Test that batch queries give the same answers on both prototypes
+void test_batch_queries() {
+    printf("\nTesting Batch Query Mode:\n");
+    
+    Flight flights[3] = {
+        {1, "BQ100", "Sydney", "Melbourne", time(NULL), 2},
+        {2, "BQ200", "Melbourne", "Hobart", time(NULL), 2},
+        {3, "BQ300", "Hobart", "Sydney", time(NULL), 2}
+    };
+    Passenger passengers[3] = {{1, "Ada Batch", "B0000001"}, {2, "Bo Batch", "B0000002"}, {3, "Cy Batch", "B0000003"}};
+    ReservationRecord reservations[3] = {
+        {1, 1, time(NULL), "1A"}, {1, 2, time(NULL), "1B"}, {2, 1, time(NULL), "2A"}
+    };
+    const char* queries =
+        "FLIGHT_ID 2\n"
+        "FLIGHT_ID 99\n"
+        "PASSENGER_FLIGHTS 1\n"
+        "FLIGHT_PASSENGERS 1\n"
+        "BOOK 3 3 5C\n"
+        "CANCEL 3 3\n"
+        "# comment\n"
+        "BOGUS 1\n"
+        "PASSENGER_NAME Bo Batch";  // No trailing newline
+    const char* expected[] = {"1,2,BQ200,Melbourne,Hobart,", "2,NOT_FOUND\n", "3,TOTAL,2\n", "4,TOTAL,2\n",
+                              "5,OK\n", "6,OK\n", "8,ERROR,", "9,2,Bo Batch,B0000002\n"};
+    
+    int consistent = 1;
+    int totals_ok = 1;
+    for (int p = 1; p <= 2; p++) {
+        QueryEngine* engine = create_engine(p, flights, 3, passengers, 3, reservations, 3);
+        FILE* input = tmpfile();
+        FILE* output = tmpfile();
+        if (engine == NULL || input == NULL || output == NULL) {
+            consistent = 0;
+        } else {
+            fputs(queries, input);
+            rewind(input);
+            
+            BatchStats stats;
+            consistent &= run_batch(engine, input, output, &stats);
+            totals_ok &= stats.queries == 8 && stats.errors == 1 && stats.not_found == 1;
+            
+            // Every expected line must appear in the output
+            rewind(output);
+            char line[256];
+            int found[8] = {0};
+            while (fgets(line, sizeof(line), output) != NULL) {
+                for (int e = 0; e < 8; e++) {
+                    if (strncmp(line, expected[e], strlen(expected[e])) == 0) found[e] = 1;
+                }
+            }
+            for (int e = 0; e < 8; e++) {
+                consistent &= found[e];
+            }
+        }
+        if (input != NULL) fclose(input);
+        if (output != NULL) fclose(output);
+        destroy_engine(engine);
+    }
+    
+    report_test_result("Batch Queries Answer Every Operation On Both Prototypes", consistent);
+    report_test_result("Batch Totals Count Queries, Misses And Errors", totals_ok);
+}
+
+// Runs a query server until it is stopped (test thread body)
+static void* serve_in_thread(void* argument) {
+    void** server_and_engine = (void**)argument;
+    server_run((QueryServer*)server_and_engine[0], (QueryEngine*)server_and_engine[1]);
+    return NULL;
+}
+
+// Test for the binary protocol, the epoll query server and the pipelined load generator
+void test_query_server() {
+    printf("\nTesting Query Server:\n");
+    
+    // Requests and responses survive an encode/decode round trip
+    ProtocolRequest request = {PROTOCOL_BOOK, 42, 7, 9, "12C", 0, 0};
+    ProtocolRequest decoded;
+    char frame[PROTOCOL_MAX_REQUEST];
+    size_t size = protocol_encode_request(frame, &request);
+    int round_trip = protocol_frame_length(frame, size) == (long)size &&
+                     protocol_frame_length(frame, size - 1) == 0 &&
+                     protocol_decode_request(frame + PROTOCOL_HEADER_SIZE, size - PROTOCOL_HEADER_SIZE, &decoded) &&
+                     decoded.op == PROTOCOL_BOOK && decoded.id == 42 && decoded.flightId == 7 &&
+                     decoded.passengerId == 9 && strcmp(decoded.key, "12C") == 0;
+    
+    Flight flight = {5, "QS500", "Hobart", "Perth", 1700000000, 180};
+    OutputBuffer out;
+    ProtocolResponse response;
+    round_trip &= output_buffer_init(&out, NULL, 256) && protocol_encode_flight(&out, 77, &flight) &&
+                  protocol_decode_response(out.data + PROTOCOL_HEADER_SIZE, out.length - PROTOCOL_HEADER_SIZE,
+                                           PROTOCOL_FLIGHT_BY_ID, &response) &&
+                  response.id == 77 && response.status == PROTOCOL_OK && response.flight.id == 5 &&
+                  strcmp(response.flight.destination, "Perth") == 0 && response.flight.capacity == 180;
+    // A truncated payload is rejected rather than read past its end
+    round_trip &= !protocol_decode_response(out.data + PROTOCOL_HEADER_SIZE, 10, PROTOCOL_FLIGHT_BY_ID, &response);
+    output_buffer_free(&out);
+    report_test_result("Protocol Frames Round Trip And Reject Truncation", round_trip);
+    
+    // Serve a small dataset on a Unix socket and answer a generated trace over pipelined connections
+    Flight flights[3] = {
+        {1, "QS100", "Sydney", "Melbourne", time(NULL), 3},
+        {2, "QS200", "Melbourne", "Hobart", time(NULL), 3},
+        {3, "QS300", "Hobart", "Sydney", time(NULL), 3}
+    };
+    Passenger passengers[3] = {{1, "Ada Server", "S0000001"}, {2, "Bo Server", "S0000002"}, {3, "Cy Server", "S0000003"}};
+    ReservationRecord reservations[3] = {
+        {1, 1, time(NULL), "1A"}, {1, 2, time(NULL), "1B"}, {2, 1, time(NULL), "2A"}
+    };
+    TraceConfig config = default_trace_config();
+    config.op_count = 2000;
+    Trace* trace = generate_trace(&config, flights, 3, passengers, 3, reservations, 3);
+    QueryEngine* engine = create_engine(2, flights, 3, passengers, 3, reservations, 3);
+    QueryServer* server = engine != NULL ? server_open("unix:test_query_server.sock") : NULL;
+    
+    int served = 0;
+    int counted = 0;
+    pthread_t thread;
+    void* server_and_engine[2] = {server, engine};
+    if (trace != NULL && server != NULL && pthread_create(&thread, NULL, serve_in_thread, server_and_engine) == 0) {
+        LoadStats stats;
+        served = run_load_generator("unix:test_query_server.sock", trace, 3, 8, &stats) &&
+                 stats.completed == trace->count && stats.errors == 0 && stats.latency->total_count == (uint64_t)trace->count;
+        histogram_free(stats.latency);
+        
+        server_stop(server);
+        pthread_join(thread, NULL);
+        ServerStats server_totals = server_stats(server);
+        counted = server_totals.connections == 3 && server_totals.requests == trace->count && server_totals.errors == 0;
+    }
+    if (server != NULL) server_close(server);
+    destroy_engine(engine);
+    free_trace(trace);
+    
+    report_test_result("Query Server Answers Every Pipelined Request", served);
+    report_test_result("Query Server Counts Connections And Requests", counted);
+}
+
+// Shared state of the concurrent booking stress test
+typedef struct {
+    QueryEngine* engine;
+    int thread_index;
+    int flight_count;
+    int capacity;
+    int* booked;      // Net bookings per flight (atomic)
+    int* stop;        // Set once all booking threads have finished
+    int* violations;  // Times a reader saw a flight over capacity
+} StressWorker;
+
+// Books seats on every flight in turn, cancelling every fifth booking it gets
+static void* stress_book(void* argument) {
+    StressWorker* worker = (StressWorker*)argument;
+    for (int i = 0; i < 200; i++) {
+        ReservationRecord record = {i % worker->flight_count + 1, worker->thread_index * 1000 + i, time(NULL), ""};
+        // Every attempt gets its own seat, since the sharded engine also rejects taken seats
+        snprintf(record.seatNumber, sizeof(record.seatNumber), "%d", record.passengerId);
+        if (!worker->engine->book(worker->engine->state, record)) continue;
+        __atomic_add_fetch(&worker->booked[record.flightId - 1], 1, __ATOMIC_RELAXED);
+        if (i % 5 == 0 && worker->engine->cancel(worker->engine->state, record.flightId, record.passengerId)) {
+            __atomic_sub_fetch(&worker->booked[record.flightId - 1], 1, __ATOMIC_RELAXED);
+        }
+    }
+    return NULL;
+}
+
+// Lists every flight's passengers until told to stop, checking none is ever over capacity
+static void* stress_read(void* argument) {
+    StressWorker* worker = (StressWorker*)argument;
+    ReservationRecord* records = NULL;
+    int capacity = 0;
+    while (!__atomic_load_n(worker->stop, __ATOMIC_ACQUIRE)) {
+        for (int f = 1; f <= worker->flight_count; f++) {
+            int count = worker->engine->flight_reservations(worker->engine->state, f, &records, &capacity);
+            if (count > worker->capacity) __atomic_add_fetch(worker->violations, 1, __ATOMIC_RELAXED);
+            worker->engine->find_flight(worker->engine->state, f);
+            worker->engine->count_passenger_bookings(worker->engine->state, worker->thread_index * 1000 + f);
+        }
+    }
+    free(records);
+    return NULL;
+}
+
+// Test for the thread-safe engines (3 and 4) under concurrent bookings and reads
+void test_concurrent_engine() {
+    printf("\nTesting Concurrent Engine:\n");
+    
+    enum { FLIGHTS = 4, CAPACITY = 40, BOOKERS = 6, READERS = 2 };
+    Flight flights[FLIGHTS];
+    for (int f = 0; f < FLIGHTS; f++) {
+        Flight flight = {f + 1, "", "Hobart", "Sydney", time(NULL), CAPACITY};
+        snprintf(flight.flightNumber, sizeof(flight.flightNumber), "CC%d", f + 1);
+        flights[f] = flight;
+    }
+    Passenger passenger = {1, "Concurrent Tester", "C0000001"};
+    
+    int within_capacity = 1;
+    int counts_match = 1;
+    for (int p = 3; p <= 4; p++) {
+        QueryEngine* engine = create_engine(p, flights, FLIGHTS, &passenger, 1, NULL, 0);
+        if (engine == NULL) {
+            within_capacity = counts_match = 0;
+            continue;
+        }
+        
+        int booked[FLIGHTS] = {0};
+        int stop = 0;
+        int violations = 0;
+        StressWorker workers[BOOKERS + READERS];
+        pthread_t threads[BOOKERS + READERS];
+        int started[BOOKERS + READERS] = {0};
+        for (int t = 0; t < BOOKERS + READERS; t++) {
+            StressWorker worker = {engine, t + 1, FLIGHTS, CAPACITY, booked, &stop, &violations};
+            workers[t] = worker;
+            started[t] = pthread_create(&threads[t], NULL, t < BOOKERS ? stress_book : stress_read, &workers[t]) == 0;
+        }
+        for (int t = 0; t < BOOKERS; t++) {
+            if (started[t]) pthread_join(threads[t], NULL);
+        }
+        __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+        for (int t = BOOKERS; t < BOOKERS + READERS; t++) {
+            if (started[t]) pthread_join(threads[t], NULL);
+        }
+        
+        // 6 threads x 50 attempts per flight is far over capacity, so every flight ends up full
+        within_capacity &= violations == 0;
+        ReservationRecord* records = NULL;
+        int capacity = 0;
+        for (int f = 1; f <= FLIGHTS; f++) {
+            int count = engine->flight_reservations(engine->state, f, &records, &capacity);
+            within_capacity &= count <= CAPACITY;
+            counts_match &= count == booked[f - 1] && count == CAPACITY;
+        }
+        free(records);
+        destroy_engine(engine);
+    }
+    
+    report_test_result("Concurrent Bookings Never Exceed Flight Capacity", within_capacity);
+    report_test_result("Concurrent Booking Totals Match Final Passenger Counts", counts_match);
+}
+
+// Books two-leg itineraries, in either leg order depending on the thread
+static void* stress_itinerary(void* argument) {
+    StressWorker* worker = (StressWorker*)argument;
+    for (int i = 0; i < 100; i++) {
+        int passengerId = worker->thread_index * 1000 + i;
+        ReservationRecord legs[2] = {{1, passengerId, time(NULL), ""}, {2, passengerId, time(NULL), ""}};
+        if (worker->thread_index % 2 == 0) {
+            legs[0].flightId = 2;
+            legs[1].flightId = 1;
+        }
+        if (sharded_book_itinerary(worker->engine, legs, 2)) {
+            __atomic_add_fetch(&worker->booked[0], 1, __ATOMIC_RELAXED);
+        }
+    }
+    return NULL;
+}
+
+// Test for seat uniqueness, capacity counts and all-or-nothing itineraries in the sharded engine
+void test_sharded_engine() {
+    printf("\nTesting Sharded Booking Engine:\n");
+    
+    Flight flights[3] = {
+        {1, "SH100", "Sydney", "Melbourne", time(NULL), 2},
+        {2, "SH200", "Melbourne", "Hobart", time(NULL), 2},
+        {3, "SH300", "Hobart", "Sydney", time(NULL), 2}
+    };
+    Passenger passenger = {1, "Shard Tester", "H0000001"};
+    QueryEngine* engine = create_engine(4, flights, 3, &passenger, 1, NULL, 0);
+    
+    int rules = 0;
+    int itineraries = 0;
+    if (engine != NULL) {
+        ReservationRecord a = {1, 1, time(NULL), "1A"};
+        ReservationRecord b = {1, 2, time(NULL), "1A"};
+        ReservationRecord c = {1, 2, time(NULL), "1B"};
+        ReservationRecord d = {1, 3, time(NULL), "1C"};
+        ReservationRecord e = {1, 1, time(NULL), "2A"};
+        rules = engine->book(engine->state, a) &&
+                !engine->book(engine->state, b) &&   // Seat taken
+                engine->book(engine->state, c) &&
+                !engine->book(engine->state, d) &&   // Flight full
+                engine->book(engine->state, e) &&    // Passenger 1 already on board
+                engine->cancel(engine->state, 1, 2) &&
+                engine->book(engine->state, d);      // Passenger 2's seat freed up
+        
+        // Flight 1 is full, so an itinerary through it books nothing
+        ReservationRecord blocked[2] = {{2, 4, time(NULL), "3A"}, {1, 4, time(NULL), "3B"}};
+        ReservationRecord open[2] = {{2, 5, time(NULL), "4A"}, {3, 5, time(NULL), "4B"}};
+        ReservationRecord* records = NULL;
+        int capacity = 0;
+        itineraries = !sharded_book_itinerary(engine, blocked, 2) &&
+                      engine->flight_reservations(engine->state, 2, &records, &capacity) == 0 &&
+                      sharded_book_itinerary(engine, open, 2) &&
+                      engine->count_passenger_bookings(engine->state, 5) == 2;
+        free(records);
+    }
+    destroy_engine(engine);
+    report_test_result("Sharded Engine Rejects Taken Seats And Full Flights", rules);
+    report_test_result("Sharded Engine Books Itineraries All Or Nothing", itineraries);
+    
+    // Threads booking the same two flights in opposite orders must neither deadlock nor
+    // leave one flight with more passengers than the other
+    Flight pair[2] = {{1, "SH100", "Sydney", "Melbourne", time(NULL), 50}, {2, "SH200", "Melbourne", "Hobart", time(NULL), 50}};
+    engine = create_engine(4, pair, 2, &passenger, 1, NULL, 0);
+    int balanced = 0;
+    if (engine != NULL) {
+        int booked[1] = {0};
+        StressWorker workers[4];
+        pthread_t threads[4];
+        int started[4];
+        for (int t = 0; t < 4; t++) {
+            StressWorker worker = {engine, t + 1, 2, 50, booked, NULL, NULL};
+            workers[t] = worker;
+            started[t] = pthread_create(&threads[t], NULL, stress_itinerary, &workers[t]) == 0;
+        }
+        for (int t = 0; t < 4; t++) {
+            if (started[t]) pthread_join(threads[t], NULL);
+        }
+        ReservationRecord* records = NULL;
+        int capacity = 0;
+        int first = engine->flight_reservations(engine->state, 1, &records, &capacity);
+        int second = engine->flight_reservations(engine->state, 2, &records, &capacity);
+        balanced = first == 50 && second == 50 && booked[0] == 50;
+        free(records);
+    }
+    destroy_engine(engine);
+    report_test_result("Concurrent Opposite-Order Itineraries Stay Balanced", balanced);
+}
+
+// In-order walk of a snapshot: checks IDs ascend and every node is AVL-balanced with the
+// right height. Returns the height, or -1 if the snapshot is broken
+static int check_snapshot(AVL_Node* node, int* last_id, int* count) {
+    if (node == NULL) {
+        return 0;
+    }
+    int left = check_snapshot(node->left, last_id, count);
+    if (left < 0 || node->data.id <= *last_id) {
+        return -1;
+    }
+    *last_id = node->data.id;
+    (*count)++;
+    int right = check_snapshot(node->right, last_id, count);
+    if (right < 0 || abs(left - right) > 1) {
+        return -1;
+    }
+    int height = 1 + (left > right ? left : right);
+    return node->height == height ? height : -1;
+}
+
+// Reader of the persistent tree test: scans snapshots until stopped
+typedef struct {
+    PersistentFlightTree* tree;
+    int reader;
+    int* stop;
+    int scans;
+    int errors;  // Scans that were broken or saw fewer flights than an earlier one
+} SnapshotScanner;
+
+static void* scan_snapshots(void* argument) {
+    SnapshotScanner* scanner = (SnapshotScanner*)argument;
+    int previous = 0;
+    do {
+        AVL_Node* snapshot = pavl_read_begin(scanner->tree, scanner->reader);
+        int last_id = -1;
+        int count = 0;
+        if (check_snapshot(snapshot, &last_id, &count) < 0 || count < previous) {
+            scanner->errors++;
+        }
+        pavl_read_end(scanner->tree, scanner->reader);
+        previous = count;
+        scanner->scans++;
+    } while (!__atomic_load_n(scanner->stop, __ATOMIC_ACQUIRE));
+    return NULL;
+}
+
+// Test the persistent AVL tree: snapshot isolation, balance, reclamation and concurrent scans
+void test_persistent_avl() {
+    printf("\nTesting Persistent AVL Flight Tree:\n");
+    
+    PersistentFlightTree* tree = pavl_create();
+    if (tree == NULL) {
+        report_test_result("Persistent AVL Snapshot Keeps Old Version", 0);
+        return;
+    }
+    Flight flight = {0, "PA000", "Perth", "Darwin", time(NULL), 100};
+    for (int i = 1; i <= 10; i++) {
+        flight.id = i;
+        pavl_insert(tree, flight);
+    }
+    
+    // A snapshot taken now must not see later inserts or replacements, and nothing it can
+    // reach may be freed while it is held
+    AVL_Node* old_root = pavl_read_begin(tree, 0);
+    for (int i = 11; i <= 1000; i++) {
+        flight.id = i;
+        pavl_insert(tree, flight);
+    }
+    flight.id = 5;
+    flight.capacity = 7;
+    pavl_insert(tree, flight);
+    int last_id = -1;
+    int old_count = 0;
+    int old_ok = check_snapshot(old_root, &last_id, &old_count) > 0 && old_count == 10 &&
+                 avl_find_flight(old_root, 5)->capacity == 100 && avl_find_flight(old_root, 11) == NULL &&
+                 tree->retired_count > 0;
+    pavl_read_end(tree, 0);
+    report_test_result("Persistent AVL Snapshot Keeps Old Version", old_ok);
+    
+    AVL_Node* new_root = pavl_read_begin(tree, 0);
+    last_id = -1;
+    int new_count = 0;
+    int height = check_snapshot(new_root, &last_id, &new_count);
+    int new_ok = height > 0 && height <= 15 && new_count == 1000 && tree->count == 1000 &&
+                 avl_find_flight(new_root, 5)->capacity == 7 && avl_find_flight(new_root, 1000) != NULL;
+    pavl_read_end(tree, 0);
+    report_test_result("Persistent AVL Latest Version Is Complete And Balanced", new_ok);
+    
+    // With every reader idle, the next insert frees everything retired so far
+    flight.id = 1001;
+    pavl_insert(tree, flight);
+    report_test_result("Persistent AVL Reclaims Nodes Once Readers Finish", tree->retired_count == 0 && tree->reclaimed > 0);
+    
+    // Readers scanning while a writer inserts always see a whole, balanced version
+    int stop = 0;
+    SnapshotScanner scanners[3];
+    pthread_t threads[3];
+    int started[3];
+    for (int t = 0; t < 3; t++) {
+        SnapshotScanner scanner = {tree, t, &stop, 0, 0};
+        scanners[t] = scanner;
+        started[t] = pthread_create(&threads[t], NULL, scan_snapshots, &scanners[t]) == 0;
+    }
+    for (int i = 1002; i <= 5000; i++) {
+        flight.id = i;
+        pavl_insert(tree, flight);
+    }
+    __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+    int errors = 0;
+    int scans = 0;
+    for (int t = 0; t < 3; t++) {
+        if (started[t]) {
+            pthread_join(threads[t], NULL);
+            errors += scanners[t].errors;
+            scans += scanners[t].scans;
+        }
+    }
+    report_test_result("Persistent AVL Concurrent Scans See Consistent Versions",
+                       errors == 0 && scans >= 3 && tree->count == 5000);
+    pavl_free(tree);
+}
+
+// Reader of the versioned reservation test: checks every snapshot of flight 1 holds one
+// contiguous run of passengers, as the writer keeps it
+typedef struct {
+    MvccReservationStore* store;
+    int reader;
+    int* stop;
+    int scans;
+    int errors;
+} MvccScanner;
+
+static void* scan_versions(void* argument) {
+    MvccScanner* scanner = (MvccScanner*)argument;
+    ReservationRecord* records = NULL;
+    int capacity = 0;
+    do {
+        unsigned long snapshot = mvcc_snapshot_begin(scanner->store, scanner->reader);
+        int count = mvcc_find_by_flight(scanner->store, snapshot, 1, &records, &capacity);
+        mvcc_snapshot_end(scanner->store, scanner->reader);
+        if (count < 0 || count > 51 ||
+            (count > 0 && records[count - 1].passengerId - records[0].passengerId + 1 != count)) {
+            scanner->errors++;
+        }
+        scanner->scans++;
+    } while (!__atomic_load_n(scanner->stop, __ATOMIC_ACQUIRE));
+    free(records);
+    return NULL;
+}
+
+// Test the multi-version reservation store: snapshots, cancellations as version ends,
+// garbage collection and scans running alongside a writer
+void test_mvcc_reservations() {
+    printf("\nTesting Multi-Version Reservations:\n");
+    
+    ReservationBST* bst = init_reservation_bst();
+    MvccReservationStore* store = mvcc_create();
+    if (bst == NULL || store == NULL) {
+        free_reservation_bst(bst);
+        mvcc_free(store);
+        report_test_result("MVCC Snapshot Sees A Consistent Old State", 0);
+        return;
+    }
+    for (int p = 1; p <= 5; p++) {
+        ReservationRecord record = {10, p, time(NULL), "1A"};
+        record.seatNumber[0] = (char)('0' + p);
+        add_reservation_bst(bst, record);
+    }
+    unsigned long imported = mvcc_import_bst(store, bst);
+    free_reservation_bst(bst);
+    
+    // An open snapshot keeps seeing the imported state while bookings and cancellations commit
+    unsigned long before = mvcc_snapshot_begin(store, 0);
+    ReservationRecord extra = {10, 6, time(NULL), "6A"};
+    mvcc_book(store, extra);
+    unsigned long cancelled_at = mvcc_cancel(store, 10, 2);
+    unsigned long missing = mvcc_cancel(store, 10, 99);
+    ReservationRecord* records = NULL;
+    int capacity = 0;
+    int old_count = mvcc_find_by_flight(store, before, 10, &records, &capacity);
+    int old_has_2 = old_count == 5 && records[1].passengerId == 2;
+    unsigned long after = mvcc_snapshot_begin(store, 1);
+    int new_count = mvcc_find_by_flight(store, after, 10, &records, &capacity);
+    int new_ok = new_count == 5 && records[1].passengerId == 3 && records[4].passengerId == 6;
+    mvcc_snapshot_end(store, 1);
+    report_test_result("MVCC Snapshot Sees A Consistent Old State",
+                       imported == 1 && old_has_2 && new_ok && cancelled_at == 3 && missing == 0);
+    
+    // The cancellation only ended a version; nothing is freed while the old snapshot is open
+    int kept = store->version_count == 6 && store->live_count == 5 && mvcc_collect_garbage(store) == 0 &&
+               mvcc_find_by_flight(store, before, 10, &records, &capacity) == 5;
+    mvcc_snapshot_end(store, 0);
+    int freed = mvcc_collect_garbage(store);
+    int by_passenger = mvcc_find_by_passenger(store, mvcc_snapshot_begin(store, 0), 6, &records, &capacity);
+    mvcc_snapshot_end(store, 0);
+    report_test_result("MVCC Garbage Collection Waits For Open Snapshots",
+                       kept && freed == 1 && store->version_count == 5 && by_passenger == 1);
+    free(records);
+    
+    // Readers scanning while a writer books passenger i and cancels passenger i - 50
+    int stop = 0;
+    MvccScanner scanners[2];
+    pthread_t threads[2];
+    int started[2];
+    for (int t = 0; t < 2; t++) {
+        MvccScanner scanner = {store, t, &stop, 0, 0};
+        scanners[t] = scanner;
+        started[t] = pthread_create(&threads[t], NULL, scan_versions, &scanners[t]) == 0;
+    }
+    for (int i = 1; i <= 3000; i++) {
+        ReservationRecord record = {1, i, time(NULL), "1A"};
+        mvcc_book(store, record);
+        if (i > 50) mvcc_cancel(store, 1, i - 50);
+    }
+    __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+    int errors = 0;
+    int scans = 0;
+    for (int t = 0; t < 2; t++) {
+        if (started[t]) {
+            pthread_join(threads[t], NULL);
+            errors += scanners[t].errors;
+            scans += scanners[t].scans;
+        }
+    }
+    mvcc_collect_garbage(store);
+    report_test_result("MVCC Concurrent Scans See Committed States Only",
+                       errors == 0 && scans >= 2 && store->live_count == 55 && store->version_count == 55 &&
+                       store->collected > 2900);
+    mvcc_free(store);
+}
+
+// Test rank/select and cursor pagination on the AVL tree, the matching prototype 1 walks,
+// and flight pages through every engine and the query protocol
+void test_order_statistics() {
+    printf("\nTesting Order Statistics And Flight Pages:\n");
+    
+    // IDs 10, 20, ..., 5000 inserted in a scrambled order
+    int n = 500;
+    Flight* flights = (Flight*)malloc(n * sizeof(Flight));
+    Flight* page = (Flight*)malloc(n * sizeof(Flight));
+    if (flights == NULL || page == NULL) {
+        free(flights);
+        free(page);
+        report_test_result("AVL Select And Rank Match Sorted Order", 0);
+        return;
+    }
+    AVL_Node* avl = NULL;
+    BST_Node* bst = NULL;
+    for (int i = 0; i < n; i++) {
+        Flight flight = {((i * 263) % n + 1) * 10, "OS000", "Alice Springs", "Cairns", time(NULL), 50};
+        flights[i] = flight;
+        avl = avl_insert(avl, flight);
+        bst = insert(bst, flight);
+    }
+    
+    int select_ok = avl_size(avl) == n;
+    for (int k = 0; k < n && select_ok; k++) {
+        Flight* kth = avl_select(avl, k);
+        select_ok = kth != NULL && kth->id == (k + 1) * 10 && avl_rank(avl, kth->id) == k &&
+                    avl_rank(avl, kth->id + 1) == k + 1;
+    }
+    select_ok &= avl_select(avl, n) == NULL && avl_select(avl, -1) == NULL;
+    report_test_result("AVL Select And Rank Match Sorted Order", select_ok);
+    
+    // Range counts against a brute-force count, on both prototypes
+    int ranges[][2] = {{0, 100000}, {10, 10}, {15, 95}, {4990, 6000}, {300, 200}, {INT_MIN, INT_MAX}, {-50, 5}};
+    int range_ok = 1;
+    for (int r = 0; r < (int)(sizeof(ranges) / sizeof(ranges[0])); r++) {
+        int expected = 0;
+        for (int i = 0; i < n; i++) {
+            if (flights[i].id >= ranges[r][0] && flights[i].id <= ranges[r][1]) expected++;
+        }
+        range_ok &= avl_count_range(avl, ranges[r][0], ranges[r][1]) == expected &&
+                    count_flights_in_range(bst, ranges[r][0], ranges[r][1]) == expected;
+    }
+    report_test_result("Flight Range Counts Match A Full Scan", range_ok);
+    
+    // Paging by position and by cursor both visit every flight once, in order
+    int paging_ok = 1;
+    int after = INT_MIN;
+    int seen = 0;
+    for (int start = 0; start < n; start += 37) {
+        int by_rank = avl_list_flights_from_rank(avl, start, page, 37);
+        int p1_rank = list_flights_from_rank(bst, start, page + by_rank, 37);
+        paging_ok &= by_rank == (n - start < 37 ? n - start : 37) && p1_rank == by_rank &&
+                     page[0].id == (start + 1) * 10 && page[by_rank].id == page[0].id;
+        
+        int by_cursor = avl_list_flights_after(avl, after, page, 37);
+        for (int i = 0; i < by_cursor; i++) {
+            paging_ok &= page[i].id == (seen + 1) * 10;
+            seen++;
+        }
+        if (by_cursor > 0) after = page[by_cursor - 1].id;
+    }
+    paging_ok &= seen == n && avl_list_flights_after(avl, after, page, 37) == 0 &&
+                 list_flights_after(bst, 4995, page, 10) == 1 && page[0].id == 5000;
+    AvlCursor cursor;
+    avl_cursor_seek(&cursor, avl, 4995);
+    paging_ok &= avl_cursor_next(&cursor)->id == 5000 && avl_cursor_next(&cursor) == NULL;
+    report_test_result("Flight Pages Visit Every Flight In Order", paging_ok);
+    free_avl_tree(avl);
+    free_tree(bst);
+    
+    // Every engine answers the same pages, and a page survives the query protocol
+    int engines_ok = 1;
+    for (int p = 1; p <= 4; p++) {
+        QueryEngine* engine = create_engine(p, flights, n, NULL, 0, NULL, 0);
+        if (engine == NULL) {
+            engines_ok = 0;
+            continue;
+        }
+        int count = engine->list_flights(engine->state, 95, page, 3);
+        engines_ok &= count == 3 && page[0].id == 100 && page[2].id == 120 &&
+                      engine->count_flights(engine->state, 100, 199) == 10;
+        destroy_engine(engine);
+    }
+    OutputBuffer out;
+    ProtocolResponse response;
+    int round_trip = output_buffer_init(&out, NULL, 1024) &&
+                     protocol_encode_flights(&out, 9, page, 3) &&
+                     protocol_decode_response(out.data + PROTOCOL_HEADER_SIZE, out.length - PROTOCOL_HEADER_SIZE,
+                                              PROTOCOL_LIST_FLIGHTS, &response) &&
+                     response.count == 3 && response.flight.id == 120;
+    output_buffer_free(&out);
+    report_test_result("Engines And Protocol Serve Flight Pages", engines_ok && round_trip);
+    
+    free(flights);
+    free(page);
+}
+
+// Check that every node of an AVL tree is ordered, balanced and has the right height and size
+static int check_avl_shape(AVL_Node* node, int low, int high, int* height, int* size) {
+    if (node == NULL) {
+        *height = 0;
+        *size = 0;
+        return 1;
+    }
+    int left_height, left_size, right_height, right_size;
+    int ok = node->data.id >= low && node->data.id <= high &&
+             check_avl_shape(node->left, low, node->data.id - 1, &left_height, &left_size) &&
+             check_avl_shape(node->right, node->data.id + 1, high, &right_height, &right_size);
+    if (!ok) return 0;
+    *height = 1 + (left_height > right_height ? left_height : right_height);
+    *size = 1 + left_size + right_size;
+    return node->height == *height && node->size == *size && abs(left_height - right_height) <= 1;
+}
+
+// Test flight deletion and the cancellation cascade on both prototypes
+void test_flight_cancellation() {
+    printf("\nTesting Flight Cancellation:\n");
+    
+    // Delete a third of the flights in a scrambled order, checking the tree after each one
+    int n = 600;
+    AVL_Node* avl = NULL;
+    for (int i = 0; i < n; i++) {
+        Flight flight = {(i * 271) % n + 1, "CX000", "Hobart", "Perth", 0, 10};
+        avl = avl_insert(avl, flight);
+    }
+    int shape_ok = 1;
+    int height, size;
+    for (int i = 0; i < n; i += 3) {
+        int deleted = 0;
+        int id = (i * 389) % n + 1;
+        avl = avl_delete(avl, id, &deleted);
+        shape_ok &= deleted && avl_find_flight(avl, id) == NULL && check_avl_shape(avl, INT_MIN, INT_MAX, &height, &size);
+    }
+    int deleted = 0;
+    avl = avl_delete(avl, n + 1, &deleted);
+    shape_ok &= !deleted && avl_size(avl) == n - n / 3;
+    report_test_result("AVL Delete Keeps The Tree Balanced", shape_ok);
+    free_avl_tree(avl);
+    
+    // Flights 1..20, two a day; every flight has between 0 and 9 reservations, booked in a
+    // scrambled order so the reservation BST has some shape
+    int flight_total = 20;
+    time_t base = 1767225600;  // 2026-01-01 00:00 UTC
+    BST_Node* bst = NULL;
+    avl = NULL;
+    for (int i = 1; i <= flight_total; i++) {
+        Flight flight = {i, "CX000", "Hobart", "Perth", base + (i - 1) / 2 * 86400 + (i % 2) * 3600, 10};
+        bst = insert(bst, flight);
+        avl = avl_insert(avl, flight);
+    }
+    ReservationArray* array = init_reservations(16);
+    ReservationBST* reservation_bst = init_reservation_bst();
+    int booked = 0;
+    for (int i = 0; i < 400; i++) {
+        int key = (i * 151) % 400;
+        int flight_id = key / 20 + 1;
+        int passenger_id = key % 20 + 1;
+        if (passenger_id > flight_id % 10) continue;
+        ReservationRecord record = {flight_id, passenger_id, base, "1A"};
+        add_reservation(array, record);
+        add_reservation_bst(reservation_bst, record);
+        booked++;
+    }
+    
+    ReservationRecord* p1_records = NULL;
+    ReservationRecord* p2_records = NULL;
+    int p1_capacity = 0;
+    int p2_capacity = 0;
+    int expected = count_passengers_by_flight(reservation_bst, 7);
+    int p1_count = cancel_flight(array, &bst, 7, &p1_records, &p1_capacity);
+    int p2_count = cancel_flight_bst(reservation_bst, &avl, 7, &p2_records, &p2_capacity);
+    int single_ok = expected == 7 && p1_count == 7 && p2_count == 7 &&
+                    find_flight(bst, 7) == NULL && avl_find_flight(avl, 7) == NULL &&
+                    count_passengers_by_flight(reservation_bst, 7) == 0 &&
+                    count_passengers_by_flight_array(array, 7) == 0 &&
+                    reservation_bst->count == booked - 7 && array->count == booked - 7;
+    for (int i = 0; i < p2_count; i++) {
+        single_ok &= p2_records[i].flightId == 7 && p1_records[i].flightId == 7;
+    }
+    single_ok &= cancel_flight_bst(reservation_bst, &avl, 7, &p2_records, &p2_capacity) == -1 &&
+                 cancel_flight(array, &bst, 7, &p1_records, &p1_capacity) == -1;
+    report_test_result("Cancelling A Flight Returns Its Passengers", single_ok);
+    
+    // Day 4 holds flights 7 (already gone) and 8; day 2 holds flights 3 and 4
+    int p1_flights = 0;
+    int p2_flights = 0;
+    int day_ok = 1;
+    for (int day = 1; day <= 3; day += 2) {
+        p1_count = cancel_departures(array, &bst, base + day * 86400, base + (day + 1) * 86400, &p1_flights,
+                                     &p1_records, &p1_capacity);
+        p2_count = cancel_departures_bst(reservation_bst, &avl, base + day * 86400, base + (day + 1) * 86400,
+                                         &p2_flights, &p2_records, &p2_capacity);
+        day_ok &= p1_count == p2_count && p1_flights == p2_flights;
+    }
+    day_ok &= p1_flights == 1 && p2_count == 8 && avl_size(avl) == flight_total - 4 &&
+              reservation_bst->count == booked - 7 - 3 - 4 - 8 && array->count == reservation_bst->count;
+    for (int i = 1; i <= flight_total; i++) {
+        int gone = i == 3 || i == 4 || i == 7 || i == 8;
+        day_ok &= (avl_find_flight(avl, i) == NULL) == gone && (find_flight(bst, i) == NULL) == gone &&
+                  count_passengers_by_flight(reservation_bst, i) == (gone ? 0 : i % 10) &&
+                  count_passengers_by_flight_array(array, i) == (gone ? 0 : i % 10);
+    }
+    report_test_result("Cancelling A Day's Departures Matches On Both Prototypes", day_ok);
+    
+    free(p1_records);
+    free(p2_records);
+    free_tree(bst);
+    free_avl_tree(avl);
+    free_reservations(array);
+    free_reservation_bst(reservation_bst);
+}
+
+// Count the test flights departing in [from, to) with a plain scan
+static int count_window(const Flight* flights, int count, time_t from, time_t to) {
+    int matches = 0;
+    for (int i = 0; i < count; i++) {
+        if (flights[i].departureTime >= from && flights[i].departureTime < to) matches++;
+    }
+    return matches;
+}
+
+// Test flights partitioned by departure day, pruning and archiving with lazy reloads
+void test_flight_partitions() {
+    printf("\nTesting Time-Partitioned Flights:\n");
+    
+    char archive_dir[] = "/tmp/airline_partitions_XXXXXX";
+    if (mkdtemp(archive_dir) == NULL) {
+        report_test_result("Partition Windows Match A Full Scan", 0);
+        return;
+    }
+    PartitionedFlightStore* store = partition_store_create(archive_dir);
+    
+    // 40 flights over 10 local days starting 2026-03-01; passenger 500 flies on flights 3 and 27
+    struct tm first_day = {0};
+    first_day.tm_year = 2026 - 1900;
+    first_day.tm_mon = 2;
+    first_day.tm_mday = 1;
+    first_day.tm_isdst = -1;
+    time_t day_starts[11];
+    for (int d = 0; d <= 10; d++) {
+        struct tm day = first_day;
+        day.tm_mday += d;
+        day_starts[d] = mktime(&day);
+    }
+    Flight flights[40];
+    int added = 1;
+    for (int i = 0; i < 40; i++) {
+        Flight flight = {i + 1, "QF000", "Hobart", "Sydney", day_starts[(i * 7) % 10] + (i % 20) * 3600, 100};
+        flights[i] = flight;
+        added &= partition_store_add_flight(store, flight) &&
+                 partition_store_add_reservation(store, (ReservationRecord){i + 1, 100 + i % 5, 0, "1A"});
+    }
+    added &= partition_store_add_reservation(store, (ReservationRecord){3, 500, 0, "2B"}) &&
+             partition_store_add_reservation(store, (ReservationRecord){27, 500, 0, "2B"}) &&
+             !partition_store_add_reservation(store, (ReservationRecord){99, 500, 0, "2B"});
+    Flight moved = flights[0];
+    moved.departureTime = day_starts[9];
+    added &= !partition_store_add_flight(store, moved);
+    
+    // A whole day, a window cutting three days, and one past the last day
+    time_t windows[][2] = {{day_starts[2], day_starts[3]},
+                           {day_starts[2] + 5 * 3600, day_starts[4] + 3600},
+                           {day_starts[0], day_starts[10]},
+                           {day_starts[10], day_starts[10] + 86400}};
+    int window_count = (int)(sizeof(windows) / sizeof(windows[0]));
+    Flight* found = NULL;
+    int found_capacity = 0;
+    int windows_ok = added && store->count == 10;
+    for (int w = 0; w < window_count; w++) {
+        windows_ok &= partition_list_departures(store, windows[w][0], windows[w][1], &found, &found_capacity) ==
+                      count_window(flights, 40, windows[w][0], windows[w][1]);
+    }
+    report_test_result("Partition Windows Match A Full Scan", windows_ok);
+    
+    // Flight 3 departs on day 4 and flight 27 on day 2
+    ReservationRecord* records = NULL;
+    int record_capacity = 0;
+    int passenger_ok = partition_passenger_reservations(store, 500, day_starts[0], day_starts[10],
+                                                        &records, &record_capacity) == 2 &&
+                       partition_passenger_reservations(store, 500, day_starts[2], day_starts[3],
+                                                        &records, &record_capacity) == 1 &&
+                       records[0].flightId == 27 &&
+                       partition_passenger_reservations(store, 501, day_starts[0], day_starts[10],
+                                                        &records, &record_capacity) == 0;
+    report_test_result("Passenger Queries Skip Days Without Reservations", passenger_ok);
+    
+    // Archive the first six days, then read them back through queries
+    int archived = partition_archive_before(store, day_starts[6]);
+    int archive_ok = archived == 6 && store->resident_count == 4 && store->reloads == 0;
+    for (int w = 0; w < window_count; w++) {
+        archive_ok &= partition_list_departures(store, windows[w][0], windows[w][1], &found, &found_capacity) ==
+                      count_window(flights, 40, windows[w][0], windows[w][1]);
+    }
+    Flight* reloaded = partition_find_flight(store, 3);
+    archive_ok &= store->reloads == 6 && reloaded != NULL && reloaded->departureTime == flights[2].departureTime &&
+                  partition_flight_reservations(store, 3, &records, &record_capacity) == 2;
+    
+    // Unchanged days are released without being written again; a changed one is rewritten
+    archive_ok &= partition_store_add_reservation(store, (ReservationRecord){3, 501, 0, "3C"}) &&
+                  partition_archive_before(store, day_starts[6]) == 6 &&
+                  partition_flight_reservations(store, 3, &records, &record_capacity) == 3;
+    report_test_result("Archived Days Reload On Demand", archive_ok);
+    
+    free(found);
+    free(records);
+    partition_store_free(store);
+    for (int d = 0; d < 10; d++) {
+        char path[sizeof(archive_dir) + 64];
+        struct tm day;
+        localtime_r(&day_starts[d], &day);
+        snprintf(path, sizeof(path), "%s/flights_%04d%02d%02d.snap", archive_dir,
+                 day.tm_year + 1900, day.tm_mon + 1, day.tm_mday);
+        remove(path);
+    }
+    rmdir(archive_dir);
+}
+
+// Test that the batched lookups return exactly what one lookup per key returns
+void test_batch_lookups() {
+    printf("\nTesting Batched Prefetching Lookups:\n");
+    
+    // Flights 1000..1299, passengers 1..900 in a small table so chains form, and a varying
+    // number of seats on every third flight
+    AVL_Node* flights = NULL;
+    PassengerHashTable* passengers = init_hash_table(64);
+    ReservationBST* reservations = init_reservation_bst();
+    for (int i = 0; i < 300; i++) {
+        Flight flight = {1000 + (i * 7) % 300, "BL001", "Brisbane", "Launceston", time(NULL), 200};
+        flights = avl_insert(flights, flight);
+    }
+    for (int i = 1; i <= 900; i++) {
+        Passenger passenger = {i, "Batch Passenger", "BP000000"};
+        hash_insert_passenger(passengers, passenger);
+    }
+    for (int i = 0; i < 300; i += 3) {
+        for (int seat = 0; seat < i % 7; seat++) {
+            ReservationRecord record = {1000 + i, 1 + (i * 13 + seat) % 900, time(NULL), "1A"};
+            snprintf(record.seatNumber, sizeof(record.seatNumber), "%dA", seat + 1);
+            add_reservation_bst(reservations, record);
+        }
+    }
+    
+    // Keys include misses, repeats and a count that is not a multiple of the group size
+    int count = 1000;
+    int ids[1000];
+    Flight* found_flights[1000];
+    Passenger* found_passengers[1000];
+    int counts[1000];
+    for (int i = 0; i < count; i++) {
+        ids[i] = 990 + (i * 31) % 330;
+    }
+    
+    avl_find_flight_batch(flights, ids, count, found_flights);
+    int flights_ok = 1;
+    for (int i = 0; i < count; i++) {
+        flights_ok &= found_flights[i] == avl_find_flight(flights, ids[i]);
+    }
+    avl_find_flight_batch(NULL, ids, 5, found_flights);
+    flights_ok &= found_flights[0] == NULL && found_flights[4] == NULL;
+    report_test_result("Batched Flight Lookups Match Single Lookups", flights_ok);
+    
+    for (int i = 0; i < count; i++) {
+        ids[i] = (i * 37) % 950;
+    }
+    hash_find_passenger_batch(passengers, ids, count, found_passengers);
+    int passengers_ok = 1;
+    for (int i = 0; i < count; i++) {
+        passengers_ok &= found_passengers[i] == hash_find_passenger(passengers, ids[i]);
+    }
+    report_test_result("Batched Passenger Lookups Match Single Lookups", passengers_ok);
+    
+    // Seat counts against a copy of each flight's reservations
+    for (int i = 0; i < count; i++) {
+        ids[i] = 995 + (i * 11) % 310;
+    }
+    ReservationRecord* records = NULL;
+    int capacity = 0;
+    int counts_ok = count_reservations_by_flight_batch_bst(reservations, ids, count, counts);
+    for (int i = 0; i < count && counts_ok; i++) {
+        counts_ok = counts[i] == find_reservations_by_flight_bst(reservations, ids[i], &records, &capacity);
+    }
+    report_test_result("Batched Reservation Counts Match Per-Flight Searches", counts_ok);
+    
+    free(records);
+    free_avl_tree(flights);
+    free_hash_table(passengers);
+    free_reservation_bst(reservations);
+}
+
+// Test the blocked Bloom filter on its own and in front of passenger and reservation lookups
+void test_bloom_filters() {
+    printf("\nTesting Bloom Filters:\n");
+    
+    // No false negatives, and a false-positive rate near the 1% target
+    BloomFilter* filter = bloom_create(10000, 0.01);
+    int filter_ok = filter != NULL;
+    if (filter_ok) {
+        for (uint64_t key = 0; key < 10000; key++) {
+            bloom_add(filter, key * 7919);
+        }
+        for (uint64_t key = 0; key < 10000 && filter_ok; key++) {
+            filter_ok = bloom_may_contain(filter, key * 7919);
+        }
+        int false_positives = 0;
+        for (uint64_t key = 0; key < 100000; key++) {
+            false_positives += bloom_may_contain(filter, key * 7919 + 1);
+        }
+        filter_ok &= false_positives < 2000 && !bloom_needs_rebuild(filter);
+        bloom_free(filter);
+    }
+    report_test_result("Bloom Filter Has No False Negatives And Few False Positives", filter_ok);
+    
+    // Enabled on a small table, then grown well past its size so it is rebuilt during the load
+    PassengerHashTable* table = init_hash_table(50);
+    int passengers_ok = table != NULL && hash_enable_filter(table, 0.01);
+    for (int i = 1; passengers_ok && i <= 2000; i++) {
+        Passenger passenger = {i * 3, "Filtered Passenger", "FP000000"};
+        hash_insert_passenger(table, passenger);
+    }
+    passengers_ok = passengers_ok && table->filter->capacity >= table->count;
+    for (int id = 0; passengers_ok && id <= 6003; id++) {
+        Passenger* found = hash_find_passenger(table, id);
+        passengers_ok = (id % 3 == 0 && id > 0 && id <= 6000) ? found != NULL && found->id == id : found == NULL;
+    }
+    report_test_result("Filtered Passenger Lookups Stay Exact Across Rebuilds", passengers_ok);
+    free_hash_table(table);
+    
+    // Booked pairs are always found, cancelled and never-booked pairs never are
+    ReservationBST* bst = init_reservation_bst();
+    int pairs_ok = bst != NULL && reservation_bst_enable_filter(bst, 16, 0.01);
+    for (int i = 0; pairs_ok && i < 1000; i++) {
+        ReservationRecord record = {100 + i % 50, 500 + i, time(NULL), "1A"};
+        add_reservation_bst(bst, record);
+    }
+    pairs_ok = pairs_ok && cancel_reservation_bst(bst, 100, 500);
+    for (int i = 0; pairs_ok && i < 1000; i++) {
+        pairs_ok = has_reservation_bst(bst, 100 + i % 50, 500 + i) == (i != 0) &&
+                   !has_reservation_bst(bst, 100 + (i + 1) % 50, 500 + i);
+    }
+    report_test_result("Filtered Duplicate-Booking Checks Stay Exact", pairs_ok);
+    free_reservation_bst(bst);
+}
+
+// Test HyperLogLog accuracy and merging, per-flight sketch queries and their snapshot section
+void test_passenger_sketches() {
+    printf("\nTesting Passenger Sketches:\n");
+    
+    // Exact-ish while sparse, within a few standard errors once dense, and merges are unions
+    HyperLogLog small, large, merged;
+    hll_init(&small);
+    hll_init(&large);
+    hll_init(&merged);
+    int accuracy_ok = 1;
+    for (uint64_t key = 1; key <= 1000; key++) {
+        accuracy_ok &= hll_add(&small, key) && hll_add(&small, key);
+    }
+    for (uint64_t key = 1; key <= 100000; key++) {
+        accuracy_ok &= hll_add(&large, key);
+    }
+    double small_estimate = hll_estimate(&small);
+    double large_estimate = hll_estimate(&large);
+    accuracy_ok &= small_estimate > 990 && small_estimate < 1010 &&
+                   large_estimate > 97000 && large_estimate < 103000;
+    report_test_result("HyperLogLog Estimates Stay Within Error Bounds", accuracy_ok);
+    
+    accuracy_ok = hll_merge(&merged, &small) && hll_merge(&merged, &large);
+    report_test_result("Merged Sketch Matches The Union", accuracy_ok && hll_estimate(&merged) == large_estimate);
+    hll_free(&small);
+    hll_free(&large);
+    hll_free(&merged);
+    
+    // 20 flights over 10 days, alternating origins; flight i carries passengers i*100 .. i*100+299,
+    // so neighbouring flights share passengers
+    time_t base = 1780000000;
+    Flight flights[20];
+    ReservationRecord reservations[20 * 300];
+    for (int i = 0; i < 20; i++) {
+        flights[i] = (Flight){1000 + i, "SK", "", "Tromso", base + (i / 2) * 86400, 300};
+        strcpy(flights[i].origin, i % 2 ? "Oslo" : "Bergen");
+        for (int p = 0; p < 300; p++) {
+            reservations[i * 300 + p] = (ReservationRecord){1000 + i, i * 100 + p, base, "1A"};
+        }
+    }
+    PassengerSketchIndex* index = sketch_index_build(flights, 20, reservations, 20 * 300);
+    
+    // Days 0-2 from Oslo are flights 1, 3, 5: passengers 100 .. 799; every origin adds flights 0, 2, 4
+    double oslo = sketch_distinct_passengers(index, "Oslo", NULL, base, base + 3 * 86400);
+    double all = sketch_distinct_passengers(index, NULL, "Tromso", base, base + 3 * 86400);
+    double none = sketch_distinct_passengers(index, "Oslo", "Bergen", base, base + 10 * 86400);
+    int query_ok = index != NULL && oslo > 690 && oslo < 710 && all > 790 && all < 810 && none == 0.0;
+    report_test_result("Sketch Queries Estimate Distinct Passengers Per Group", query_ok);
+    
+    // Cancelling flight 1005 leaves flights 1 and 3: passengers 100 .. 599
+    query_ok = index != NULL && sketch_index_remove_flight(index, 1005) && !sketch_index_remove_flight(index, 1005);
+    oslo = sketch_distinct_passengers(index, "Oslo", NULL, base, base + 3 * 86400);
+    report_test_result("Cancelled Flights Drop Out Of Sketch Queries", query_ok && oslo > 490 && oslo < 510);
+    
+    // The sketches survive a snapshot round trip and the dataset sections still load
+    char snapshot_dir[] = "/tmp/airline_sketches_XXXXXX";
+    char path[MAX_LINE_LENGTH];
+    int snapshot_ok = mkdtemp(snapshot_dir) != NULL;
+    snprintf(path, sizeof(path), "%s/sketches.snap", snapshot_dir);
+    snapshot_ok = snapshot_ok && index != NULL &&
+                  sketch_index_save_snapshot(index, flights, 20, NULL, 0, reservations, 20 * 300, path);
+    PassengerSketchIndex* loaded = snapshot_ok ? sketch_index_load_snapshot(path) : NULL;
+    snapshot_ok = loaded != NULL && loaded->count == 19 &&
+                  sketch_distinct_passengers(loaded, "Oslo", NULL, base, base + 3 * 86400) == oslo &&
+                  sketch_distinct_passengers(loaded, NULL, NULL, base, base + 10 * 86400) ==
+                  sketch_distinct_passengers(index, NULL, NULL, base, base + 10 * 86400);
+    Flight* loaded_flights = NULL;
+    Passenger* loaded_passengers = NULL;
+    ReservationRecord* loaded_reservations = NULL;
+    int loaded_flight_count = 0, loaded_passenger_count = 0, loaded_reservation_count = 0;
+    snapshot_ok = snapshot_ok && load_data_from_snapshot(path, &loaded_flights, &loaded_flight_count,
+                                                         &loaded_passengers, &loaded_passenger_count,
+                                                         &loaded_reservations, &loaded_reservation_count) &&
+                  loaded_flight_count == 20 && loaded_reservation_count == 20 * 300;
+    report_test_result("Sketches Survive A Snapshot Round Trip", snapshot_ok);
+    free(loaded_flights);
+    free(loaded_passengers);
+    free(loaded_reservations);
+    sketch_index_free(loaded);
+    sketch_index_free(index);
+    unlink(path);
+    rmdir(snapshot_dir);
+}
+
+// Test group-by aggregation against hand-written loops, across thread counts and as CSV
+void test_aggregation() {
+    printf("\nTesting Reservation Aggregation:\n");
+    
+    // 30 flights from 3 origins over 5 local days; 200000 reservations (enough for several
+    // threads) booked 1 to 30 days ahead, plus 7 on a flight that does not exist
+    struct tm first_day = {0};
+    first_day.tm_year = 2026 - 1900;
+    first_day.tm_mon = 5;
+    first_day.tm_mday = 1;
+    first_day.tm_hour = 10;
+    first_day.tm_isdst = -1;
+    time_t base = mktime(&first_day);
+    const char* origins[] = {"Lisbon", "Amsterdam", "Zurich"};
+    Flight flights[30];
+    for (int i = 0; i < 30; i++) {
+        flights[i] = (Flight){500 + i, "AG", "", "Madrid", base + (i % 5) * 86400, 100 + i};
+        strcpy(flights[i].origin, origins[i % 3]);
+    }
+    int rows = 200007;
+    ReservationRecord* reservations = (ReservationRecord*)malloc(rows * sizeof(ReservationRecord));
+    if (reservations == NULL) {
+        report_test_result("Aggregation Matches Hand-Written Loops", 0);
+        return;
+    }
+    long long expected_count[3][5] = {{0}};
+    long long expected_sum[3][5] = {{0}};
+    for (int i = 0; i < rows; i++) {
+        int flight = (i * 7) % 30;
+        int lead = 1 + (i / 30) % 30;
+        reservations[i] = (ReservationRecord){i < 7 ? 9999 : 500 + flight, i,
+                                              flights[flight].departureTime - lead * 86400 - 60, "1A"};
+        if (i >= 7) {
+            expected_count[flight % 3][flight % 5]++;
+            expected_sum[flight % 3][flight % 5] += lead;
+        }
+    }
+    
+    // Groups come out alphabetically by origin, then by day
+    AggregateQuery query;
+    memset(&query, 0, sizeof(query));
+    int aggregate_ok = aggregate_parse_keys("origin,departure_day", &query);
+    query.threads = 4;
+    AggregateResult* result = aggregate_reservations(&query, flights, 30, reservations, rows);
+    const int origin_order[] = {1, 0, 2};
+    aggregate_ok = aggregate_ok && result != NULL && result->group_count == 15 &&
+                   result->skipped == 7 && result->rows == rows - 7;
+    for (int g = 0; aggregate_ok && g < 15; g++) {
+        const AggregateGroup* group = &result->groups[g];
+        int origin = origin_order[g / 5];
+        int day = g % 5;
+        aggregate_ok = strcmp(result->strings[group->key[0]], origins[origin]) == 0 &&
+                       result->day_starts[group->key[1]] <= base + day * 86400 &&
+                       result->day_starts[group->key[1] + 1] > base + day * 86400 &&
+                       group->count == expected_count[origin][day] && group->sum == expected_sum[origin][day] &&
+                       group->min == 1 && group->max == 30;
+    }
+    report_test_result("Aggregation Matches Hand-Written Loops", aggregate_ok);
+    
+    // One thread gives the same groups as four
+    query.threads = 1;
+    AggregateResult* single = aggregate_reservations(&query, flights, 30, reservations, rows);
+    int threads_ok = result != NULL && single != NULL && single->threads == 1 && result->threads > 1 &&
+                     single->group_count == result->group_count &&
+                     memcmp(single->groups, result->groups, result->group_count * sizeof(AggregateGroup)) == 0;
+    report_test_result("Aggregation Is The Same On Any Number Of Threads", threads_ok);
+    aggregate_free(single);
+    aggregate_free(result);
+    
+    // Booking day and capacity, written as CSV: 30 booking days, each with every flight
+    int csv_ok = aggregate_parse_keys("booking_day", &query) && aggregate_parse_value("capacity", &query.value) &&
+                 !aggregate_parse_keys("origin,gate", &query) && aggregate_parse_keys("booking_day", &query);
+    result = csv_ok ? aggregate_reservations(&query, flights, 30, reservations, rows) : NULL;
+    const char* header = "booking_day,count,sum_capacity,min_capacity,max_capacity,avg_capacity\n";
+    char text[4096] = "";
+    FILE* file = tmpfile();
+    if (result != NULL && file != NULL && aggregate_write_csv(file, result) > 0) {
+        rewind(file);
+        size_t length = fread(text, 1, sizeof(text) - 1, file);
+        text[length] = '\0';
+    }
+    csv_ok = csv_ok && result != NULL && result->group_count == 34 &&
+             strncmp(text, header, strlen(header)) == 0 &&
+             strstr(text, ",100,129,") != NULL;
+    report_test_result("Aggregation Writes Grouped CSV", csv_ok);
+    if (file != NULL) fclose(file);
+    aggregate_free(result);
+    free(reservations);
+}
+
+// Check a fullest-first (direction 1) or emptiest-first (direction -1) list against brute force:
+// each entry departs in [from, to) and comes no later than the next, and no flight left out of
+// the window ranks ahead of the last entry
+static int check_flight_loads(const FlightLoad* loads, int count, const Flight* flights, const int* booked,
+                              int flight_count, time_t from, time_t to, int direction) {
+    int eligible = 0;
+    for (int i = 0; i < flight_count; i++) {
+        eligible += flights[i].departureTime >= from && flights[i].departureTime < to;
+    }
+    if (count != (eligible < 5 ? eligible : 5)) return 0;
+    for (int i = 0; i < count; i++) {
+        if (loads[i].departureTime < from || loads[i].departureTime >= to) return 0;
+        if (i > 0) {
+            long long previous = (long long)loads[i - 1].booked * loads[i].capacity * direction;
+            long long current = (long long)loads[i].booked * loads[i - 1].capacity * direction;
+            if (previous < current ||
+                (previous == current && (loads[i - 1].flightId - loads[i].flightId) * direction < 0)) return 0;
+        }
+    }
+    for (int i = 0; count > 0 && i < flight_count; i++) {
+        if (flights[i].departureTime < from || flights[i].departureTime >= to) continue;
+        int listed = 0;
+        for (int j = 0; j < count; j++) listed |= loads[j].flightId == flights[i].id;
+        long long other = (long long)booked[i] * loads[count - 1].capacity * direction;
+        long long last = (long long)loads[count - 1].booked * flights[i].capacity * direction;
+        if (!listed && other > last) return 0;
+    }
+    return 1;
+}
+
+// Test the load-factor index on its own and kept current through the reservation BST
+void test_flight_loads() {
+    printf("\nTesting Flight Load Index:\n");
+    
+    // 40 flights over 4 days with capacities 100-139 and bookings spread so loads repeat
+    time_t base = 1780000000;
+    time_t end = base + 4 * 86400;
+    Flight flights[40];
+    int booked[40];
+    for (int i = 0; i < 40; i++) {
+        flights[i] = (Flight){700 + i, "LD", "Oslo", "Rome", base + (i % 4) * 86400, 100 + i};
+        booked[i] = (i * 37) % 120;
+    }
+    FlightLoadIndex* index = load_index_build(flights, booked, 40);
+    FlightLoad loads[5];
+    int order_ok = index != NULL && index->count == 40;
+    int count = load_index_fullest(index, 5, 0, 0, loads);
+    order_ok = order_ok && check_flight_loads(loads, count, flights, booked, 40, base, end, 1);
+    count = load_index_emptiest(index, 5, 0, 0, loads);
+    order_ok = order_ok && check_flight_loads(loads, count, flights, booked, 40, base, end, -1) && loads[0].booked == 0;
+    count = load_index_fullest(index, 5, base + 86400, base + 2 * 86400, loads);
+    order_ok = order_ok && check_flight_loads(loads, count, flights, booked, 40, base + 86400, base + 2 * 86400, 1);
+    count = load_index_emptiest(index, 5, base + 3 * 86400, end, loads);
+    order_ok = order_ok && check_flight_loads(loads, count, flights, booked, 40, base + 3 * 86400, end, -1);
+    report_test_result("Load Index Lists Fullest And Emptiest Flights", order_ok);
+    
+    // Moving flights: overbook flight 700 (load 0) to twice its capacity, then empty flight 701 out
+    int moves_ok = index != NULL && load_index_adjust(index, 700, 200) && load_index_adjust(index, 701, -1000) &&
+                   !load_index_adjust(index, 999, 1);
+    booked[0] = 200;
+    booked[1] = 0;
+    count = load_index_fullest(index, 5, 0, 0, loads);
+    moves_ok = moves_ok && loads[0].flightId == 700 && check_flight_loads(loads, count, flights, booked, 40, base, end, 1);
+    moves_ok = moves_ok && load_index_remove_flight(index, 700) && !load_index_remove_flight(index, 700) &&
+               load_index_fullest(index, 1, 0, 0, loads) == 1 && loads[0].flightId != 700 && index->count == 39;
+    report_test_result("Load Index Moves Flights On Bookings", moves_ok);
+    load_index_free(index);
+    
+    // Through the reservation BST: bookings, cancellations and a flight cancellation keep it current
+    AVL_Node* root = NULL;
+    for (int i = 0; i < 40; i++) {
+        root = avl_insert(root, flights[i]);
+    }
+    ReservationBST* bst = init_reservation_bst();
+    int passenger = 1;
+    for (int i = 0; bst != NULL && i < 40; i++) {
+        for (int b = 0; b < i % 7; b++) {
+            ReservationRecord record = {700 + i, passenger++, base, "1A"};
+            add_reservation_bst(bst, record);
+        }
+    }
+    int bst_ok = bst != NULL && reservation_bst_enable_load_index(bst, root);
+    for (int b = 0; bst_ok && b < 120; b++) {
+        ReservationRecord record = {739, passenger++, base, "2B"};
+        add_reservation_bst(bst, record);
+    }
+    bst_ok = bst_ok && cancel_reservation_bst(bst, 706, 16);
+    ReservationRecord* removed = NULL;
+    int removed_capacity = 0;
+    bst_ok = bst_ok && cancel_flight_bst(bst, &root, 713, &removed, &removed_capacity) == 6;
+    free(removed);
+    FlightLoad load;
+    bst_ok = bst_ok && load_index_get(bst->load_index, 739, &load) && load.booked == 124 &&
+             load_index_get(bst->load_index, 706, &load) && load.booked == 5 &&
+             !load_index_get(bst->load_index, 713, &load) &&
+             load_index_fullest(bst->load_index, 1, 0, 0, &load) == 1 && load.flightId == 739;
+    report_test_result("Reservation BST Keeps The Load Index Current", bst_ok);
+    free_reservation_bst(bst);
+    free_avl_tree(root);
+}
+
+// Check the skip list shape: `next` visits `expected` passengers in ID order, and every level
+// links exactly the nodes that reach it, in order
+static int check_skip_list(LL_Node* head, int expected) {
+    int count = 0;
+    for (LL_Node* node = head; node != NULL; node = node->next) {
+        if (node->next != NULL && node->next->data.id <= node->data.id) return 0;
+        if ((node == head) != (node->level == PASSENGER_SKIP_MAX_LEVEL)) return 0;
+        count++;
+    }
+    if (count != expected) return 0;
+    for (int level = 1; head != NULL && level < PASSENGER_SKIP_MAX_LEVEL; level++) {
+        // Nodes above this level, found along level 0 and along the level itself
+        LL_Node* linked = head->tower[level - 1];
+        for (LL_Node* node = head->next; node != NULL; node = node->next) {
+            if (node->level <= level) continue;
+            if (linked != node) return 0;
+            linked = node->tower[level - 1];
+        }
+        if (linked != NULL) return 0;
+    }
+    return 1;
+}
+
+// Test the passenger skip list against many inserts and removals, including new heads
+void test_passenger_skip_list() {
+    printf("\nTesting Passenger Skip List:\n");
+    
+    MemStats nodes_before = mem_stats_get(MEM_PASSENGER_LIST);
+    MemStats towers_before = mem_stats_get(MEM_PASSENGER_LIST_TOWERS);
+    
+    // 3000 IDs from 2 to 6000 in scrambled order, so the head is replaced many times
+    LL_Node* head = NULL;
+    for (int i = 0; i < 3000; i++) {
+        Passenger passenger = {2 + 2 * ((i * 1733) % 3000), "Skip Passenger", "SK000000"};
+        head = insert_passenger(head, passenger);
+    }
+    for (int id = 2; id <= 200; id += 2) {
+        Passenger passenger = {id, "Updated Passenger", "SK111111"};
+        head = insert_passenger(head, passenger);
+    }
+    int build_ok = check_skip_list(head, 3000) && head->data.id == 2;
+    for (int id = 1; build_ok && id <= 6001; id++) {
+        Passenger* found = find_passenger(head, id);
+        build_ok = id % 2 == 0 ? found != NULL && found->id == id : found == NULL;
+        if (found != NULL && id <= 200) build_ok &= strcmp(found->name, "Updated Passenger") == 0;
+    }
+    report_test_result("Skip List Insert, Update and Find", build_ok);
+    
+    // Remove every third passenger, then keep removing the head
+    int remaining = 3000;
+    for (int id = 6; id <= 6000; id += 6) {
+        head = remove_passenger(head, id);
+        remaining--;
+    }
+    head = remove_passenger(head, 7);
+    for (int i = 0; i < 50; i++) {
+        head = remove_passenger(head, head->data.id);
+        remaining--;
+    }
+    int remove_ok = check_skip_list(head, remaining);
+    for (int id = 1; remove_ok && id <= 6000; id++) {
+        // The 50 smallest survivors (2, 4, 8, 10, ... 148) went with the heads
+        int present = id % 2 == 0 && id % 6 != 0 && id > 148;
+        remove_ok = (find_passenger(head, id) != NULL) == present;
+    }
+    remove_ok = remove_ok && head->data.id == 152;
+    report_test_result("Skip List Remove Including The Head", remove_ok);
+    
+    // Reinserting into the thinned list keeps it consistent
+    for (int id = 6; id <= 600; id += 6) {
+        Passenger passenger = {id, "Returning Passenger", "SK222222"};
+        head = insert_passenger(head, passenger);
+        remaining++;
+    }
+    int reinsert_ok = check_skip_list(head, remaining) && head->data.id == 6;
+    free_list(head);
+    
+    // A list linked by hand through `next` is still usable
+    LL_Node* plain = create_passenger_node((Passenger){10, "Plain One", "PL000001"});
+    plain->next = create_passenger_node((Passenger){30, "Plain Three", "PL000003"});
+    plain = insert_passenger(plain, (Passenger){20, "Plain Two", "PL000002"});
+    plain = insert_passenger(plain, (Passenger){5, "Plain Zero", "PL000000"});
+    plain = remove_passenger(plain, 5);
+    int plain_ok = check_skip_list(plain, 3) && find_passenger(plain, 20) != NULL &&
+                   find_passenger(plain, 30) != NULL && plain->data.id == 10;
+    free_list(plain);
+    
+    MemStats nodes_after = mem_stats_get(MEM_PASSENGER_LIST);
+    MemStats towers_after = mem_stats_get(MEM_PASSENGER_LIST_TOWERS);
+    reinsert_ok = reinsert_ok && plain_ok && nodes_after.live_bytes == nodes_before.live_bytes &&
+                  towers_after.live_bytes == towers_before.live_bytes &&
+                  towers_after.allocations > towers_before.allocations;
+    report_test_result("Skip List Reinsert, Hand-Built Lists and Memory", reinsert_ok);
+}
+
+// Check the unrolled list shape: `expected` passengers in ID order in non-empty blocks,
+// each record matching its ID, and the block count up to date
+static int check_unrolled_list(UnrolledPassengerList* list, long long expected) {
+    long long count = 0;
+    int blocks = 0;
+    int last_id = INT_MIN;
+    for (PassengerBlock* block = list->head; block != NULL; block = block->next) {
+        if (block->count < 1 || block->count > UNROLLED_BLOCK_CAPACITY) return 0;
+        for (int i = 0; i < block->count; i++) {
+            if (block->ids[i] <= last_id || block->payloads[i]->id != block->ids[i]) return 0;
+            last_id = block->ids[i];
+        }
+        count += block->count;
+        blocks++;
+    }
+    return count == expected && list->count == expected && blocks == list->block_count;
+}
+
+// Test the unrolled passenger list: bulk build, block splits and merges, and scans
+void test_unrolled_passenger_list() {
+    printf("\nTesting Unrolled Passenger List:\n");
+    
+    MemStats before = mem_stats_get(MEM_PASSENGER_UNROLLED);
+    
+    // Even IDs 2 to 1000 in scrambled order, with the first 20 repeated under a new name
+    Passenger passengers[520];
+    for (int i = 0; i < 500; i++) {
+        passengers[i] = (Passenger){2 + 2 * ((i * 173) % 500), "Block Passenger", "UN000000"};
+    }
+    for (int i = 0; i < 20; i++) {
+        passengers[500 + i] = passengers[i];
+        strcpy(passengers[500 + i].name, "Renamed Passenger");
+    }
+    UnrolledPassengerList* list = unrolled_build(passengers, 520);
+    int build_ok = list != NULL && check_unrolled_list(list, 500) &&
+                   list->block_count == (500 + UNROLLED_BUILD_FILL - 1) / UNROLLED_BUILD_FILL;
+    for (int id = 1; build_ok && id <= 1001; id++) {
+        Passenger* found = unrolled_find(list, id);
+        build_ok = id % 2 == 0 ? found != NULL && found->id == id : found == NULL;
+    }
+    Passenger* renamed = list != NULL ? unrolled_find(list, passengers[0].id) : NULL;
+    build_ok = build_ok && renamed != NULL && strcmp(renamed->name, "Renamed Passenger") == 0;
+    report_test_result("Unrolled List Bulk Build", build_ok);
+    
+    // Odd IDs fill the blocks until they split; an existing ID is replaced in place
+    int split_ok = list != NULL;
+    int blocks_before = split_ok ? list->block_count : 0;
+    for (int id = 1; split_ok && id <= 601; id += 2) {
+        split_ok = unrolled_insert(list, (Passenger){id, "Odd Passenger", "UN111111"}) == 1;
+    }
+    split_ok = split_ok && unrolled_insert(list, (Passenger){4, "Updated Passenger", "UN222222"}) == 0 &&
+               strcmp(unrolled_find(list, 4)->name, "Updated Passenger") == 0 &&
+               check_unrolled_list(list, 801) && list->block_count > blocks_before;
+    report_test_result("Unrolled List Insert With Block Splits", split_ok);
+    
+    // Removing most passengers merges blocks; emptying the list and refilling it still works
+    int merge_ok = list != NULL;
+    int blocks_full = merge_ok ? list->block_count : 0;
+    long long remaining = 801;
+    for (int id = 1; merge_ok && id <= 1000; id++) {
+        if (id % 10 == 0) continue;
+        int present = id % 2 == 0 || id <= 601;
+        merge_ok = unrolled_remove(list, id) == present;
+        remaining -= present;
+    }
+    // Every block but the last is at least half full
+    merge_ok = merge_ok && unrolled_remove(list, 5000) == 0 && check_unrolled_list(list, remaining) &&
+               list->block_count <= remaining / (UNROLLED_BLOCK_CAPACITY / 2) + 1 && list->block_count < blocks_full;
+    for (int id = 10; merge_ok && id <= 1000; id += 10) {
+        merge_ok = unrolled_remove(list, id) == 1;
+    }
+    merge_ok = merge_ok && list->head == NULL && list->block_count == 0 && unrolled_find(list, 10) == NULL &&
+               unrolled_insert(list, (Passenger){42, "Only Passenger", "UN333333"}) == 1 && check_unrolled_list(list, 1);
+    report_test_result("Unrolled List Remove With Block Merges", merge_ok);
+    unrolled_free(list);
+    
+    // Name scans return the first match in ID order, ignoring case
+    Passenger named[40];
+    for (int i = 0; i < 40; i++) {
+        named[i] = (Passenger){100 - i, "Plain Name", "UN444444"};
+    }
+    strcpy(named[5].name, "Ada Lovelace");
+    strcpy(named[30].name, "ADA Byron");
+    list = unrolled_build(named, 40);
+    Passenger* first = unrolled_find_by_name(list, "ada");
+    int scan_ok = list != NULL && first != NULL && first->id == 70 &&
+                  unrolled_find_by_name(list, "lovelace") != NULL && unrolled_find_by_name(list, "Grace") == NULL;
+    unrolled_free(list);
+    
+    MemStats after = mem_stats_get(MEM_PASSENGER_UNROLLED);
+    scan_ok = scan_ok && after.live_bytes == before.live_bytes;
+    report_test_result("Unrolled List Name Scan and Memory", scan_ok);
+}
+
+// Order pairs by key for qsort, ties by value (the original position)
+static int compare_radix_pairs(const void* a, const void* b) {
+    const RadixPair* x = (const RadixPair*)a;
+    const RadixPair* y = (const RadixPair*)b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return (x->value > y->value) - (x->value < y->value);
+}
+
+// Check the array's flight and passenger queries against a plain scan of the bookings
+static int check_reservation_columns(ReservationArray* array, const ReservationRecord* bookings, int count) {
+    for (int flight = 0; flight <= 41; flight++) {
+        int seen[301] = {0};
+        int unique = 0;
+        int rows = 0;
+        long long dates = 0;
+        for (int i = 0; i < count; i++) {
+            if (bookings[i].flightId != flight) continue;
+            unique += seen[bookings[i].passengerId]++ == 0;
+            rows++;
+            dates += bookings[i].bookingDate;
+        }
+        ReservationRecord* found = NULL;
+        int capacity = 0;
+        int found_count = find_reservations_by_flight_array(array, flight, &found, &capacity);
+        for (int i = 0; i < found_count; i++) {
+            dates -= found[i].bookingDate;
+        }
+        free(found);
+        if (count_passengers_by_flight_array(array, flight) != unique || found_count != rows || dates != 0) return 0;
+        for (int passenger = 1; passenger <= 300; passenger += 37) {
+            if (has_reservation_array(array, flight, passenger) != (seen[passenger] > 0)) return 0;
+        }
+    }
+    for (int passenger = 0; passenger <= 301; passenger++) {
+        int rows = 0;
+        for (int i = 0; i < count; i++) {
+            rows += bookings[i].passengerId == passenger;
+        }
+        if (count_flights_by_passenger_array(array, passenger) != rows) return 0;
+    }
+    return array->count == count;
+}
+
+// Test the columnar reservation array: radix sort, SIMD scans, and queries over sorted and
+// recent rows through merges and cancellations
+void test_reservation_columns() {
+    printf("\nTesting Columnar Reservation Array:\n");
+    
+    // Radix sort matches a stable qsort, including negative keys and the threaded passes
+    int pair_count = 300000;
+    RadixPair* pairs = (RadixPair*)malloc(pair_count * sizeof(RadixPair));
+    RadixPair* expected = (RadixPair*)malloc(pair_count * sizeof(RadixPair));
+    unsigned int state = 49;
+    int sort_ok = pairs != NULL && expected != NULL;
+    for (int i = 0; sort_ok && i < pair_count; i++) {
+        state = state * 1103515245u + 12345u;
+        int flight = (int)(state >> 16) % 2000 - 1000;
+        pairs[i].key = ((uint64_t)radix_key_i32(flight) << 32) | (state & 0x3ff);
+        pairs[i].value = (uint32_t)i;
+    }
+    if (sort_ok) {
+        memcpy(expected, pairs, pair_count * sizeof(RadixPair));
+        qsort(expected, pair_count, sizeof(RadixPair), compare_radix_pairs);
+        sort_ok = radix_sort_pairs(pairs, pair_count, 4) &&
+                  memcmp(pairs, expected, pair_count * sizeof(RadixPair)) == 0;
+    }
+    free(pairs);
+    free(expected);
+    report_test_result("Parallel Radix Sort Matches Stable Sort", sort_ok);
+    
+    // The vector kernels agree with plain loops at every length and alignment
+    int values[64];
+    for (int i = 0; i < 64; i++) {
+        values[i] = (i * 7) % 5 == 0 ? 3 : i / 4;
+    }
+    int simd_ok = 1;
+    for (int start = 0; start < 4; start++) {
+        for (int length = 0; start + length <= 60; length++) {
+            const int* column = values + start;
+            int first = -1;
+            int matches = 0;
+            int runs = 0;
+            for (int i = 0; i < length; i++) {
+                if (column[i] == 3 && first < 0) first = i;
+                matches += column[i] == 3;
+                runs += i == 0 || column[i] != column[i - 1];
+            }
+            simd_ok &= simd_find_equal_i32(column, length, 3) == first &&
+                       simd_count_equal_i32(column, length, 3) == matches &&
+                       simd_count_runs_i32(column, length) == runs;
+        }
+    }
+    report_test_result("SIMD Column Scans Match Scalar Loops", simd_ok);
+    
+    // Bookings past the tail limit get merged into sorted rows; later ones stay recent
+    int booking_count = RESERVATION_TAIL_MIN * 3 + 500;
+    ReservationRecord* bookings = (ReservationRecord*)malloc(booking_count * sizeof(ReservationRecord));
+    ReservationArray* array = init_reservations(16);
+    int query_ok = bookings != NULL && array != NULL;
+    for (int i = 0; query_ok && i < booking_count; i++) {
+        state = state * 1103515245u + 12345u;
+        bookings[i] = (ReservationRecord){1 + (int)(state >> 16) % 40, 1 + (int)(state >> 8) % 300, 1000 + i, "1A"};
+        add_reservation(array, bookings[i]);
+        if (i == RESERVATION_TAIL_MIN * 3) {
+            query_ok = check_reservation_columns(array, bookings, i + 1) && array->sorted == i + 1;
+        }
+    }
+    query_ok = query_ok && array->sorted < array->count && check_reservation_columns(array, bookings, booking_count);
+    report_test_result("Columnar Queries Over Sorted and Recent Rows", query_ok);
+    
+    // Cancelling takes a passenger's earliest booking, whether sorted or recent
+    int cancel_ok = query_ok;
+    for (int i = 0; cancel_ok && i < 400; i++) {
+        int victim = (i * 97) % booking_count;
+        int flight = bookings[victim].flightId;
+        int passenger = bookings[victim].passengerId;
+        int earliest = 0;
+        while (bookings[earliest].flightId != flight || bookings[earliest].passengerId != passenger) {
+            earliest++;
+        }
+        memmove(&bookings[earliest], &bookings[earliest + 1], (booking_count - earliest - 1) * sizeof(ReservationRecord));
+        booking_count--;
+        cancel_ok = cancel_reservation(array, flight, passenger) == 1;
+    }
+    cancel_ok = cancel_ok && cancel_reservation(array, 41, 1) == 0 && check_reservation_columns(array, bookings, booking_count);
+    
+    // Removing a flight keeps the rest sorted
+    ReservationRecord* removed = NULL;
+    int removed_capacity = 0;
+    int kept = 0;
+    for (int i = 0; cancel_ok && i < booking_count; i++) {
+        if (bookings[i].flightId != 7) bookings[kept++] = bookings[i];
+    }
+    cancel_ok = cancel_ok && cancel_flight_reservations(array, 7, &removed, &removed_capacity) == booking_count - kept &&
+                check_reservation_columns(array, bookings, kept) && sort_reservations(array) &&
+                array->sorted == kept && check_reservation_columns(array, bookings, kept);
+    free(removed);
+    report_test_result("Columnar Cancellations Keep Rows Ordered", cancel_ok);
+    free_reservations(array);
+    free(bookings);
+}
+
+// Whether `name` contains `pattern` ignoring ASCII case, one position at a time
+static int name_contains(const char* name, const char* pattern) {
+    size_t length = strlen(pattern);
+    for (const char* start = name; ; start++) {
+        size_t i = 0;
+        while (i < length && start[i] != '\0' && tolower((unsigned char)start[i]) == tolower((unsigned char)pattern[i])) {
+            i++;
+        }
+        if (i == length) return 1;
+        if (*start == '\0') return 0;
+    }
+}
+
+// Test the passenger name heap: the SIMD byte search, fragment matches across names and
+// threads, and agreement with the prototypes' name searches
+void test_passenger_name_heap() {
+    printf("\nTesting Passenger Name Heap:\n");
+    
+    // The byte search agrees with a plain search for every text and pattern length
+    char text[96];
+    unsigned int state = 50;
+    for (int i = 0; i < 96; i++) {
+        state = state * 1103515245u + 12345u;
+        text[i] = "ab"[(state >> 16) & 1];
+    }
+    int bytes_ok = 1;
+    for (int start = 0; start < 3; start++) {
+        for (long length = 0; start + length <= 90; length++) {
+            for (long pattern_length = 0; pattern_length <= 6; pattern_length++) {
+                const char* pattern = text + (start * 7 + length) % 80;
+                long expected = -1;
+                for (long i = 0; expected < 0 && i + pattern_length <= length; i++) {
+                    if (memcmp(text + start + i, pattern, pattern_length) == 0) expected = i;
+                }
+                bytes_ok &= simd_find_bytes(text + start, length, pattern, pattern_length) == expected;
+            }
+        }
+    }
+    report_test_result("SIMD Byte Search Matches Plain Search", bytes_ok);
+    
+    // Short fragments, case folding, one match per name and none spanning two names
+    MemStats before = mem_stats_get(MEM_NAME_HEAP);
+    Passenger named[6] = {{1, "Ada Lovelace", "NH000001"}, {2, "Grace Hopper", "NH000002"},
+                          {3, "ANNABEL Banana", "NH000003"}, {4, "Max Xy", "NH000004"},
+                          {5, "Zeta Jones", "NH000005"}, {6, "", "NH000006"}};
+    PassengerNameHeap* heap = name_heap_build(named, 6);
+    int* ids = NULL;
+    int capacity = 0;
+    int fragment_ok = heap != NULL;
+    if (fragment_ok) {
+        fragment_ok = name_heap_find(heap, "an", 1, &ids, &capacity) == 1 && ids[0] == 3;
+        fragment_ok = fragment_ok && name_heap_find(heap, "A", 1, &ids, &capacity) == 5 && ids[4] == 5;
+        fragment_ok = fragment_ok && name_heap_find(heap, "xyz", 1, &ids, &capacity) == 0 &&
+                      name_heap_find(heap, "xy", 1, &ids, &capacity) == 1 && ids[0] == 4;
+        fragment_ok = fragment_ok && name_heap_find(heap, "", 1, &ids, &capacity) == 6 && ids[5] == 6;
+        fragment_ok = fragment_ok && name_heap_find(heap, "LOVELACE", 1, &ids, &capacity) == 1 && ids[0] == 1;
+        char long_pattern[MAX_PASSENGER_NAME_LENGTH + 8];
+        memset(long_pattern, 'a', sizeof(long_pattern) - 1);
+        long_pattern[sizeof(long_pattern) - 1] = '\0';
+        fragment_ok = fragment_ok && name_heap_find(heap, long_pattern, 1, &ids, &capacity) == 0;
+    }
+    name_heap_free(heap);
+    report_test_result("Name Heap Fragment Matches", fragment_ok);
+    
+    // A threaded scan of a large heap returns every match in order
+    int count = 200000;
+    Passenger* passengers = generate_passengers(count);
+    heap = passengers != NULL ? name_heap_build(passengers, count) : NULL;
+    const char* patterns[] = {"an", "SON", "e", "ll", "zq"};
+    int thread_ok = heap != NULL;
+    for (int p = 0; thread_ok && p < 5; p++) {
+        int found = name_heap_find(heap, patterns[p], 4, &ids, &capacity);
+        int expected = 0;
+        for (int i = 0; thread_ok && i < count; i++) {
+            if (name_contains(passengers[i].name, patterns[p])) {
+                thread_ok = expected < found && ids[expected] == passengers[i].id;
+                expected++;
+            }
+        }
+        thread_ok = thread_ok && found == expected;
+    }
+    name_heap_free(heap);
+    report_test_result("Threaded Name Heap Scan Matches Every Record", thread_ok);
+    
+    // Built from either prototype, the first match is what its own name search returns
+    LL_Node* list = NULL;
+    PassengerHashTable* table = init_hash_table(4096);
+    for (int i = 0; passengers != NULL && table != NULL && i < 2000; i++) {
+        list = insert_passenger(list, passengers[i]);
+        hash_insert_passenger(table, passengers[i]);
+    }
+    PassengerNameHeap* list_heap = name_heap_from_list(list);
+    PassengerNameHeap* table_heap = name_heap_from_table(table);
+    int prototype_ok = list_heap != NULL && table_heap != NULL && list_heap->count == 2000 && table_heap->count == 2000;
+    for (int p = 0; prototype_ok && p < 5; p++) {
+        Passenger* first = find_passenger_by_name(list, patterns[p]);
+        int found = name_heap_find(list_heap, patterns[p], 0, &ids, &capacity);
+        prototype_ok = first != NULL ? found > 0 && ids[0] == first->id : found == 0;
+        first = hash_find_passenger_by_name(table, patterns[p]);
+        found = name_heap_find(table_heap, patterns[p], 0, &ids, &capacity);
+        prototype_ok = prototype_ok && (first != NULL ? found > 0 && ids[0] == first->id : found == 0);
+    }
+    name_heap_free(list_heap);
+    name_heap_free(table_heap);
+    free_list(list);
+    free_hash_table(table);
+    free(passengers);
+    free(ids);
+    
+    MemStats after = mem_stats_get(MEM_NAME_HEAP);
+    prototype_ok = prototype_ok && after.live_bytes == before.live_bytes;
+    report_test_result("Name Heap Agrees With Prototype Name Searches", prototype_ok);
+}
+
 // Validate that all flights in the system have passenger counts that match or are below capacity
 // We implement this function with basic test data to avoid freezing
 void test_all_flights_capacity_validation() {
@@ -586,5 +2811,32 @@ void run_all_tests() {
     // Now we can run the simplified version without freezing
     test_all_flights_capacity_validation();
     
+    // Data generator tests
+    test_skewed_data_generation();
+    test_csv_writer_and_snapshot();
+    test_trace_replay();
+    test_latency_histogram();
+    test_perf_counters();
+    test_memory_accounting();
+    test_structure_health();
+    test_batch_queries();
+    test_query_server();
+    test_concurrent_engine();
+    test_sharded_engine();
+    test_persistent_avl();
+    test_mvcc_reservations();
+    test_order_statistics();
+    test_flight_cancellation();
+    test_flight_partitions();
+    test_batch_lookups();
+    test_bloom_filters();
+    test_passenger_sketches();
+    test_aggregation();
+    test_flight_loads();
+    test_passenger_skip_list();
+    test_unrolled_passenger_list();
+    test_reservation_columns();
+    test_passenger_name_heap();
+    
     printf("\nAll tests completed.\n");
 }
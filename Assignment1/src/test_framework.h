@@ -20,6 +20,81 @@ void test_prototype2_integration();
 void test_flight_capacity_validation();
 void test_reservation_capacity_validation();
 
+// Test for the skewed workload generator
+void test_skewed_data_generation();
+
+// Test for the buffered CSV writer and binary snapshots
+void test_csv_writer_and_snapshot();
+
+// Test for operation traces and replay
+void test_trace_replay();
+
+// Test for the benchmark latency histogram
+void test_latency_histogram();
+
+// Test for hardware performance counters
+void test_perf_counters();
+
+// Test for per-structure memory accounting
+void test_memory_accounting();
+
+// Test for structure health statistics
+void test_structure_health();
+
+// Test for the batch query mode
+void test_batch_queries();
+
+// Test for the binary protocol, query server and load generator
+void test_query_server();
+
+// Test for the thread-safe engines under concurrent bookings
+void test_concurrent_engine();
+
+// Test for the sharded booking engine and itinerary bookings
+void test_sharded_engine();
+
+// Test for the persistent (path-copying) AVL flight tree
+void test_persistent_avl();
+
+// Test for the multi-version reservation store
+void test_mvcc_reservations();
+
+// Test for order statistics and paginated flight listing
+void test_order_statistics();
+
+// Test for flight deletion and the cancellation cascade
+void test_flight_cancellation();
+
+// Test for time-partitioned flights and archiving
+void test_flight_partitions();
+
+// Test for batched prefetching lookups
+void test_batch_lookups();
+
+// Test for Bloom filters in front of negative lookups
+void test_bloom_filters();
+
+// Test for distinct-passenger sketches
+void test_passenger_sketches();
+
+// Test for group-by aggregation over the reservations
+void test_aggregation();
+
+// Test for the fullest/emptiest flight index
+void test_flight_loads();
+
+// Test for the passenger skip list
+void test_passenger_skip_list();
+
+// Test for the unrolled passenger list
+void test_unrolled_passenger_list();
+
+// Test for the columnar reservation array, its radix sort and SIMD scans
+void test_reservation_columns();
+
+// Test for the passenger name heap and its SIMD substring scan
+void test_passenger_name_heap();
+
 // Keeping declaration but skipping call to avoid freezing
 void test_all_flights_capacity_validation();
 
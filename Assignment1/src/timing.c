@@ -0,0 +1,110 @@
+/*
+ * Monotonic Timing Helpers
+ * 
+ * clock() measures CPU time at coarse resolution, which can't resolve single
+ * lookups. These helpers use CLOCK_MONOTONIC wall-clock time in nanoseconds.
+ * 
+ * Sources used:
+ * 1. The Linux man-pages project - clock_gettime(2) and clock_nanosleep(2)
+ * 2. "How NOT to Measure Latency" by Gil Tene - Nearest-rank percentiles
+ * 3. Intel 64 and IA-32 Architectures Software Developer's Manual - RDTSC and invariant TSC
+ */
+#define _POSIX_C_SOURCE 200809L  // For clock_gettime and clock_nanosleep
+
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+#include "timing.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TIMING_HAVE_TSC 1
+#else
+#define TIMING_HAVE_TSC 0
+#endif
+
+static double ns_per_tick = 0.0;
+
+// Current time from the monotonic clock, in nanoseconds
+uint64_t timing_now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// 1 if timing_ticks() reads the CPU timestamp counter
+int timing_has_tsc() {
+    return TIMING_HAVE_TSC;
+}
+
+// Raw timestamp: the CPU timestamp counter on x86, otherwise monotonic nanoseconds
+uint64_t timing_ticks() {
+#if TIMING_HAVE_TSC
+    return __rdtsc();
+#else
+    return timing_now_ns();
+#endif
+}
+
+// Nanoseconds per tick (calibrated against the monotonic clock on first use)
+double timing_ns_per_tick() {
+    if (ns_per_tick > 0.0) {
+        return ns_per_tick;
+    }
+    
+#if TIMING_HAVE_TSC
+    // Count ticks over ~20ms of monotonic time (assumes an invariant TSC, as on any recent x86)
+    uint64_t start_ns = timing_now_ns();
+    uint64_t start_ticks = timing_ticks();
+    while (timing_now_ns() - start_ns < 20000000ull) {
+        // Spin
+    }
+    uint64_t elapsed_ns = timing_now_ns() - start_ns;
+    uint64_t elapsed_ticks = timing_ticks() - start_ticks;
+    ns_per_tick = elapsed_ticks > 0 ? (double)elapsed_ns / elapsed_ticks : 1.0;
+#else
+    ns_per_tick = 1.0;
+#endif
+    return ns_per_tick;
+}
+
+// Sleep or spin until the monotonic clock reaches `deadline_ns`
+void timing_wait_until_ns(uint64_t deadline_ns) {
+    uint64_t now = timing_now_ns();
+    
+    // Sleep for the bulk of long waits, then spin for the last 50us for precision
+    if (deadline_ns > now + 100000) {
+        uint64_t sleep_until = deadline_ns - 50000;
+        struct timespec ts;
+        ts.tv_sec = (time_t)(sleep_until / 1000000000ull);
+        ts.tv_nsec = (long)(sleep_until % 1000000000ull);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+    }
+    while (timing_now_ns() < deadline_ns) {
+        // Spin
+    }
+}
+
+// Comparison function for qsort
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Sort an array of latencies in place (ascending)
+void timing_sort_ns(uint64_t* values, int count) {
+    qsort(values, count, sizeof(uint64_t), compare_u64);
+}
+
+// Percentile (0-100) of an ascending array using the nearest-rank method
+uint64_t timing_percentile_ns(const uint64_t* sorted, int count, double percentile) {
+    if (count <= 0) {
+        return 0;
+    }
+    
+    int rank = (int)ceil(percentile / 100.0 * count);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
@@ -0,0 +1,28 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdint.h>
+
+// Current time from the monotonic clock, in nanoseconds
+uint64_t timing_now_ns();
+
+// 1 if timing_ticks() reads the CPU timestamp counter (rdtsc), 0 if it falls back to the monotonic clock
+int timing_has_tsc();
+
+// Raw timestamp: the CPU timestamp counter on x86, otherwise monotonic nanoseconds.
+// Much cheaper than clock_gettime, but only meaningful as a difference of two readings
+uint64_t timing_ticks();
+
+// Nanoseconds per tick (calibrated against the monotonic clock on first use)
+double timing_ns_per_tick();
+
+// Sleep or spin until the monotonic clock reaches `deadline_ns`
+void timing_wait_until_ns(uint64_t deadline_ns);
+
+// Sort an array of latencies in place (ascending)
+void timing_sort_ns(uint64_t* values, int count);
+
+// Percentile (0-100) of an ascending array using the nearest-rank method
+uint64_t timing_percentile_ns(const uint64_t* sorted, int count, double percentile);
+
+#endif
@@ -0,0 +1,596 @@
+/*
+ * Operation Trace Implementation
+ * 
+ * Generates, records, saves, loads and replays traces of query operations so
+ * the prototypes can be compared under realistic query mixes instead of a few
+ * fixed operations.
+ * 
+ * Sources used:
+ * 1. "How NOT to Measure Latency" by Gil Tene - Open-loop replay and coordinated omission
+ * 2. "Benchmarking Cloud Serving Systems with YCSB" by Cooper et al. - Operation mixes and Zipf keys
+ * 3. The C Programming Language (K&R) - Text file parsing
+ */
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include "trace.h"
+#include "timing.h"
+#include "data_generator.h"
+
+static const char* trace_op_names[TRACE_OP_COUNT] = {
+    "FLIGHT_ID", "FLIGHT_NUMBER", "PASSENGER", "BOOKINGS", "BOOK", "CANCEL"
+};
+
+// Name of an operation type as used in trace files
+const char* trace_op_name(int type) {
+    if (type < 0 || type >= TRACE_OP_COUNT) {
+        return "UNKNOWN";
+    }
+    return trace_op_names[type];
+}
+
+// Look up an operation type by name (-1 if unknown)
+static int trace_op_from_name(const char* name) {
+    for (int i = 0; i < TRACE_OP_COUNT; i++) {
+        if (strcmp(name, trace_op_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Default trace settings: read-heavy mix with moderate key skew
+TraceConfig default_trace_config() {
+    TraceConfig config;
+    config.op_count = 100000;
+    config.mix[TRACE_FLIGHT_BY_ID] = 35;
+    config.mix[TRACE_FLIGHT_BY_NUMBER] = 5;
+    config.mix[TRACE_PASSENGER_BY_ID] = 30;
+    config.mix[TRACE_LIST_BOOKINGS] = 15;
+    config.mix[TRACE_BOOK] = 10;
+    config.mix[TRACE_CANCEL] = 5;
+    config.key_skew = 0.99;  // YCSB's default Zipfian constant
+    config.rate = 10000.0;
+    config.seed = 205;
+    return config;
+}
+
+// Create an empty trace with room for `capacity` operations
+static Trace* create_trace(int capacity) {
+    Trace* trace = (Trace*)malloc(sizeof(Trace));
+    if (trace == NULL) {
+        fprintf(stderr, "Memory allocation failed for trace\n");
+        return NULL;
+    }
+    if (capacity < 16) capacity = 16;
+    trace->ops = (TraceOp*)malloc(capacity * sizeof(TraceOp));
+    if (trace->ops == NULL) {
+        fprintf(stderr, "Memory allocation failed for %d trace operations\n", capacity);
+        free(trace);
+        return NULL;
+    }
+    trace->count = 0;
+    trace->capacity = capacity;
+    return trace;
+}
+
+// Append an operation, growing the array when needed. Returns 1 on success
+static int append_trace_op(Trace* trace, const TraceOp* op) {
+    if (trace->count >= trace->capacity) {
+        int new_capacity = trace->capacity * 2;
+        TraceOp* new_ops = (TraceOp*)realloc(trace->ops, new_capacity * sizeof(TraceOp));
+        if (new_ops == NULL) {
+            fprintf(stderr, "Memory allocation failed while growing trace to %d operations\n", new_capacity);
+            return 0;
+        }
+        trace->ops = new_ops;
+        trace->capacity = new_capacity;
+    }
+    trace->ops[trace->count++] = *op;
+    return 1;
+}
+
+// Pool of (flight, passenger) pairs that a generated CANCEL can target
+typedef struct {
+    int* flight_ids;
+    int* passenger_ids;
+    int count;
+    int capacity;
+} BookingPool;
+
+static void booking_pool_add(BookingPool* pool, int flightId, int passengerId) {
+    if (pool->count >= pool->capacity) {
+        int new_capacity = pool->capacity > 0 ? pool->capacity * 2 : 1024;
+        int* new_flights = (int*)realloc(pool->flight_ids, new_capacity * sizeof(int));
+        if (new_flights == NULL) return;
+        pool->flight_ids = new_flights;
+        int* new_passengers = (int*)realloc(pool->passenger_ids, new_capacity * sizeof(int));
+        if (new_passengers == NULL) return;
+        pool->passenger_ids = new_passengers;
+        pool->capacity = new_capacity;
+    }
+    pool->flight_ids[pool->count] = flightId;
+    pool->passenger_ids[pool->count] = passengerId;
+    pool->count++;
+}
+
+// Generate a trace against a dataset
+Trace* generate_trace(const TraceConfig* config,
+                      const Flight* flights, int flight_count,
+                      const Passenger* passengers, int passenger_count,
+                      const ReservationRecord* reservations, int reservation_count) {
+    if (config == NULL || flights == NULL || passengers == NULL || flight_count <= 0 || passenger_count <= 0) {
+        fprintf(stderr, "Cannot generate a trace without flights and passengers\n");
+        return NULL;
+    }
+    
+    srand(config->seed);
+    
+    Trace* trace = create_trace(config->op_count);
+    double* flight_cdf = generator_zipf_cdf(flight_count, config->key_skew);
+    double* passenger_cdf = generator_zipf_cdf(passenger_count, config->key_skew);
+    if (trace == NULL || flight_cdf == NULL || passenger_cdf == NULL) {
+        free_trace(trace);
+        free(flight_cdf);
+        free(passenger_cdf);
+        return NULL;
+    }
+    
+    // Cumulative operation mix
+    double mix_cdf[TRACE_OP_COUNT];
+    double mix_total = 0.0;
+    for (int i = 0; i < TRACE_OP_COUNT; i++) {
+        mix_total += config->mix[i] > 0 ? config->mix[i] : 0.0;
+        mix_cdf[i] = mix_total;
+    }
+    if (mix_total <= 0.0) {
+        fprintf(stderr, "Trace operation mix is empty\n");
+        free_trace(trace);
+        free(flight_cdf);
+        free(passenger_cdf);
+        return NULL;
+    }
+    for (int i = 0; i < TRACE_OP_COUNT; i++) {
+        mix_cdf[i] /= mix_total;
+    }
+    
+    // Existing reservations seed the cancellation pool
+    BookingPool pool = {NULL, NULL, 0, 0};
+    for (int i = 0; i < reservation_count; i++) {
+        booking_pool_add(&pool, reservations[i].flightId, reservations[i].passengerId);
+    }
+    
+    double clock_us = 0.0;
+    for (int i = 0; i < config->op_count; i++) {
+        TraceOp op;
+        memset(&op, 0, sizeof(op));
+        
+        // Poisson arrivals: exponential gaps between operations
+        if (config->rate > 0.0) {
+            clock_us += -log(generator_random_unit()) * 1e6 / config->rate;
+        }
+        op.timestamp_us = (uint64_t)clock_us;
+        op.type = generator_sample_cdf(mix_cdf, TRACE_OP_COUNT, generator_random_unit());
+        
+        const Flight* flight = &flights[generator_sample_cdf(flight_cdf, flight_count, generator_random_unit())];
+        const Passenger* passenger = &passengers[generator_sample_cdf(passenger_cdf, passenger_count,
+                                                                      generator_random_unit())];
+        
+        switch (op.type) {
+            case TRACE_FLIGHT_BY_ID:
+                op.flightId = flight->id;
+                break;
+            case TRACE_FLIGHT_BY_NUMBER:
+                strncpy(op.key, flight->flightNumber, sizeof(op.key) - 1);
+                break;
+            case TRACE_PASSENGER_BY_ID:
+            case TRACE_LIST_BOOKINGS:
+                op.passengerId = passenger->id;
+                break;
+            case TRACE_BOOK:
+                op.flightId = flight->id;
+                op.passengerId = passenger->id;
+                generate_seat_number(op.key, sizeof(op.key));
+                booking_pool_add(&pool, op.flightId, op.passengerId);
+                break;
+            case TRACE_CANCEL:
+                if (pool.count > 0) {
+                    // Cancel a random outstanding booking and drop it from the pool
+                    int index = (int)(generator_random_unit() * pool.count);
+                    op.flightId = pool.flight_ids[index];
+                    op.passengerId = pool.passenger_ids[index];
+                    pool.count--;
+                    pool.flight_ids[index] = pool.flight_ids[pool.count];
+                    pool.passenger_ids[index] = pool.passenger_ids[pool.count];
+                } else {
+                    op.flightId = flight->id;
+                    op.passengerId = passenger->id;
+                }
+                break;
+        }
+        
+        if (!append_trace_op(trace, &op)) {
+            break;
+        }
+    }
+    
+    free(pool.flight_ids);
+    free(pool.passenger_ids);
+    free(flight_cdf);
+    free(passenger_cdf);
+    return trace;
+}
+
+// Write one operation as a trace line
+static void write_trace_op(FILE* file, const TraceOp* op) {
+    fprintf(file, "%llu %s", (unsigned long long)op->timestamp_us, trace_op_name(op->type));
+    switch (op->type) {
+        case TRACE_FLIGHT_BY_ID:
+            fprintf(file, " %d\n", op->flightId);
+            break;
+        case TRACE_FLIGHT_BY_NUMBER:
+            fprintf(file, " %s\n", op->key);
+            break;
+        case TRACE_PASSENGER_BY_ID:
+        case TRACE_LIST_BOOKINGS:
+            fprintf(file, " %d\n", op->passengerId);
+            break;
+        case TRACE_BOOK:
+            fprintf(file, " %d %d %s\n", op->flightId, op->passengerId, op->key);
+            break;
+        case TRACE_CANCEL:
+            fprintf(file, " %d %d\n", op->flightId, op->passengerId);
+            break;
+        default:
+            fprintf(file, "\n");
+            break;
+    }
+}
+
+// Save a trace to a file
+int save_trace(const Trace* trace, const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Could not open trace %s for writing\n", path);
+        return 0;
+    }
+    
+    fprintf(file, "# airline-trace v1: <timestamp_us> <op> <args>\n");
+    for (int i = 0; i < trace->count; i++) {
+        write_trace_op(file, &trace->ops[i]);
+    }
+    
+    return fclose(file) == 0;
+}
+
+// Load a trace from a file
+Trace* load_trace(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Could not open trace %s\n", path);
+        return NULL;
+    }
+    
+    Trace* trace = create_trace(1024);
+    if (trace == NULL) {
+        fclose(file);
+        return NULL;
+    }
+    
+    char line[MAX_LINE_LENGTH];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line_number++;
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+            continue;
+        }
+        
+        TraceOp op;
+        memset(&op, 0, sizeof(op));
+        unsigned long long timestamp;
+        char name[32];
+        int consumed = 0;
+        if (sscanf(line, "%llu %31s %n", &timestamp, name, &consumed) < 2 ||
+            (op.type = trace_op_from_name(name)) < 0) {
+            fprintf(stderr, "Skipping malformed trace line %d: %s", line_number, line);
+            continue;
+        }
+        op.timestamp_us = timestamp;
+        
+        const char* args = line + consumed;
+        int parsed = 0;
+        switch (op.type) {
+            case TRACE_FLIGHT_BY_ID:
+                parsed = sscanf(args, "%d", &op.flightId) == 1;
+                break;
+            case TRACE_FLIGHT_BY_NUMBER:
+                parsed = sscanf(args, "%19s", op.key) == 1;
+                break;
+            case TRACE_PASSENGER_BY_ID:
+            case TRACE_LIST_BOOKINGS:
+                parsed = sscanf(args, "%d", &op.passengerId) == 1;
+                break;
+            case TRACE_BOOK:
+                parsed = sscanf(args, "%d %d %9s", &op.flightId, &op.passengerId, op.key) == 3;
+                break;
+            case TRACE_CANCEL:
+                parsed = sscanf(args, "%d %d", &op.flightId, &op.passengerId) == 2;
+                break;
+        }
+        if (!parsed) {
+            fprintf(stderr, "Skipping malformed trace line %d: %s", line_number, line);
+            continue;
+        }
+        
+        if (!append_trace_op(trace, &op)) {
+            break;
+        }
+    }
+    
+    fclose(file);
+    return trace;
+}
+
+// Free a trace
+void free_trace(Trace* trace) {
+    if (trace != NULL) {
+        free(trace->ops);
+        free(trace);
+    }
+}
+
+// Start recording to a file
+TraceRecorder* trace_recorder_open(const char* path) {
+    TraceRecorder* recorder = (TraceRecorder*)malloc(sizeof(TraceRecorder));
+    if (recorder == NULL) {
+        fprintf(stderr, "Memory allocation failed for trace recorder\n");
+        return NULL;
+    }
+    recorder->file = fopen(path, "w");
+    if (recorder->file == NULL) {
+        fprintf(stderr, "Could not open trace %s for writing\n", path);
+        free(recorder);
+        return NULL;
+    }
+    fprintf(recorder->file, "# airline-trace v1: <timestamp_us> <op> <args>\n");
+    recorder->start_ns = timing_now_ns();
+    return recorder;
+}
+
+// Record one operation
+void trace_record(TraceRecorder* recorder, int type, int flightId, int passengerId, const char* key) {
+    if (recorder == NULL) {
+        return;
+    }
+    
+    TraceOp op;
+    memset(&op, 0, sizeof(op));
+    op.timestamp_us = (timing_now_ns() - recorder->start_ns) / 1000;
+    op.type = type;
+    op.flightId = flightId;
+    op.passengerId = passengerId;
+    if (key != NULL) {
+        strncpy(op.key, key, sizeof(op.key) - 1);
+    }
+    write_trace_op(recorder->file, &op);
+    fflush(recorder->file);  // Keep the trace usable even if the session is killed
+}
+
+// Stop recording and close the file
+void trace_recorder_close(TraceRecorder* recorder) {
+    if (recorder != NULL) {
+        fclose(recorder->file);
+        free(recorder);
+    }
+}
+
+// Execute one operation against an engine, listing bookings into the caller's reusable
+// records array. Returns 1 on a hit / success
+static int execute_trace_op(QueryEngine* engine, const TraceOp* op, ReservationRecord** records, int* capacity) {
+    ReservationRecord record;
+    switch (op->type) {
+        case TRACE_FLIGHT_BY_ID:
+            return engine->find_flight(engine->state, op->flightId) != NULL;
+        case TRACE_FLIGHT_BY_NUMBER:
+            return engine->find_flight_by_number(engine->state, op->key) != NULL;
+        case TRACE_PASSENGER_BY_ID:
+            return engine->find_passenger(engine->state, op->passengerId) != NULL;
+        case TRACE_LIST_BOOKINGS:
+            return engine->passenger_reservations(engine->state, op->passengerId, records, capacity) >= 0;
+        case TRACE_BOOK:
+            record.flightId = op->flightId;
+            record.passengerId = op->passengerId;
+            record.bookingDate = time(NULL);
+            strncpy(record.seatNumber, op->key, sizeof(record.seatNumber) - 1);
+            record.seatNumber[sizeof(record.seatNumber) - 1] = '\0';
+            return engine->book(engine->state, record);
+        case TRACE_CANCEL:
+            return engine->cancel(engine->state, op->flightId, op->passengerId);
+        default:
+            return 0;
+    }
+}
+
+// Fill in throughput and percentiles from per-type latencies (sorts and frees them)
+static void finish_replay_stats(ReplayStats* stats, uint64_t* latencies[TRACE_OP_COUNT], int total, uint64_t elapsed_ns) {
+    stats->elapsed_seconds = elapsed_ns / 1e9;
+    stats->throughput = stats->elapsed_seconds > 0 ? total / stats->elapsed_seconds : 0.0;
+    for (int t = 0; t < TRACE_OP_COUNT; t++) {
+        int n = stats->count[t];
+        if (n > 0) {
+            timing_sort_ns(latencies[t], n);
+            stats->p50_ns[t] = timing_percentile_ns(latencies[t], n, 50.0);
+            stats->p99_ns[t] = timing_percentile_ns(latencies[t], n, 99.0);
+            stats->p999_ns[t] = timing_percentile_ns(latencies[t], n, 99.9);
+            stats->max_ns[t] = latencies[t][n - 1];
+        }
+        free(latencies[t]);
+    }
+}
+
+// Replay a trace against an engine
+int replay_trace(QueryEngine* engine, const Trace* trace, ReplayMode mode, double speed, ReplayStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (engine == NULL || trace == NULL || trace->count == 0) {
+        return 0;
+    }
+    if (speed <= 0.0) speed = 1.0;
+    
+    // Latencies are stored per operation type and sorted for percentiles afterwards
+    uint64_t* latencies[TRACE_OP_COUNT];
+    for (int t = 0; t < TRACE_OP_COUNT; t++) {
+        latencies[t] = (uint64_t*)malloc(trace->count * sizeof(uint64_t));
+        if (latencies[t] == NULL) {
+            fprintf(stderr, "Memory allocation failed for replay latencies\n");
+            for (int j = 0; j < t; j++) free(latencies[j]);
+            return 0;
+        }
+    }
+    
+    ReservationRecord* records = NULL;
+    int record_capacity = 0;
+    uint64_t start = timing_now_ns();
+    for (int i = 0; i < trace->count; i++) {
+        const TraceOp* op = &trace->ops[i];
+        uint64_t issued;
+        if (mode == REPLAY_OPEN_LOOP) {
+            // Latency is measured from when the operation was due, so time spent
+            // queued behind slow operations is charged to the engine
+            issued = start + (uint64_t)(op->timestamp_us * 1000.0 / speed);
+            timing_wait_until_ns(issued);
+        } else {
+            issued = timing_now_ns();
+        }
+        
+        int hit = execute_trace_op(engine, op, &records, &record_capacity);
+        uint64_t latency = timing_now_ns() - issued;
+        
+        latencies[op->type][stats->count[op->type]++] = latency;
+        stats->hits[op->type] += hit;
+    }
+    uint64_t end = timing_now_ns();
+    free(records);
+    
+    finish_replay_stats(stats, latencies, trace->count, end - start);
+    return 1;
+}
+
+// One thread of a parallel replay: runs every `stride`-th operation starting at `first`
+typedef struct {
+    QueryEngine* engine;
+    const Trace* trace;
+    int first;
+    int stride;
+    uint64_t* latencies[TRACE_OP_COUNT];
+    int count[TRACE_OP_COUNT];
+    int hits[TRACE_OP_COUNT];
+} ReplayWorker;
+
+static void* replay_worker(void* argument) {
+    ReplayWorker* worker = (ReplayWorker*)argument;
+    ReservationRecord* records = NULL;
+    int record_capacity = 0;
+    for (int i = worker->first; i < worker->trace->count; i += worker->stride) {
+        const TraceOp* op = &worker->trace->ops[i];
+        uint64_t issued = timing_now_ns();
+        int hit = execute_trace_op(worker->engine, op, &records, &record_capacity);
+        worker->latencies[op->type][worker->count[op->type]++] = timing_now_ns() - issued;
+        worker->hits[op->type] += hit;
+    }
+    free(records);
+    return NULL;
+}
+
+// Replay a trace closed-loop from several threads at once
+int replay_trace_parallel(QueryEngine* engine, const Trace* trace, int threads, ReplayStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (engine == NULL || trace == NULL || trace->count == 0) {
+        return 0;
+    }
+    if (threads < 1) threads = 1;
+    
+    ReplayWorker* workers = (ReplayWorker*)calloc(threads, sizeof(ReplayWorker));
+    pthread_t* handles = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    int* started = (int*)calloc(threads, sizeof(int));
+    uint64_t* latencies[TRACE_OP_COUNT] = {NULL};
+    int ok = workers != NULL && handles != NULL && started != NULL;
+    for (int t = 0; ok && t < TRACE_OP_COUNT; t++) {
+        latencies[t] = (uint64_t*)malloc(trace->count * sizeof(uint64_t));
+        ok = latencies[t] != NULL;
+    }
+    // Each worker can run at most count / threads + 1 operations of any one type
+    int share = trace->count / threads + 1;
+    for (int w = 0; ok && w < threads; w++) {
+        workers[w].engine = engine;
+        workers[w].trace = trace;
+        workers[w].first = w;
+        workers[w].stride = threads;
+        for (int t = 0; ok && t < TRACE_OP_COUNT; t++) {
+            workers[w].latencies[t] = (uint64_t*)malloc(share * sizeof(uint64_t));
+            ok = workers[w].latencies[t] != NULL;
+        }
+    }
+    if (!ok) {
+        fprintf(stderr, "Memory allocation failed for parallel replay\n");
+    }
+    
+    uint64_t start = timing_now_ns();
+    for (int w = 0; ok && w < threads; w++) {
+        // Fall back to running the share on this thread if a worker can't be started
+        started[w] = pthread_create(&handles[w], NULL, replay_worker, &workers[w]) == 0;
+        if (!started[w]) {
+            replay_worker(&workers[w]);
+        }
+    }
+    for (int w = 0; ok && w < threads; w++) {
+        if (started[w]) {
+            pthread_join(handles[w], NULL);
+        }
+    }
+    uint64_t end = timing_now_ns();
+    
+    // Merge the per-thread latencies before computing percentiles
+    for (int w = 0; ok && w < threads; w++) {
+        for (int t = 0; t < TRACE_OP_COUNT; t++) {
+            memcpy(latencies[t] + stats->count[t], workers[w].latencies[t], workers[w].count[t] * sizeof(uint64_t));
+            stats->count[t] += workers[w].count[t];
+            stats->hits[t] += workers[w].hits[t];
+        }
+    }
+    if (ok) {
+        finish_replay_stats(stats, latencies, trace->count, end - start);
+    } else {
+        for (int t = 0; t < TRACE_OP_COUNT; t++) free(latencies[t]);
+    }
+    
+    for (int w = 0; workers != NULL && w < threads; w++) {
+        for (int t = 0; t < TRACE_OP_COUNT; t++) free(workers[w].latencies[t]);
+    }
+    free(workers);
+    free(handles);
+    free(started);
+    return ok;
+}
+
+// Print throughput and per-operation latency percentiles
+void print_replay_stats(const QueryEngine* engine, const ReplayStats* stats, ReplayMode mode) {
+    int total = 0;
+    for (int t = 0; t < TRACE_OP_COUNT; t++) {
+        total += stats->count[t];
+    }
+    
+    printf("\n%s - %s replay\n", engine->name, mode == REPLAY_OPEN_LOOP ? "open-loop" : "closed-loop");
+    printf("Operations: %d in %.3f seconds (%.0f ops/sec)\n", total, stats->elapsed_seconds, stats->throughput);
+    printf("%-14s %9s %9s %12s %12s %12s %12s\n", "Operation", "Count", "Hits", "p50 (us)", "p99 (us)",
+           "p999 (us)", "max (us)");
+    for (int t = 0; t < TRACE_OP_COUNT; t++) {
+        if (stats->count[t] == 0) continue;
+        printf("%-14s %9d %9d %12.2f %12.2f %12.2f %12.2f\n", trace_op_name(t), stats->count[t], stats->hits[t],
+               stats->p50_ns[t] / 1000.0, stats->p99_ns[t] / 1000.0,
+               stats->p999_ns[t] / 1000.0, stats->max_ns[t] / 1000.0);
+    }
+}
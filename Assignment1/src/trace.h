@@ -0,0 +1,119 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "airline_types.h"
+#include "engine.h"
+
+// Trace file format (text, one operation per line, '#' starts a comment):
+//   <timestamp_us> FLIGHT_ID <flightId>
+//   <timestamp_us> FLIGHT_NUMBER <flightNumber>
+//   <timestamp_us> PASSENGER <passengerId>
+//   <timestamp_us> BOOKINGS <passengerId>
+//   <timestamp_us> BOOK <flightId> <passengerId> <seat>
+//   <timestamp_us> CANCEL <flightId> <passengerId>
+// Timestamps are microseconds since the start of the trace
+
+// Operation types
+typedef enum {
+    TRACE_FLIGHT_BY_ID = 0,
+    TRACE_FLIGHT_BY_NUMBER,
+    TRACE_PASSENGER_BY_ID,
+    TRACE_LIST_BOOKINGS,
+    TRACE_BOOK,
+    TRACE_CANCEL,
+    TRACE_OP_COUNT
+} TraceOpType;
+
+// One traced operation
+typedef struct {
+    uint64_t timestamp_us;
+    int type;
+    int flightId;
+    int passengerId;
+    char key[MAX_FLIGHT_ID_LENGTH];  // Flight number (FLIGHT_NUMBER) or seat (BOOK)
+} TraceOp;
+
+// An in-memory trace
+typedef struct {
+    TraceOp* ops;
+    int count;
+    int capacity;
+} Trace;
+
+// Settings for generating synthetic traces
+typedef struct {
+    int op_count;
+    double mix[TRACE_OP_COUNT];  // Relative weight of each operation type
+    double key_skew;             // Zipf exponent for flight/passenger popularity (0 = uniform)
+    double rate;                 // Mean arrival rate in operations per second (Poisson arrivals)
+    unsigned int seed;
+} TraceConfig;
+
+// Records the menu operations of an interactive session
+typedef struct {
+    FILE* file;
+    uint64_t start_ns;
+} TraceRecorder;
+
+// Replay modes
+typedef enum {
+    REPLAY_CLOSED_LOOP = 0,  // Issue the next operation as soon as the previous one finishes
+    REPLAY_OPEN_LOOP         // Issue operations at their trace timestamps, whatever the backlog
+} ReplayMode;
+
+// Results of replaying a trace
+typedef struct {
+    int count[TRACE_OP_COUNT];
+    int hits[TRACE_OP_COUNT];  // Lookups that found a record / bookings and cancels that succeeded
+    uint64_t p50_ns[TRACE_OP_COUNT];
+    uint64_t p99_ns[TRACE_OP_COUNT];
+    uint64_t p999_ns[TRACE_OP_COUNT];
+    uint64_t max_ns[TRACE_OP_COUNT];
+    double elapsed_seconds;
+    double throughput;  // Operations per second over the whole replay
+} ReplayStats;
+
+// Name of an operation type as used in trace files
+const char* trace_op_name(int type);
+
+// Default trace settings: read-heavy mix with moderate key skew
+TraceConfig default_trace_config();
+
+// Generate a trace against a dataset (reservations seed the pool of cancellable bookings)
+Trace* generate_trace(const TraceConfig* config,
+                      const Flight* flights, int flight_count,
+                      const Passenger* passengers, int passenger_count,
+                      const ReservationRecord* reservations, int reservation_count);
+
+// Save a trace to a file. Returns 1 on success
+int save_trace(const Trace* trace, const char* path);
+
+// Load a trace from a file. Returns NULL on failure
+Trace* load_trace(const char* path);
+
+// Free a trace
+void free_trace(Trace* trace);
+
+// Start recording to a file. Returns NULL on failure
+TraceRecorder* trace_recorder_open(const char* path);
+
+// Record one operation (key may be NULL)
+void trace_record(TraceRecorder* recorder, int type, int flightId, int passengerId, const char* key);
+
+// Stop recording and close the file
+void trace_recorder_close(TraceRecorder* recorder);
+
+// Replay a trace against an engine. `speed` scales open-loop timestamps (2.0 = twice as fast)
+// Returns 1 on success
+int replay_trace(QueryEngine* engine, const Trace* trace, ReplayMode mode, double speed, ReplayStats* stats);
+
+// Replay a trace closed-loop from `threads` threads, each running every threads-th operation.
+// The engine must be safe to call concurrently (engine 3). Returns 1 on success
+int replay_trace_parallel(QueryEngine* engine, const Trace* trace, int threads, ReplayStats* stats);
+
+// Print throughput and per-operation latency percentiles
+void print_replay_stats(const QueryEngine* engine, const ReplayStats* stats, ReplayMode mode);
+
+#endif